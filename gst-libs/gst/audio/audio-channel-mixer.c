@@ -29,6 +29,11 @@
 
 #include "audio-channel-mixer.h"
 
+#if defined (HAVE_EMMINTRIN_H) && defined (__SSE2__)
+#include <emmintrin.h>
+#define HAVE_MIX_SSE2 1
+#endif
+
 #ifndef GST_DISABLE_GST_DEBUG
 #define GST_CAT_DEFAULT ensure_debug_category()
 static GstDebugCategory *
@@ -70,6 +75,20 @@ struct _GstAudioChannelMixer
    * this is matrix * (2^10) as integers */
   gint **matrix_int;
 
+  /* non-zero matrix entries per output channel, m[out_channels][in_channels].
+   * taps holds the input channel and coeffs/coeffs_int the coefficient of
+   * the first n_taps[out] entries of each row */
+  gint *n_taps;
+  gint *taps;
+  gfloat *coeffs;
+  gint *coeffs_int;
+
+  /* input channels contributing to a stereo output and their coefficients
+   * for both output channels, used by the SIMD stereo downmix */
+  gint n_stereo_taps;
+  gint *stereo_taps;
+  gfloat *stereo_coeffs;
+
   MixerFunc func;
 };
 
@@ -95,6 +114,13 @@ gst_audio_channel_mixer_free (GstAudioChannelMixer * mix)
   g_free (mix->matrix_int);
   mix->matrix_int = NULL;
 
+  g_free (mix->n_taps);
+  g_free (mix->taps);
+  g_free (mix->coeffs);
+  g_free (mix->coeffs_int);
+  g_free (mix->stereo_taps);
+  g_free (mix->stereo_coeffs);
+
   g_slice_free (GstAudioChannelMixer, mix);
 }
 
@@ -806,6 +832,467 @@ DEFINE_FLOAT_MIX_FUNC (double, interleaved, planar);
 DEFINE_FLOAT_MIX_FUNC (double, planar, interleaved);
 DEFINE_FLOAT_MIX_FUNC (double, planar, planar);
 
+/* The functions below are selected by gst_audio_channel_mixer_setup_func()
+ * after analysing the matrix. They only visit the non-zero coefficients and
+ * produce the same samples as the dense functions above. */
+
+/* every output channel is a copy of one input channel or silence */
+#define DEFINE_PERMUTE_FUNC(name, type, inlayout, outlayout) \
+static void \
+gst_audio_channel_mixer_permute_##name##_##inlayout##_##outlayout ( \
+    GstAudioChannelMixer * mix, const type * in_data[], \
+    type * out_data[], gint samples) \
+{ \
+  gint out, n; \
+  gint inchannels, outchannels; \
+  \
+  inchannels = mix->in_channels; \
+  outchannels = mix->out_channels; \
+  \
+  for (n = 0; n < samples; n++) { \
+    for (out = 0; out < outchannels; out++) { \
+      *_get_out_data_##outlayout##_##type (out_data, n, out, outchannels) = \
+          mix->n_taps[out] ? _get_in_data_##inlayout##_##type (in_data, n, \
+          mix->taps[out * inchannels], inchannels) : 0; \
+    } \
+  } \
+}
+
+#define DEFINE_PERMUTE_PLANAR_FUNC(name, type) \
+static void \
+gst_audio_channel_mixer_permute_##name##_planar_planar ( \
+    GstAudioChannelMixer * mix, const type * in_data[], \
+    type * out_data[], gint samples) \
+{ \
+  gint out; \
+  \
+  for (out = 0; out < mix->out_channels; out++) { \
+    if (mix->n_taps[out]) \
+      memcpy (out_data[out], in_data[mix->taps[out * mix->in_channels]], \
+          samples * sizeof (type)); \
+    else \
+      memset (out_data[out], 0, samples * sizeof (type)); \
+  } \
+}
+
+/* output channel c is input channel c multiplied with a gain, the gain is
+ * the only coefficient of row c */
+#define DEFINE_INTEGER_GAIN_FUNC(bits, resbits, inlayout, outlayout) \
+static void \
+gst_audio_channel_mixer_gain_int##bits##_##inlayout##_##outlayout ( \
+    GstAudioChannelMixer * mix, const gint##bits * in_data[], \
+    gint##bits * out_data[], gint samples) \
+{ \
+  gint c, n; \
+  gint##resbits res; \
+  gint channels; \
+  \
+  channels = mix->in_channels; \
+  \
+  for (n = 0; n < samples; n++) { \
+    for (c = 0; c < channels; c++) { \
+      res = \
+          _get_in_data_##inlayout##_gint##bits (in_data, n, c, channels) * \
+          (gint##resbits) mix->coeffs_int[c * channels]; \
+      res = (res + (1 << (PRECISION_INT - 1))) >> PRECISION_INT; \
+      *_get_out_data_##outlayout##_gint##bits (out_data, n, c, channels) = \
+          CLAMP (res, G_MININT##bits, G_MAXINT##bits); \
+    } \
+  } \
+}
+
+#define DEFINE_FLOAT_GAIN_FUNC(type, inlayout, outlayout) \
+static void \
+gst_audio_channel_mixer_gain_##type##_##inlayout##_##outlayout ( \
+    GstAudioChannelMixer * mix, const g##type * in_data[], \
+    g##type * out_data[], gint samples) \
+{ \
+  gint c, n; \
+  gint channels; \
+  \
+  channels = mix->in_channels; \
+  \
+  for (n = 0; n < samples; n++) { \
+    for (c = 0; c < channels; c++) { \
+      *_get_out_data_##outlayout##_g##type (out_data, n, c, channels) = \
+          _get_in_data_##inlayout##_g##type (in_data, n, c, channels) * \
+          mix->coeffs[c * channels]; \
+    } \
+  } \
+}
+
+#define DEFINE_INTEGER_SPARSE_FUNC(bits, resbits, inlayout, outlayout) \
+static void \
+gst_audio_channel_mixer_sparse_int##bits##_##inlayout##_##outlayout ( \
+    GstAudioChannelMixer * mix, const gint##bits * in_data[], \
+    gint##bits * out_data[], gint samples) \
+{ \
+  gint out, n, k; \
+  gint##resbits res; \
+  gint inchannels, outchannels; \
+  \
+  inchannels = mix->in_channels; \
+  outchannels = mix->out_channels; \
+  \
+  for (n = 0; n < samples; n++) { \
+    for (out = 0; out < outchannels; out++) { \
+      const gint *taps = &mix->taps[out * inchannels]; \
+      const gint *coeffs = &mix->coeffs_int[out * inchannels]; \
+      \
+      res = 0; \
+      for (k = 0; k < mix->n_taps[out]; k++) \
+        res += \
+          _get_in_data_##inlayout##_gint##bits (in_data, n, taps[k], \
+              inchannels) * (gint##resbits) coeffs[k]; \
+      \
+      res = (res + (1 << (PRECISION_INT - 1))) >> PRECISION_INT; \
+      *_get_out_data_##outlayout##_gint##bits (out_data, n, out, outchannels) = \
+          CLAMP (res, G_MININT##bits, G_MAXINT##bits); \
+    } \
+  } \
+}
+
+#define DEFINE_FLOAT_SPARSE_FUNC(type, inlayout, outlayout) \
+static void \
+gst_audio_channel_mixer_sparse_##type##_##inlayout##_##outlayout ( \
+    GstAudioChannelMixer * mix, const g##type * in_data[], \
+    g##type * out_data[], gint samples) \
+{ \
+  gint out, n, k; \
+  g##type res; \
+  gint inchannels, outchannels; \
+  \
+  inchannels = mix->in_channels; \
+  outchannels = mix->out_channels; \
+  \
+  for (n = 0; n < samples; n++) { \
+    for (out = 0; out < outchannels; out++) { \
+      const gint *taps = &mix->taps[out * inchannels]; \
+      const gfloat *coeffs = &mix->coeffs[out * inchannels]; \
+      \
+      res = 0.0; \
+      for (k = 0; k < mix->n_taps[out]; k++) \
+        res += \
+          _get_in_data_##inlayout##_g##type (in_data, n, taps[k], \
+              inchannels) * coeffs[k]; \
+      \
+      *_get_out_data_##outlayout##_g##type (out_data, n, out, outchannels) = res; \
+    } \
+  } \
+}
+
+DEFINE_PERMUTE_FUNC (int16, gint16, interleaved, interleaved);
+DEFINE_PERMUTE_FUNC (int16, gint16, interleaved, planar);
+DEFINE_PERMUTE_FUNC (int16, gint16, planar, interleaved);
+DEFINE_PERMUTE_PLANAR_FUNC (int16, gint16);
+DEFINE_INTEGER_GAIN_FUNC (16, 32, interleaved, interleaved);
+DEFINE_INTEGER_GAIN_FUNC (16, 32, interleaved, planar);
+DEFINE_INTEGER_GAIN_FUNC (16, 32, planar, interleaved);
+DEFINE_INTEGER_GAIN_FUNC (16, 32, planar, planar);
+DEFINE_INTEGER_SPARSE_FUNC (16, 32, interleaved, interleaved);
+DEFINE_INTEGER_SPARSE_FUNC (16, 32, interleaved, planar);
+DEFINE_INTEGER_SPARSE_FUNC (16, 32, planar, interleaved);
+DEFINE_INTEGER_SPARSE_FUNC (16, 32, planar, planar);
+
+DEFINE_PERMUTE_FUNC (int32, gint32, interleaved, interleaved);
+DEFINE_PERMUTE_FUNC (int32, gint32, interleaved, planar);
+DEFINE_PERMUTE_FUNC (int32, gint32, planar, interleaved);
+DEFINE_PERMUTE_PLANAR_FUNC (int32, gint32);
+DEFINE_INTEGER_GAIN_FUNC (32, 64, interleaved, interleaved);
+DEFINE_INTEGER_GAIN_FUNC (32, 64, interleaved, planar);
+DEFINE_INTEGER_GAIN_FUNC (32, 64, planar, interleaved);
+DEFINE_INTEGER_GAIN_FUNC (32, 64, planar, planar);
+DEFINE_INTEGER_SPARSE_FUNC (32, 64, interleaved, interleaved);
+DEFINE_INTEGER_SPARSE_FUNC (32, 64, interleaved, planar);
+DEFINE_INTEGER_SPARSE_FUNC (32, 64, planar, interleaved);
+DEFINE_INTEGER_SPARSE_FUNC (32, 64, planar, planar);
+
+DEFINE_PERMUTE_FUNC (float, gfloat, interleaved, interleaved);
+DEFINE_PERMUTE_FUNC (float, gfloat, interleaved, planar);
+DEFINE_PERMUTE_FUNC (float, gfloat, planar, interleaved);
+DEFINE_PERMUTE_PLANAR_FUNC (float, gfloat);
+DEFINE_FLOAT_GAIN_FUNC (float, interleaved, interleaved);
+DEFINE_FLOAT_GAIN_FUNC (float, interleaved, planar);
+DEFINE_FLOAT_GAIN_FUNC (float, planar, interleaved);
+DEFINE_FLOAT_GAIN_FUNC (float, planar, planar);
+DEFINE_FLOAT_SPARSE_FUNC (float, interleaved, interleaved);
+DEFINE_FLOAT_SPARSE_FUNC (float, interleaved, planar);
+DEFINE_FLOAT_SPARSE_FUNC (float, planar, interleaved);
+DEFINE_FLOAT_SPARSE_FUNC (float, planar, planar);
+
+DEFINE_PERMUTE_FUNC (double, gdouble, interleaved, interleaved);
+DEFINE_PERMUTE_FUNC (double, gdouble, interleaved, planar);
+DEFINE_PERMUTE_FUNC (double, gdouble, planar, interleaved);
+DEFINE_PERMUTE_PLANAR_FUNC (double, gdouble);
+DEFINE_FLOAT_GAIN_FUNC (double, interleaved, interleaved);
+DEFINE_FLOAT_GAIN_FUNC (double, interleaved, planar);
+DEFINE_FLOAT_GAIN_FUNC (double, planar, interleaved);
+DEFINE_FLOAT_GAIN_FUNC (double, planar, planar);
+DEFINE_FLOAT_SPARSE_FUNC (double, interleaved, interleaved);
+DEFINE_FLOAT_SPARSE_FUNC (double, interleaved, planar);
+DEFINE_FLOAT_SPARSE_FUNC (double, planar, interleaved);
+DEFINE_FLOAT_SPARSE_FUNC (double, planar, planar);
+
+#ifdef HAVE_MIX_SSE2
+/* gain for 1, 2 or 4 interleaved channels, the gains repeat every 4 samples */
+static void
+gst_audio_channel_mixer_gain_float_interleaved_interleaved_sse2
+    (GstAudioChannelMixer * mix, const gfloat * in_data[],
+    gfloat * out_data[], gint samples)
+{
+  const gfloat *in = in_data[0];
+  gfloat *out = out_data[0];
+  gint i, channels, total;
+  __m128 g;
+
+  channels = mix->in_channels;
+  total = samples * channels;
+
+  g = _mm_set_ps (mix->coeffs[(3 % channels) * channels],
+      mix->coeffs[(2 % channels) * channels],
+      mix->coeffs[(1 % channels) * channels], mix->coeffs[0]);
+
+  for (i = 0; i + 4 <= total; i += 4)
+    _mm_storeu_ps (out + i, _mm_mul_ps (_mm_loadu_ps (in + i), g));
+  for (; i < total; i++)
+    out[i] = in[i] * mix->coeffs[(i % channels) * channels];
+}
+
+static void
+gst_audio_channel_mixer_gain_float_planar_planar_sse2 (GstAudioChannelMixer *
+    mix, const gfloat * in_data[], gfloat * out_data[], gint samples)
+{
+  gint c, i, channels;
+
+  channels = mix->in_channels;
+
+  for (c = 0; c < channels; c++) {
+    const gfloat *in = in_data[c];
+    gfloat *out = out_data[c];
+    gfloat gain = mix->coeffs[c * channels];
+    __m128 g = _mm_set1_ps (gain);
+
+    for (i = 0; i + 4 <= samples; i += 4)
+      _mm_storeu_ps (out + i, _mm_mul_ps (_mm_loadu_ps (in + i), g));
+    for (; i < samples; i++)
+      out[i] = in[i] * gain;
+  }
+}
+
+/* mix to interleaved stereo, two output frames at a time. The stereo taps
+ * contain the input channels used by either output channel, adding the
+ * products with a zero coefficient does not change the result. */
+static void
+gst_audio_channel_mixer_stereo_float_interleaved_interleaved_sse2
+    (GstAudioChannelMixer * mix, const gfloat * in_data[],
+    gfloat * out_data[], gint samples)
+{
+  const gfloat *in = in_data[0];
+  gfloat *out = out_data[0];
+  const gint *taps = mix->stereo_taps;
+  const gfloat *coeffs = mix->stereo_coeffs;
+  gint n, k, inchannels, n_taps;
+
+  inchannels = mix->in_channels;
+  n_taps = mix->n_stereo_taps;
+
+  for (n = 0; n + 2 <= samples; n += 2) {
+    const gfloat *in0 = in + n * inchannels;
+    const gfloat *in1 = in0 + inchannels;
+    __m128 res = _mm_setzero_ps ();
+
+    for (k = 0; k < n_taps; k++) {
+      __m128 x = _mm_set_ps (in1[taps[k]], in1[taps[k]], in0[taps[k]],
+          in0[taps[k]]);
+
+      res = _mm_add_ps (res, _mm_mul_ps (x, _mm_loadu_ps (&coeffs[4 * k])));
+    }
+    _mm_storeu_ps (out + 2 * n, res);
+  }
+  for (; n < samples; n++) {
+    const gfloat *in0 = in + n * inchannels;
+    gfloat l = 0.0, r = 0.0;
+
+    for (k = 0; k < n_taps; k++) {
+      l += in0[taps[k]] * coeffs[4 * k];
+      r += in0[taps[k]] * coeffs[4 * k + 1];
+    }
+    out[2 * n] = l;
+    out[2 * n + 1] = r;
+  }
+}
+
+static void
+gst_audio_channel_mixer_stereo_double_interleaved_interleaved_sse2
+    (GstAudioChannelMixer * mix, const gdouble * in_data[],
+    gdouble * out_data[], gint samples)
+{
+  const gdouble *in = in_data[0];
+  gdouble *out = out_data[0];
+  const gint *taps = mix->stereo_taps;
+  const gfloat *coeffs = mix->stereo_coeffs;
+  gint n, k, inchannels, n_taps;
+
+  inchannels = mix->in_channels;
+  n_taps = mix->n_stereo_taps;
+
+  for (n = 0; n < samples; n++) {
+    const gdouble *in0 = in + n * inchannels;
+    __m128d res = _mm_setzero_pd ();
+
+    for (k = 0; k < n_taps; k++) {
+      __m128d c = _mm_cvtps_pd (_mm_loadu_ps (&coeffs[4 * k]));
+
+      res = _mm_add_pd (res, _mm_mul_pd (_mm_set1_pd (in0[taps[k]]), c));
+    }
+    _mm_storeu_pd (out + 2 * n, res);
+  }
+}
+#endif
+
+#define MIX_FUNC(kind, name, inlayout, outlayout) \
+  (MixerFunc) gst_audio_channel_mixer_##kind##_##name##_##inlayout##_##outlayout
+
+#define MIX_FUNC_TABLE(kind, name) \
+  { { MIX_FUNC (kind, name, interleaved, interleaved), \
+      MIX_FUNC (kind, name, interleaved, planar) }, \
+    { MIX_FUNC (kind, name, planar, interleaved), \
+      MIX_FUNC (kind, name, planar, planar) } }
+
+/* indexed by format (S16, S32, F32, F64), non-interleaved in and out */
+static const MixerFunc permute_funcs[4][2][2] = {
+  MIX_FUNC_TABLE (permute, int16),
+  MIX_FUNC_TABLE (permute, int32),
+  MIX_FUNC_TABLE (permute, float),
+  MIX_FUNC_TABLE (permute, double),
+};
+
+static const MixerFunc gain_funcs[4][2][2] = {
+  MIX_FUNC_TABLE (gain, int16),
+  MIX_FUNC_TABLE (gain, int32),
+  MIX_FUNC_TABLE (gain, float),
+  MIX_FUNC_TABLE (gain, double),
+};
+
+static const MixerFunc sparse_funcs[4][2][2] = {
+  MIX_FUNC_TABLE (sparse, int16),
+  MIX_FUNC_TABLE (sparse, int32),
+  MIX_FUNC_TABLE (sparse, float),
+  MIX_FUNC_TABLE (sparse, double),
+};
+
+/* collect the non-zero coefficients of the matrix in the taps and pick the
+ * most specialized function for it. Integer formats look at the int matrix
+ * as that is what the integer functions use. */
+static void
+gst_audio_channel_mixer_setup_func (GstAudioChannelMixer * mix,
+    GstAudioFormat format, GstAudioChannelMixerFlags flags)
+{
+  gint i, j, n_coeffs = 0, f, in_planar, out_planar;
+  gboolean is_int, permute = TRUE, gain;
+
+  is_int = format == GST_AUDIO_FORMAT_S16 || format == GST_AUDIO_FORMAT_S32;
+  gain = mix->in_channels == mix->out_channels;
+
+  mix->n_taps = g_new0 (gint, mix->out_channels);
+  mix->taps = g_new0 (gint, mix->out_channels * mix->in_channels);
+  mix->coeffs = g_new0 (gfloat, mix->out_channels * mix->in_channels);
+  mix->coeffs_int = g_new0 (gint, mix->out_channels * mix->in_channels);
+
+  for (j = 0; j < mix->out_channels; j++) {
+    gint *n_taps = &mix->n_taps[j];
+    gint row = j * mix->in_channels;
+
+    for (i = 0; i < mix->in_channels; i++) {
+      gboolean unit;
+
+      if (is_int ? mix->matrix_int[i][j] == 0 : mix->matrix[i][j] == 0.0f)
+        continue;
+
+      unit = is_int ? mix->matrix_int[i][j] == (1 << PRECISION_INT) :
+          mix->matrix[i][j] == 1.0f;
+
+      mix->taps[row + *n_taps] = i;
+      mix->coeffs[row + *n_taps] = mix->matrix[i][j];
+      mix->coeffs_int[row + *n_taps] = mix->matrix_int[i][j];
+      (*n_taps)++;
+      n_coeffs++;
+
+      if (!unit || *n_taps > 1)
+        permute = FALSE;
+      if (i != j)
+        gain = FALSE;
+    }
+    /* an empty row would need to produce silence */
+    if (*n_taps == 0)
+      gain = FALSE;
+  }
+
+  f = format == GST_AUDIO_FORMAT_S16 ? 0 : format == GST_AUDIO_FORMAT_S32 ?
+      1 : format == GST_AUDIO_FORMAT_F32 ? 2 : 3;
+  in_planar = !!(flags & GST_AUDIO_CHANNEL_MIXER_FLAGS_NON_INTERLEAVED_IN);
+  out_planar = !!(flags & GST_AUDIO_CHANNEL_MIXER_FLAGS_NON_INTERLEAVED_OUT);
+
+  if (permute) {
+    GST_DEBUG ("using permutation");
+    mix->func = permute_funcs[f][in_planar][out_planar];
+    return;
+  }
+  if (gain) {
+    GST_DEBUG ("using per channel gain");
+    mix->func = gain_funcs[f][in_planar][out_planar];
+#ifdef HAVE_MIX_SSE2
+    if (format == GST_AUDIO_FORMAT_F32) {
+      if (in_planar && out_planar) {
+        mix->func = (MixerFunc)
+            gst_audio_channel_mixer_gain_float_planar_planar_sse2;
+      } else if (!in_planar && !out_planar && 4 % mix->in_channels == 0) {
+        mix->func = (MixerFunc)
+            gst_audio_channel_mixer_gain_float_interleaved_interleaved_sse2;
+      }
+    }
+#endif
+    return;
+  }
+
+#ifdef HAVE_MIX_SSE2
+  if (!is_int && !in_planar && !out_planar && mix->out_channels == 2) {
+    mix->stereo_taps = g_new0 (gint, mix->in_channels);
+    mix->stereo_coeffs = g_new0 (gfloat, 4 * mix->in_channels);
+
+    for (i = 0; i < mix->in_channels; i++) {
+      gint k = mix->n_stereo_taps;
+
+      if (mix->matrix[i][0] == 0.0f && mix->matrix[i][1] == 0.0f)
+        continue;
+
+      mix->stereo_taps[k] = i;
+      mix->stereo_coeffs[4 * k] = mix->stereo_coeffs[4 * k + 2] =
+          mix->matrix[i][0];
+      mix->stereo_coeffs[4 * k + 1] = mix->stereo_coeffs[4 * k + 3] =
+          mix->matrix[i][1];
+      mix->n_stereo_taps++;
+    }
+
+    GST_DEBUG ("using SSE2 stereo mix with %d taps", mix->n_stereo_taps);
+    if (format == GST_AUDIO_FORMAT_F32)
+      mix->func = (MixerFunc)
+          gst_audio_channel_mixer_stereo_float_interleaved_interleaved_sse2;
+    else
+      mix->func = (MixerFunc)
+          gst_audio_channel_mixer_stereo_double_interleaved_interleaved_sse2;
+    return;
+  }
+#endif
+
+  /* the dense functions have less overhead per coefficient */
+  if (n_coeffs < mix->in_channels * mix->out_channels) {
+    GST_DEBUG ("using sparse matrix with %d of %d coefficients", n_coeffs,
+        mix->in_channels * mix->out_channels);
+    mix->func = sparse_funcs[f][in_planar][out_planar];
+  }
+}
+
 /**
  * gst_audio_channel_mixer_new_with_matrix: (skip):
  * @flags: #GstAudioChannelMixerFlags
@@ -967,6 +1454,9 @@ gst_audio_channel_mixer_new_with_matrix (GstAudioChannelMixerFlags flags,
       g_assert_not_reached ();
       break;
   }
+
+  gst_audio_channel_mixer_setup_func (mix, format, flags);
+
   return mix;
 }
 
@@ -145,6 +145,9 @@ struct _GstAudioConverter
   /* endian swap */
   AudioConvertEndianFunc swap_endian;
 
+  /* single pass conversion between native S16, S32 and F32 */
+  AudioConvertFunc convert_fast;
+
   AudioConvertSamplesFunc convert;
 };
 
@@ -181,6 +184,8 @@ struct _AudioChain
 
   gboolean pass_alloc;
   gboolean allow_ip;
+  /* the next element writes its output into our samples */
+  gboolean next_ip;
 
   AudioChainAllocFunc alloc_func;
   gpointer alloc_data;
@@ -451,7 +456,12 @@ do_unpack (AudioChain * chain, gpointer user_data)
   in_writable = convert->in_writable;
   num_samples = convert->in_frames;
 
-  if (!chain->allow_ip || !in_writable || !convert->in_default) {
+  if (convert->in_data && convert->in_default && !chain->next_ip &&
+      chain->alloc_func != get_output_samples) {
+    /* nothing downstream modifies our samples, read from the input */
+    tmp = convert->in_data;
+    GST_LOG ("read in samples %p", tmp);
+  } else if (!chain->allow_ip || !in_writable || !convert->in_default) {
     gint i;
 
     if (in_writable && chain->allow_ip) {
@@ -1037,7 +1047,7 @@ chain_pack (GstAudioConverter * convert, AudioChain * prev)
 static void
 setup_allocators (GstAudioConverter * convert)
 {
-  AudioChain *chain;
+  AudioChain *chain, *next = NULL;
   AudioChainAllocFunc alloc_func;
   gboolean allow_ip;
 
@@ -1051,11 +1061,13 @@ setup_allocators (GstAudioConverter * convert)
   }
   /* now walk backwards, we try to write into the dest samples directly
    * and keep track if the source needs to be writable */
-  for (chain = convert->chain_end; chain; chain = chain->prev) {
+  for (chain = convert->chain_end; chain; next = chain, chain = chain->prev) {
     chain->alloc_func = alloc_func;
     chain->alloc_data = convert;
     chain->allow_ip = allow_ip && chain->allow_ip;
-    GST_LOG ("chain %p: %d %d", chain, allow_ip, chain->allow_ip);
+    chain->next_ip = next && next->allow_ip;
+    GST_LOG ("chain %p: %d %d %d", chain, allow_ip, chain->allow_ip,
+        chain->next_ip);
 
     if (!chain->pass_alloc) {
       /* can't pass allocator, make new temp line allocator */
@@ -1253,6 +1265,137 @@ converter_endian (GstAudioConverter * convert,
   return TRUE;
 }
 
+/* convert a double in the [-1.0, 1.0] range to S32 like
+ * audio_orc_double_to_s32() does, truncating and saturating */
+static inline gint32
+double_to_s32 (gdouble d)
+{
+  d *= 2147483648.0;
+  if (d >= -2147483648.0 && d < 2147483647.0)
+    return (gint32) d;
+
+  return d < 0.0 ? G_MININT32 : G_MAXINT32;
+}
+
+/* reduce S32 to S16 like the non-dithering quantizer and the S16 packer do */
+static inline gint16
+s32_to_s16 (gint32 v)
+{
+  if (v > G_MAXINT32 - (1 << 15))
+    return G_MAXINT16;
+
+  return (v + (1 << 15)) >> 16;
+}
+
+/* fused conversions between the native S16, S32 and F32 formats.
+ * They produce the same samples as the generic unpack, convert, quantize
+ * and pack chain, but in a single pass and without temp memory. */
+static void
+converter_s16_to_f32 (gpointer dst, const gpointer src, gint count)
+{
+  gfloat *out = dst;
+  const gint16 *in = src;
+  gint i;
+
+  for (i = 0; i < count; i++)
+    out[i] = in[i] * (1.0f / 32768.0f);
+}
+
+static void
+converter_f32_to_s16 (gpointer dst, const gpointer src, gint count)
+{
+  gint16 *out = dst;
+  const gfloat *in = src;
+  gint i;
+
+  for (i = 0; i < count; i++)
+    out[i] = s32_to_s16 (double_to_s32 (in[i]));
+}
+
+static void
+converter_s16_to_s32 (gpointer dst, const gpointer src, gint count)
+{
+  gint32 *out = dst;
+  const gint16 *in = src;
+  gint i;
+
+  for (i = 0; i < count; i++)
+    out[i] = in[i] * 65536;
+}
+
+static void
+converter_s32_to_s16 (gpointer dst, const gpointer src, gint count)
+{
+  gint16 *out = dst;
+  const gint32 *in = src;
+  gint i;
+
+  for (i = 0; i < count; i++)
+    out[i] = s32_to_s16 (in[i]);
+}
+
+static void
+converter_s32_to_f32 (gpointer dst, const gpointer src, gint count)
+{
+  gfloat *out = dst;
+  const gint32 *in = src;
+  gint i;
+
+  for (i = 0; i < count; i++)
+    out[i] = in[i] / 2147483648.0;
+}
+
+static void
+converter_f32_to_s32 (gpointer dst, const gpointer src, gint count)
+{
+  gint32 *out = dst;
+  const gfloat *in = src;
+  gint i;
+
+  for (i = 0; i < count; i++)
+    out[i] = double_to_s32 (in[i]);
+}
+
+static const struct
+{
+  GstAudioFormat in;
+  GstAudioFormat out;
+  AudioConvertFunc func;
+} fast_conversions[] = {
+  {GST_AUDIO_FORMAT_S16, GST_AUDIO_FORMAT_F32, converter_s16_to_f32},
+  {GST_AUDIO_FORMAT_F32, GST_AUDIO_FORMAT_S16, converter_f32_to_s16},
+  {GST_AUDIO_FORMAT_S16, GST_AUDIO_FORMAT_S32, converter_s16_to_s32},
+  {GST_AUDIO_FORMAT_S32, GST_AUDIO_FORMAT_S16, converter_s32_to_s16},
+  {GST_AUDIO_FORMAT_S32, GST_AUDIO_FORMAT_F32, converter_s32_to_f32},
+  {GST_AUDIO_FORMAT_F32, GST_AUDIO_FORMAT_S32, converter_f32_to_s32},
+};
+
+/* the worker function for the fused single pass conversions */
+static gboolean
+converter_fast (GstAudioConverter * convert,
+    GstAudioConverterFlags flags, gpointer in[], gsize in_frames,
+    gpointer out[], gsize out_frames)
+{
+  gint i;
+  AudioChain *chain;
+  gsize samples;
+
+  chain = convert->chain_end;
+  samples = in_frames * chain->inc;
+
+  GST_LOG ("convert fast: %" G_GSIZE_FORMAT " / %" G_GSIZE_FORMAT " samples",
+      in_frames, samples);
+
+  if (in) {
+    for (i = 0; i < chain->blocks; i++)
+      convert->convert_fast (out[i], in[i], samples);
+  } else {
+    for (i = 0; i < chain->blocks; i++)
+      gst_audio_format_fill_silence (convert->out.finfo, out[i], samples);
+  }
+  return TRUE;
+}
+
 static gboolean
 converter_generic (GstAudioConverter * convert,
     GstAudioConverterFlags flags, gpointer in[], gsize in_frames,
@@ -1423,6 +1566,24 @@ gst_audio_converter_new (GstAudioConverterFlags flags, GstAudioInfo * in_info,
             g_assert_not_reached ();
         }
       }
+    } else if (convert->resampler == NULL
+        && out_info->layout == in_info->layout
+        && (convert->quant == NULL
+            || (GET_OPT_DITHER_METHOD (convert) == GST_AUDIO_DITHER_NONE
+                && GET_OPT_NOISE_SHAPING_METHOD (convert) ==
+                GST_AUDIO_NOISE_SHAPING_NONE))) {
+      guint i;
+
+      for (i = 0; i < G_N_ELEMENTS (fast_conversions); i++) {
+        if (fast_conversions[i].in == in_info->finfo->format &&
+            fast_conversions[i].out == out_info->finfo->format) {
+          GST_INFO ("no resampler, passthrough mixing -> fast conversion "
+              "%s to %s", in_info->finfo->name, out_info->finfo->name);
+          convert->convert = converter_fast;
+          convert->convert_fast = fast_conversions[i].func;
+          break;
+        }
+      }
     }
   }
 
@@ -49,6 +49,8 @@ typedef void (*ResampleFunc) (GstAudioResampler * resampler, gpointer in[],
 typedef void (*DeinterleaveFunc) (GstAudioResampler * resampler,
     gpointer * sbuf, gpointer in[], gsize in_frames);
 
+typedef struct _GstAudioResamplerTask GstAudioResamplerTask;
+
 struct _GstAudioResampler
 {
   GstAudioResamplerMethod method;
@@ -90,6 +92,7 @@ struct _GstAudioResampler
   gpointer cached_taps;
   gpointer cached_taps_mem;
   gsize cached_taps_stride;
+  gint n_cached_phases;
 
   ConvertTapsFunc convert_taps;
   InterpolateFunc interpolate;
@@ -108,6 +111,14 @@ struct _GstAudioResampler
   gsize samples_len;
   gsize samples_avail;
   gpointer *sbuf;
+
+  /* channel groups resampled in parallel */
+  guint n_threads;
+  GThreadPool *thread_pool;
+  GstAudioResamplerTask *tasks;
+  GMutex thread_lock;
+  GCond thread_cond;
+  guint n_pending_tasks;
 };
 
 #endif /* __GST_AUDIO_RESAMPLER_PRIVATE_H__ */
@@ -0,0 +1,705 @@
+/* GStreamer
+ * Copyright (C) <2021> GStreamer developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "audio-resampler-x86-avx2.h"
+
+#if defined (HAVE_IMMINTRIN_H) && defined (__AVX2__) && defined (__FMA__)
+
+#include <immintrin.h>
+
+/* The taps are only aligned to 16 bytes so all loads and stores are
+ * unaligned. The integer inner products accumulate in vectors and apply the
+ * rounding, interpolation and clamping of the C functions to the final sums,
+ * so they produce exactly the same output as the C code. The loops never read
+ * further past len than the SSE versions. */
+
+#define LOADU256(p) _mm256_loadu_si256 ((const __m256i *) (p))
+#define STOREU256(p,v) _mm256_storeu_si256 ((__m256i *) (p), v)
+
+static inline gfloat
+hsum_ps (__m256 v)
+{
+  __m128 s;
+
+  s = _mm_add_ps (_mm256_castps256_ps128 (v), _mm256_extractf128_ps (v, 1));
+  s = _mm_add_ps (s, _mm_movehl_ps (s, s));
+  s = _mm_add_ss (s, _mm_shuffle_ps (s, s, 0x55));
+
+  return _mm_cvtss_f32 (s);
+}
+
+static inline gdouble
+hsum_pd (__m256d v)
+{
+  __m128d s;
+
+  s = _mm_add_pd (_mm256_castpd256_pd128 (v), _mm256_extractf128_pd (v, 1));
+  s = _mm_add_sd (s, _mm_unpackhi_pd (s, s));
+
+  return _mm_cvtsd_f64 (s);
+}
+
+static inline gint32
+hsum_epi32 (__m256i v)
+{
+  __m128i s;
+
+  s = _mm_add_epi32 (_mm256_castsi256_si128 (v),
+      _mm256_extracti128_si256 (v, 1));
+  s = _mm_add_epi32 (s, _mm_shuffle_epi32 (s, _MM_SHUFFLE (2, 3, 2, 3)));
+  s = _mm_add_epi32 (s, _mm_shuffle_epi32 (s, _MM_SHUFFLE (1, 1, 1, 1)));
+
+  return _mm_cvtsi128_si32 (s);
+}
+
+static inline void
+inner_product_gint16_full_1_avx2 (gint16 * o, const gint16 * a,
+    const gint16 * b, gint len, const gint16 * icoeff, gint bstride)
+{
+  gint i;
+  gint32 res;
+  __m256i sum = _mm256_setzero_si256 ();
+
+  for (i = 0; i < len; i += 16)
+    sum = _mm256_add_epi32 (sum, _mm256_madd_epi16 (LOADU256 (a + i),
+            LOADU256 (b + i)));
+
+  res = hsum_epi32 (sum);
+  res = (res + (1 << (PRECISION_S16 - 1))) >> PRECISION_S16;
+  *o = CLAMP (res, G_MININT16, G_MAXINT16);
+}
+
+static inline void
+inner_product_gint16_linear_1_avx2 (gint16 * o, const gint16 * a,
+    const gint16 * b, gint len, const gint16 * icoeff, gint bstride)
+{
+  gint i;
+  gint32 res[2], c0 = icoeff[0];
+  __m256i sum[2], t;
+  const gint16 *c[2] = { (gint16 *) ((gint8 *) b + 0 * bstride),
+    (gint16 *) ((gint8 *) b + 1 * bstride)
+  };
+
+  sum[0] = sum[1] = _mm256_setzero_si256 ();
+
+  for (i = 0; i < len; i += 16) {
+    t = LOADU256 (a + i);
+    sum[0] = _mm256_add_epi32 (sum[0], _mm256_madd_epi16 (t,
+            LOADU256 (c[0] + i)));
+    sum[1] = _mm256_add_epi32 (sum[1], _mm256_madd_epi16 (t,
+            LOADU256 (c[1] + i)));
+  }
+  res[0] = hsum_epi32 (sum[0]) >> PRECISION_S16;
+  res[1] = hsum_epi32 (sum[1]) >> PRECISION_S16;
+  res[0] = ((gint32) (gint16) res[0] - (gint32) (gint16) res[1]) * c0 +
+      ((gint32) (gint16) res[1] << PRECISION_S16);
+  res[0] = (res[0] + (1 << (PRECISION_S16 - 1))) >> PRECISION_S16;
+  *o = CLAMP (res[0], G_MININT16, G_MAXINT16);
+}
+
+static inline void
+inner_product_gint16_cubic_1_avx2 (gint16 * o, const gint16 * a,
+    const gint16 * b, gint len, const gint16 * icoeff, gint bstride)
+{
+  gint i;
+  gint32 res;
+  __m256i sum[4], t;
+  const gint16 *c[4] = { (gint16 *) ((gint8 *) b + 0 * bstride),
+    (gint16 *) ((gint8 *) b + 1 * bstride),
+    (gint16 *) ((gint8 *) b + 2 * bstride),
+    (gint16 *) ((gint8 *) b + 3 * bstride)
+  };
+
+  sum[0] = sum[1] = sum[2] = sum[3] = _mm256_setzero_si256 ();
+
+  for (i = 0; i < len; i += 16) {
+    t = LOADU256 (a + i);
+    sum[0] = _mm256_add_epi32 (sum[0], _mm256_madd_epi16 (t,
+            LOADU256 (c[0] + i)));
+    sum[1] = _mm256_add_epi32 (sum[1], _mm256_madd_epi16 (t,
+            LOADU256 (c[1] + i)));
+    sum[2] = _mm256_add_epi32 (sum[2], _mm256_madd_epi16 (t,
+            LOADU256 (c[2] + i)));
+    sum[3] = _mm256_add_epi32 (sum[3], _mm256_madd_epi16 (t,
+            LOADU256 (c[3] + i)));
+  }
+  res = (gint32) (gint16) (hsum_epi32 (sum[0]) >> PRECISION_S16) * icoeff[0] +
+      (gint32) (gint16) (hsum_epi32 (sum[1]) >> PRECISION_S16) * icoeff[1] +
+      (gint32) (gint16) (hsum_epi32 (sum[2]) >> PRECISION_S16) * icoeff[2] +
+      (gint32) (gint16) (hsum_epi32 (sum[3]) >> PRECISION_S16) * icoeff[3];
+  res = (res + (1 << (PRECISION_S16 - 1))) >> PRECISION_S16;
+  *o = CLAMP (res, G_MININT16, G_MAXINT16);
+}
+
+#if defined (__x86_64__)
+static inline gint64
+hsum_epi64 (__m256i v)
+{
+  __m128i s;
+
+  s = _mm_add_epi64 (_mm256_castsi256_si128 (v),
+      _mm256_extracti128_si256 (v, 1));
+  s = _mm_add_epi64 (s, _mm_unpackhi_epi64 (s, s));
+
+  return _mm_cvtsi128_si64 (s);
+}
+
+/* multiply the signed 32 bits samples in the even and odd lanes of a and b
+ * and add the 64 bits products to sum */
+static inline __m256i
+madd_epi32_epi64 (__m256i sum, __m256i a, __m256i b)
+{
+  sum = _mm256_add_epi64 (sum, _mm256_mul_epi32 (a, b));
+  sum = _mm256_add_epi64 (sum, _mm256_mul_epi32 (_mm256_srli_epi64 (a, 32),
+          _mm256_srli_epi64 (b, 32)));
+
+  return sum;
+}
+
+static inline void
+inner_product_gint32_full_1_avx2 (gint32 * o, const gint32 * a,
+    const gint32 * b, gint len, const gint32 * icoeff, gint bstride)
+{
+  gint i;
+  gint64 res;
+  __m256i sum = _mm256_setzero_si256 ();
+
+  for (i = 0; i < len; i += 8)
+    sum = madd_epi32_epi64 (sum, LOADU256 (a + i), LOADU256 (b + i));
+
+  res = hsum_epi64 (sum);
+  res = (res + ((gint64) 1 << (PRECISION_S32 - 1))) >> PRECISION_S32;
+  *o = CLAMP (res, G_MININT32, G_MAXINT32);
+}
+
+static inline void
+inner_product_gint32_linear_1_avx2 (gint32 * o, const gint32 * a,
+    const gint32 * b, gint len, const gint32 * icoeff, gint bstride)
+{
+  gint i;
+  gint64 res[2], c0 = icoeff[0];
+  __m256i sum[2], t;
+  const gint32 *c[2] = { (gint32 *) ((gint8 *) b + 0 * bstride),
+    (gint32 *) ((gint8 *) b + 1 * bstride)
+  };
+
+  sum[0] = sum[1] = _mm256_setzero_si256 ();
+
+  for (i = 0; i < len; i += 8) {
+    t = LOADU256 (a + i);
+    sum[0] = madd_epi32_epi64 (sum[0], t, LOADU256 (c[0] + i));
+    sum[1] = madd_epi32_epi64 (sum[1], t, LOADU256 (c[1] + i));
+  }
+  res[0] = hsum_epi64 (sum[0]) >> PRECISION_S32;
+  res[1] = hsum_epi64 (sum[1]) >> PRECISION_S32;
+  res[0] = ((gint64) (gint32) res[0] - (gint64) (gint32) res[1]) * c0 +
+      ((gint64) (gint32) res[1] << PRECISION_S32);
+  res[0] = (res[0] + ((gint64) 1 << (PRECISION_S32 - 1))) >> PRECISION_S32;
+  *o = CLAMP (res[0], G_MININT32, G_MAXINT32);
+}
+
+static inline void
+inner_product_gint32_cubic_1_avx2 (gint32 * o, const gint32 * a,
+    const gint32 * b, gint len, const gint32 * icoeff, gint bstride)
+{
+  gint i;
+  gint64 res;
+  __m256i sum[4], t;
+  const gint32 *c[4] = { (gint32 *) ((gint8 *) b + 0 * bstride),
+    (gint32 *) ((gint8 *) b + 1 * bstride),
+    (gint32 *) ((gint8 *) b + 2 * bstride),
+    (gint32 *) ((gint8 *) b + 3 * bstride)
+  };
+
+  sum[0] = sum[1] = sum[2] = sum[3] = _mm256_setzero_si256 ();
+
+  for (i = 0; i < len; i += 8) {
+    t = LOADU256 (a + i);
+    sum[0] = madd_epi32_epi64 (sum[0], t, LOADU256 (c[0] + i));
+    sum[1] = madd_epi32_epi64 (sum[1], t, LOADU256 (c[1] + i));
+    sum[2] = madd_epi32_epi64 (sum[2], t, LOADU256 (c[2] + i));
+    sum[3] = madd_epi32_epi64 (sum[3], t, LOADU256 (c[3] + i));
+  }
+  res = (gint64) (gint32) (hsum_epi64 (sum[0]) >> PRECISION_S32) * icoeff[0] +
+      (gint64) (gint32) (hsum_epi64 (sum[1]) >> PRECISION_S32) * icoeff[1] +
+      (gint64) (gint32) (hsum_epi64 (sum[2]) >> PRECISION_S32) * icoeff[2] +
+      (gint64) (gint32) (hsum_epi64 (sum[3]) >> PRECISION_S32) * icoeff[3];
+  res = (res + ((gint64) 1 << (PRECISION_S32 - 1))) >> PRECISION_S32;
+  *o = CLAMP (res, G_MININT32, G_MAXINT32);
+}
+
+MAKE_RESAMPLE_FUNC (gint32, full, 1, avx2);
+MAKE_RESAMPLE_FUNC (gint32, linear, 1, avx2);
+MAKE_RESAMPLE_FUNC (gint32, cubic, 1, avx2);
+#endif
+
+static inline void
+inner_product_gfloat_full_1_avx2 (gfloat * o, const gfloat * a,
+    const gfloat * b, gint len, const gfloat * icoeff, gint bstride)
+{
+  gint i = 0;
+  __m256 sum[2];
+
+  sum[0] = sum[1] = _mm256_setzero_ps ();
+
+  /* two accumulators to hide the latency of the fma */
+  for (; i + 16 <= len; i += 16) {
+    sum[0] = _mm256_fmadd_ps (_mm256_loadu_ps (a + i + 0),
+        _mm256_loadu_ps (b + i + 0), sum[0]);
+    sum[1] = _mm256_fmadd_ps (_mm256_loadu_ps (a + i + 8),
+        _mm256_loadu_ps (b + i + 8), sum[1]);
+  }
+  if (i < len)
+    sum[0] = _mm256_fmadd_ps (_mm256_loadu_ps (a + i),
+        _mm256_loadu_ps (b + i), sum[0]);
+
+  *o = hsum_ps (_mm256_add_ps (sum[0], sum[1]));
+}
+
+static inline void
+inner_product_gfloat_linear_1_avx2 (gfloat * o, const gfloat * a,
+    const gfloat * b, gint len, const gfloat * icoeff, gint bstride)
+{
+  gint i;
+  __m256 sum[2], t;
+  const gfloat *c[2] = { (gfloat *) ((gint8 *) b + 0 * bstride),
+    (gfloat *) ((gint8 *) b + 1 * bstride)
+  };
+
+  sum[0] = sum[1] = _mm256_setzero_ps ();
+
+  for (i = 0; i < len; i += 8) {
+    t = _mm256_loadu_ps (a + i);
+    sum[0] = _mm256_fmadd_ps (t, _mm256_loadu_ps (c[0] + i), sum[0]);
+    sum[1] = _mm256_fmadd_ps (t, _mm256_loadu_ps (c[1] + i), sum[1]);
+  }
+  sum[0] = _mm256_fmadd_ps (_mm256_sub_ps (sum[0], sum[1]),
+      _mm256_broadcast_ss (icoeff), sum[1]);
+
+  *o = hsum_ps (sum[0]);
+}
+
+static inline void
+inner_product_gfloat_cubic_1_avx2 (gfloat * o, const gfloat * a,
+    const gfloat * b, gint len, const gfloat * icoeff, gint bstride)
+{
+  gint i;
+  __m256 sum[4], t;
+  const gfloat *c[4] = { (gfloat *) ((gint8 *) b + 0 * bstride),
+    (gfloat *) ((gint8 *) b + 1 * bstride),
+    (gfloat *) ((gint8 *) b + 2 * bstride),
+    (gfloat *) ((gint8 *) b + 3 * bstride)
+  };
+
+  sum[0] = sum[1] = sum[2] = sum[3] = _mm256_setzero_ps ();
+
+  for (i = 0; i < len; i += 8) {
+    t = _mm256_loadu_ps (a + i);
+    sum[0] = _mm256_fmadd_ps (t, _mm256_loadu_ps (c[0] + i), sum[0]);
+    sum[1] = _mm256_fmadd_ps (t, _mm256_loadu_ps (c[1] + i), sum[1]);
+    sum[2] = _mm256_fmadd_ps (t, _mm256_loadu_ps (c[2] + i), sum[2]);
+    sum[3] = _mm256_fmadd_ps (t, _mm256_loadu_ps (c[3] + i), sum[3]);
+  }
+  sum[0] = _mm256_mul_ps (sum[0], _mm256_broadcast_ss (icoeff + 0));
+  sum[0] = _mm256_fmadd_ps (sum[1], _mm256_broadcast_ss (icoeff + 1), sum[0]);
+  sum[0] = _mm256_fmadd_ps (sum[2], _mm256_broadcast_ss (icoeff + 2), sum[0]);
+  sum[0] = _mm256_fmadd_ps (sum[3], _mm256_broadcast_ss (icoeff + 3), sum[0]);
+
+  *o = hsum_ps (sum[0]);
+}
+
+static inline void
+inner_product_gdouble_full_1_avx2 (gdouble * o, const gdouble * a,
+    const gdouble * b, gint len, const gdouble * icoeff, gint bstride)
+{
+  gint i;
+  __m256d sum[2];
+
+  sum[0] = sum[1] = _mm256_setzero_pd ();
+
+  for (i = 0; i < len; i += 8) {
+    sum[0] = _mm256_fmadd_pd (_mm256_loadu_pd (a + i + 0),
+        _mm256_loadu_pd (b + i + 0), sum[0]);
+    sum[1] = _mm256_fmadd_pd (_mm256_loadu_pd (a + i + 4),
+        _mm256_loadu_pd (b + i + 4), sum[1]);
+  }
+
+  *o = hsum_pd (_mm256_add_pd (sum[0], sum[1]));
+}
+
+static inline void
+inner_product_gdouble_linear_1_avx2 (gdouble * o, const gdouble * a,
+    const gdouble * b, gint len, const gdouble * icoeff, gint bstride)
+{
+  gint i;
+  __m256d sum[2], t;
+  const gdouble *c[2] = { (gdouble *) ((gint8 *) b + 0 * bstride),
+    (gdouble *) ((gint8 *) b + 1 * bstride)
+  };
+
+  sum[0] = sum[1] = _mm256_setzero_pd ();
+
+  for (i = 0; i < len; i += 4) {
+    t = _mm256_loadu_pd (a + i);
+    sum[0] = _mm256_fmadd_pd (t, _mm256_loadu_pd (c[0] + i), sum[0]);
+    sum[1] = _mm256_fmadd_pd (t, _mm256_loadu_pd (c[1] + i), sum[1]);
+  }
+  sum[0] = _mm256_fmadd_pd (_mm256_sub_pd (sum[0], sum[1]),
+      _mm256_broadcast_sd (icoeff), sum[1]);
+
+  *o = hsum_pd (sum[0]);
+}
+
+static inline void
+inner_product_gdouble_cubic_1_avx2 (gdouble * o, const gdouble * a,
+    const gdouble * b, gint len, const gdouble * icoeff, gint bstride)
+{
+  gint i;
+  __m256d sum[4], t;
+  const gdouble *c[4] = { (gdouble *) ((gint8 *) b + 0 * bstride),
+    (gdouble *) ((gint8 *) b + 1 * bstride),
+    (gdouble *) ((gint8 *) b + 2 * bstride),
+    (gdouble *) ((gint8 *) b + 3 * bstride)
+  };
+
+  sum[0] = sum[1] = sum[2] = sum[3] = _mm256_setzero_pd ();
+
+  for (i = 0; i < len; i += 4) {
+    t = _mm256_loadu_pd (a + i);
+    sum[0] = _mm256_fmadd_pd (t, _mm256_loadu_pd (c[0] + i), sum[0]);
+    sum[1] = _mm256_fmadd_pd (t, _mm256_loadu_pd (c[1] + i), sum[1]);
+    sum[2] = _mm256_fmadd_pd (t, _mm256_loadu_pd (c[2] + i), sum[2]);
+    sum[3] = _mm256_fmadd_pd (t, _mm256_loadu_pd (c[3] + i), sum[3]);
+  }
+  sum[0] = _mm256_mul_pd (sum[0], _mm256_broadcast_sd (icoeff + 0));
+  sum[0] = _mm256_fmadd_pd (sum[1], _mm256_broadcast_sd (icoeff + 1), sum[0]);
+  sum[0] = _mm256_fmadd_pd (sum[2], _mm256_broadcast_sd (icoeff + 2), sum[0]);
+  sum[0] = _mm256_fmadd_pd (sum[3], _mm256_broadcast_sd (icoeff + 3), sum[0]);
+
+  *o = hsum_pd (sum[0]);
+}
+
+MAKE_RESAMPLE_FUNC (gint16, full, 1, avx2);
+MAKE_RESAMPLE_FUNC (gint16, linear, 1, avx2);
+MAKE_RESAMPLE_FUNC (gint16, cubic, 1, avx2);
+
+MAKE_RESAMPLE_FUNC (gfloat, full, 1, avx2);
+MAKE_RESAMPLE_FUNC (gfloat, linear, 1, avx2);
+MAKE_RESAMPLE_FUNC (gfloat, cubic, 1, avx2);
+
+MAKE_RESAMPLE_FUNC (gdouble, full, 1, avx2);
+MAKE_RESAMPLE_FUNC (gdouble, linear, 1, avx2);
+MAKE_RESAMPLE_FUNC (gdouble, cubic, 1, avx2);
+
+/* the unpack and pack instructions work within the 128 bits lanes, which
+ * keeps the samples in order when they are used in pairs */
+void
+interpolate_gint16_linear_avx2 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gint16 *o = op, *a = ap, *ic = icp;
+  gint32 tmp, c0 = ic[0];
+  __m256i ta, tb, t1, t2;
+  const __m256i f = _mm256_set1_epi32 ((ic[0] & 0xffff) |
+      ((gint32) (1 << PRECISION_S16) - ic[0]) << 16);
+  const __m256i round = _mm256_set1_epi32 (1 << (PRECISION_S16 - 1));
+  const gint16 *c[2] = { (gint16 *) ((gint8 *) a + 0 * astride),
+    (gint16 *) ((gint8 *) a + 1 * astride)
+  };
+
+  /* (c0 - c1) * x + (c1 << 15) == c0 * x + c1 * (32768 - x), the second
+   * factor does not fit in a signed word when x is 0 */
+  if (c0 == 0) {
+    memcpy (o, c[1], len * sizeof (gint16));
+    return;
+  }
+
+  for (i = 0; i + 16 <= len; i += 16) {
+    ta = LOADU256 (c[0] + i);
+    tb = LOADU256 (c[1] + i);
+
+    t1 = _mm256_madd_epi16 (_mm256_unpacklo_epi16 (ta, tb), f);
+    t2 = _mm256_madd_epi16 (_mm256_unpackhi_epi16 (ta, tb), f);
+
+    t1 = _mm256_srai_epi32 (_mm256_add_epi32 (t1, round), PRECISION_S16);
+    t2 = _mm256_srai_epi32 (_mm256_add_epi32 (t2, round), PRECISION_S16);
+
+    STOREU256 (o + i, _mm256_packs_epi32 (t1, t2));
+  }
+  for (; i < len; i++) {
+    tmp = ((gint32) c[0][i] - (gint32) c[1][i]) * c0 +
+        ((gint32) c[1][i] << PRECISION_S16);
+    o[i] = (tmp + (1 << (PRECISION_S16 - 1))) >> PRECISION_S16;
+  }
+}
+
+void
+interpolate_gint16_cubic_avx2 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gint16 *o = op, *a = ap, *ic = icp;
+  gint32 tmp;
+  __m256i ta, tb, tl1, tl2, th1, th2;
+  const __m256i f[2] = {
+    _mm256_set1_epi32 ((ic[0] & 0xffff) | ((gint32) ic[1] << 16)),
+    _mm256_set1_epi32 ((ic[2] & 0xffff) | ((gint32) ic[3] << 16))
+  };
+  const __m256i round = _mm256_set1_epi32 (1 << (PRECISION_S16 - 1));
+  const gint16 *c[4] = { (gint16 *) ((gint8 *) a + 0 * astride),
+    (gint16 *) ((gint8 *) a + 1 * astride),
+    (gint16 *) ((gint8 *) a + 2 * astride),
+    (gint16 *) ((gint8 *) a + 3 * astride)
+  };
+
+  for (i = 0; i + 16 <= len; i += 16) {
+    ta = LOADU256 (c[0] + i);
+    tb = LOADU256 (c[1] + i);
+
+    tl1 = _mm256_madd_epi16 (_mm256_unpacklo_epi16 (ta, tb), f[0]);
+    th1 = _mm256_madd_epi16 (_mm256_unpackhi_epi16 (ta, tb), f[0]);
+
+    ta = LOADU256 (c[2] + i);
+    tb = LOADU256 (c[3] + i);
+
+    tl2 = _mm256_madd_epi16 (_mm256_unpacklo_epi16 (ta, tb), f[1]);
+    th2 = _mm256_madd_epi16 (_mm256_unpackhi_epi16 (ta, tb), f[1]);
+
+    tl1 = _mm256_add_epi32 (_mm256_add_epi32 (tl1, tl2), round);
+    th1 = _mm256_add_epi32 (_mm256_add_epi32 (th1, th2), round);
+
+    tl1 = _mm256_srai_epi32 (tl1, PRECISION_S16);
+    th1 = _mm256_srai_epi32 (th1, PRECISION_S16);
+
+    STOREU256 (o + i, _mm256_packs_epi32 (tl1, th1));
+  }
+  for (; i < len; i++) {
+    tmp = (gint32) c[0][i] * ic[0] + (gint32) c[1][i] * ic[1] +
+        (gint32) c[2][i] * ic[2] + (gint32) c[3][i] * ic[3];
+    tmp = (tmp + (1 << (PRECISION_S16 - 1))) >> PRECISION_S16;
+    o[i] = CLAMP (tmp, G_MININT16, G_MAXINT16);
+  }
+}
+
+#if defined (__x86_64__)
+/* arithmetic right shift of 64 bits lanes by PRECISION_S32 */
+static inline __m256i
+srai_epi64_s32 (__m256i v)
+{
+  const __m256i sign = _mm256_set1_epi64x ((gint64) 1 << (63 - PRECISION_S32));
+
+  v = _mm256_srli_epi64 (v, PRECISION_S32);
+  return _mm256_sub_epi64 (_mm256_xor_si256 (v, sign), sign);
+}
+
+/* the low 32 bits of the even 64 bits lanes of even and odd, interleaved */
+static inline __m256i
+merge_epi64_epi32 (__m256i even, __m256i odd)
+{
+  return _mm256_blend_epi32 (even, _mm256_slli_epi64 (odd, 32), 0xaa);
+}
+
+void
+interpolate_gint32_linear_avx2 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gint32 *o = op, *a = ap, *ic = icp;
+  __m256i ta, tb, te, to;
+  const __m256i f = _mm256_set1_epi64x (ic[0]);
+  const __m256i round = _mm256_set1_epi64x ((gint64) 1 << (PRECISION_S32 - 1));
+  const gint32 *c[2] = { (gint32 *) ((gint8 *) a + 0 * astride),
+    (gint32 *) ((gint8 *) a + 1 * astride)
+  };
+
+  /* the output is truncated to 32 bits so only bits 31 to 62 of the 64 bits
+   * intermediate results matter and the missing sign extension of the
+   * samples does not change them */
+  for (i = 0; i < len; i += 8) {
+    ta = LOADU256 (c[0] + i);
+    tb = LOADU256 (c[1] + i);
+
+    te = _mm256_sub_epi64 (_mm256_mul_epi32 (ta, f), _mm256_mul_epi32 (tb, f));
+    te = _mm256_add_epi64 (te, _mm256_slli_epi64 (tb, PRECISION_S32));
+    te = _mm256_srli_epi64 (_mm256_add_epi64 (te, round), PRECISION_S32);
+
+    ta = _mm256_srli_epi64 (ta, 32);
+    tb = _mm256_srli_epi64 (tb, 32);
+
+    to = _mm256_sub_epi64 (_mm256_mul_epi32 (ta, f), _mm256_mul_epi32 (tb, f));
+    to = _mm256_add_epi64 (to, _mm256_slli_epi64 (tb, PRECISION_S32));
+    to = _mm256_srli_epi64 (_mm256_add_epi64 (to, round), PRECISION_S32);
+
+    STOREU256 (o + i, merge_epi64_epi32 (te, to));
+  }
+}
+
+static inline __m256i
+interpolate_gint32_cubic_lanes (__m256i c0, __m256i c1, __m256i c2,
+    __m256i c3, const __m256i f[4])
+{
+  const __m256i round = _mm256_set1_epi64x ((gint64) 1 << (PRECISION_S32 - 1));
+  const __m256i max = _mm256_set1_epi64x (G_MAXINT32);
+  const __m256i min = _mm256_set1_epi64x (G_MININT32);
+  __m256i t;
+
+  t = _mm256_add_epi64 (_mm256_mul_epi32 (c0, f[0]),
+      _mm256_mul_epi32 (c1, f[1]));
+  t = _mm256_add_epi64 (t, _mm256_mul_epi32 (c2, f[2]));
+  t = _mm256_add_epi64 (t, _mm256_mul_epi32 (c3, f[3]));
+  t = srai_epi64_s32 (_mm256_add_epi64 (t, round));
+
+  t = _mm256_blendv_epi8 (t, max, _mm256_cmpgt_epi64 (t, max));
+  t = _mm256_blendv_epi8 (t, min, _mm256_cmpgt_epi64 (min, t));
+
+  return t;
+}
+
+void
+interpolate_gint32_cubic_avx2 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gint32 *o = op, *a = ap, *ic = icp;
+  __m256i t[4], te, to;
+  const __m256i f[4] = { _mm256_set1_epi64x (ic[0]),
+    _mm256_set1_epi64x (ic[1]),
+    _mm256_set1_epi64x (ic[2]),
+    _mm256_set1_epi64x (ic[3])
+  };
+  const gint32 *c[4] = { (gint32 *) ((gint8 *) a + 0 * astride),
+    (gint32 *) ((gint8 *) a + 1 * astride),
+    (gint32 *) ((gint8 *) a + 2 * astride),
+    (gint32 *) ((gint8 *) a + 3 * astride)
+  };
+
+  for (i = 0; i < len; i += 8) {
+    t[0] = LOADU256 (c[0] + i);
+    t[1] = LOADU256 (c[1] + i);
+    t[2] = LOADU256 (c[2] + i);
+    t[3] = LOADU256 (c[3] + i);
+
+    te = interpolate_gint32_cubic_lanes (t[0], t[1], t[2], t[3], f);
+    to = interpolate_gint32_cubic_lanes (_mm256_srli_epi64 (t[0], 32),
+        _mm256_srli_epi64 (t[1], 32), _mm256_srli_epi64 (t[2], 32),
+        _mm256_srli_epi64 (t[3], 32), f);
+
+    STOREU256 (o + i, merge_epi64_epi32 (te, to));
+  }
+}
+#endif
+
+void
+interpolate_gfloat_linear_avx2 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gfloat *o = op, *a = ap, *ic = icp;
+  __m256 t;
+  const __m256 f = _mm256_broadcast_ss (ic);
+  const gfloat *c[2] = { (gfloat *) ((gint8 *) a + 0 * astride),
+    (gfloat *) ((gint8 *) a + 1 * astride)
+  };
+
+  for (i = 0; i < len; i += 8) {
+    t = _mm256_loadu_ps (c[1] + i);
+    t = _mm256_fmadd_ps (_mm256_sub_ps (_mm256_loadu_ps (c[0] + i), t), f, t);
+    _mm256_storeu_ps (o + i, t);
+  }
+}
+
+void
+interpolate_gfloat_cubic_avx2 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gfloat *o = op, *a = ap, *ic = icp;
+  __m256 t;
+  const __m256 f[4] = { _mm256_broadcast_ss (ic + 0),
+    _mm256_broadcast_ss (ic + 1),
+    _mm256_broadcast_ss (ic + 2),
+    _mm256_broadcast_ss (ic + 3)
+  };
+  const gfloat *c[4] = { (gfloat *) ((gint8 *) a + 0 * astride),
+    (gfloat *) ((gint8 *) a + 1 * astride),
+    (gfloat *) ((gint8 *) a + 2 * astride),
+    (gfloat *) ((gint8 *) a + 3 * astride)
+  };
+
+  for (i = 0; i < len; i += 8) {
+    t = _mm256_mul_ps (_mm256_loadu_ps (c[0] + i), f[0]);
+    t = _mm256_fmadd_ps (_mm256_loadu_ps (c[1] + i), f[1], t);
+    t = _mm256_fmadd_ps (_mm256_loadu_ps (c[2] + i), f[2], t);
+    t = _mm256_fmadd_ps (_mm256_loadu_ps (c[3] + i), f[3], t);
+    _mm256_storeu_ps (o + i, t);
+  }
+}
+
+void
+interpolate_gdouble_linear_avx2 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gdouble *o = op, *a = ap, *ic = icp;
+  __m256d t;
+  const __m256d f = _mm256_broadcast_sd (ic);
+  const gdouble *c[2] = { (gdouble *) ((gint8 *) a + 0 * astride),
+    (gdouble *) ((gint8 *) a + 1 * astride)
+  };
+
+  for (i = 0; i < len; i += 4) {
+    t = _mm256_loadu_pd (c[1] + i);
+    t = _mm256_fmadd_pd (_mm256_sub_pd (_mm256_loadu_pd (c[0] + i), t), f, t);
+    _mm256_storeu_pd (o + i, t);
+  }
+}
+
+void
+interpolate_gdouble_cubic_avx2 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gdouble *o = op, *a = ap, *ic = icp;
+  __m256d t;
+  const __m256d f[4] = { _mm256_broadcast_sd (ic + 0),
+    _mm256_broadcast_sd (ic + 1),
+    _mm256_broadcast_sd (ic + 2),
+    _mm256_broadcast_sd (ic + 3)
+  };
+  const gdouble *c[4] = { (gdouble *) ((gint8 *) a + 0 * astride),
+    (gdouble *) ((gint8 *) a + 1 * astride),
+    (gdouble *) ((gint8 *) a + 2 * astride),
+    (gdouble *) ((gint8 *) a + 3 * astride)
+  };
+
+  for (i = 0; i < len; i += 4) {
+    t = _mm256_mul_pd (_mm256_loadu_pd (c[0] + i), f[0]);
+    t = _mm256_fmadd_pd (_mm256_loadu_pd (c[1] + i), f[1], t);
+    t = _mm256_fmadd_pd (_mm256_loadu_pd (c[2] + i), f[2], t);
+    t = _mm256_fmadd_pd (_mm256_loadu_pd (c[3] + i), f[3], t);
+    _mm256_storeu_pd (o + i, t);
+  }
+}
+
+#endif
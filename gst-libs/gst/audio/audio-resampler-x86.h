@@ -21,6 +21,29 @@
 #include "audio-resampler-x86-sse.h"
 #include "audio-resampler-x86-sse2.h"
 #include "audio-resampler-x86-sse41.h"
+#include "audio-resampler-x86-avx2.h"
+
+#if defined (HAVE_IMMINTRIN_H) && HAVE_AVX2
+/* clang defines __GNUC__ as 4.2 but has the builtin */
+#if defined (__has_builtin)
+#if __has_builtin (__builtin_cpu_supports)
+#define HAVE_BUILTIN_CPU_SUPPORTS
+#endif
+#elif defined (__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 8))
+#define HAVE_BUILTIN_CPU_SUPPORTS
+#endif
+
+static gboolean
+cpu_has_avx2_fma (void)
+{
+#ifdef HAVE_BUILTIN_CPU_SUPPORTS
+  __builtin_cpu_init ();
+  return __builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma");
+#else
+  return FALSE;
+#endif
+}
+#endif
 
 static void
 audio_resampler_check_x86 (const gchar *option)
@@ -66,6 +89,45 @@ audio_resampler_check_x86 (const gchar *option)
     resample_gint32_cubic_1 = resample_gint32_cubic_1_sse41;
 #else
     GST_DEBUG ("SSE41 optimisations not enabled");
+#endif
+  } else if (!strcmp (option, "avx2")) {
+#if defined (HAVE_IMMINTRIN_H) && HAVE_AVX2
+    if (!cpu_has_avx2_fma ()) {
+      GST_DEBUG ("AVX2/FMA not supported by the CPU");
+      return;
+    }
+    GST_DEBUG ("enable AVX2/FMA optimisations");
+    resample_gint16_full_1 = resample_gint16_full_1_avx2;
+    resample_gint16_linear_1 = resample_gint16_linear_1_avx2;
+    resample_gint16_cubic_1 = resample_gint16_cubic_1_avx2;
+
+    interpolate_gint16_linear = interpolate_gint16_linear_avx2;
+    interpolate_gint16_cubic = interpolate_gint16_cubic_avx2;
+
+#if defined (__x86_64__)
+    resample_gint32_full_1 = resample_gint32_full_1_avx2;
+    resample_gint32_linear_1 = resample_gint32_linear_1_avx2;
+    resample_gint32_cubic_1 = resample_gint32_cubic_1_avx2;
+
+    interpolate_gint32_linear = interpolate_gint32_linear_avx2;
+    interpolate_gint32_cubic = interpolate_gint32_cubic_avx2;
+#endif
+
+    resample_gfloat_full_1 = resample_gfloat_full_1_avx2;
+    resample_gfloat_linear_1 = resample_gfloat_linear_1_avx2;
+    resample_gfloat_cubic_1 = resample_gfloat_cubic_1_avx2;
+
+    interpolate_gfloat_linear = interpolate_gfloat_linear_avx2;
+    interpolate_gfloat_cubic = interpolate_gfloat_cubic_avx2;
+
+    resample_gdouble_full_1 = resample_gdouble_full_1_avx2;
+    resample_gdouble_linear_1 = resample_gdouble_linear_1_avx2;
+    resample_gdouble_cubic_1 = resample_gdouble_cubic_1_avx2;
+
+    interpolate_gdouble_linear = interpolate_gdouble_linear_avx2;
+    interpolate_gdouble_cubic = interpolate_gdouble_cubic_avx2;
+#else
+    GST_DEBUG ("AVX2 optimisations not enabled");
 #endif
   }
 }
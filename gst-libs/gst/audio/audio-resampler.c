@@ -105,6 +105,11 @@ static const BlackmanQualityMap blackman_qualities[] = {
 #define DEFAULT_OPT_FILTER_INTERPOLATION GST_AUDIO_RESAMPLER_FILTER_INTERPOLATION_CUBIC
 #define DEFAULT_OPT_FILTER_OVERSAMPLE 8
 #define DEFAULT_OPT_MAX_PHASE_ERROR 0.1
+#define DEFAULT_OPT_THREADS 1
+
+/* Not part of the API, the unit tests use this to compare the optimised
+ * inner loops against the C versions */
+#define OPT_NO_SIMD "GstAudioResampler.no-simd"
 
 static gdouble
 get_opt_double (GstStructure * options, const gchar * name, gdouble def)
@@ -124,6 +129,15 @@ get_opt_int (GstStructure * options, const gchar * name, gint def)
   return res;
 }
 
+static guint
+get_opt_uint (GstStructure * options, const gchar * name, guint def)
+{
+  guint res;
+  if (!options || !gst_structure_get_uint (options, name, &res))
+    res = def;
+  return res;
+}
+
 static gint
 get_opt_enum (GstStructure * options, const gchar * name, GType type, gint def)
 {
@@ -160,6 +174,8 @@ get_opt_enum (GstStructure * options, const gchar * name, GType type, gint def)
     GST_AUDIO_RESAMPLER_OPT_FILTER_OVERSAMPLE, DEFAULT_OPT_FILTER_OVERSAMPLE)
 #define GET_OPT_MAX_PHASE_ERROR(options) get_opt_double(options, \
     GST_AUDIO_RESAMPLER_OPT_MAX_PHASE_ERROR, DEFAULT_OPT_MAX_PHASE_ERROR)
+#define GET_OPT_THREADS(options) get_opt_uint(options, \
+    GST_AUDIO_RESAMPLER_OPT_THREADS, DEFAULT_OPT_THREADS)
 
 #include "dbesi0.c"
 #define bessel dbesi0
@@ -458,7 +474,7 @@ INTERPOLATE_INT_CUBIC_FUNC (gint32, gint64, PRECISION_S32, (gint64) 1 << 31);
 INTERPOLATE_FLOAT_CUBIC_FUNC (gfloat);
 INTERPOLATE_FLOAT_CUBIC_FUNC (gdouble);
 
-static InterpolateFunc interpolate_funcs[] = {
+static const InterpolateFunc default_interpolate_funcs[] = {
   interpolate_gint16_linear_c,
   interpolate_gint32_linear_c,
   interpolate_gfloat_linear_c,
@@ -470,6 +486,10 @@ static InterpolateFunc interpolate_funcs[] = {
   interpolate_gdouble_cubic_c,
 };
 
+/* the C versions, replaced by optimised ones in audio_resampler_init() */
+static InterpolateFunc interpolate_funcs[G_N_ELEMENTS
+    (default_interpolate_funcs)];
+
 #define interpolate_gint16_linear  interpolate_funcs[0]
 #define interpolate_gint32_linear  interpolate_funcs[1]
 #define interpolate_gfloat_linear  interpolate_funcs[2]
@@ -554,6 +574,7 @@ DECL_GET_TAPS_FULL_FUNC(type)
       }                                                                         \
     }                                                                           \
     resampler->cached_phases[phase] = res;                                      \
+    resampler->n_cached_phases++;                                               \
   }                                                                             \
   *samp_index += resampler->samp_inc;                                           \
   *samp_phase += resampler->samp_frac;                                          \
@@ -780,7 +801,7 @@ MAKE_RESAMPLE_FUNC_STATIC (gint32, cubic, 1, c);
 MAKE_RESAMPLE_FUNC_STATIC (gfloat, cubic, 1, c);
 MAKE_RESAMPLE_FUNC_STATIC (gdouble, cubic, 1, c);
 
-static ResampleFunc resample_funcs[] = {
+static const ResampleFunc default_resample_funcs[] = {
   resample_gint16_nearest_1_c,
   resample_gint32_nearest_1_c,
   resample_gfloat_nearest_1_c,
@@ -802,6 +823,8 @@ static ResampleFunc resample_funcs[] = {
   resample_gdouble_cubic_1_c,
 };
 
+static ResampleFunc resample_funcs[G_N_ELEMENTS (default_resample_funcs)];
+
 #define resample_gint16_nearest_1 resample_funcs[0]
 #define resample_gint32_nearest_1 resample_funcs[1]
 #define resample_gfloat_nearest_1 resample_funcs[2]
@@ -843,6 +866,10 @@ audio_resampler_init (void)
     GST_DEBUG_CATEGORY_INIT (audio_resampler_debug, "audio-resampler", 0,
         "audio-resampler object");
 
+    memcpy (interpolate_funcs, default_interpolate_funcs,
+        sizeof (interpolate_funcs));
+    memcpy (resample_funcs, default_resample_funcs, sizeof (resample_funcs));
+
 #if defined HAVE_ORC && !defined DISABLE_ORC
     orc_init ();
     {
@@ -873,6 +900,11 @@ audio_resampler_init (void)
           }
         }
       }
+#ifdef CHECK_X86
+      /* Orc has no AVX2 flag, these override the SSE functions when the CPU
+       * supports them */
+      audio_resampler_check_x86 ("avx2");
+#endif
     }
 #endif
     g_once_init_leave (&init_gonce, 1);
@@ -1010,17 +1042,29 @@ alloc_cache_mem (GstAudioResampler * resampler, gint bps, gint n_taps,
   resampler->cached_taps =
       MEM_ALIGN ((gint8 *) resampler->cached_taps_mem + phases_size, ALIGN);
   resampler->cached_phases = resampler->cached_taps_mem;
+  resampler->n_cached_phases = 0;
 }
 
 static void
 setup_functions (GstAudioResampler * resampler)
 {
+  const InterpolateFunc *ifuncs = interpolate_funcs;
+  const ResampleFunc *rfuncs = resample_funcs;
+  gboolean no_simd = FALSE;
   gint index, fidx;
 
   index = resampler->format_index;
 
+  if (resampler->options &&
+      gst_structure_get_boolean (resampler->options, OPT_NO_SIMD, &no_simd)
+      && no_simd) {
+    GST_DEBUG ("using the C functions");
+    ifuncs = default_interpolate_funcs;
+    rfuncs = default_resample_funcs;
+  }
+
   if (resampler->in_rate == resampler->out_rate)
-    resampler->resample = resample_funcs[index];
+    resampler->resample = rfuncs[index];
   else {
     switch (resampler->filter_interpolation) {
       default:
@@ -1037,7 +1081,7 @@ setup_functions (GstAudioResampler * resampler)
         break;
     }
     GST_DEBUG ("using filter interpolate function %d", index + fidx);
-    resampler->interpolate = interpolate_funcs[index + fidx];
+    resampler->interpolate = ifuncs[index + fidx];
 
     switch (resampler->method) {
       case GST_AUDIO_RESAMPLER_METHOD_NEAREST:
@@ -1058,7 +1102,7 @@ setup_functions (GstAudioResampler * resampler)
         break;
     }
     GST_DEBUG ("using resample function %d", index);
-    resampler->resample = resample_funcs[index];
+    resampler->resample = rfuncs[index];
   }
 }
 
@@ -1394,6 +1438,8 @@ gst_audio_resampler_new (GstAudioResamplerMethod method,
   info = gst_audio_format_get_info (format);
   resampler->bps = GST_AUDIO_FORMAT_INFO_WIDTH (info) / 8;
   resampler->sbuf = g_malloc0 (sizeof (gpointer) * channels);
+  g_mutex_init (&resampler->thread_lock);
+  g_cond_init (&resampler->thread_cond);
 
   non_interleaved_in =
       (resampler->flags & GST_AUDIO_RESAMPLER_FLAG_NON_INTERLEAVED_IN);
@@ -1459,6 +1505,134 @@ get_sample_bufs (GstAudioResampler * resampler, gsize need)
   return resampler->sbuf;
 }
 
+/* A group of channels resampled on one thread. The resample functions only
+ * read the shared filter tables and write the sample position when they are
+ * done, so each group works on a copy of the resampler with the blocks and
+ * buffers of its channels. */
+struct _GstAudioResamplerTask
+{
+  GstAudioResampler resampler;
+  gpointer *in;
+  gpointer *out;
+  gpointer out_interleaved;
+  gsize in_len;
+  gsize out_len;
+  gsize consumed;
+};
+
+static void
+resample_task (GstAudioResamplerTask * task)
+{
+  GstAudioResampler *resampler = &task->resampler;
+
+  resampler->resample (resampler, task->in, task->in_len, task->out,
+      task->out_len, &task->consumed);
+}
+
+static void
+resample_thread_func (gpointer data, gpointer user_data)
+{
+  GstAudioResampler *resampler = user_data;
+
+  resample_task (data);
+
+  g_mutex_lock (&resampler->thread_lock);
+  if (--resampler->n_pending_tasks == 0)
+    g_cond_signal (&resampler->thread_cond);
+  g_mutex_unlock (&resampler->thread_lock);
+}
+
+static void
+resample_threaded (GstAudioResampler * resampler, gpointer in[],
+    gsize in_len, gpointer out[], gsize out_len, gsize * consumed)
+{
+  GstAudioResamplerTask *tasks = resampler->tasks;
+  gint i, n_tasks, first, blocks = resampler->blocks;
+
+  n_tasks = MIN (resampler->n_threads, blocks);
+
+  for (i = 0, first = 0; i < n_tasks; i++) {
+    GstAudioResamplerTask *task = &tasks[i];
+    gint n_blocks = (blocks * (i + 1)) / n_tasks - first;
+
+    task->resampler = *resampler;
+    task->resampler.blocks = n_blocks;
+    task->in = in + first;
+    if (resampler->ostride == 1) {
+      task->out = out + first;
+    } else {
+      /* interleaved, start at the first channel of the group */
+      task->out_interleaved = (gint8 *) out[0] + first * resampler->bps;
+      task->out = &task->out_interleaved;
+    }
+    task->in_len = in_len;
+    task->out_len = out_len;
+    first += n_blocks;
+  }
+
+  /* full filter tables are made on the fly, let the first group fill them
+   * before the other groups start to read them */
+  i = 0;
+  if (resampler->filter_mode == GST_AUDIO_RESAMPLER_FILTER_MODE_FULL &&
+      resampler->n_cached_phases < resampler->n_phases) {
+    resample_task (&tasks[0]);
+    resampler->n_cached_phases = tasks[0].resampler.n_cached_phases;
+    i = 1;
+  }
+
+  if (n_tasks - i > 1) {
+    gint j;
+
+    resampler->n_pending_tasks = n_tasks - i - 1;
+    for (j = i + 1; j < n_tasks; j++)
+      g_thread_pool_push (resampler->thread_pool, &tasks[j], NULL);
+
+    resample_task (&tasks[i]);
+
+    g_mutex_lock (&resampler->thread_lock);
+    while (resampler->n_pending_tasks > 0)
+      g_cond_wait (&resampler->thread_cond, &resampler->thread_lock);
+    g_mutex_unlock (&resampler->thread_lock);
+  } else if (i < n_tasks) {
+    resample_task (&tasks[i]);
+  }
+
+  /* all groups advance the same way */
+  resampler->samp_index = tasks[0].resampler.samp_index;
+  resampler->samp_phase = tasks[0].resampler.samp_phase;
+  *consumed = tasks[0].consumed;
+}
+
+static void
+resampler_setup_threads (GstAudioResampler * resampler)
+{
+  guint n_threads;
+
+  n_threads = GET_OPT_THREADS (resampler->options);
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+  n_threads = MIN (n_threads, resampler->channels);
+
+  if (n_threads == resampler->n_threads)
+    return;
+
+  if (resampler->thread_pool)
+    g_thread_pool_free (resampler->thread_pool, FALSE, TRUE);
+  resampler->thread_pool = NULL;
+  g_free (resampler->tasks);
+  resampler->tasks = NULL;
+
+  GST_DEBUG ("using %u threads", n_threads);
+  resampler->n_threads = n_threads;
+
+  if (n_threads > 1) {
+    /* the calling thread resamples one of the groups */
+    resampler->thread_pool = g_thread_pool_new (resample_thread_func,
+        resampler, n_threads - 1, FALSE, NULL);
+    resampler->tasks = g_new0 (GstAudioResamplerTask, n_threads);
+  }
+}
+
 /**
  * gst_audio_resampler_reset:
  * @resampler: a #GstAudioResampler
@@ -1574,6 +1748,7 @@ gst_audio_resampler_update (GstAudioResampler * resampler,
 
     resampler_calculate_taps (resampler);
     resampler_dump (resampler);
+    resampler_setup_threads (resampler);
 
     if (old_n_taps > 0 && old_n_taps != resampler->n_taps) {
       gpointer *sbuf;
@@ -1628,6 +1803,11 @@ gst_audio_resampler_free (GstAudioResampler * resampler)
 {
   g_return_if_fail (resampler != NULL);
 
+  if (resampler->thread_pool)
+    g_thread_pool_free (resampler->thread_pool, FALSE, TRUE);
+  g_free (resampler->tasks);
+  g_mutex_clear (&resampler->thread_lock);
+  g_cond_clear (&resampler->thread_cond);
   g_free (resampler->cached_taps_mem);
   g_free (resampler->taps_mem);
   g_free (resampler->tmp_taps);
@@ -1781,8 +1961,12 @@ gst_audio_resampler_resample (GstAudioResampler * resampler,
   }
 
   /* resample all channels */
-  resampler->resample (resampler, sbuf, samples_avail, out, out_frames,
-      &consumed);
+  if (resampler->n_threads > 1 && resampler->blocks > 1)
+    resample_threaded (resampler, sbuf, samples_avail, out, out_frames,
+        &consumed);
+  else
+    resampler->resample (resampler, sbuf, samples_avail, out, out_frames,
+        &consumed);
 
   GST_LOG ("in %" G_GSIZE_FORMAT ", avail %" G_GSIZE_FORMAT ", consumed %"
       G_GSIZE_FORMAT, in_frames, samples_avail, consumed);
@@ -164,6 +164,18 @@ typedef enum {
  */
 #define GST_AUDIO_RESAMPLER_OPT_MAX_PHASE_ERROR "GstAudioResampler.max-phase-error"
 
+/**
+ * GST_AUDIO_RESAMPLER_OPT_THREADS:
+ *
+ * G_TYPE_UINT: maximum number of threads to use for resampling. The
+ * channels are split into groups that are resampled in parallel and the
+ * output is the same for any number of threads. 0 uses the number of
+ * processors. 1 is the default.
+ *
+ * Since: 1.20
+ */
+#define GST_AUDIO_RESAMPLER_OPT_THREADS "GstAudioResampler.threads"
+
 /**
  * GstAudioResamplerMethod:
  * @GST_AUDIO_RESAMPLER_METHOD_NEAREST: Duplicates the samples when
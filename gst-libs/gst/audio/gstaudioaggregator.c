@@ -264,6 +264,15 @@ gst_audio_aggregator_convert_pad_convert_buffer (GstAudioAggregatorPad *
         GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_TIMESTAMPS |
         GST_BUFFER_COPY_META, 0, -1);
 
+    /* GAP input buffers are skipped when mixing, don't convert their
+     * contents. With resampling they still go through the converter to keep
+     * its history and output size consistent. The output buffer is always
+     * converted, its contents are pushed even when it's a GAP. */
+    if (GST_PAD_IS_SINK (aaggpad) &&
+        GST_BUFFER_FLAG_IS_SET (input_buffer, GST_BUFFER_FLAG_GAP) &&
+        GST_AUDIO_INFO_RATE (in_info) == GST_AUDIO_INFO_RATE (out_info))
+      return res;
+
     gst_buffer_map (input_buffer, &inmap, GST_MAP_READ);
     gst_buffer_map (res, &outmap, GST_MAP_WRITE);
 
@@ -25,6 +25,13 @@
 #include <string.h>
 #include "video.h"
 
+struct _GstVideoConvertSampleCache
+{
+  GMutex lock;
+  guint max_entries;
+  GQueue entries;               /* most recently used first */
+};
+
 static gboolean
 caps_are_raw (const GstCaps * caps)
 {
@@ -281,6 +288,615 @@ link_failed:
   }
 }
 
+static GstCaps *
+copy_caps_without_framerate (const GstCaps * caps)
+{
+  GstCaps *copy;
+  guint i, n;
+
+  copy = gst_caps_new_empty ();
+  n = gst_caps_get_size (caps);
+  for (i = 0; i < n; i++) {
+    GstStructure *s = gst_caps_get_structure (caps, i);
+
+    s = gst_structure_copy (s);
+    gst_structure_remove_field (s, "framerate");
+    gst_caps_append_structure (copy, s);
+  }
+
+  return copy;
+}
+
+/* Converting without a pipeline
+ *
+ * When the input is raw video in system memory and the output caps leave no
+ * choice open other than what videoscale would fixate, the conversion is
+ * done directly with a #GstVideoConverter. Encoded output caps are handled
+ * by pushing the converted frame through the encoder element with our own
+ * pads. The result matches what the pipeline produces, but without creating
+ * and linking elements and without starting streaming threads.
+ */
+typedef struct
+{
+  /* the key */
+  GstCaps *from_caps;
+  GstCaps *to_caps;
+  GstVideoRectangle crop;
+
+  GstVideoInfo in_info;
+  GstVideoInfo out_info;
+  GstCaps *out_caps;
+  GstVideoConverter *convert;
+
+  /* for encoded output */
+  GstElement *encoder;
+  GstPad *srcpad, *sinkpad;
+  gboolean need_segment;
+  gboolean drained;
+  GstCaps *encoded_caps;
+  GstBuffer *encoded;
+} GstVideoConvertSampleEntry;
+
+static gboolean
+caps_are_system_memory (const GstCaps * caps)
+{
+  GstCapsFeatures *features;
+
+  if (gst_caps_get_size (caps) != 1)
+    return FALSE;
+
+  features = gst_caps_get_features (caps, 0);
+  return features == NULL ||
+      gst_caps_features_is_equal (features,
+      GST_CAPS_FEATURES_MEMORY_SYSTEM_MEMORY);
+}
+
+static gboolean
+structure_field_is_fixed (GQuark field_id, const GValue * value,
+    gpointer user_data)
+{
+  return gst_value_is_fixed (value);
+}
+
+/* Fill in width, height and pixel-aspect-ratio of @s the way videoscale
+ * fixates them for an input of @in_width x @in_height with the
+ * pixel-aspect-ratio of @in_info: fields that are set are kept and the
+ * missing ones are chosen to keep the display aspect ratio. */
+static gboolean
+fixate_raw_size (GstStructure * s, const GstVideoInfo * in_info,
+    gint in_width, gint in_height)
+{
+  gint dar_n, dar_d, par_n, par_d, n, d;
+  gint width = 0, height = 0;
+  gboolean has_width, has_height;
+
+  if (!gst_util_fraction_multiply (in_width, in_height,
+          GST_VIDEO_INFO_PAR_N (in_info), GST_VIDEO_INFO_PAR_D (in_info),
+          &dar_n, &dar_d))
+    return FALSE;
+
+  has_width = gst_structure_get_int (s, "width", &width);
+  has_height = gst_structure_get_int (s, "height", &height);
+  if (gst_structure_has_field (s, "width") != has_width ||
+      gst_structure_has_field (s, "height") != has_height)
+    return FALSE;
+
+  if (!gst_structure_get_fraction (s, "pixel-aspect-ratio", &par_n, &par_d)) {
+    if (gst_structure_has_field (s, "pixel-aspect-ratio"))
+      return FALSE;
+
+    if (has_width && has_height) {
+      /* pick the pixel-aspect-ratio that keeps the display aspect ratio */
+      if (!gst_util_fraction_multiply (dar_n, dar_d, height, width,
+              &par_n, &par_d))
+        return FALSE;
+    } else {
+      par_n = GST_VIDEO_INFO_PAR_N (in_info);
+      par_d = GST_VIDEO_INFO_PAR_D (in_info);
+    }
+    gst_structure_set (s, "pixel-aspect-ratio", GST_TYPE_FRACTION, par_n,
+        par_d, NULL);
+  }
+
+  /* width / height of the output that keeps the display aspect ratio */
+  if (!gst_util_fraction_multiply (dar_n, dar_d, par_d, par_n, &n, &d))
+    return FALSE;
+
+  if (!has_width && !has_height) {
+    height = in_height;
+    width = gst_util_uint64_scale_int (height, n, d);
+  } else if (!has_height) {
+    height = gst_util_uint64_scale_int (width, d, n);
+  } else if (!has_width) {
+    width = gst_util_uint64_scale_int (height, n, d);
+  }
+
+  if (width <= 0 || height <= 0)
+    return FALSE;
+
+  gst_structure_set (s, "width", G_TYPE_INT, width, "height", G_TYPE_INT,
+      height, "framerate", GST_TYPE_FRACTION, GST_VIDEO_INFO_FPS_N (in_info),
+      GST_VIDEO_INFO_FPS_D (in_info), NULL);
+
+  return TRUE;
+}
+
+/* Fill in the format and colorimetry of @s from @in_info when they are not
+ * set, like videoconvert fixates them. */
+static gboolean
+fixate_raw_format (GstStructure * s, const GstVideoInfo * in_info)
+{
+  const GstVideoFormatInfo *finfo;
+  const gchar *format;
+
+  if (!gst_structure_has_field (s, "format")) {
+    gst_structure_set (s, "format", G_TYPE_STRING,
+        gst_video_format_to_string (GST_VIDEO_INFO_FORMAT (in_info)), NULL);
+  }
+
+  format = gst_structure_get_string (s, "format");
+  if (format == NULL)
+    return FALSE;
+
+  finfo = gst_video_format_get_info (gst_video_format_from_string (format));
+  if (GST_VIDEO_FORMAT_INFO_FORMAT (finfo) == GST_VIDEO_FORMAT_UNKNOWN ||
+      GST_VIDEO_FORMAT_INFO_FORMAT (finfo) == GST_VIDEO_FORMAT_ENCODED)
+    return FALSE;
+
+  /* keep the colorimetry when it applies to the output format */
+  if (GST_VIDEO_FORMAT_INFO_IS_YUV (finfo) == GST_VIDEO_INFO_IS_YUV (in_info)
+      && GST_VIDEO_FORMAT_INFO_IS_RGB (finfo) ==
+      GST_VIDEO_INFO_IS_RGB (in_info)) {
+    if (!gst_structure_has_field (s, "colorimetry")) {
+      gchar *colorimetry =
+          gst_video_colorimetry_to_string (&in_info->colorimetry);
+
+      if (colorimetry)
+        gst_structure_set (s, "colorimetry", G_TYPE_STRING, colorimetry, NULL);
+      g_free (colorimetry);
+    }
+    if (!gst_structure_has_field (s, "chroma-site") &&
+        GST_VIDEO_FORMAT_INFO_IS_YUV (finfo)) {
+      const gchar *chroma_site =
+          gst_video_chroma_to_string (in_info->chroma_site);
+
+      if (chroma_site)
+        gst_structure_set (s, "chroma-site", G_TYPE_STRING, chroma_site, NULL);
+    }
+  }
+
+  return TRUE;
+}
+
+static void
+convert_entry_free (GstVideoConvertSampleEntry * entry)
+{
+  if (entry->encoder) {
+    gst_element_set_state (entry->encoder, GST_STATE_NULL);
+    gst_pad_set_active (entry->srcpad, FALSE);
+    gst_pad_set_active (entry->sinkpad, FALSE);
+    gst_object_unref (entry->encoder);
+  }
+  if (entry->srcpad)
+    gst_object_unref (entry->srcpad);
+  if (entry->sinkpad)
+    gst_object_unref (entry->sinkpad);
+  gst_buffer_replace (&entry->encoded, NULL);
+  gst_caps_replace (&entry->encoded_caps, NULL);
+  if (entry->convert)
+    gst_video_converter_free (entry->convert);
+  gst_caps_replace (&entry->out_caps, NULL);
+  gst_caps_unref (entry->from_caps);
+  gst_caps_unref (entry->to_caps);
+  g_slice_free (GstVideoConvertSampleEntry, entry);
+}
+
+static GstFlowReturn
+convert_entry_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstVideoConvertSampleEntry *entry = gst_pad_get_element_private (pad);
+
+  /* like the preroll of the pipeline, we take the first buffer */
+  if (entry->encoded == NULL)
+    entry->encoded = buffer;
+  else
+    gst_buffer_unref (buffer);
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+convert_entry_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstVideoConvertSampleEntry *entry = gst_pad_get_element_private (pad);
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_CAPS) {
+    GstCaps *caps;
+
+    gst_event_parse_caps (event, &caps);
+    gst_caps_replace (&entry->encoded_caps, caps);
+  }
+  gst_event_unref (event);
+
+  return TRUE;
+}
+
+/* answer caps queries of the encoder with the requested output caps, like
+ * appsink does in the pipeline */
+static gboolean
+convert_entry_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  GstVideoConvertSampleEntry *entry = gst_pad_get_element_private (pad);
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_CAPS:
+    {
+      GstCaps *filter, *caps;
+
+      gst_query_parse_caps (query, &filter);
+      if (filter)
+        caps = gst_caps_intersect_full (filter, entry->to_caps,
+            GST_CAPS_INTERSECT_FIRST);
+      else
+        caps = gst_caps_ref (entry->to_caps);
+      gst_query_set_caps_result (query, caps);
+      gst_caps_unref (caps);
+      return TRUE;
+    }
+    case GST_QUERY_ACCEPT_CAPS:
+    {
+      GstCaps *caps;
+
+      gst_query_parse_accept_caps (query, &caps);
+      gst_query_set_accept_caps_result (query,
+          gst_caps_can_intersect (caps, entry->to_caps));
+      return TRUE;
+    }
+    default:
+      return gst_pad_query_default (pad, parent, query);
+  }
+}
+
+/* Set up @encoder to encode into @entry->to_caps and fill in the raw format it
+ * takes in @s. */
+static gboolean
+convert_entry_setup_encoder (GstVideoConvertSampleEntry * entry,
+    GstElement * encoder, GstStructure * s)
+{
+  GstPad *enc_sinkpad = NULL, *enc_srcpad = NULL;
+  GstCaps *filter, *caps = NULL, *tmp;
+  const gchar *format;
+  gboolean res = FALSE;
+
+  entry->encoder = gst_object_ref_sink (encoder);
+  entry->srcpad = gst_object_ref_sink (gst_pad_new ("src", GST_PAD_SRC));
+  entry->sinkpad = gst_object_ref_sink (gst_pad_new ("sink", GST_PAD_SINK));
+  gst_pad_set_element_private (entry->sinkpad, entry);
+  gst_pad_set_chain_function (entry->sinkpad, convert_entry_chain);
+  gst_pad_set_event_function (entry->sinkpad, convert_entry_event);
+  gst_pad_set_query_function (entry->sinkpad, convert_entry_query);
+
+  enc_sinkpad = gst_element_get_static_pad (encoder, "sink");
+  enc_srcpad = gst_element_get_static_pad (encoder, "src");
+  if (!enc_sinkpad || !enc_srcpad)
+    goto done;
+
+  if (gst_pad_link (entry->srcpad, enc_sinkpad) != GST_PAD_LINK_OK ||
+      gst_pad_link (enc_srcpad, entry->sinkpad) != GST_PAD_LINK_OK)
+    goto done;
+
+  gst_pad_set_active (entry->srcpad, TRUE);
+  gst_pad_set_active (entry->sinkpad, TRUE);
+  if (gst_element_set_state (encoder,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE)
+    goto done;
+
+  /* the size is known already, prefer the input format if the encoder takes
+   * it and otherwise what the encoder prefers */
+  tmp = gst_caps_new_full (gst_structure_copy (s), NULL);
+  gst_structure_remove_field (gst_caps_get_structure (tmp, 0), "format");
+  caps = gst_pad_query_caps (enc_sinkpad, tmp);
+  gst_caps_unref (tmp);
+
+  filter = gst_caps_new_full (gst_structure_copy (s), NULL);
+  fixate_raw_format (gst_caps_get_structure (filter, 0), &entry->in_info);
+  tmp = gst_caps_intersect (caps, filter);
+  gst_caps_unref (filter);
+  if (gst_caps_is_empty (tmp)) {
+    gst_caps_unref (tmp);
+  } else {
+    gst_caps_unref (caps);
+    caps = tmp;
+  }
+  if (gst_caps_is_empty (caps))
+    goto done;
+
+  caps = gst_caps_fixate (caps);
+  format = gst_structure_get_string (gst_caps_get_structure (caps, 0),
+      "format");
+  if (format == NULL)
+    goto done;
+  gst_structure_set (s, "format", G_TYPE_STRING, format, NULL);
+  entry->need_segment = TRUE;
+  res = TRUE;
+
+done:
+  if (caps)
+    gst_caps_unref (caps);
+  if (enc_sinkpad)
+    gst_object_unref (enc_sinkpad);
+  if (enc_srcpad)
+    gst_object_unref (enc_srcpad);
+
+  return res;
+}
+
+/* Prepare the direct conversion of samples with @from_caps and crop
+ * rectangle @cmeta to @to_caps, which has no framerate field.
+ * Returns: the entry or %NULL when the conversion needs a pipeline. */
+static GstVideoConvertSampleEntry *
+convert_entry_new (const GstCaps * from_caps, GstVideoCropMeta * cmeta,
+    const GstCaps * to_caps, gboolean allow_encode)
+{
+  GstVideoConvertSampleEntry *entry;
+  GstStructure *s;
+  GstElement *encoder = NULL;
+  gboolean raw;
+
+  if (!caps_are_system_memory (from_caps) || gst_caps_get_size (to_caps) != 1)
+    return NULL;
+
+  raw = caps_are_raw (to_caps);
+  if (raw && !caps_are_system_memory (to_caps))
+    return NULL;
+  if (!raw && !allow_encode)
+    return NULL;
+
+  entry = g_slice_new0 (GstVideoConvertSampleEntry);
+  entry->from_caps = gst_caps_copy (from_caps);
+  entry->to_caps = gst_caps_copy (to_caps);
+
+  if (!gst_video_info_from_caps (&entry->in_info, from_caps) ||
+      GST_VIDEO_INFO_IS_INTERLACED (&entry->in_info))
+    goto no_direct;
+
+  if (cmeta) {
+    entry->crop.x = cmeta->x;
+    entry->crop.y = cmeta->y;
+    entry->crop.w = cmeta->width;
+    entry->crop.h = cmeta->height;
+    if (entry->crop.w <= 0 || entry->crop.h <= 0 || entry->crop.x < 0 ||
+        entry->crop.y < 0 ||
+        entry->crop.x + entry->crop.w > GST_VIDEO_INFO_WIDTH (&entry->in_info)
+        || entry->crop.y + entry->crop.h >
+        GST_VIDEO_INFO_HEIGHT (&entry->in_info))
+      goto no_direct;
+  } else {
+    entry->crop.w = GST_VIDEO_INFO_WIDTH (&entry->in_info);
+    entry->crop.h = GST_VIDEO_INFO_HEIGHT (&entry->in_info);
+  }
+
+  if (raw) {
+    s = gst_structure_copy (gst_caps_get_structure (to_caps, 0));
+  } else {
+    GstStructure *to_s = gst_caps_get_structure (to_caps, 0);
+    const gchar *fields[] = { "width", "height", "pixel-aspect-ratio" };
+    guint i;
+
+    /* encoders take the size of the output caps */
+    s = gst_structure_new_empty ("video/x-raw");
+    for (i = 0; i < G_N_ELEMENTS (fields); i++) {
+      const GValue *v = gst_structure_get_value (to_s, fields[i]);
+
+      if (v)
+        gst_structure_set_value (s, fields[i], v);
+    }
+  }
+
+  if (!fixate_raw_size (s, &entry->in_info, entry->crop.w, entry->crop.h))
+    goto no_direct_structure;
+
+  if (!raw) {
+    GError *err = NULL;
+
+    encoder = get_encoder (to_caps, &err);
+    g_clear_error (&err);
+    if (!encoder || !convert_entry_setup_encoder (entry, encoder, s))
+      goto no_direct_structure;
+  }
+
+  if (!fixate_raw_format (s, &entry->in_info) ||
+      !gst_structure_foreach (s, structure_field_is_fixed, NULL))
+    goto no_direct_structure;
+
+  entry->out_caps = gst_caps_new_full (s, NULL);
+  if (!gst_video_info_from_caps (&entry->out_info, entry->out_caps))
+    goto no_direct;
+
+  {
+    gint from_dar_n, from_dar_d, to_dar_n, to_dar_d;
+    gint borders_w = 0, borders_h = 0;
+    GstVideoInfo *out_info = &entry->out_info;
+
+    /* add black borders to keep the display aspect ratio, like videoscale
+     * does in the pipeline */
+    if (gst_util_fraction_multiply (entry->crop.w, entry->crop.h,
+            entry->in_info.par_n, entry->in_info.par_d, &from_dar_n,
+            &from_dar_d)
+        && gst_util_fraction_multiply (out_info->width, out_info->height,
+            out_info->par_n, out_info->par_d, &to_dar_n, &to_dar_d)
+        && (from_dar_n != to_dar_n || from_dar_d != to_dar_d)) {
+      gint n, d, to_h, to_w;
+
+      if (gst_util_fraction_multiply (from_dar_n, from_dar_d,
+              out_info->par_d, out_info->par_n, &n, &d)) {
+        to_h = gst_util_uint64_scale_int (out_info->width, d, n);
+        if (to_h <= out_info->height) {
+          borders_h = out_info->height - to_h;
+        } else {
+          to_w = gst_util_uint64_scale_int (out_info->height, n, d);
+          borders_w = out_info->width - to_w;
+        }
+      }
+    }
+
+    entry->convert = gst_video_converter_new (&entry->in_info, out_info,
+        gst_structure_new ("GstVideoConvertSample",
+            GST_VIDEO_CONVERTER_OPT_SRC_X, G_TYPE_INT, entry->crop.x,
+            GST_VIDEO_CONVERTER_OPT_SRC_Y, G_TYPE_INT, entry->crop.y,
+            GST_VIDEO_CONVERTER_OPT_SRC_WIDTH, G_TYPE_INT, entry->crop.w,
+            GST_VIDEO_CONVERTER_OPT_SRC_HEIGHT, G_TYPE_INT, entry->crop.h,
+            GST_VIDEO_CONVERTER_OPT_DEST_X, G_TYPE_INT, borders_w / 2,
+            GST_VIDEO_CONVERTER_OPT_DEST_Y, G_TYPE_INT, borders_h / 2,
+            GST_VIDEO_CONVERTER_OPT_DEST_WIDTH, G_TYPE_INT,
+            out_info->width - borders_w,
+            GST_VIDEO_CONVERTER_OPT_DEST_HEIGHT, G_TYPE_INT,
+            out_info->height - borders_h,
+            GST_VIDEO_CONVERTER_OPT_RESAMPLER_METHOD,
+            GST_TYPE_VIDEO_RESAMPLER_METHOD, GST_VIDEO_RESAMPLER_METHOD_LINEAR,
+            GST_VIDEO_RESAMPLER_OPT_MAX_TAPS, G_TYPE_INT, 2, NULL));
+    if (entry->convert == NULL)
+      goto no_direct;
+  }
+
+  GST_DEBUG ("direct conversion from %" GST_PTR_FORMAT " to %" GST_PTR_FORMAT
+      " with encoder %" GST_PTR_FORMAT, from_caps, entry->out_caps,
+      entry->encoder);
+
+  return entry;
+
+no_direct_structure:
+  gst_structure_free (s);
+no_direct:
+  GST_DEBUG ("no direct conversion from %" GST_PTR_FORMAT " to %"
+      GST_PTR_FORMAT, from_caps, to_caps);
+  convert_entry_free (entry);
+  return NULL;
+}
+
+static gboolean
+convert_entry_matches (GstVideoConvertSampleEntry * entry,
+    const GstCaps * from_caps, GstVideoCropMeta * cmeta,
+    const GstCaps * to_caps)
+{
+  if (cmeta) {
+    if (entry->crop.x != (gint) cmeta->x || entry->crop.y != (gint) cmeta->y ||
+        entry->crop.w != (gint) cmeta->width ||
+        entry->crop.h != (gint) cmeta->height)
+      return FALSE;
+  } else if (entry->crop.x != 0 || entry->crop.y != 0 ||
+      entry->crop.w != GST_VIDEO_INFO_WIDTH (&entry->in_info) ||
+      entry->crop.h != GST_VIDEO_INFO_HEIGHT (&entry->in_info)) {
+    return FALSE;
+  }
+
+  return gst_caps_is_equal (entry->from_caps, from_caps) &&
+      gst_caps_is_equal (entry->to_caps, to_caps);
+}
+
+/* Push @buffer through the encoder of @entry.
+ * Returns: the encoded buffer or %NULL */
+static GstBuffer *
+convert_entry_encode (GstVideoConvertSampleEntry * entry, GstBuffer * buffer,
+    GError ** error)
+{
+  GstFlowReturn ret;
+  GstBuffer *encoded;
+
+  if (entry->drained) {
+    /* the encoder got EOS last time, flush it to start again */
+    gst_pad_push_event (entry->srcpad, gst_event_new_flush_start ());
+    gst_pad_push_event (entry->srcpad, gst_event_new_flush_stop (TRUE));
+    entry->need_segment = TRUE;
+    entry->drained = FALSE;
+  }
+
+  if (entry->need_segment) {
+    GstSegment segment;
+
+    if (!gst_pad_has_current_caps (entry->srcpad)) {
+      gst_pad_push_event (entry->srcpad,
+          gst_event_new_stream_start ("convert-sample"));
+      gst_pad_push_event (entry->srcpad,
+          gst_event_new_caps (entry->out_caps));
+    }
+    gst_segment_init (&segment, GST_FORMAT_TIME);
+    gst_pad_push_event (entry->srcpad, gst_event_new_segment (&segment));
+    entry->need_segment = FALSE;
+  }
+
+  gst_buffer_replace (&entry->encoded, NULL);
+  ret = gst_pad_push (entry->srcpad, buffer);
+
+  /* encoders with latency only give us the frame when draining */
+  if (ret == GST_FLOW_OK && entry->encoded == NULL) {
+    gst_pad_push_event (entry->srcpad, gst_event_new_eos ());
+    entry->drained = TRUE;
+  }
+
+  encoded = entry->encoded;
+  entry->encoded = NULL;
+
+  if (encoded == NULL) {
+    GST_ERROR ("Could not encode video frame: %s", gst_flow_get_name (ret));
+    g_set_error (error, GST_CORE_ERROR, GST_CORE_ERROR_FAILED,
+        "Could not encode video frame: %s", gst_flow_get_name (ret));
+    /* start with a clean encoder next time */
+    entry->drained = TRUE;
+  }
+
+  return encoded;
+}
+
+static GstSample *
+convert_entry_convert (GstVideoConvertSampleEntry * entry, GstSample * sample,
+    GError ** error)
+{
+  GstVideoFrame in_frame, out_frame;
+  GstBuffer *buf, *outbuf;
+  GstSample *result;
+  GstCaps *caps;
+
+  buf = gst_sample_get_buffer (sample);
+  if (!gst_video_frame_map (&in_frame, &entry->in_info, buf, GST_MAP_READ)) {
+    GST_ERROR ("Could not map video frame");
+    g_set_error (error, GST_CORE_ERROR, GST_CORE_ERROR_FAILED,
+        "Could not convert video frame: failed to map input frame");
+    return NULL;
+  }
+
+  outbuf = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&entry->out_info),
+      NULL);
+  if (!gst_video_frame_map (&out_frame, &entry->out_info, outbuf,
+          GST_MAP_WRITE)) {
+    GST_ERROR ("Could not map output video frame");
+    g_set_error (error, GST_CORE_ERROR, GST_CORE_ERROR_FAILED,
+        "Could not convert video frame: failed to map output frame");
+    gst_video_frame_unmap (&in_frame);
+    gst_buffer_unref (outbuf);
+    return NULL;
+  }
+  gst_video_converter_frame (entry->convert, &in_frame, &out_frame);
+  gst_video_frame_unmap (&out_frame);
+  gst_video_frame_unmap (&in_frame);
+
+  gst_buffer_copy_into (outbuf, buf,
+      GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
+
+  caps = entry->out_caps;
+  if (entry->encoder) {
+    outbuf = convert_entry_encode (entry, outbuf, error);
+    if (outbuf == NULL)
+      return NULL;
+    caps = entry->encoded_caps;
+  }
+
+  result = gst_sample_new (outbuf, caps, gst_sample_get_segment (sample), NULL);
+  gst_buffer_unref (outbuf);
+
+  return result;
+}
+
 /**
  * gst_video_convert_sample:
  * @sample: a #GstSample
@@ -294,6 +910,12 @@ link_failed:
  *
  * The width, height and pixel-aspect-ratio can also be specified in the output caps.
  *
+ * Conversions between raw video formats in system memory are done directly
+ * without a pipeline. Use gst_video_convert_sample_cache_convert() to reuse
+ * the conversion for many samples. Direct conversions run synchronously in
+ * the calling thread, @timeout only limits the conversions that need a
+ * pipeline.
+ *
  * Returns: The converted #GstSample, or %NULL if an error happened (in which case @err
  * will point to the #GError).
  */
@@ -309,7 +931,7 @@ gst_video_convert_sample (GstSample * sample, const GstCaps * to_caps,
   GstCaps *from_caps, *to_caps_copy = NULL;
   GstFlowReturn ret;
   GstElement *pipeline, *src, *sink;
-  guint i, n;
+  GstVideoConvertSampleEntry *entry;
 
   g_return_val_if_fail (sample != NULL, NULL);
   g_return_val_if_fail (to_caps != NULL, NULL);
@@ -320,14 +942,17 @@ gst_video_convert_sample (GstSample * sample, const GstCaps * to_caps,
   from_caps = gst_sample_get_caps (sample);
   g_return_val_if_fail (from_caps != NULL, NULL);
 
-  to_caps_copy = gst_caps_new_empty ();
-  n = gst_caps_get_size (to_caps);
-  for (i = 0; i < n; i++) {
-    GstStructure *s = gst_caps_get_structure (to_caps, i);
+  to_caps_copy = copy_caps_without_framerate (to_caps);
 
-    s = gst_structure_copy (s);
-    gst_structure_remove_field (s, "framerate");
-    gst_caps_append_structure (to_caps_copy, s);
+  /* raw to raw conversions don't need a pipeline */
+  entry = convert_entry_new (from_caps, gst_buffer_get_video_crop_meta (buf),
+      to_caps_copy, FALSE);
+  if (entry) {
+    result = convert_entry_convert (entry, sample, error);
+    convert_entry_free (entry);
+    gst_caps_unref (to_caps_copy);
+
+    return result;
   }
 
   pipeline =
@@ -418,6 +1043,135 @@ state_change_failed:
   }
 }
 
+/**
+ * gst_video_convert_sample_cache_new:
+ * @max_entries: the maximum number of conversions to keep
+ *
+ * Create a cache for converting many samples with gst_video_convert_sample().
+ *
+ * For every pair of input and output caps the cache keeps the
+ * #GstVideoConverter and, for encoded output caps, the encoder element that
+ * was used, so that converting another sample with the same caps only costs
+ * the conversion itself. The @max_entries most recently used conversions are
+ * kept.
+ *
+ * A #GstVideoConvertSampleCache can be used from multiple threads at the
+ * same time.
+ *
+ * Returns: (transfer full): a new #GstVideoConvertSampleCache. Free with
+ * gst_video_convert_sample_cache_free().
+ *
+ * Since: 1.20
+ */
+GstVideoConvertSampleCache *
+gst_video_convert_sample_cache_new (guint max_entries)
+{
+  GstVideoConvertSampleCache *cache;
+
+  g_return_val_if_fail (max_entries > 0, NULL);
+
+  cache = g_slice_new0 (GstVideoConvertSampleCache);
+  g_mutex_init (&cache->lock);
+  cache->max_entries = max_entries;
+  g_queue_init (&cache->entries);
+
+  return cache;
+}
+
+/**
+ * gst_video_convert_sample_cache_free:
+ * @cache: a #GstVideoConvertSampleCache
+ *
+ * Free @cache and all the conversions it keeps.
+ *
+ * Since: 1.20
+ */
+void
+gst_video_convert_sample_cache_free (GstVideoConvertSampleCache * cache)
+{
+  g_return_if_fail (cache != NULL);
+
+  g_queue_free_full (&cache->entries, (GDestroyNotify) convert_entry_free);
+  g_mutex_clear (&cache->lock);
+  g_slice_free (GstVideoConvertSampleCache, cache);
+}
+
+/**
+ * gst_video_convert_sample_cache_convert:
+ * @cache: a #GstVideoConvertSampleCache
+ * @sample: a #GstSample
+ * @to_caps: the #GstCaps to convert to
+ * @timeout: the maximum amount of time allowed for the processing.
+ * @error: pointer to a #GError. Can be %NULL.
+ *
+ * Converts a raw video buffer into the specified output caps like
+ * gst_video_convert_sample(), reusing the conversion of a previous call with
+ * the same caps from @cache.
+ *
+ * The cached conversions, including the encoding into image formats, run
+ * synchronously in the calling thread and are not limited by @timeout. It
+ * only applies when the conversion falls back to a pipeline like
+ * gst_video_convert_sample() does.
+ *
+ * Returns: The converted #GstSample, or %NULL if an error happened (in which case @err
+ * will point to the #GError).
+ *
+ * Since: 1.20
+ */
+GstSample *
+gst_video_convert_sample_cache_convert (GstVideoConvertSampleCache * cache,
+    GstSample * sample, const GstCaps * to_caps, GstClockTime timeout,
+    GError ** error)
+{
+  GstVideoConvertSampleEntry *entry = NULL;
+  GstVideoCropMeta *cmeta;
+  GstBuffer *buf;
+  GstCaps *from_caps, *to_caps_copy;
+  GstSample *result;
+  GList *l;
+
+  g_return_val_if_fail (cache != NULL, NULL);
+  g_return_val_if_fail (sample != NULL, NULL);
+  g_return_val_if_fail (to_caps != NULL, NULL);
+
+  buf = gst_sample_get_buffer (sample);
+  g_return_val_if_fail (buf != NULL, NULL);
+
+  from_caps = gst_sample_get_caps (sample);
+  g_return_val_if_fail (from_caps != NULL, NULL);
+
+  to_caps_copy = copy_caps_without_framerate (to_caps);
+  cmeta = gst_buffer_get_video_crop_meta (buf);
+
+  /* take the entry out of the cache while we use it */
+  g_mutex_lock (&cache->lock);
+  for (l = cache->entries.head; l; l = l->next) {
+    if (convert_entry_matches (l->data, from_caps, cmeta, to_caps_copy)) {
+      entry = l->data;
+      g_queue_delete_link (&cache->entries, l);
+      break;
+    }
+  }
+  g_mutex_unlock (&cache->lock);
+
+  if (entry == NULL)
+    entry = convert_entry_new (from_caps, cmeta, to_caps_copy, TRUE);
+  gst_caps_unref (to_caps_copy);
+
+  if (entry == NULL)
+    return gst_video_convert_sample (sample, to_caps, timeout, error);
+
+  result = convert_entry_convert (entry, sample, error);
+
+  g_mutex_lock (&cache->lock);
+  g_queue_push_head (&cache->entries, entry);
+  while (g_queue_get_length (&cache->entries) > cache->max_entries)
+    convert_entry_free (g_queue_pop_tail (&cache->entries));
+  g_mutex_unlock (&cache->lock);
+
+  return result;
+}
+
 typedef struct
 {
   gint ref_count;
@@ -691,7 +1445,6 @@ gst_video_convert_sample_async (GstSample * sample,
   GstBuffer *buf;
   GstCaps *from_caps, *to_caps_copy = NULL;
   GstElement *pipeline, *src, *sink;
-  guint i, n;
   GSource *source;
   GstVideoConvertSampleContext *ctx;
 
@@ -710,15 +1463,7 @@ gst_video_convert_sample_async (GstSample * sample,
   if (!context)
     context = g_main_context_default ();
 
-  to_caps_copy = gst_caps_new_empty ();
-  n = gst_caps_get_size (to_caps);
-  for (i = 0; i < n; i++) {
-    GstStructure *s = gst_caps_get_structure (to_caps, i);
-
-    s = gst_structure_copy (s);
-    gst_structure_remove_field (s, "framerate");
-    gst_caps_append_structure (to_caps_copy, s);
-  }
+  to_caps_copy = copy_caps_without_framerate (to_caps);
 
   /* There's a reference cycle between the context and the pipeline, which is
    * broken up once the finish() is called on the context. At latest when the
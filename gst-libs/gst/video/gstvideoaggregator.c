@@ -28,7 +28,10 @@
  * output parameters. Indeed output video frames will have the geometry of the
  * biggest incoming video stream and the framerate of the fastest incoming one.
  *
- * VideoAggregator will do colorspace conversion.
+ * VideoAggregator will do colorspace conversion. The frames of the
+ * #GstVideoAggregatorConvertPad pads whose class sets
+ * parallel_prepare_frame are converted in parallel on the shared
+ * #GstVideoTaskPool before the aggregation starts.
  *
  * Zorder for each input stream can be configured on the
  * #GstVideoAggregatorPad.
@@ -464,8 +467,10 @@ gst_video_aggregator_convert_pad_prepare_frame (GstVideoAggregatorPad * vpad,
 
     gst_video_info_init (&conversion_info);
     klass->create_conversion_info (pad, vagg, &conversion_info);
-    if (conversion_info.finfo == NULL)
+    if (conversion_info.finfo == NULL) {
+      GST_OBJECT_UNLOCK (pad);
       return FALSE;
+    }
     pad->priv->converter_config_changed = FALSE;
 
     pad->priv->conversion_info = conversion_info;
@@ -480,6 +485,7 @@ gst_video_aggregator_convert_pad_prepare_frame (GstVideoAggregatorPad * vpad,
           pad->priv->converter_config ? gst_structure_copy (pad->priv->
               converter_config) : NULL);
       if (!pad->priv->convert) {
+        GST_OBJECT_UNLOCK (pad);
         GST_WARNING_OBJECT (pad, "No path found for conversion");
         return FALSE;
       }
@@ -755,6 +761,9 @@ struct _GstVideoAggregatorPrivate
   /* The (ordered) list of #GstVideoFormatInfo supported by the aggregation
      method (from the srcpad template caps). */
   GPtrArray *supported_formats;
+
+  /* threads for preparing the frames of the convert pads */
+  GstVideoTaskPool *task_pool;
 };
 
 /* Can't use the G_DEFINE_TYPE macros because we need the
@@ -1784,12 +1793,33 @@ sync_pad_values (GstElement * vagg, GstPad * pad, gpointer user_data)
   return TRUE;
 }
 
+typedef struct
+{
+  GstVideoAggregator *vagg;
+  GstVideoAggregatorPad *pad;
+  gboolean parallel;
+  gboolean res;
+} PrepareFrameTask;
+
+static void
+prepare_frame_task (PrepareFrameTask * task)
+{
+  GstVideoAggregatorPad *vpad = task->pad;
+  GstVideoAggregatorPadClass *vaggpad_class =
+      GST_VIDEO_AGGREGATOR_PAD_GET_CLASS (vpad);
+
+  task->res = vaggpad_class->prepare_frame (vpad, task->vagg,
+      vpad->priv->buffer, &vpad->priv->prepared_frame);
+}
+
 static gboolean
 prepare_frames (GstElement * agg, GstPad * pad, gpointer user_data)
 {
+  GArray *tasks = user_data;
   GstVideoAggregatorPad *vpad = GST_VIDEO_AGGREGATOR_PAD_CAST (pad);
   GstVideoAggregatorPadClass *vaggpad_class =
       GST_VIDEO_AGGREGATOR_PAD_GET_CLASS (pad);
+  PrepareFrameTask task;
 
   memset (&vpad->priv->prepared_frame, 0, sizeof (GstVideoFrame));
 
@@ -1803,8 +1833,65 @@ prepare_frames (GstElement * agg, GstPad * pad, gpointer user_data)
     return TRUE;
   }
 
-  return vaggpad_class->prepare_frame (vpad, GST_VIDEO_AGGREGATOR_CAST (agg),
-      vpad->priv->buffer, &vpad->priv->prepared_frame);
+  task.vagg = GST_VIDEO_AGGREGATOR_CAST (agg);
+  task.pad = gst_object_ref (vpad);
+  task.parallel = GST_IS_VIDEO_AGGREGATOR_CONVERT_PAD (pad) &&
+      GST_VIDEO_AGGREGATOR_CONVERT_PAD_GET_CLASS (pad)->parallel_prepare_frame;
+  task.res = TRUE;
+
+  /* Pads that allow it are prepared in parallel afterwards, the other pads
+   * are prepared here from the aggregate thread and stop the iteration when
+   * they fail. */
+  if (!task.parallel)
+    prepare_frame_task (&task);
+
+  g_array_append_val (tasks, task);
+
+  return task.res;
+}
+
+static void
+prepare_frame_tasks_run (GstVideoAggregator * vagg, GArray * tasks)
+{
+  GstVideoAggregatorPadClass *vaggpad_class;
+  PrepareFrameTask *task;
+  gpointer *tasks_p;
+  guint i, n_tasks = 0;
+  gboolean failed = FALSE;
+
+  tasks_p = g_newa (gpointer, tasks->len);
+  for (i = 0; i < tasks->len; i++) {
+    task = &g_array_index (tasks, PrepareFrameTask, i);
+    if (task->parallel)
+      tasks_p[n_tasks++] = task;
+  }
+
+  if (n_tasks > 1) {
+    GST_LOG_OBJECT (vagg, "preparing %u pads in parallel", n_tasks);
+
+    if (vagg->priv->task_pool == NULL)
+      vagg->priv->task_pool = gst_video_task_pool_get_shared ();
+    gst_video_task_pool_run (vagg->priv->task_pool,
+        (GstVideoTaskFunc) prepare_frame_task, tasks_p, n_tasks);
+  } else if (n_tasks == 1) {
+    prepare_frame_task (tasks_p[0]);
+  }
+
+  /* Like when preparing one pad after the other, the pads after the first
+   * one that failed are not aggregated */
+  for (i = 0; i < tasks->len; i++) {
+    task = &g_array_index (tasks, PrepareFrameTask, i);
+    if (failed) {
+      vaggpad_class = GST_VIDEO_AGGREGATOR_PAD_GET_CLASS (task->pad);
+      if (vaggpad_class->clean_frame)
+        vaggpad_class->clean_frame (task->pad, vagg,
+            &task->pad->priv->prepared_frame);
+      memset (&task->pad->priv->prepared_frame, 0, sizeof (GstVideoFrame));
+    } else if (!task->res) {
+      failed = TRUE;
+    }
+    gst_object_unref (task->pad);
+  }
 }
 
 static gboolean
@@ -1833,6 +1920,7 @@ gst_video_aggregator_do_aggregate (GstVideoAggregator * vagg,
   GstElementClass *klass = GST_ELEMENT_GET_CLASS (vagg);
   GstVideoAggregatorClass *vagg_klass = (GstVideoAggregatorClass *) klass;
   GstClockTime out_stream_time;
+  GArray *tasks;
 
   g_assert (vagg_klass->aggregate_frames != NULL);
   g_assert (vagg_klass->create_output_buffer != NULL);
@@ -1864,8 +1952,15 @@ gst_video_aggregator_do_aggregate (GstVideoAggregator * vagg,
   gst_aggregator_selected_samples (agg, GST_BUFFER_PTS (*outbuf),
       GST_BUFFER_DTS (*outbuf), GST_BUFFER_DURATION (*outbuf), NULL);
 
-  /* Convert all the frames the subclass has before aggregating */
-  gst_element_foreach_sink_pad (GST_ELEMENT_CAST (vagg), prepare_frames, NULL);
+  /* Convert all the frames the subclass has before aggregating. The
+   * conversions of the different pads are independent and are spread over
+   * the threads of the shared task pool, we wait for all of them to finish
+   * before aggregating. */
+  tasks = g_array_new (FALSE, FALSE, sizeof (PrepareFrameTask));
+  gst_element_foreach_sink_pad (GST_ELEMENT_CAST (vagg), prepare_frames,
+      tasks);
+  prepare_frame_tasks_run (vagg, tasks);
+  g_array_unref (tasks);
 
   ret = vagg_klass->aggregate_frames (vagg, *outbuf);
 
@@ -2660,6 +2755,8 @@ gst_video_aggregator_finalize (GObject * o)
 
   g_mutex_clear (&vagg->priv->lock);
   g_ptr_array_unref (vagg->priv->supported_formats);
+  if (vagg->priv->task_pool)
+    gst_video_task_pool_unref (vagg->priv->task_pool);
 
   G_OBJECT_CLASS (gst_video_aggregator_parent_class)->finalize (o);
 }
@@ -148,6 +148,11 @@ struct _GstVideoAggregatorConvertPad
 
 /**
  * GstVideoAggregatorConvertPadClass:
+ * @parallel_prepare_frame: %TRUE if the frames of the pads can be prepared
+ *                          from several threads at the same time. Set this
+ *                          only if @prepare_frame modifies nothing but the
+ *                          pad itself and reads other pads only with the
+ *                          object lock of the aggregator. Since: 1.20
  *
  * Since: 1.16
  */
@@ -157,8 +162,10 @@ struct _GstVideoAggregatorConvertPadClass
 
   void (*create_conversion_info) (GstVideoAggregatorConvertPad *pad, GstVideoAggregator *agg, GstVideoInfo *conversion_info);
 
+  gboolean      parallel_prepare_frame;
+
   /*< private >*/
-  gpointer      _gst_reserved[GST_PADDING];
+  gpointer      _gst_reserved[GST_PADDING - 1];
 };
 
 GST_VIDEO_API
@@ -66,6 +66,12 @@
  *     and offset tracking, and possibly to requeue the frame for a later
  *     attempt in the case of reverse playback.
  *
+ *   * Subclasses that can decode every frame independently of the others,
+ *     like intra-only codecs, can call gst_video_decoder_set_frame_threads()
+ *     to have @handle_frame called for several frames in parallel from
+ *     worker threads. The finished frames are still pushed downstream in
+ *     decoding order.
+ *
  * ## Shutdown phase
  *
  *   * The GstVideoDecoder class calls @stop to inform the subclass that data
@@ -383,6 +389,16 @@ struct _GstVideoDecoderPrivate
   guint32 decode_frame_number;
 
   GQueue frames;                /* Protected with OBJECT_LOCK */
+  /* system_frame_number -> GList link of the frame in frames, made again
+   * from frames when the subclass renumbered some */
+  GHashTable *frame_table;
+  /* pending_number of the next frame added to frames */
+  guint32 pending_number;
+  /* the pending frames that have events, in the order of frames */
+  GQueue event_frames;
+  /* the pending frames with a valid ts and ts2, ordered by them */
+  GQueue ts_frames;
+  GQueue ts2_frames;
   GstVideoCodecState *input_state;
   GstVideoCodecState *output_state;     /* OBJECT_LOCK and STREAM_LOCK */
   gboolean output_state_changed;
@@ -416,6 +432,17 @@ struct _GstVideoDecoderPrivate
   /* flags */
   gboolean use_default_pad_acceptcaps;
 
+  /* frame threading, see gst_video_decoder_set_frame_threads() */
+  guint n_frame_threads;
+  GThreadPool *frame_thread_pool;
+  GMutex frame_threads_lock;
+  GCond frame_threads_cond;
+  /* FrameThreadTask, in decoding order, protected by frame_threads_lock */
+  GQueue frame_tasks;
+  /* flow return of the tasks collected while handling an event, returned
+   * by the next chain call. Protected with STREAM_LOCK */
+  GstFlowReturn frame_tasks_ret;
+
 #ifndef GST_DISABLE_DEBUG
   /* Diagnostic time for reporting the time
    * from flush to first output */
@@ -473,6 +500,15 @@ static GstFlowReturn gst_video_decoder_flush_parse (GstVideoDecoder * dec,
 
 static void gst_video_decoder_clear_queues (GstVideoDecoder * dec);
 
+static void gst_video_decoder_collect_frame_tasks_unchained (GstVideoDecoder
+    * decoder);
+static GstFlowReturn gst_video_decoder_collect_frame_tasks (GstVideoDecoder *
+    decoder, guint max_pending);
+static void gst_video_decoder_discard_frame_tasks (GstVideoDecoder * decoder);
+static gboolean gst_video_decoder_in_frame_thread (GstVideoDecoder * decoder);
+static gboolean gst_video_decoder_defer_frame (GstVideoDecoder * decoder,
+    GstVideoCodecFrame * frame, gint action);
+
 static gboolean gst_video_decoder_sink_event_default (GstVideoDecoder * decoder,
     GstEvent * event);
 static gboolean gst_video_decoder_src_event_default (GstVideoDecoder * decoder,
@@ -643,6 +679,15 @@ gst_video_decoder_init (GstVideoDecoder * decoder, GstVideoDecoderClass * klass)
   decoder->priv->needs_format = FALSE;
 
   g_queue_init (&decoder->priv->frames);
+  decoder->priv->frame_table = g_hash_table_new (NULL, NULL);
+  g_queue_init (&decoder->priv->event_frames);
+  g_queue_init (&decoder->priv->ts_frames);
+  g_queue_init (&decoder->priv->ts2_frames);
+
+  decoder->priv->n_frame_threads = 1;
+  g_mutex_init (&decoder->priv->frame_threads_lock);
+  g_cond_init (&decoder->priv->frame_threads_cond);
+  g_queue_init (&decoder->priv->frame_tasks);
   g_queue_init (&decoder->priv->timestamps);
 
   /* properties */
@@ -776,6 +821,9 @@ gst_video_decoder_setcaps (GstVideoDecoder * decoder, GstCaps * caps)
   if (G_UNLIKELY (state == NULL))
     goto parse_fail;
 
+  /* frames still being decoded belong to the previous format */
+  gst_video_decoder_collect_frame_tasks_unchained (decoder);
+
   if (decoder_class->set_format)
     ret = decoder_class->set_format (decoder, state);
 
@@ -825,6 +873,13 @@ gst_video_decoder_finalize (GObject * object)
 
   g_rec_mutex_clear (&decoder->stream_lock);
 
+  g_hash_table_unref (decoder->priv->frame_table);
+
+  if (decoder->priv->frame_thread_pool)
+    g_thread_pool_free (decoder->priv->frame_thread_pool, FALSE, TRUE);
+  g_mutex_clear (&decoder->priv->frame_threads_lock);
+  g_cond_clear (&decoder->priv->frame_threads_cond);
+
   if (decoder->priv->input_adapter) {
     g_object_unref (decoder->priv->input_adapter);
     decoder->priv->input_adapter = NULL;
@@ -901,6 +956,12 @@ gst_video_decoder_flush (GstVideoDecoder * dec, gboolean hard)
 
   GST_LOG_OBJECT (dec, "flush hard %d", hard);
 
+  /* frame threads are done before the subclass is flushed */
+  if (hard)
+    gst_video_decoder_discard_frame_tasks (dec);
+  else
+    ret = gst_video_decoder_collect_frame_tasks (dec, 0);
+
   /* Inform subclass */
   if (klass->reset) {
     GST_FIXME_OBJECT (dec, "GstVideoDecoder::reset() is deprecated");
@@ -1036,12 +1097,17 @@ gst_video_decoder_drain_out (GstVideoDecoder * dec, gboolean at_eos)
   GstFlowReturn ret = GST_FLOW_OK;
 
   if (dec->input_segment.rate > 0.0) {
+    GstFlowReturn tasks_ret;
+
     /* Forward mode, if unpacketized, give the child class
      * a final chance to flush out packets */
     if (!priv->packetized) {
       ret = gst_video_decoder_parse_available (dec, TRUE, FALSE);
     }
 
+    /* then push everything that is still being decoded */
+    tasks_ret = gst_video_decoder_collect_frame_tasks (dec, 0);
+
     if (at_eos) {
       if (decoder_class->finish)
         ret = decoder_class->finish (dec);
@@ -1052,6 +1118,10 @@ gst_video_decoder_drain_out (GstVideoDecoder * dec, gboolean at_eos)
         GST_FIXME_OBJECT (dec, "Sub-class should implement drain()");
       }
     }
+
+    /* the frames that were in flight came first */
+    if (tasks_ret != GST_FLOW_OK)
+      ret = tasks_ret;
   } else {
     /* Reverse playback mode */
     ret = gst_video_decoder_flush_parse (dec, TRUE);
@@ -1371,6 +1441,9 @@ gst_video_decoder_sink_event_default (GstVideoDecoder * decoder,
 
       GST_VIDEO_DECODER_STREAM_LOCK (decoder);
 
+      /* the frames in flight belong to the previous segment */
+      gst_video_decoder_collect_frame_tasks_unchained (decoder);
+
       /* Update the decode flags in the segment if we have an instant-rate
        * override active */
       GST_OBJECT_LOCK (decoder);
@@ -1415,10 +1488,14 @@ gst_video_decoder_sink_event_default (GstVideoDecoder * decoder,
       GList *l;
 
       GST_VIDEO_DECODER_STREAM_LOCK (decoder);
-      for (l = priv->frames.head; l; l = l->next) {
+      for (l = priv->event_frames.head; l;) {
         GstVideoCodecFrame *frame = l->data;
+        GList *next = l->next;
 
         frame->events = _flush_events (decoder->srcpad, frame->events);
+        if (frame->events == NULL)
+          g_queue_delete_link (&priv->event_frames, l);
+        l = next;
       }
       priv->current_frame_events = _flush_events (decoder->srcpad,
           decoder->priv->current_frame_events);
@@ -2105,6 +2182,7 @@ static void
 gst_video_decoder_clear_queues (GstVideoDecoder * dec)
 {
   GstVideoDecoderPrivate *priv = dec->priv;
+  GList *l;
 
   g_list_free_full (priv->output_queued,
       (GDestroyNotify) gst_mini_object_unref);
@@ -2119,6 +2197,16 @@ gst_video_decoder_clear_queues (GstVideoDecoder * dec)
   g_list_free_full (priv->parse_gather,
       (GDestroyNotify) gst_video_codec_frame_unref);
   priv->parse_gather = NULL;
+  g_hash_table_remove_all (priv->frame_table);
+  g_queue_clear (&priv->event_frames);
+  for (l = priv->frames.head; l; l = l->next) {
+    GstVideoCodecFrame *frame = l->data;
+
+    frame->abidata.ABI.ts_link = NULL;
+    frame->abidata.ABI.ts2_link = NULL;
+  }
+  g_queue_clear (&priv->ts_frames);
+  g_queue_clear (&priv->ts2_frames);
   g_queue_clear_full (&priv->frames,
       (GDestroyNotify) gst_video_codec_frame_unref);
 }
@@ -2133,6 +2221,13 @@ gst_video_decoder_reset (GstVideoDecoder * decoder, gboolean full,
 
   GST_VIDEO_DECODER_STREAM_LOCK (decoder);
 
+  if (full || flush_hard) {
+    gst_video_decoder_discard_frame_tasks (decoder);
+    priv->frame_tasks_ret = GST_FLOW_OK;
+  } else {
+    gst_video_decoder_collect_frame_tasks_unchained (decoder);
+  }
+
   if (full || flush_hard) {
     gst_segment_init (&decoder->input_segment, GST_FORMAT_UNDEFINED);
     gst_segment_init (&decoder->output_segment, GST_FORMAT_UNDEFINED);
@@ -2562,6 +2657,9 @@ gst_video_decoder_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
 
   GST_VIDEO_DECODER_STREAM_LOCK (decoder);
 
+  if (G_UNLIKELY (decoder->priv->frame_tasks_ret != GST_FLOW_OK))
+    goto frame_tasks_failed;
+
   /* NOTE:
    * requiring the pad to be negotiated makes it impossible to use
    * oggdemux or filesrc ! decoder */
@@ -2600,6 +2698,16 @@ not_negotiated:
     gst_buffer_unref (buf);
     return GST_FLOW_NOT_NEGOTIATED;
   }
+frame_tasks_failed:
+  {
+    ret = decoder->priv->frame_tasks_ret;
+    decoder->priv->frame_tasks_ret = GST_FLOW_OK;
+    GST_DEBUG_OBJECT (decoder, "frames collected for an event returned %s",
+        gst_flow_get_name (ret));
+    GST_VIDEO_DECODER_STREAM_UNLOCK (decoder);
+    gst_buffer_unref (buf);
+    return ret;
+  }
 }
 
 static GstStateChangeReturn
@@ -2637,6 +2745,11 @@ gst_video_decoder_change_state (GstElement * element, GstStateChange transition)
     case GST_STATE_CHANGE_PAUSED_TO_READY:{
       gboolean stopped = TRUE;
 
+      /* no frame thread may still be decoding when the subclass stops */
+      GST_VIDEO_DECODER_STREAM_LOCK (decoder);
+      gst_video_decoder_discard_frame_tasks (decoder);
+      GST_VIDEO_DECODER_STREAM_UNLOCK (decoder);
+
       if (decoder_class->stop)
         stopped = decoder_class->stop (decoder);
 
@@ -2696,9 +2809,7 @@ gst_video_decoder_new_frame (GstVideoDecoder * decoder)
   GstVideoDecoderPrivate *priv = decoder->priv;
   GstVideoCodecFrame *frame;
 
-  frame = g_slice_new0 (GstVideoCodecFrame);
-
-  frame->ref_count = 1;
+  frame = __gst_video_codec_frame_new ();
 
   GST_VIDEO_DECODER_STREAM_LOCK (decoder);
   frame->system_frame_number = priv->system_frame_number;
@@ -2733,13 +2844,104 @@ gst_video_decoder_push_event_list (GstVideoDecoder * decoder, GList * events)
   g_list_free (events);
 }
 
+static inline GstClockTime *
+frame_ts (GstVideoCodecFrame * frame, gboolean ts2)
+{
+  return ts2 ? &frame->abidata.ABI.ts2 : &frame->abidata.ABI.ts;
+}
+
+static inline GList **
+frame_ts_link (GstVideoCodecFrame * frame, gboolean ts2)
+{
+  return ts2 ? &frame->abidata.ABI.ts2_link : &frame->abidata.ABI.ts_link;
+}
+
+/* Add @frame to @queue, which is ordered by ts or ts2, if it has a valid
+ * one. Timestamps mostly grow, so this starts looking from the tail. */
+static void
+gst_video_decoder_insert_frame_ts (GQueue * queue, GstVideoCodecFrame * frame,
+    gboolean ts2)
+{
+  GstClockTime ts = *frame_ts (frame, ts2);
+  GList *l;
+
+  if (!GST_CLOCK_TIME_IS_VALID (ts)) {
+    *frame_ts_link (frame, ts2) = NULL;
+    return;
+  }
+
+  for (l = queue->tail; l; l = l->prev) {
+    if (*frame_ts (l->data, ts2) <= ts)
+      break;
+  }
+
+  if (l) {
+    g_queue_insert_after (queue, l, frame);
+    *frame_ts_link (frame, ts2) = l->next;
+  } else {
+    g_queue_push_head (queue, frame);
+    *frame_ts_link (frame, ts2) = queue->head;
+  }
+}
+
+static void
+gst_video_decoder_remove_frame_ts (GQueue * queue, GstVideoCodecFrame * frame,
+    gboolean ts2)
+{
+  GList **link = frame_ts_link (frame, ts2);
+
+  if (*link) {
+    g_queue_delete_link (queue, *link);
+    *link = NULL;
+  }
+}
+
+/* Get the oldest ts or ts2 of the pending frames. The frame that had it
+ * gets the one of @frame instead, which is about to be finished. */
+static GstClockTime
+gst_video_decoder_take_oldest_ts (GstVideoDecoder * decoder, GQueue * queue,
+    GstVideoCodecFrame * frame, gboolean ts2, gboolean * seen_none)
+{
+  GstVideoCodecFrame *oframe;
+  GstClockTime min_ts;
+  GList **link;
+
+  *seen_none = queue->length < decoder->priv->frames.length;
+
+  oframe = g_queue_peek_head (queue);
+  if (oframe == NULL)
+    return GST_CLOCK_TIME_NONE;
+
+  min_ts = *frame_ts (oframe, ts2);
+  if (oframe == frame)
+    return min_ts;
+
+  /* save a ts if needed */
+  *frame_ts (oframe, ts2) = *frame_ts (frame, ts2);
+  g_queue_delete_link (queue, queue->head);
+  *frame_ts_link (oframe, ts2) = NULL;
+
+  link = frame_ts_link (frame, ts2);
+  if (*link) {
+    /* the timestamp of @frame is in its place already */
+    (*link)->data = oframe;
+    *frame_ts_link (oframe, ts2) = *link;
+    *link = NULL;
+  } else {
+    gst_video_decoder_insert_frame_ts (queue, oframe, ts2);
+  }
+
+  return min_ts;
+}
+
 static void
 gst_video_decoder_prepare_finish_frame (GstVideoDecoder *
     decoder, GstVideoCodecFrame * frame, gboolean dropping)
 {
   GstVideoDecoderPrivate *priv = decoder->priv;
-  GList *l, *events = NULL;
-  gboolean sync;
+  GstVideoCodecFrame *tmp;
+  GList *link, *events = NULL;
+  gboolean sync, pending;
 
 #ifndef GST_DISABLE_GST_DEBUG
   GST_LOG_OBJECT (decoder, "n %d in %" G_GSIZE_FORMAT " out %" G_GSIZE_FORMAT,
@@ -2756,17 +2958,21 @@ gst_video_decoder_prepare_finish_frame (GstVideoDecoder *
       frame, frame->system_frame_number,
       sync, GST_TIME_ARGS (frame->pts), GST_TIME_ARGS (frame->dts));
 
-  /* Push all pending events that arrived before this frame */
-  for (l = priv->frames.head; l; l = l->next) {
-    GstVideoCodecFrame *tmp = l->data;
-
-    if (tmp->events) {
-      events = g_list_concat (tmp->events, events);
-      tmp->events = NULL;
-    }
+  /* Push all pending events that arrived before this frame, or all of them
+   * if it's not pending anymore */
+  link = g_hash_table_lookup (priv->frame_table,
+      GUINT_TO_POINTER (frame->system_frame_number));
+  pending = (link && link->data == frame) ||
+      g_queue_find (&priv->frames, frame) != NULL;
 
-    if (tmp == frame)
+  while ((tmp = g_queue_peek_head (&priv->event_frames))) {
+    if (pending && (gint32) (tmp->abidata.ABI.pending_number -
+            frame->abidata.ABI.pending_number) > 0)
       break;
+
+    g_queue_pop_head (&priv->event_frames);
+    events = g_list_concat (tmp->events, events);
+    tmp->events = NULL;
   }
 
   if (dropping || !decoder->priv->output_state) {
@@ -2812,28 +3018,12 @@ gst_video_decoder_prepare_finish_frame (GstVideoDecoder *
   /* PTS is expected montone ascending,
    * so a good guess is lowest unsent DTS */
   {
-    GstClockTime min_ts = GST_CLOCK_TIME_NONE;
-    GstVideoCodecFrame *oframe = NULL;
-    gboolean seen_none = FALSE;
+    GstClockTime min_ts;
+    gboolean seen_none;
 
     /* some maintenance regardless */
-    for (l = priv->frames.head; l; l = l->next) {
-      GstVideoCodecFrame *tmp = l->data;
-
-      if (!GST_CLOCK_TIME_IS_VALID (tmp->abidata.ABI.ts)) {
-        seen_none = TRUE;
-        continue;
-      }
-
-      if (!GST_CLOCK_TIME_IS_VALID (min_ts) || tmp->abidata.ABI.ts < min_ts) {
-        min_ts = tmp->abidata.ABI.ts;
-        oframe = tmp;
-      }
-    }
-    /* save a ts if needed */
-    if (oframe && oframe != frame) {
-      oframe->abidata.ABI.ts = frame->abidata.ABI.ts;
-    }
+    min_ts = gst_video_decoder_take_oldest_ts (decoder, &priv->ts_frames,
+        frame, FALSE, &seen_none);
 
     /* and set if needed;
      * valid delta means we have reasonable DTS input */
@@ -2849,25 +3039,8 @@ gst_video_decoder_prepare_finish_frame (GstVideoDecoder *
     }
 
     /* some more maintenance, ts2 holds PTS */
-    min_ts = GST_CLOCK_TIME_NONE;
-    seen_none = FALSE;
-    for (l = priv->frames.head; l; l = l->next) {
-      GstVideoCodecFrame *tmp = l->data;
-
-      if (!GST_CLOCK_TIME_IS_VALID (tmp->abidata.ABI.ts2)) {
-        seen_none = TRUE;
-        continue;
-      }
-
-      if (!GST_CLOCK_TIME_IS_VALID (min_ts) || tmp->abidata.ABI.ts2 < min_ts) {
-        min_ts = tmp->abidata.ABI.ts2;
-        oframe = tmp;
-      }
-    }
-    /* save a ts if needed */
-    if (oframe && oframe != frame) {
-      oframe->abidata.ABI.ts2 = frame->abidata.ABI.ts2;
-    }
+    min_ts = gst_video_decoder_take_oldest_ts (decoder, &priv->ts2_frames,
+        frame, TRUE, &seen_none);
 
     /* if we detected reordered output, then PTS are void,
      * however those were obtained; bogus input, subclass etc */
@@ -2928,6 +3101,23 @@ no_output_buffer:
   }
 }
 
+/* Index the pending frames by their current system_frame_number. Like with
+ * a walk of the frames, the first one wins for duplicate numbers. */
+static void
+gst_video_decoder_index_frames (GstVideoDecoder * dec)
+{
+  GstVideoDecoderPrivate *priv = dec->priv;
+  GList *l;
+
+  g_hash_table_remove_all (priv->frame_table);
+  for (l = priv->frames.tail; l; l = l->prev) {
+    GstVideoCodecFrame *tmp = l->data;
+
+    g_hash_table_insert (priv->frame_table,
+        GUINT_TO_POINTER (tmp->system_frame_number), l);
+  }
+}
+
 /**
  * gst_video_decoder_release_frame:
  * @dec: a #GstVideoDecoder
@@ -2944,15 +3134,35 @@ gst_video_decoder_release_frame (GstVideoDecoder * dec,
     GstVideoCodecFrame * frame)
 {
   GList *link;
+  gboolean reindex;
+
+  if (gst_video_decoder_defer_frame (dec, frame, FRAME_TASK_RELEASE))
+    return;
 
   /* unref once from the list */
   GST_VIDEO_DECODER_STREAM_LOCK (dec);
-  link = g_queue_find (&dec->priv->frames, frame);
+  link = g_hash_table_lookup (dec->priv->frame_table,
+      GUINT_TO_POINTER (frame->system_frame_number));
+  if (link && link->data == frame) {
+    g_hash_table_remove (dec->priv->frame_table,
+        GUINT_TO_POINTER (frame->system_frame_number));
+    reindex = FALSE;
+  } else {
+    /* the subclass changed the frame number behind our back, the frame is
+     * still indexed by the old number */
+    link = g_queue_find (&dec->priv->frames, frame);
+    reindex = link != NULL;
+  }
   if (link) {
+    gst_video_decoder_remove_frame_ts (&dec->priv->ts_frames, frame, FALSE);
+    gst_video_decoder_remove_frame_ts (&dec->priv->ts2_frames, frame, TRUE);
     gst_video_codec_frame_unref (frame);
     g_queue_delete_link (&dec->priv->frames, link);
+    if (reindex)
+      gst_video_decoder_index_frames (dec);
   }
   if (frame->events) {
+    g_queue_remove (&dec->priv->event_frames, frame);
     dec->priv->pending_events =
         g_list_concat (frame->events, dec->priv->pending_events);
     frame->events = NULL;
@@ -3011,6 +3221,9 @@ gst_video_decoder_drop_frame (GstVideoDecoder * dec, GstVideoCodecFrame * frame)
 {
   GST_LOG_OBJECT (dec, "drop frame %p", frame);
 
+  if (gst_video_decoder_defer_frame (dec, frame, FRAME_TASK_DROP))
+    return GST_FLOW_OK;
+
   GST_VIDEO_DECODER_STREAM_LOCK (dec);
 
   gst_video_decoder_prepare_finish_frame (dec, frame, TRUE);
@@ -3122,6 +3335,9 @@ gst_video_decoder_finish_frame (GstVideoDecoder * decoder,
 
   GST_LOG_OBJECT (decoder, "finish frame %p", frame);
 
+  if (gst_video_decoder_defer_frame (decoder, frame, FRAME_TASK_FINISH))
+    return GST_FLOW_OK;
+
   GST_VIDEO_DECODER_STREAM_LOCK (decoder);
 
   needs_reconfigure = gst_pad_check_reconfigure (decoder->srcpad);
@@ -3507,6 +3723,201 @@ gst_video_decoder_have_frame (GstVideoDecoder * decoder)
   return ret;
 }
 
+/* What @handle_frame did with the frame of a frame thread task. The base
+ * class functions are then called with the frame from the streaming thread
+ * once all previous frames were collected. */
+enum
+{
+  FRAME_TASK_KEEP,
+  FRAME_TASK_FINISH,
+  FRAME_TASK_DROP,
+  FRAME_TASK_RELEASE
+};
+
+typedef struct
+{
+  GstVideoDecoder *decoder;
+  GstVideoCodecFrame *frame;
+  gint action;
+  GstFlowReturn ret;
+  gboolean done;
+} FrameThreadTask;
+
+/* the task the current thread is running @handle_frame for */
+static GPrivate frame_thread_task = G_PRIVATE_INIT (NULL);
+
+static gboolean
+gst_video_decoder_in_frame_thread (GstVideoDecoder * decoder)
+{
+  FrameThreadTask *task = g_private_get (&frame_thread_task);
+
+  return task && task->decoder == decoder;
+}
+
+/* Called from the finish/drop/release functions. Frame threads never take
+ * the stream lock, the action is recorded and performed once the streaming
+ * thread collects the task. */
+static gboolean
+gst_video_decoder_defer_frame (GstVideoDecoder * decoder,
+    GstVideoCodecFrame * frame, gint action)
+{
+  FrameThreadTask *task = g_private_get (&frame_thread_task);
+
+  if (!task || task->decoder != decoder || task->frame != frame
+      || task->action != FRAME_TASK_KEEP)
+    return FALSE;
+
+  GST_LOG_OBJECT (decoder, "deferring action %d for frame %p (#%d)", action,
+      frame, frame->system_frame_number);
+  task->action = action;
+
+  return TRUE;
+}
+
+static void
+gst_video_decoder_frame_thread_func (FrameThreadTask * task,
+    GstVideoDecoder * decoder)
+{
+  GstVideoDecoderClass *decoder_class = GST_VIDEO_DECODER_GET_CLASS (decoder);
+  GstVideoDecoderPrivate *priv = decoder->priv;
+
+  g_private_set (&frame_thread_task, task);
+  task->ret = decoder_class->handle_frame (decoder, task->frame);
+  g_private_set (&frame_thread_task, NULL);
+
+  g_mutex_lock (&priv->frame_threads_lock);
+  task->done = TRUE;
+  g_cond_broadcast (&priv->frame_threads_cond);
+  g_mutex_unlock (&priv->frame_threads_lock);
+}
+
+/* Performs the actions of the finished tasks at the head of the queue and
+ * waits until at most @max_pending tasks are left.
+ * Called with the STREAM_LOCK */
+static GstFlowReturn
+gst_video_decoder_collect_frame_tasks (GstVideoDecoder * decoder,
+    guint max_pending)
+{
+  GstVideoDecoderPrivate *priv = decoder->priv;
+  GstFlowReturn ret = GST_FLOW_OK;
+  FrameThreadTask *task;
+
+  g_mutex_lock (&priv->frame_threads_lock);
+  while ((task = g_queue_peek_head (&priv->frame_tasks))) {
+    GstFlowReturn res = GST_FLOW_OK;
+
+    if (!task->done) {
+      if (priv->frame_tasks.length <= max_pending)
+        break;
+      g_cond_wait (&priv->frame_threads_cond, &priv->frame_threads_lock);
+      continue;
+    }
+    g_queue_pop_head (&priv->frame_tasks);
+    g_mutex_unlock (&priv->frame_threads_lock);
+
+    switch (task->action) {
+      case FRAME_TASK_FINISH:
+        res = gst_video_decoder_finish_frame (decoder, task->frame);
+        break;
+      case FRAME_TASK_DROP:
+        res = gst_video_decoder_drop_frame (decoder, task->frame);
+        break;
+      case FRAME_TASK_RELEASE:
+        gst_video_decoder_release_frame (decoder, task->frame);
+        break;
+      default:
+        break;
+    }
+    if (task->ret != GST_FLOW_OK) {
+      GST_DEBUG_OBJECT (decoder, "flow error %s", gst_flow_get_name (task->ret));
+      res = task->ret;
+    }
+    if (ret == GST_FLOW_OK)
+      ret = res;
+
+    g_slice_free (FrameThreadTask, task);
+    g_mutex_lock (&priv->frame_threads_lock);
+  }
+  g_mutex_unlock (&priv->frame_threads_lock);
+
+  return ret;
+}
+
+/* Collects all tasks where no GstFlowReturn can be returned, like for
+ * events. A flow error is returned by the next chain call instead.
+ * Called with the STREAM_LOCK */
+static void
+gst_video_decoder_collect_frame_tasks_unchained (GstVideoDecoder * decoder)
+{
+  GstVideoDecoderPrivate *priv = decoder->priv;
+  GstFlowReturn ret;
+
+  ret = gst_video_decoder_collect_frame_tasks (decoder, 0);
+  if (ret != GST_FLOW_OK && priv->frame_tasks_ret == GST_FLOW_OK)
+    priv->frame_tasks_ret = ret;
+}
+
+/* Waits for all frame threads and drops their frames.
+ * Called with the STREAM_LOCK */
+static void
+gst_video_decoder_discard_frame_tasks (GstVideoDecoder * decoder)
+{
+  GstVideoDecoderPrivate *priv = decoder->priv;
+  FrameThreadTask *task;
+
+  g_mutex_lock (&priv->frame_threads_lock);
+  while ((task = g_queue_pop_head (&priv->frame_tasks))) {
+    while (!task->done)
+      g_cond_wait (&priv->frame_threads_cond, &priv->frame_threads_lock);
+
+    /* the frames are still in the list of pending frames, which is
+     * cleared with the reset */
+    if (task->action != FRAME_TASK_KEEP)
+      gst_video_codec_frame_unref (task->frame);
+    g_slice_free (FrameThreadTask, task);
+  }
+  g_mutex_unlock (&priv->frame_threads_lock);
+}
+
+/* Hands @frame to a frame thread. Called with the STREAM_LOCK */
+static GstFlowReturn
+gst_video_decoder_dispatch_frame (GstVideoDecoder * decoder,
+    GstVideoCodecFrame * frame)
+{
+  GstVideoDecoderPrivate *priv = decoder->priv;
+  GstFlowReturn ret = GST_FLOW_OK;
+  FrameThreadTask *task;
+
+  /* frame threads can't negotiate, do that here. Frames in flight were
+   * decoded for the previous output state and go first. */
+  if (G_UNLIKELY (priv->output_state_changed))
+    ret = gst_video_decoder_collect_frame_tasks (decoder, 0);
+  if (priv->output_state && (priv->output_state_changed
+          || gst_pad_check_reconfigure (decoder->srcpad))) {
+    if (!gst_video_decoder_negotiate_unlocked (decoder))
+      gst_pad_mark_reconfigure (decoder->srcpad);
+  }
+
+  task = g_slice_new0 (FrameThreadTask);
+  task->decoder = decoder;
+  task->frame = frame;
+  task->action = FRAME_TASK_KEEP;
+
+  g_mutex_lock (&priv->frame_threads_lock);
+  g_queue_push_tail (&priv->frame_tasks, task);
+  g_mutex_unlock (&priv->frame_threads_lock);
+
+  g_thread_pool_push (priv->frame_thread_pool, task, NULL);
+
+  if (ret == GST_FLOW_OK)
+    ret = gst_video_decoder_collect_frame_tasks (decoder,
+        priv->n_frame_threads * 2);
+  else
+    gst_video_decoder_collect_frame_tasks (decoder, priv->n_frame_threads * 2);
+
+  return ret;
+}
+
 /* Pass the frame in priv->current_frame through the
  * handle_frame() callback for decoding and passing to gvd_finish_frame(),
  * or dropping by passing to gvd_drop_frame() */
@@ -3516,7 +3927,7 @@ gst_video_decoder_decode_frame (GstVideoDecoder * decoder,
 {
   GstVideoDecoderPrivate *priv = decoder->priv;
   GstVideoDecoderClass *decoder_class;
-  GstFlowReturn ret = GST_FLOW_OK;
+  GstFlowReturn ret = GST_FLOW_OK, tasks_ret = GST_FLOW_OK;
 
   decoder_class = GST_VIDEO_DECODER_GET_CLASS (decoder);
 
@@ -3553,6 +3964,13 @@ gst_video_decoder_decode_frame (GstVideoDecoder * decoder,
       frame->distance_from_sync);
 
   g_queue_push_tail (&priv->frames, gst_video_codec_frame_ref (frame));
+  g_hash_table_insert (priv->frame_table,
+      GUINT_TO_POINTER (frame->system_frame_number), priv->frames.tail);
+  frame->abidata.ABI.pending_number = priv->pending_number++;
+  if (frame->events)
+    g_queue_push_tail (&priv->event_frames, frame);
+  gst_video_decoder_insert_frame_ts (&priv->ts_frames, frame, FALSE);
+  gst_video_decoder_insert_frame_ts (&priv->ts2_frames, frame, TRUE);
 
   if (priv->frames.length > 10) {
     GST_DEBUG_OBJECT (decoder, "decoder frame list getting long: %d frames,"
@@ -3563,10 +3981,20 @@ gst_video_decoder_decode_frame (GstVideoDecoder * decoder,
       gst_segment_to_running_time (&decoder->input_segment, GST_FORMAT_TIME,
       frame->pts);
 
+  /* reverse playback decodes whole GOPs at once and is kept serial */
+  if (priv->frame_thread_pool && decoder->input_segment.rate > 0.0)
+    return gst_video_decoder_dispatch_frame (decoder, frame);
+
+  /* make sure frames of a threaded section are out before */
+  if (priv->frame_thread_pool)
+    tasks_ret = gst_video_decoder_collect_frame_tasks (decoder, 0);
+
   /* do something with frame */
   ret = decoder_class->handle_frame (decoder, frame);
   if (ret != GST_FLOW_OK)
     GST_DEBUG_OBJECT (decoder, "flow error %s", gst_flow_get_name (ret));
+  else
+    ret = tasks_ret;
 
   /* the frame has either been added to parse_gather or sent to
      handle frame so there is no need to unref it */
@@ -3741,14 +4169,17 @@ gst_video_decoder_get_frame (GstVideoDecoder * decoder, int frame_number)
   GST_DEBUG_OBJECT (decoder, "frame_number : %d", frame_number);
 
   GST_VIDEO_DECODER_STREAM_LOCK (decoder);
-  for (g = decoder->priv->frames.head; g; g = g->next) {
-    GstVideoCodecFrame *tmp = g->data;
-
-    if (tmp->system_frame_number == frame_number) {
-      frame = gst_video_codec_frame_ref (tmp);
-      break;
-    }
+  g = g_hash_table_lookup (decoder->priv->frame_table,
+      GUINT_TO_POINTER ((guint32) frame_number));
+  if (g == NULL || ((GstVideoCodecFrame *) g->data)->system_frame_number !=
+      (guint32) frame_number) {
+    /* not pending, or the subclass renumbered frames behind our back */
+    gst_video_decoder_index_frames (decoder);
+    g = g_hash_table_lookup (decoder->priv->frame_table,
+        GUINT_TO_POINTER ((guint32) frame_number));
   }
+  if (g)
+    frame = gst_video_codec_frame_ref (g->data);
   GST_VIDEO_DECODER_STREAM_UNLOCK (decoder);
 
   return frame;
@@ -3824,6 +4255,13 @@ gst_video_decoder_decide_allocation_default (GstVideoDecoder * decoder,
     pool = gst_video_buffer_pool_new ();
   }
 
+  /* every frame in flight in a frame thread holds an output buffer */
+  if (decoder->priv->n_frame_threads > 1) {
+    min += decoder->priv->n_frame_threads * 2;
+    if (max)
+      max += decoder->priv->n_frame_threads * 2;
+  }
+
   /* now configure */
   config = gst_buffer_pool_get_config (pool);
   gst_buffer_pool_config_set_params (config, outcaps, size, min, max);
@@ -3890,7 +4328,7 @@ gst_video_decoder_negotiate_pool (GstVideoDecoder * decoder, GstCaps * caps)
 {
   GstVideoDecoderClass *klass;
   GstQuery *query = NULL;
-  GstBufferPool *pool = NULL;
+  GstBufferPool *pool = NULL, *old_pool;
   GstAllocator *allocator;
   GstAllocationParams params;
   gboolean ret = TRUE;
@@ -3937,22 +4375,26 @@ gst_video_decoder_negotiate_pool (GstVideoDecoder * decoder, GstCaps * caps)
   decoder->priv->allocator = allocator;
   decoder->priv->params = params;
 
-  if (decoder->priv->pool) {
+  /* and activate */
+  GST_DEBUG_OBJECT (decoder, "activate pool %" GST_PTR_FORMAT, pool);
+  gst_buffer_pool_set_active (pool, TRUE);
+
+  /* frame threads pick up the pool with the object lock */
+  GST_OBJECT_LOCK (decoder);
+  old_pool = decoder->priv->pool;
+  decoder->priv->pool = pool;
+  GST_OBJECT_UNLOCK (decoder);
+
+  if (old_pool) {
     /* do not set the bufferpool to inactive here, it will be done
      * on its finalize function. As videodecoder do late renegotiation
      * it might happen that some element downstream is already using this
      * same bufferpool and deactivating it will make it fail.
      * Happens when a downstream element changes from passthrough to
      * non-passthrough and gets this same bufferpool to use */
-    GST_DEBUG_OBJECT (decoder, "unref pool %" GST_PTR_FORMAT,
-        decoder->priv->pool);
-    gst_object_unref (decoder->priv->pool);
+    GST_DEBUG_OBJECT (decoder, "unref pool %" GST_PTR_FORMAT, old_pool);
+    gst_object_unref (old_pool);
   }
-  decoder->priv->pool = pool;
-
-  /* and activate */
-  GST_DEBUG_OBJECT (decoder, "activate pool %" GST_PTR_FORMAT, pool);
-  gst_buffer_pool_set_active (pool, TRUE);
 
 done:
   if (query)
@@ -4059,6 +4501,11 @@ gst_video_decoder_negotiate_default (GstVideoDecoder * decoder)
         l = l->prev;
       }
     }
+
+    /* the oldest frame is the first one with events, if any */
+    if (frame && frame->events == NULL &&
+        g_queue_peek_head (&decoder->priv->event_frames) == frame)
+      g_queue_pop_head (&decoder->priv->event_frames);
   }
 
   prevcaps = gst_pad_get_current_caps (decoder->srcpad);
@@ -4129,6 +4576,31 @@ gst_video_decoder_negotiate (GstVideoDecoder * decoder)
   return ret;
 }
 
+/* Allocation from a frame thread, which can't take the stream lock. The
+ * streaming thread negotiated before handing out the frame. */
+static GstFlowReturn
+gst_video_decoder_frame_thread_acquire_buffer (GstVideoDecoder * decoder,
+    GstBuffer ** buffer, GstBufferPoolAcquireParams * params)
+{
+  GstBufferPool *pool = NULL;
+  GstFlowReturn flow;
+
+  GST_OBJECT_LOCK (decoder);
+  if (decoder->priv->pool)
+    pool = gst_object_ref (decoder->priv->pool);
+  GST_OBJECT_UNLOCK (decoder);
+
+  if (pool == NULL) {
+    GST_DEBUG_OBJECT (decoder, "no pool negotiated for frame threads");
+    return GST_FLOW_NOT_NEGOTIATED;
+  }
+
+  flow = gst_buffer_pool_acquire_buffer (pool, buffer, params);
+  gst_object_unref (pool);
+
+  return flow;
+}
+
 /**
  * gst_video_decoder_allocate_output_buffer:
  * @decoder: a #GstVideoDecoder
@@ -4151,6 +4623,34 @@ gst_video_decoder_allocate_output_buffer (GstVideoDecoder * decoder)
 
   GST_DEBUG ("alloc src buffer");
 
+  if (gst_video_decoder_in_frame_thread (decoder)) {
+    GstVideoCodecState *state = NULL;
+
+    flow = gst_video_decoder_frame_thread_acquire_buffer (decoder, &buffer,
+        NULL);
+    if (flow == GST_FLOW_OK)
+      return buffer;
+
+    GST_INFO_OBJECT (decoder, "couldn't allocate output buffer, flow %s",
+        gst_flow_get_name (flow));
+    GST_OBJECT_LOCK (decoder);
+    if (decoder->priv->output_state)
+      state = gst_video_codec_state_ref (decoder->priv->output_state);
+    GST_OBJECT_UNLOCK (decoder);
+
+    if (state && state->info.size) {
+      GST_INFO_OBJECT (decoder,
+          "Fallback allocation, creating new buffer which doesn't belongs to any buffer pool");
+      buffer = gst_buffer_new_allocate (NULL, state->info.size, NULL);
+    } else {
+      GST_ERROR_OBJECT (decoder, "Failed to allocate the buffer..");
+    }
+    if (state)
+      gst_video_codec_state_unref (state);
+
+    return buffer;
+  }
+
   GST_VIDEO_DECODER_STREAM_LOCK (decoder);
   needs_reconfigure = gst_pad_check_reconfigure (decoder->srcpad);
   if (G_UNLIKELY (!decoder->priv->output_state
@@ -4242,6 +4742,10 @@ gst_video_decoder_allocate_output_frame_with_params (GstVideoDecoder *
   g_return_val_if_fail (decoder->priv->output_state, GST_FLOW_NOT_NEGOTIATED);
   g_return_val_if_fail (frame->output_buffer == NULL, GST_FLOW_ERROR);
 
+  if (gst_video_decoder_in_frame_thread (decoder))
+    return gst_video_decoder_frame_thread_acquire_buffer (decoder,
+        &frame->output_buffer, params);
+
   GST_VIDEO_DECODER_STREAM_LOCK (decoder);
 
   state = decoder->priv->output_state;
@@ -4453,6 +4957,79 @@ gst_video_decoder_get_needs_format (GstVideoDecoder * dec)
   return result;
 }
 
+/**
+ * gst_video_decoder_set_frame_threads:
+ * @decoder: a #GstVideoDecoder
+ * @n_threads: number of frames to decode in parallel, 0 for the number of
+ *     CPUs
+ *
+ * Lets the base class call @handle_frame for up to @n_threads frames at the
+ * same time, each from a worker thread instead of the streaming thread. This
+ * is only suitable for decoders that can decode every frame independently of
+ * the others, like intra-only codecs. The default of 1 disables it.
+ *
+ * @handle_frame must then finish its frame with
+ * gst_video_decoder_finish_frame() or gst_video_decoder_drop_frame() before
+ * returning. The base class performs these from the streaming thread in
+ * decoding order, after all previous frames were finished. Besides that,
+ * @handle_frame may only allocate its output with
+ * gst_video_decoder_allocate_output_frame() or
+ * gst_video_decoder_allocate_output_buffer(); the output state has to be
+ * configured from @set_format or @parse.
+ *
+ * Up to twice @n_threads frames are in flight, which subclasses should
+ * include in the latency they report. Frames in flight are pushed before
+ * draining and discarded when flushing.
+ *
+ * Since: 1.20
+ */
+void
+gst_video_decoder_set_frame_threads (GstVideoDecoder * decoder,
+    guint n_threads)
+{
+  GstVideoDecoderPrivate *priv;
+
+  g_return_if_fail (GST_IS_VIDEO_DECODER (decoder));
+
+  priv = decoder->priv;
+
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+
+  GST_VIDEO_DECODER_STREAM_LOCK (decoder);
+  if (n_threads != priv->n_frame_threads) {
+    GST_DEBUG_OBJECT (decoder, "using %u frame threads", n_threads);
+
+    gst_video_decoder_collect_frame_tasks_unchained (decoder);
+    if (priv->frame_thread_pool) {
+      g_thread_pool_free (priv->frame_thread_pool, FALSE, TRUE);
+      priv->frame_thread_pool = NULL;
+    }
+    if (n_threads > 1)
+      priv->frame_thread_pool =
+          g_thread_pool_new ((GFunc) gst_video_decoder_frame_thread_func,
+          decoder, n_threads, FALSE, NULL);
+    priv->n_frame_threads = n_threads;
+  }
+  GST_VIDEO_DECODER_STREAM_UNLOCK (decoder);
+}
+
+/**
+ * gst_video_decoder_get_frame_threads:
+ * @decoder: a #GstVideoDecoder
+ *
+ * Returns: the number of frames @handle_frame is called for in parallel.
+ *
+ * Since: 1.20
+ */
+guint
+gst_video_decoder_get_frame_threads (GstVideoDecoder * decoder)
+{
+  g_return_val_if_fail (GST_IS_VIDEO_DECODER (decoder), 1);
+
+  return decoder->priv->n_frame_threads;
+}
+
 /**
  * gst_video_decoder_set_packetized:
  * @decoder: a #GstVideoDecoder
@@ -374,6 +374,13 @@ void     gst_video_decoder_set_needs_format (GstVideoDecoder * dec,
 GST_VIDEO_API
 gboolean gst_video_decoder_get_needs_format (GstVideoDecoder * dec);
 
+GST_VIDEO_API
+void     gst_video_decoder_set_frame_threads (GstVideoDecoder * decoder,
+                                              guint n_threads);
+
+GST_VIDEO_API
+guint    gst_video_decoder_get_frame_threads (GstVideoDecoder * decoder);
+
 GST_VIDEO_API
 void     gst_video_decoder_set_latency (GstVideoDecoder *decoder,
 					GstClockTime min_latency,
@@ -1479,9 +1479,7 @@ gst_video_encoder_new_frame (GstVideoEncoder * encoder, GstBuffer * buf,
   GstVideoEncoderPrivate *priv = encoder->priv;
   GstVideoCodecFrame *frame;
 
-  frame = g_slice_new0 (GstVideoCodecFrame);
-
-  frame->ref_count = 1;
+  frame = __gst_video_codec_frame_new ();
 
   GST_VIDEO_ENCODER_STREAM_LOCK (encoder);
   frame->system_frame_number = priv->system_frame_number;
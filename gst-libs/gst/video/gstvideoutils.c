@@ -24,6 +24,7 @@
 
 #include <gst/video/video.h>
 #include "gstvideoutils.h"
+#include "gstvideoutilsprivate.h"
 
 /**
  * SECTION:gstvideoutils
@@ -37,6 +38,38 @@ G_DEFINE_BOXED_TYPE (GstVideoCodecFrame, gst_video_codec_frame,
     (GBoxedCopyFunc) gst_video_codec_frame_ref,
     (GBoxedFreeFunc) gst_video_codec_frame_unref);
 
+/* Released frames are kept around for reuse so that codecs with many frames
+ * in flight don't go through the allocator for every frame. The pool is
+ * linked through the user_data field of the unused frames. */
+#define MAX_POOLED_FRAMES 64
+
+G_LOCK_DEFINE_STATIC (frame_pool);
+static GstVideoCodecFrame *frame_pool = NULL;
+static guint n_pooled_frames = 0;
+
+GstVideoCodecFrame *
+__gst_video_codec_frame_new (void)
+{
+  GstVideoCodecFrame *frame;
+
+  G_LOCK (frame_pool);
+  frame = frame_pool;
+  if (frame) {
+    frame_pool = frame->user_data;
+    n_pooled_frames--;
+  }
+  G_UNLOCK (frame_pool);
+
+  if (frame)
+    memset (frame, 0, sizeof (GstVideoCodecFrame));
+  else
+    frame = g_slice_new0 (GstVideoCodecFrame);
+
+  frame->ref_count = 1;
+
+  return frame;
+}
+
 static void
 _gst_video_codec_frame_free (GstVideoCodecFrame * frame)
 {
@@ -58,7 +91,17 @@ _gst_video_codec_frame_free (GstVideoCodecFrame * frame)
   if (frame->user_data_destroy_notify)
     frame->user_data_destroy_notify (frame->user_data);
 
-  g_slice_free (GstVideoCodecFrame, frame);
+  G_LOCK (frame_pool);
+  if (n_pooled_frames < MAX_POOLED_FRAMES) {
+    frame->user_data = frame_pool;
+    frame_pool = frame;
+    n_pooled_frames++;
+    frame = NULL;
+  }
+  G_UNLOCK (frame_pool);
+
+  if (frame)
+    g_slice_free (GstVideoCodecFrame, frame);
 }
 
 /**
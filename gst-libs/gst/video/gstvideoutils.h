@@ -263,6 +263,11 @@ struct _GstVideoCodecFrame
       GstClockTime ts;
       GstClockTime ts2;
       guint num_subframes;
+      /* GstVideoDecoder: order of the pending frames and links in the
+       * pending frames ordered by ts and ts2 */
+      guint32 pending_number;
+      GList *ts_link;
+      GList *ts2_link;
     } ABI;
     gpointer padding[GST_PADDING_LARGE];
   } abidata;
@@ -46,6 +46,9 @@ gboolean __gst_video_rawvideo_convert (GstVideoCodecState * state, GstFormat src
                                        gint64 src_value, GstFormat * dest_format,
                                        gint64 * dest_value);
 
+G_GNUC_INTERNAL
+GstVideoCodecFrame *__gst_video_codec_frame_new (void);
+
 G_END_DECLS
 
 #endif
@@ -22,20 +22,15 @@
 #include "config.h"
 #endif
 
-#if 0
-#ifdef HAVE_PTHREAD
-#define _GNU_SOURCE
-#include <pthread.h>
-#endif
-#endif
-
 #include "video-converter.h"
+#include "video-task-pool.h"
 
 #include <glib.h>
 #include <string.h>
 #include <math.h>
 
 #include "video-orc.h"
+#include "video-simd-private.h"
 
 /**
  * SECTION:videoconverter
@@ -115,197 +110,62 @@ ensure_debug_category (void)
 #define ensure_debug_category() /* NOOP */
 #endif /* GST_DISABLE_GST_DEBUG */
 
-typedef void (*GstParallelizedTaskFunc) (gpointer user_data);
+typedef GstVideoTaskFunc GstParallelizedTaskFunc;
 
 typedef struct _GstParallelizedTaskRunner GstParallelizedTaskRunner;
-typedef struct _GstParallelizedTaskThread GstParallelizedTaskThread;
-
-struct _GstParallelizedTaskThread
-{
-  GstParallelizedTaskRunner *runner;
-  guint idx;
-  GThread *thread;
-};
 
+/* Splits the work of one conversion into n_threads slices that are executed
+ * on a (usually shared) #GstVideoTaskPool. n_threads is the maximum
+ * concurrency of this converter, the threads themselves belong to the pool. */
 struct _GstParallelizedTaskRunner
 {
   guint n_threads;
 
-  GstParallelizedTaskThread *threads;
-
-  GstParallelizedTaskFunc func;
-  gpointer *task_data;
-
-  GMutex lock;
-  GCond cond_todo, cond_done;
-  gint n_todo, n_done;
-  gboolean quit;
+  GstVideoTaskPool *pool;
 };
 
-static gpointer
-gst_parallelized_task_thread_func (gpointer data)
-{
-  GstParallelizedTaskThread *self = data;
-
-#if 0
-#ifdef HAVE_PTHREAD
-  {
-    pthread_t thread = pthread_self ();
-    cpu_set_t cpuset;
-    int r;
-
-    CPU_ZERO (&cpuset);
-    CPU_SET (self->idx, &cpuset);
-    if ((r = pthread_setaffinity_np (thread, sizeof (cpuset), &cpuset)) != 0)
-      GST_ERROR ("Failed to set thread affinity for thread %d: %s", self->idx,
-          g_strerror (r));
-  }
-#endif
-#endif
-
-  g_mutex_lock (&self->runner->lock);
-  self->runner->n_done++;
-  if (self->runner->n_done == self->runner->n_threads - 1)
-    g_cond_signal (&self->runner->cond_done);
-
-  do {
-    gint idx;
-
-    while (self->runner->n_todo == -1 && !self->runner->quit)
-      g_cond_wait (&self->runner->cond_todo, &self->runner->lock);
-
-    if (self->runner->quit)
-      break;
-
-    idx = self->runner->n_todo--;
-    g_assert (self->runner->n_todo >= -1);
-    g_mutex_unlock (&self->runner->lock);
-
-    g_assert (self->runner->func != NULL);
-
-    self->runner->func (self->runner->task_data[idx]);
-
-    g_mutex_lock (&self->runner->lock);
-    self->runner->n_done++;
-    if (self->runner->n_done == self->runner->n_threads - 1)
-      g_cond_signal (&self->runner->cond_done);
-  } while (TRUE);
-
-  g_mutex_unlock (&self->runner->lock);
-
-  return NULL;
-}
-
 static void
 gst_parallelized_task_runner_free (GstParallelizedTaskRunner * self)
 {
-  guint i;
-
-  g_mutex_lock (&self->lock);
-  self->quit = TRUE;
-  g_cond_broadcast (&self->cond_todo);
-  g_mutex_unlock (&self->lock);
-
-  for (i = 1; i < self->n_threads; i++) {
-    if (!self->threads[i].thread)
-      continue;
-
-    g_thread_join (self->threads[i].thread);
-  }
-
-  g_mutex_clear (&self->lock);
-  g_cond_clear (&self->cond_todo);
-  g_cond_clear (&self->cond_done);
-  g_free (self->threads);
+  if (self->pool)
+    gst_video_task_pool_unref (self->pool);
   g_free (self);
 }
 
 static GstParallelizedTaskRunner *
-gst_parallelized_task_runner_new (guint n_threads)
+gst_parallelized_task_runner_new (guint n_threads, GstVideoTaskPool * pool)
 {
   GstParallelizedTaskRunner *self;
-  guint i;
-  GError *err = NULL;
 
   if (n_threads == 0)
     n_threads = g_get_num_processors ();
 
   self = g_new0 (GstParallelizedTaskRunner, 1);
   self->n_threads = n_threads;
-  self->threads = g_new0 (GstParallelizedTaskThread, n_threads);
-
-  self->quit = FALSE;
-  self->n_todo = -1;
-  self->n_done = 0;
-  g_mutex_init (&self->lock);
-  g_cond_init (&self->cond_todo);
-  g_cond_init (&self->cond_done);
 
-  /* Set when scheduling a job */
-  self->func = NULL;
-  self->task_data = NULL;
-
-  for (i = 0; i < n_threads; i++) {
-    self->threads[i].runner = self;
-    self->threads[i].idx = i;
-
-    /* First thread is the one calling run() */
-    if (i > 0) {
-      self->threads[i].thread =
-          g_thread_try_new ("videoconvert", gst_parallelized_task_thread_func,
-          &self->threads[i], &err);
-      if (!self->threads[i].thread)
-        goto error;
-    }
+  /* Only bother the pool when there is something to parallelize */
+  if (n_threads > 1) {
+    if (pool)
+      self->pool = gst_video_task_pool_ref (pool);
+    else
+      self->pool = gst_video_task_pool_get_shared ();
   }
 
-  g_mutex_lock (&self->lock);
-  while (self->n_done < self->n_threads - 1)
-    g_cond_wait (&self->cond_done, &self->lock);
-  self->n_done = 0;
-  g_mutex_unlock (&self->lock);
-
   return self;
-
-error:
-  {
-    GST_ERROR ("Failed to start thread %u: %s", i, err->message);
-    g_clear_error (&err);
-
-    gst_parallelized_task_runner_free (self);
-    return NULL;
-  }
 }
 
 static void
 gst_parallelized_task_runner_run (GstParallelizedTaskRunner * self,
     GstParallelizedTaskFunc func, gpointer * task_data)
 {
-  guint n_threads = self->n_threads;
-
-  self->func = func;
-  self->task_data = task_data;
-
-  if (n_threads > 1) {
-    g_mutex_lock (&self->lock);
-    self->n_todo = self->n_threads - 2;
-    self->n_done = 0;
-    g_cond_broadcast (&self->cond_todo);
-    g_mutex_unlock (&self->lock);
-  }
-
-  self->func (self->task_data[self->n_threads - 1]);
+  if (self->pool) {
+    gst_video_task_pool_run (self->pool, func, task_data, self->n_threads);
+  } else {
+    guint i;
 
-  if (n_threads > 1) {
-    g_mutex_lock (&self->lock);
-    while (self->n_done < self->n_threads - 1)
-      g_cond_wait (&self->cond_done, &self->lock);
-    self->n_done = 0;
-    g_mutex_unlock (&self->lock);
+    for (i = 0; i < self->n_threads; i++)
+      func (task_data[i]);
   }
-
-  self->func = NULL;
-  self->task_data = NULL;
 }
 
 typedef struct _GstLineCache GstLineCache;
@@ -332,6 +192,7 @@ struct _MatrixData
 };
 
 typedef struct _GammaData GammaData;
+typedef struct _ColorLut ColorLut;
 
 struct _GammaData
 {
@@ -390,6 +251,15 @@ struct _GstVideoConverter
   GstStructure *config;
 
   GstParallelizedTaskRunner *conversion_runner;
+  /* the pool passed at construction, for the rect converters */
+  GstVideoTaskPool *pool;
+  /* converters for the sizes used with gst_video_converter_frame_rect(),
+   * most recently used first */
+  GQueue rect_converters;
+  /* converter for the last rectangle of gst_video_converter_frame_crop() */
+  GstVideoConverter *crop_convert;
+  GstVideoRectangle crop_rect;
+  gint crop_frame_width, crop_frame_height;
 
   guint16 **tmpline;
 
@@ -419,6 +289,10 @@ struct _GstVideoConverter
   guint up_n_lines;
   gint up_offset;
 
+  /* complete color conversion with a 3D table */
+  GstLineCache **lut_lines;
+  ColorLut *color_lut;
+
   /* to R'G'B */
   GstLineCache **to_RGB_lines;
   MatrixData to_RGB_matrix;
@@ -659,6 +533,8 @@ static gboolean do_unpack_lines (GstLineCache * cache, gint idx, gint out_line,
     gint in_line, gpointer user_data);
 static gboolean do_downsample_lines (GstLineCache * cache, gint idx,
     gint out_line, gint in_line, gpointer user_data);
+static gboolean do_color_lut_lines (GstLineCache * cache, gint idx,
+    gint out_line, gint in_line, gpointer user_data);
 static gboolean do_convert_to_RGB_lines (GstLineCache * cache, gint idx,
     gint out_line, gint in_line, gpointer user_data);
 static gboolean do_convert_lines (GstLineCache * cache, gint idx, gint out_line,
@@ -807,6 +683,8 @@ get_opt_enum (GstVideoConverter * convert, const gchar * opt, GType type,
 #define DEFAULT_OPT_RESAMPLER_TAPS 0
 #define DEFAULT_OPT_DITHER_METHOD GST_VIDEO_DITHER_BAYER
 #define DEFAULT_OPT_DITHER_QUANTIZATION 1
+#define DEFAULT_OPT_COLOR_LUT FALSE
+#define DEFAULT_OPT_COLOR_LUT_MAX_ERROR 0.002
 
 #define GET_OPT_FILL_BORDER(c) get_opt_bool(c, \
     GST_VIDEO_CONVERTER_OPT_FILL_BORDER, DEFAULT_OPT_FILL_BORDER)
@@ -837,6 +715,10 @@ get_opt_enum (GstVideoConverter * convert, const gchar * opt, GType type,
     DEFAULT_OPT_DITHER_METHOD)
 #define GET_OPT_DITHER_QUANTIZATION(c) get_opt_uint(c, \
     GST_VIDEO_CONVERTER_OPT_DITHER_QUANTIZATION, DEFAULT_OPT_DITHER_QUANTIZATION)
+#define GET_OPT_COLOR_LUT(c) get_opt_bool(c, \
+    GST_VIDEO_CONVERTER_OPT_COLOR_LUT, DEFAULT_OPT_COLOR_LUT)
+#define GET_OPT_COLOR_LUT_MAX_ERROR(c) get_opt_double(c, \
+    GST_VIDEO_CONVERTER_OPT_COLOR_LUT_MAX_ERROR, DEFAULT_OPT_COLOR_LUT_MAX_ERROR)
 
 #define CHECK_ALPHA_COPY(c) (GET_OPT_ALPHA_MODE(c) == GST_VIDEO_ALPHA_MODE_COPY)
 #define CHECK_ALPHA_SET(c) (GET_OPT_ALPHA_MODE(c) == GST_VIDEO_ALPHA_MODE_SET)
@@ -1150,52 +1032,12 @@ videoconvert_convert_init_tables (MatrixData * data)
       + ((gint64) data->im[2][3] << 0);
 }
 
-void
-_custom_video_orc_matrix8 (guint8 * ORC_RESTRICT d1,
-    const guint8 * ORC_RESTRICT s1, orc_int64 p1, orc_int64 p2, orc_int64 p3,
-    orc_int64 p4, int n)
-{
-  gint i;
-  gint r, g, b;
-  gint y, u, v;
-  gint a00, a01, a02, a03;
-  gint a10, a11, a12, a13;
-  gint a20, a21, a22, a23;
-
-  a00 = (gint16) (p1 >> 16);
-  a01 = (gint16) (p2 >> 16);
-  a02 = (gint16) (p3 >> 16);
-  a03 = (gint16) (p4 >> 16);
-  a10 = (gint16) (p1 >> 32);
-  a11 = (gint16) (p2 >> 32);
-  a12 = (gint16) (p3 >> 32);
-  a13 = (gint16) (p4 >> 32);
-  a20 = (gint16) (p1 >> 48);
-  a21 = (gint16) (p2 >> 48);
-  a22 = (gint16) (p3 >> 48);
-  a23 = (gint16) (p4 >> 48);
-
-  for (i = 0; i < n; i++) {
-    r = s1[i * 4 + 1];
-    g = s1[i * 4 + 2];
-    b = s1[i * 4 + 3];
-
-    y = ((a00 * r + a01 * g + a02 * b) >> SCALE) + a03;
-    u = ((a10 * r + a11 * g + a12 * b) >> SCALE) + a13;
-    v = ((a20 * r + a21 * g + a22 * b) >> SCALE) + a23;
-
-    d1[i * 4 + 1] = CLAMP (y, 0, 255);
-    d1[i * 4 + 2] = CLAMP (u, 0, 255);
-    d1[i * 4 + 3] = CLAMP (v, 0, 255);
-  }
-}
-
 static void
 video_converter_matrix8 (MatrixData * data, gpointer pixels)
 {
   gpointer d = pixels;
-  video_orc_matrix8 (d, pixels, data->orc_p1, data->orc_p2,
-      data->orc_p3, data->orc_p4, data->width);
+  gst_video_simd_get_funcs ()->matrix8 (d, pixels, data->orc_p1,
+      data->orc_p2, data->orc_p3, data->orc_p4, data->width);
 }
 
 static void
@@ -1310,31 +1152,10 @@ is_no_clip_matrix (MatrixData * data)
 static void
 video_converter_matrix16 (MatrixData * data, gpointer pixels)
 {
-  int i;
-  int r, g, b;
-  int y, u, v;
-  guint16 *p = pixels;
-  gint width = data->width;
-
-  for (i = 0; i < width; i++) {
-    r = p[i * 4 + 1];
-    g = p[i * 4 + 2];
-    b = p[i * 4 + 3];
-
-    y = (data->im[0][0] * r + data->im[0][1] * g +
-        data->im[0][2] * b + data->im[0][3]) >> SCALE;
-    u = (data->im[1][0] * r + data->im[1][1] * g +
-        data->im[1][2] * b + data->im[1][3]) >> SCALE;
-    v = (data->im[2][0] * r + data->im[2][1] * g +
-        data->im[2][2] * b + data->im[2][3]) >> SCALE;
-
-    p[i * 4 + 1] = CLAMP (y, 0, 65535);
-    p[i * 4 + 2] = CLAMP (u, 0, 65535);
-    p[i * 4 + 3] = CLAMP (v, 0, 65535);
-  }
+  gst_video_simd_get_funcs ()->matrix16 (pixels, pixels, &data->im[0][0],
+      data->width);
 }
 
-
 static void
 prepare_matrix (GstVideoConverter * convert, MatrixData * data)
 {
@@ -1457,6 +1278,59 @@ compute_matrix_to_YUV (GstVideoConverter * convert, MatrixData * data,
 }
 
 
+/* add the conversion from the input to the output primaries in linear RGB
+ * to @data */
+static void
+compute_matrix_primaries (GstVideoConverter * convert, MatrixData * data)
+{
+  const GstVideoColorPrimariesInfo *pi;
+  MatrixData p1, p2;
+
+  /* Convert from RGB_input to RGB_output via XYZ
+   *    res = XYZ_to_RGB_output ( RGB_to_XYZ_input ( input ) )
+   * or in matricial form:
+   *    RGB_output = XYZ_to_RGB_output_matrix * RGB_TO_XYZ_input_matrix * RGB_input
+   *
+   * The RGB_input is the pre-existing convert_matrix
+   * The convert_matrix will become the RGB_output
+   */
+
+  /* Convert input RGB to XYZ */
+  pi = gst_video_color_primaries_get_info (convert->in_info.colorimetry.
+      primaries);
+  /* Get the RGB_TO_XYZ_input_matrix */
+  color_matrix_RGB_to_XYZ (&p1, pi->Rx, pi->Ry, pi->Gx, pi->Gy, pi->Bx,
+      pi->By, pi->Wx, pi->Wy);
+  GST_DEBUG ("to XYZ matrix");
+  color_matrix_debug (&p1);
+  GST_DEBUG ("current matrix");
+  /* convert_matrix = RGB_TO_XYZ_input_matrix * input_RGB */
+  color_matrix_multiply (data, data, &p1);
+  color_matrix_debug (data);
+
+  /* Convert XYZ to output RGB */
+  pi = gst_video_color_primaries_get_info (convert->out_info.colorimetry.
+      primaries);
+  /* Calculate the XYZ_to_RGB_output_matrix
+   *  * Get the RGB_TO_XYZ_output_matrix
+   *  * invert it
+   *  * store in p2
+   */
+  color_matrix_RGB_to_XYZ (&p2, pi->Rx, pi->Ry, pi->Gx, pi->Gy, pi->Bx,
+      pi->By, pi->Wx, pi->Wy);
+  color_matrix_invert (&p2, &p2);
+  GST_DEBUG ("to RGB matrix");
+  color_matrix_debug (&p2);
+  /* Finally:
+   * convert_matrix = XYZ_to_RGB_output_matrix * RGB_TO_XYZ_input_matrix * RGB_input
+   *                = XYZ_to_RGB_output_matrix * convert_matrix
+   *                = p2 * convert_matrix
+   */
+  color_matrix_multiply (data, &p2, data);
+  GST_DEBUG ("current matrix");
+  color_matrix_debug (data);
+}
+
 static void
 gamma_convert_u8_u16 (GammaData * data, gpointer dest, gpointer src)
 {
@@ -1574,12 +1448,355 @@ setup_gamma_encode (GstVideoConverter * convert, gint target_bits)
   }
 }
 
+/* With gamma remapping every pixel is converted to linear RGB, converted
+ * between primaries and converted back to the output transfer function and
+ * matrix. Without scaling in between, this is a function of the 3 color
+ * components only and can be replaced by a 3D table with tetrahedral
+ * interpolation. Tables are expensive to make so they are shared between
+ * converters with the same parameters, some unused ones are kept around for
+ * renegotiation. */
+#define MAX_UNUSED_LUTS 8
+/* the sizes we try are 17, 33 and 65 points per axis */
+#define COLOR_LUT_MIN_BITS 4
+#define COLOR_LUT_MAX_BITS 6
+/* number of pixels converted at once */
+#define COLOR_LUT_CHUNK 256
+
+typedef struct
+{
+  GstVideoFormat unpack_format;
+  GstVideoFormat pack_format;
+  GstVideoColorimetry in_colorimetry;
+  GstVideoColorimetry out_colorimetry;
+  GstVideoMatrixMode matrix_mode;
+  GstVideoPrimariesMode primaries_mode;
+  gdouble max_error;
+} ColorLutKey;
+
+struct _ColorLut
+{
+  ColorLutKey key;
+  gint refcount;
+
+  /* NULL when no table is accurate enough */
+  guint16 *table;
+  gint bits;
+};
+
+/* the exact conversion as done without table */
+typedef struct
+{
+  MatrixData to_RGB;
+  MatrixData primaries;
+  MatrixData to_YUV;
+  GstVideoTransferFunction in_func;
+  GstVideoTransferFunction out_func;
+  gdouble in_max;
+  gdouble out_max;
+  gint out_bits;
+} ColorTransform;
+
+G_LOCK_DEFINE_STATIC (luts_lock);
+static GHashTable *luts_cache;
+static GQueue luts_unused = G_QUEUE_INIT;
+
+static guint
+color_lut_key_hash (gconstpointer data)
+{
+  const ColorLutKey *key = data;
+
+  return (key->unpack_format * 31 + key->pack_format) * 31 +
+      (key->in_colorimetry.transfer << 24) +
+      (key->in_colorimetry.primaries << 16) +
+      (key->out_colorimetry.transfer << 8) + key->out_colorimetry.primaries;
+}
+
+static gboolean
+color_lut_key_equal (gconstpointer a, gconstpointer b)
+{
+  const ColorLutKey *ka = a, *kb = b;
+
+  return ka->unpack_format == kb->unpack_format &&
+      ka->pack_format == kb->pack_format &&
+      gst_video_colorimetry_is_equal (&ka->in_colorimetry,
+      &kb->in_colorimetry) &&
+      gst_video_colorimetry_is_equal (&ka->out_colorimetry,
+      &kb->out_colorimetry) && ka->matrix_mode == kb->matrix_mode &&
+      ka->primaries_mode == kb->primaries_mode &&
+      ka->max_error == kb->max_error;
+}
+
+static void
+color_lut_free (ColorLut * lut)
+{
+  g_free (lut->table);
+  g_slice_free (ColorLut, lut);
+}
+
+static gdouble
+color_transform_apply (const MatrixData * m, const gdouble v[3], gint i)
+{
+  return m->dm[i][0] * v[0] + m->dm[i][1] * v[1] + m->dm[i][2] * v[2] +
+      m->dm[i][3];
+}
+
+static void
+color_transform_init (GstVideoConverter * convert, ColorTransform * t)
+{
+  color_matrix_set_identity (&t->to_RGB);
+  compute_matrix_to_RGB (convert, &t->to_RGB);
+  color_matrix_set_identity (&t->primaries);
+  if (!CHECK_PRIMARIES_NONE (convert) &&
+      convert->in_info.colorimetry.primaries !=
+      convert->out_info.colorimetry.primaries)
+    compute_matrix_primaries (convert, &t->primaries);
+  color_matrix_set_identity (&t->to_YUV);
+  compute_matrix_to_YUV (convert, &t->to_YUV, FALSE);
+
+  t->in_func = convert->in_info.colorimetry.transfer;
+  t->out_func = convert->out_info.colorimetry.transfer;
+  t->in_max = (1 << convert->unpack_bits) - 1;
+  t->out_bits = convert->pack_bits;
+  t->out_max = (1 << convert->pack_bits) - 1;
+}
+
+/* convert the 3 components in 0..1 to the 16 bit values of the table. The
+ * output of 8 bit formats is stored in the high byte with a bias so that the
+ * 16 to 8 bit conversion after the table rounds. */
+static void
+color_transform_convert (const ColorTransform * t, const gdouble in[3],
+    gdouble out[3])
+{
+  gdouble v[3], r[3];
+  gint i;
+
+  for (i = 0; i < 3; i++)
+    v[i] = in[i] * t->in_max;
+  for (i = 0; i < 3; i++)
+    r[i] = gst_video_color_transfer_decode (t->in_func,
+        CLAMP (color_transform_apply (&t->to_RGB, v, i), 0.0, 1.0));
+  for (i = 0; i < 3; i++)
+    v[i] = gst_video_color_transfer_encode (t->out_func,
+        CLAMP (color_transform_apply (&t->primaries, r, i), 0.0, 1.0));
+  for (i = 0; i < 3; i++) {
+    out[i] = CLAMP (color_transform_apply (&t->to_YUV, v, i), 0.0, t->out_max);
+    if (t->out_bits == 8)
+      out[i] = out[i] * 256.0 + 128.0;
+  }
+}
+
+/* the largest difference between the table and the exact conversion in the
+ * middle of the cells, as a fraction of the output range */
+static gdouble
+color_lut_measure_error (const ColorTransform * t, const guint16 * table,
+    gint bits)
+{
+  const GstVideoSimdFuncs *funcs = gst_video_simd_get_funcs ();
+  gint a, b, c, cells = 1 << bits;
+  guint16 *in, *out;
+  gdouble max_error = 0.0;
+
+  in = g_new (guint16, cells * 4);
+  out = g_new (guint16, cells * 4);
+
+  for (a = 0; a < cells; a++) {
+    for (b = 0; b < cells; b++) {
+      for (c = 0; c < cells; c++) {
+        in[c * 4 + 0] = 0xffff;
+        in[c * 4 + 1] = rint ((a + 0.5) * 65535.0 / cells);
+        in[c * 4 + 2] = rint ((b + 0.5) * 65535.0 / cells);
+        in[c * 4 + 3] = rint ((c + 0.5) * 65535.0 / cells);
+      }
+      funcs->lut3d (out, in, table, bits, cells);
+
+      for (c = 0; c < cells; c++) {
+        gdouble v[3], exact[3];
+        gint i;
+
+        for (i = 0; i < 3; i++)
+          v[i] = in[c * 4 + i + 1] / 65535.0;
+        color_transform_convert (t, v, exact);
+        for (i = 0; i < 3; i++)
+          max_error = MAX (max_error, fabs (out[c * 4 + i + 1] - exact[i]));
+      }
+    }
+  }
+  g_free (in);
+  g_free (out);
+
+  return max_error / 65535.0;
+}
+
+/* make the smallest table that is within the maximum error */
+static void
+color_lut_make_table (GstVideoConverter * convert, ColorLut * lut)
+{
+  ColorTransform t;
+  gint bits;
+
+  color_transform_init (convert, &t);
+
+  for (bits = COLOR_LUT_MIN_BITS; bits <= COLOR_LUT_MAX_BITS; bits++) {
+    gint a, b, c, size = (1 << bits) + 1;
+    guint16 *table, *p;
+    gdouble error;
+
+    p = table = g_new (guint16, size * size * size * 4);
+    for (a = 0; a < size; a++) {
+      for (b = 0; b < size; b++) {
+        for (c = 0; c < size; c++) {
+          gdouble v[3], out[3];
+
+          v[0] = a / (gdouble) (size - 1);
+          v[1] = b / (gdouble) (size - 1);
+          v[2] = c / (gdouble) (size - 1);
+          color_transform_convert (&t, v, out);
+
+          p[0] = CLAMP (rint (out[0]), 0, 65535);
+          p[1] = CLAMP (rint (out[1]), 0, 65535);
+          p[2] = CLAMP (rint (out[2]), 0, 65535);
+          p[3] = 0;
+          p += 4;
+        }
+      }
+    }
+
+    error = color_lut_measure_error (&t, table, bits);
+    GST_DEBUG ("color lut with %d points, error %f", size, error);
+    if (error <= lut->key.max_error) {
+      lut->table = table;
+      lut->bits = bits;
+      return;
+    }
+    g_free (table);
+  }
+  GST_INFO ("no color lut within error %f", lut->key.max_error);
+}
+
+/* Get the table for the conversion from the cache, making it when it is not
+ * there yet. */
+static ColorLut *
+color_lut_get (GstVideoConverter * convert)
+{
+  ColorLutKey key;
+  ColorLut *lut, *other;
+
+  memset (&key, 0, sizeof (ColorLutKey));
+  key.unpack_format = convert->unpack_format;
+  key.pack_format = convert->pack_format;
+  key.in_colorimetry = convert->in_info.colorimetry;
+  key.out_colorimetry = convert->out_info.colorimetry;
+  key.matrix_mode = GET_OPT_MATRIX_MODE (convert);
+  key.primaries_mode = GET_OPT_PRIMARIES_MODE (convert);
+  key.max_error = GET_OPT_COLOR_LUT_MAX_ERROR (convert);
+
+  G_LOCK (luts_lock);
+  if (luts_cache == NULL)
+    luts_cache = g_hash_table_new (color_lut_key_hash, color_lut_key_equal);
+
+  lut = g_hash_table_lookup (luts_cache, &key);
+  if (lut) {
+    if (lut->refcount++ == 0)
+      g_queue_remove (&luts_unused, lut);
+    G_UNLOCK (luts_lock);
+
+    GST_DEBUG ("reusing color lut %p", lut);
+    return lut;
+  }
+  G_UNLOCK (luts_lock);
+
+  /* make the table without the lock, another thread might make the same
+   * table at the same time, we keep the first one */
+  lut = g_slice_new0 (ColorLut);
+  lut->key = key;
+  lut->refcount = 1;
+  color_lut_make_table (convert, lut);
+
+  G_LOCK (luts_lock);
+  other = g_hash_table_lookup (luts_cache, &key);
+  if (other) {
+    if (other->refcount++ == 0)
+      g_queue_remove (&luts_unused, other);
+    G_UNLOCK (luts_lock);
+    color_lut_free (lut);
+    return other;
+  }
+  g_hash_table_insert (luts_cache, &lut->key, lut);
+  G_UNLOCK (luts_lock);
+
+  GST_DEBUG ("made color lut %p", lut);
+
+  return lut;
+}
+
+static void
+color_lut_unref (ColorLut * lut)
+{
+  ColorLut *old = NULL;
+
+  G_LOCK (luts_lock);
+  if (--lut->refcount == 0) {
+    g_queue_push_head (&luts_unused, lut);
+    if (luts_unused.length > MAX_UNUSED_LUTS) {
+      old = g_queue_pop_tail (&luts_unused);
+      g_hash_table_remove (luts_cache, &old->key);
+    }
+  }
+  G_UNLOCK (luts_lock);
+
+  if (old)
+    color_lut_free (old);
+}
+
+static GstLineCache *
+chain_color_lut (GstVideoConverter * convert, GstLineCache * prev, gint idx)
+{
+  if (!CHECK_GAMMA_REMAP (convert) || !GET_OPT_COLOR_LUT (convert))
+    return prev;
+
+  /* scaling is done in linear RGB, between the steps the table replaces */
+  if (convert->in_width != convert->out_width ||
+      convert->in_height != convert->out_height)
+    return prev;
+
+  /* Set up the table, but only for the first thread */
+  if (idx == 0) {
+    convert->color_lut = color_lut_get (convert);
+    if (convert->color_lut->table == NULL) {
+      color_lut_unref (convert->color_lut);
+      convert->color_lut = NULL;
+    }
+  }
+  if (convert->color_lut == NULL)
+    return prev;
+
+  GST_DEBUG ("chain color lut, %d points", (1 << convert->color_lut->bits) + 1);
+
+  convert->current_bits = convert->pack_bits;
+  convert->current_format = convert->pack_format;
+  convert->current_pstride = convert->current_bits >> 1;
+
+  prev = convert->lut_lines[idx] = gst_line_cache_new (prev);
+  prev->write_input = TRUE;
+  prev->pass_alloc = convert->unpack_bits == convert->pack_bits;
+  prev->n_lines = 1;
+  prev->stride = convert->current_pstride * convert->current_width;
+  gst_line_cache_set_need_line_func (prev,
+      do_color_lut_lines, idx, convert, NULL);
+
+  return prev;
+}
+
 static GstLineCache *
 chain_convert_to_RGB (GstVideoConverter * convert, GstLineCache * prev,
     gint idx)
 {
   gboolean do_gamma;
 
+  /* done by the color lut */
+  if (convert->color_lut)
+    return prev;
+
   do_gamma = CHECK_GAMMA_REMAP (convert);
 
   if (do_gamma) {
@@ -1730,7 +1947,10 @@ chain_convert (GstVideoConverter * convert, GstLineCache * prev, gint idx)
 {
   gboolean do_gamma, do_conversion, pass_alloc = FALSE;
   gboolean same_matrix, same_primaries, same_bits;
-  MatrixData p1, p2;
+
+  /* done by the color lut */
+  if (convert->color_lut)
+    return prev;
 
   same_bits = convert->unpack_bits == convert->pack_bits;
   if (CHECK_MATRIX_NONE (convert)) {
@@ -1758,55 +1978,8 @@ chain_convert (GstVideoConverter * convert, GstLineCache * prev, gint idx)
 
   color_matrix_set_identity (&convert->convert_matrix);
 
-  if (!same_primaries) {
-    const GstVideoColorPrimariesInfo *pi;
-
-    /* Convert from RGB_input to RGB_output via XYZ
-     *    res = XYZ_to_RGB_output ( RGB_to_XYZ_input ( input ) )
-     * or in matricial form:
-     *    RGB_output = XYZ_to_RGB_output_matrix * RGB_TO_XYZ_input_matrix * RGB_input
-     *
-     * The RGB_input is the pre-existing convert_matrix
-     * The convert_matrix will become the RGB_output
-     */
-
-    /* Convert input RGB to XYZ */
-    pi = gst_video_color_primaries_get_info (convert->in_info.colorimetry.
-        primaries);
-    /* Get the RGB_TO_XYZ_input_matrix */
-    color_matrix_RGB_to_XYZ (&p1, pi->Rx, pi->Ry, pi->Gx, pi->Gy, pi->Bx,
-        pi->By, pi->Wx, pi->Wy);
-    GST_DEBUG ("to XYZ matrix");
-    color_matrix_debug (&p1);
-    GST_DEBUG ("current matrix");
-    /* convert_matrix = RGB_TO_XYZ_input_matrix * input_RGB */
-    color_matrix_multiply (&convert->convert_matrix, &convert->convert_matrix,
-        &p1);
-    color_matrix_debug (&convert->convert_matrix);
-
-    /* Convert XYZ to output RGB */
-    pi = gst_video_color_primaries_get_info (convert->out_info.colorimetry.
-        primaries);
-    /* Calculate the XYZ_to_RGB_output_matrix
-     *  * Get the RGB_TO_XYZ_output_matrix
-     *  * invert it
-     *  * store in p2
-     */
-    color_matrix_RGB_to_XYZ (&p2, pi->Rx, pi->Ry, pi->Gx, pi->Gy, pi->Bx,
-        pi->By, pi->Wx, pi->Wy);
-    color_matrix_invert (&p2, &p2);
-    GST_DEBUG ("to RGB matrix");
-    color_matrix_debug (&p2);
-    /* Finally:
-     * convert_matrix = XYZ_to_RGB_output_matrix * RGB_TO_XYZ_input_matrix * RGB_input
-     *                = XYZ_to_RGB_output_matrix * convert_matrix
-     *                = p2 * convert_matrix
-     */
-    color_matrix_multiply (&convert->convert_matrix, &p2,
-        &convert->convert_matrix);
-    GST_DEBUG ("current matrix");
-    color_matrix_debug (&convert->convert_matrix);
-  }
+  if (!same_primaries)
+    compute_matrix_primaries (convert, &convert->convert_matrix);
 
   do_gamma = CHECK_GAMMA_REMAP (convert);
   if (!do_gamma) {
@@ -1967,6 +2140,10 @@ chain_convert_to_YUV (GstVideoConverter * convert, GstLineCache * prev,
 {
   gboolean do_gamma;
 
+  /* done by the color lut */
+  if (convert->color_lut)
+    return prev;
+
   do_gamma = CHECK_GAMMA_REMAP (convert);
 
   if (do_gamma) {
@@ -2298,6 +2475,32 @@ convert_get_alpha_mode (GstVideoConverter * convert)
 GstVideoConverter *
 gst_video_converter_new (GstVideoInfo * in_info, GstVideoInfo * out_info,
     GstStructure * config)
+{
+  return gst_video_converter_new_with_pool (in_info, out_info, config, NULL);
+}
+
+/**
+ * gst_video_converter_new_with_pool: (skip)
+ * @in_info: a #GstVideoInfo
+ * @out_info: a #GstVideoInfo
+ * @config: (transfer full): a #GstStructure with configuration options
+ * @pool: (allow-none): a #GstVideoTaskPool to run the conversion on
+ *
+ * Create a new converter object to convert between @in_info and @out_info
+ * with @config.
+ *
+ * When #GST_VIDEO_CONVERTER_OPT_THREADS is bigger than 1, the slices of each
+ * conversion are executed on @pool, or on the process-wide pool returned by
+ * gst_video_task_pool_get_shared() if @pool is %NULL. No threads are created
+ * by the converter itself.
+ *
+ * Returns: a #GstVideoConverter or %NULL if conversion is not possible.
+ *
+ * Since: 1.20
+ */
+GstVideoConverter *
+gst_video_converter_new_with_pool (GstVideoInfo * in_info,
+    GstVideoInfo * out_info, GstStructure * config, GstVideoTaskPool * pool)
 {
   GstVideoConverter *convert;
   GstLineCache *prev;
@@ -2433,7 +2636,10 @@ gst_video_converter_new (GstVideoInfo * in_info, GstVideoInfo * out_info,
   if (n_threads < 1)
     n_threads = 1;
 
-  convert->conversion_runner = gst_parallelized_task_runner_new (n_threads);
+  if (pool)
+    convert->pool = gst_video_task_pool_ref (pool);
+  convert->conversion_runner =
+      gst_parallelized_task_runner_new (n_threads, pool);
 
   if (video_converter_lookup_fastpath (convert))
     goto done;
@@ -2456,6 +2662,7 @@ gst_video_converter_new (GstVideoInfo * in_info, GstVideoInfo * out_info,
   convert->unpack_lines = g_new0 (GstLineCache *, n_threads);
   convert->pack_lines = g_new0 (GstLineCache *, n_threads);
   convert->upsample_lines = g_new0 (GstLineCache *, n_threads);
+  convert->lut_lines = g_new0 (GstLineCache *, n_threads);
   convert->to_RGB_lines = g_new0 (GstLineCache *, n_threads);
   convert->hscale_lines = g_new0 (GstLineCache *, n_threads);
   convert->vscale_lines = g_new0 (GstLineCache *, n_threads);
@@ -2477,6 +2684,8 @@ gst_video_converter_new (GstVideoInfo * in_info, GstVideoInfo * out_info,
       prev = chain_unpack_line (convert, i);
       /* upsample chroma */
       prev = chain_upsample (convert, prev, i);
+      /* do the complete color conversion with a table */
+      prev = chain_color_lut (convert, prev, i);
       /* convert to gamma decoded RGB */
       prev = chain_convert_to_RGB (convert, prev, i);
       /* do all downscaling */
@@ -2530,6 +2739,20 @@ clear_matrix_data (MatrixData * data)
   g_free (data->t_b);
 }
 
+static void
+clear_rect_converters (GstVideoConverter * convert)
+{
+  GstVideoConverter *rconvert;
+
+  while ((rconvert = g_queue_pop_head (&convert->rect_converters)))
+    gst_video_converter_free (rconvert);
+
+  if (convert->crop_convert) {
+    gst_video_converter_free (convert->crop_convert);
+    convert->crop_convert = NULL;
+  }
+}
+
 /**
  * gst_video_converter_free:
  * @convert: a #GstVideoConverter
@@ -2564,6 +2787,8 @@ gst_video_converter_free (GstVideoConverter * convert)
       gst_line_cache_free (convert->unpack_lines[i]);
     if (convert->upsample_lines && convert->upsample_lines[i])
       gst_line_cache_free (convert->upsample_lines[i]);
+    if (convert->lut_lines && convert->lut_lines[i])
+      gst_line_cache_free (convert->lut_lines[i]);
     if (convert->to_RGB_lines && convert->to_RGB_lines[i])
       gst_line_cache_free (convert->to_RGB_lines[i]);
     if (convert->hscale_lines && convert->hscale_lines[i])
@@ -2593,6 +2818,7 @@ gst_video_converter_free (GstVideoConverter * convert)
   g_free (convert->unpack_lines);
   g_free (convert->pack_lines);
   g_free (convert->upsample_lines);
+  g_free (convert->lut_lines);
   g_free (convert->to_RGB_lines);
   g_free (convert->hscale_lines);
   g_free (convert->vscale_lines);
@@ -2605,6 +2831,8 @@ gst_video_converter_free (GstVideoConverter * convert)
 
   g_free (convert->gamma_dec.gamma_table);
   g_free (convert->gamma_enc.gamma_table);
+  if (convert->color_lut)
+    color_lut_unref (convert->color_lut);
 
   if (convert->tmpline) {
     for (i = 0; i < convert->conversion_runner->n_threads; i++)
@@ -2630,6 +2858,9 @@ gst_video_converter_free (GstVideoConverter * convert)
 
   if (convert->conversion_runner)
     gst_parallelized_task_runner_free (convert->conversion_runner);
+  if (convert->pool)
+    gst_video_task_pool_unref (convert->pool);
+  clear_rect_converters (convert);
 
   clear_matrix_data (&convert->to_RGB_matrix);
   clear_matrix_data (&convert->convert_matrix);
@@ -2676,6 +2907,10 @@ gst_video_converter_set_config (GstVideoConverter * convert,
   gst_structure_foreach (config, copy_config, convert);
   gst_structure_free (config);
 
+  /* the rect and crop converters are made again with the new config when
+   * needed */
+  clear_rect_converters (convert);
+
   return TRUE;
 }
 
@@ -2742,6 +2977,328 @@ gst_video_converter_frame (GstVideoConverter * convert,
   convert->convert (convert, src, dest);
 }
 
+/* Make @view a frame with the pixels of @frame in the given rectangle. The
+ * position is rounded down to the chroma subsampling. Returns FALSE when the
+ * pixels of the format can't be addressed independently. */
+static gboolean
+video_frame_view (const GstVideoFrame * frame, gint x, gint y, gint width,
+    gint height, GstVideoFrame * view)
+{
+  const GstVideoFormatInfo *finfo = frame->info.finfo;
+  gint i, comp[GST_VIDEO_MAX_COMPONENTS];
+  gint x_sub = 0, y_sub = 0;
+
+  if (GST_VIDEO_FORMAT_INFO_IS_COMPLEX (finfo) ||
+      GST_VIDEO_FORMAT_INFO_IS_TILED (finfo))
+    return FALSE;
+
+  for (i = 0; i < GST_VIDEO_FORMAT_INFO_N_COMPONENTS (finfo); i++) {
+    if (GST_VIDEO_FORMAT_INFO_PSTRIDE (finfo, i) == 0)
+      return FALSE;
+    x_sub = MAX (x_sub, GST_VIDEO_FORMAT_INFO_W_SUB (finfo, i));
+    y_sub = MAX (y_sub, GST_VIDEO_FORMAT_INFO_H_SUB (finfo, i));
+  }
+  /* the lines of the fields of interlaced frames alternate, a chroma line
+   * of a field is shared by two lines of the same field */
+  if (GST_VIDEO_FRAME_IS_INTERLACED (frame) &&
+      GST_VIDEO_INFO_INTERLACE_MODE (&frame->info) !=
+      GST_VIDEO_INTERLACE_MODE_ALTERNATE)
+    y_sub++;
+  x &= ~((1 << x_sub) - 1);
+  y &= ~((1 << y_sub) - 1);
+
+  *view = *frame;
+  GST_VIDEO_INFO_WIDTH (&view->info) = width;
+  GST_VIDEO_INFO_HEIGHT (&view->info) = height;
+
+  for (i = 0; i < GST_VIDEO_FRAME_N_PLANES (frame); i++) {
+    gint c;
+
+    gst_video_format_info_component (finfo, i, comp);
+    /* the palette */
+    if ((c = comp[0]) < 0)
+      continue;
+
+    view->data[i] = (guint8 *) frame->data[i] +
+        GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (finfo, c, y) *
+        GST_VIDEO_FRAME_PLANE_STRIDE (frame, i) +
+        GST_VIDEO_FORMAT_INFO_SCALE_WIDTH (finfo, c, x) *
+        GST_VIDEO_FORMAT_INFO_PSTRIDE (finfo, c);
+  }
+  return TRUE;
+}
+
+/* The geometry of a converter is fixed, for each pair of rectangle sizes we
+ * keep a converter that works on views of the frames. The position of the
+ * rectangles only moves the views, so the converter of the size is used
+ * as-is. Only the most recently used ones are kept. */
+#define MAX_RECT_CONVERTERS 4
+
+static GstVideoConverter *
+get_rect_converter (GstVideoConverter * convert, gint src_width,
+    gint src_height, gint dest_width, gint dest_height)
+{
+  GstVideoConverter *rconvert;
+  GstVideoInfo in_info, out_info;
+  GstStructure *config;
+  GList *l;
+
+  for (l = convert->rect_converters.head; l; l = l->next) {
+    rconvert = l->data;
+
+    if (GST_VIDEO_INFO_WIDTH (&rconvert->in_info) == src_width &&
+        GST_VIDEO_INFO_HEIGHT (&rconvert->in_info) == src_height &&
+        GST_VIDEO_INFO_WIDTH (&rconvert->out_info) == dest_width &&
+        GST_VIDEO_INFO_HEIGHT (&rconvert->out_info) == dest_height) {
+      /* move to the front */
+      if (l != convert->rect_converters.head) {
+        g_queue_unlink (&convert->rect_converters, l);
+        g_queue_push_head_link (&convert->rect_converters, l);
+      }
+      return rconvert;
+    }
+  }
+
+  GST_DEBUG ("new converter for %dx%d -> %dx%d", src_width, src_height,
+      dest_width, dest_height);
+
+  in_info = convert->in_info;
+  GST_VIDEO_INFO_WIDTH (&in_info) = src_width;
+  GST_VIDEO_INFO_HEIGHT (&in_info) = src_height;
+  out_info = convert->out_info;
+  GST_VIDEO_INFO_WIDTH (&out_info) = dest_width;
+  GST_VIDEO_INFO_HEIGHT (&out_info) = dest_height;
+
+  /* the views are converted completely */
+  config = gst_structure_copy (convert->config);
+  gst_structure_remove_fields (config, GST_VIDEO_CONVERTER_OPT_SRC_X,
+      GST_VIDEO_CONVERTER_OPT_SRC_Y, GST_VIDEO_CONVERTER_OPT_SRC_WIDTH,
+      GST_VIDEO_CONVERTER_OPT_SRC_HEIGHT, GST_VIDEO_CONVERTER_OPT_DEST_X,
+      GST_VIDEO_CONVERTER_OPT_DEST_Y, GST_VIDEO_CONVERTER_OPT_DEST_WIDTH,
+      GST_VIDEO_CONVERTER_OPT_DEST_HEIGHT, NULL);
+
+  rconvert = gst_video_converter_new_with_pool (&in_info, &out_info, config,
+      convert->pool);
+  if (rconvert == NULL)
+    return NULL;
+
+  g_queue_push_head (&convert->rect_converters, rconvert);
+  if (convert->rect_converters.length > MAX_RECT_CONVERTERS)
+    gst_video_converter_free (g_queue_pop_tail (&convert->rect_converters));
+
+  return rconvert;
+}
+
+/**
+ * gst_video_converter_frame_rect:
+ * @convert: a #GstVideoConverter
+ * @src: a #GstVideoFrame
+ * @src_x: source x position
+ * @src_y: source y position
+ * @src_width: source width
+ * @src_height: source height
+ * @dest: a #GstVideoFrame
+ * @dest_x: destination x position
+ * @dest_y: destination y position
+ * @dest_width: destination width
+ * @dest_height: destination height
+ *
+ * Convert the pixels in the given rectangle of @src into the given rectangle
+ * of @dest using @convert. The pixels of @dest outside of the rectangle are
+ * not modified. The positions are rounded down to the chroma subsampling of
+ * the formats, for interlaced frames to twice the vertical subsampling so
+ * that the fields stay apart.
+ *
+ * The rectangles can change on every call. The converters for recently used
+ * rectangle sizes are kept, so that only a change of the size requires
+ * setting up the conversion again. The #GST_VIDEO_CONVERTER_OPT_SRC_X,
+ * #GST_VIDEO_CONVERTER_OPT_DEST_X and related options of @convert are
+ * ignored.
+ *
+ * Returns: %FALSE when the rectangles can not be converted, for example
+ * because a format does not allow addressing its pixels independently.
+ *
+ * Since: 1.20
+ */
+gboolean
+gst_video_converter_frame_rect (GstVideoConverter * convert,
+    const GstVideoFrame * src, gint src_x, gint src_y, gint src_width,
+    gint src_height, GstVideoFrame * dest, gint dest_x, gint dest_y,
+    gint dest_width, gint dest_height)
+{
+  GstVideoConverter *rconvert;
+  GstVideoFrame src_view, dest_view;
+
+  g_return_val_if_fail (convert != NULL, FALSE);
+  g_return_val_if_fail (src != NULL, FALSE);
+  g_return_val_if_fail (dest != NULL, FALSE);
+  g_return_val_if_fail (src_x >= 0 && src_y >= 0, FALSE);
+  g_return_val_if_fail (src_x + src_width <= GST_VIDEO_FRAME_WIDTH (src),
+      FALSE);
+  g_return_val_if_fail (src_y + src_height <= GST_VIDEO_FRAME_HEIGHT (src),
+      FALSE);
+  g_return_val_if_fail (dest_x >= 0 && dest_y >= 0, FALSE);
+  g_return_val_if_fail (dest_x + dest_width <= GST_VIDEO_FRAME_WIDTH (dest),
+      FALSE);
+  g_return_val_if_fail (dest_y + dest_height <= GST_VIDEO_FRAME_HEIGHT (dest),
+      FALSE);
+
+  if (G_UNLIKELY (GST_VIDEO_INFO_FORMAT (&convert->in_info) !=
+          GST_VIDEO_FRAME_FORMAT (src))) {
+    g_critical ("Input video frame does not match configuration");
+    return FALSE;
+  }
+  if (G_UNLIKELY (GST_VIDEO_INFO_FORMAT (&convert->out_info) !=
+          GST_VIDEO_FRAME_FORMAT (dest))) {
+    g_critical ("Output video frame does not match configuration");
+    return FALSE;
+  }
+
+  if (src_width <= 0 || src_height <= 0 || dest_width <= 0 || dest_height <= 0)
+    return TRUE;
+
+  if (!video_frame_view (src, src_x, src_y, src_width, src_height, &src_view))
+    goto no_view;
+  if (!video_frame_view (dest, dest_x, dest_y, dest_width, dest_height,
+          &dest_view))
+    goto no_view;
+
+  rconvert = get_rect_converter (convert, src_width, src_height, dest_width,
+      dest_height);
+  if (rconvert == NULL)
+    return FALSE;
+
+  gst_video_converter_frame (rconvert, &src_view, &dest_view);
+
+  return TRUE;
+
+  /* ERRORS */
+no_view:
+  {
+    GST_WARNING ("can't address rectangles in %s -> %s",
+        GST_VIDEO_INFO_NAME (&convert->in_info),
+        GST_VIDEO_INFO_NAME (&convert->out_info));
+    return FALSE;
+  }
+}
+
+/* The converter for a crop rectangle has all the options of @convert but
+ * the source rectangle, and the size of the cropped frames as input size.
+ * It is kept until the rectangle or the size of the frames changes. */
+static GstVideoConverter *
+get_crop_converter (GstVideoConverter * convert, gint frame_width,
+    gint frame_height, gint x, gint y, gint width, gint height)
+{
+  GstVideoInfo in_info;
+  GstStructure *config;
+
+  if (convert->crop_convert && convert->crop_rect.x == x &&
+      convert->crop_rect.y == y && convert->crop_rect.w == width &&
+      convert->crop_rect.h == height &&
+      convert->crop_frame_width == frame_width &&
+      convert->crop_frame_height == frame_height)
+    return convert->crop_convert;
+
+  if (convert->crop_convert) {
+    gst_video_converter_free (convert->crop_convert);
+    convert->crop_convert = NULL;
+  }
+
+  GST_DEBUG ("new converter for crop %d,%d %dx%d of %dx%d", x, y, width,
+      height, frame_width, frame_height);
+
+  in_info = convert->in_info;
+  GST_VIDEO_INFO_WIDTH (&in_info) = frame_width;
+  GST_VIDEO_INFO_HEIGHT (&in_info) = frame_height;
+
+  config = gst_structure_copy (convert->config);
+  gst_structure_set (config,
+      GST_VIDEO_CONVERTER_OPT_SRC_X, G_TYPE_INT, x,
+      GST_VIDEO_CONVERTER_OPT_SRC_Y, G_TYPE_INT, y,
+      GST_VIDEO_CONVERTER_OPT_SRC_WIDTH, G_TYPE_INT, width,
+      GST_VIDEO_CONVERTER_OPT_SRC_HEIGHT, G_TYPE_INT, height, NULL);
+
+  convert->crop_convert = gst_video_converter_new_with_pool (&in_info,
+      &convert->out_info, config, convert->pool);
+  if (convert->crop_convert == NULL)
+    return NULL;
+
+  convert->crop_rect.x = x;
+  convert->crop_rect.y = y;
+  convert->crop_rect.w = width;
+  convert->crop_rect.h = height;
+  convert->crop_frame_width = frame_width;
+  convert->crop_frame_height = frame_height;
+
+  return convert->crop_convert;
+}
+
+/**
+ * gst_video_converter_frame_crop:
+ * @convert: a #GstVideoConverter
+ * @src: a #GstVideoFrame
+ * @crop_x: x position of the rectangle in @src
+ * @crop_y: y position of the rectangle in @src
+ * @crop_width: width of the rectangle
+ * @crop_height: height of the rectangle
+ * @dest: a #GstVideoFrame
+ *
+ * Convert the given rectangle of @src to @dest like gst_video_converter_frame()
+ * does with the #GST_VIDEO_CONVERTER_OPT_SRC_X, #GST_VIDEO_CONVERTER_OPT_SRC_Y,
+ * #GST_VIDEO_CONVERTER_OPT_SRC_WIDTH and #GST_VIDEO_CONVERTER_OPT_SRC_HEIGHT
+ * options set to the rectangle. This is meant for frames with a
+ * #GstVideoCropMeta, @src can be larger than the input of @convert. All
+ * other options of @convert, including the destination rectangle and the
+ * borders, apply as configured.
+ *
+ * The converter for the rectangle is kept until the rectangle or the size
+ * of @src changes.
+ *
+ * Returns: %FALSE when the rectangle is not inside @src or can not be
+ * converted, @dest is not modified then.
+ *
+ * Since: 1.20
+ */
+gboolean
+gst_video_converter_frame_crop (GstVideoConverter * convert,
+    const GstVideoFrame * src, gint crop_x, gint crop_y, gint crop_width,
+    gint crop_height, GstVideoFrame * dest)
+{
+  GstVideoConverter *cconvert;
+
+  g_return_val_if_fail (convert != NULL, FALSE);
+  g_return_val_if_fail (src != NULL, FALSE);
+  g_return_val_if_fail (dest != NULL, FALSE);
+
+  if (crop_x < 0 || crop_y < 0 || crop_width <= 0 || crop_height <= 0 ||
+      crop_x + crop_width > GST_VIDEO_FRAME_WIDTH (src) ||
+      crop_y + crop_height > GST_VIDEO_FRAME_HEIGHT (src)) {
+    GST_WARNING ("invalid crop %d,%d %dx%d of %dx%d", crop_x, crop_y,
+        crop_width, crop_height, GST_VIDEO_FRAME_WIDTH (src),
+        GST_VIDEO_FRAME_HEIGHT (src));
+    return FALSE;
+  }
+
+  /* @convert already reads this part of the frame */
+  if (crop_x == convert->in_x && crop_y == convert->in_y &&
+      crop_width == convert->in_width && crop_height == convert->in_height) {
+    gst_video_converter_frame (convert, src, dest);
+    return TRUE;
+  }
+
+  cconvert = get_crop_converter (convert, GST_VIDEO_FRAME_WIDTH (src),
+      GST_VIDEO_FRAME_HEIGHT (src), crop_x, crop_y, crop_width, crop_height);
+  if (cconvert == NULL) {
+    GST_WARNING ("could not create the converter for crop %d,%d %dx%d",
+        crop_x, crop_y, crop_width, crop_height);
+    return FALSE;
+  }
+
+  gst_video_converter_frame (cconvert, src, dest);
+
+  return TRUE;
+}
+
 static void
 video_converter_compute_matrix (GstVideoConverter * convert)
 {
@@ -2927,6 +3484,52 @@ do_upsample_lines (GstLineCache * cache, gint idx, gint out_line, gint in_line,
   return TRUE;
 }
 
+static gboolean
+do_color_lut_lines (GstLineCache * cache, gint idx, gint out_line,
+    gint in_line, gpointer user_data)
+{
+  GstVideoConverter *convert = user_data;
+  const GstVideoSimdFuncs *funcs = gst_video_simd_get_funcs ();
+  ColorLut *lut = convert->color_lut;
+  guint16 tmp[COLOR_LUT_CHUNK * 4];
+  gpointer *lines, destline;
+  gint x, n, width;
+
+  lines = gst_line_cache_get_lines (cache->prev, idx, out_line, in_line, 1);
+
+  destline = lines[0];
+  if (convert->unpack_bits != convert->pack_bits)
+    destline = gst_line_cache_alloc_line (cache, out_line);
+
+  width = convert->in_width;
+
+  GST_DEBUG ("color lut line %d %p->%p", in_line, lines[0], destline);
+  /* the table works on 16 bits, 8 bit lines are converted in chunks */
+  for (x = 0; x < width; x += n) {
+    const guint16 *src;
+
+    n = MIN (width - x, COLOR_LUT_CHUNK);
+
+    if (convert->unpack_bits == 8) {
+      video_orc_convert_u8_to_u16 (tmp, (guint8 *) lines[0] + x * 4, n * 4);
+      src = tmp;
+    } else {
+      src = (guint16 *) lines[0] + x * 4;
+    }
+
+    if (convert->pack_bits == 8) {
+      funcs->lut3d (tmp, src, lut->table, lut->bits, n);
+      video_orc_convert_u16_to_u8 ((guint8 *) destline + x * 4, tmp, n * 4);
+    } else {
+      funcs->lut3d ((guint16 *) destline + x * 4, src, lut->table, lut->bits,
+          n);
+    }
+  }
+  gst_line_cache_add_line (cache, in_line, destline);
+
+  return TRUE;
+}
+
 static gboolean
 do_convert_to_RGB_lines (GstLineCache * cache, gint idx, gint out_line,
     gint in_line, gpointer user_data)
@@ -3294,6 +3897,9 @@ static void convert_fill_border (GstVideoConverter * convert,
       l2 = l1 + 1;                              \
     }
 
+typedef void (*FusedLineFunc) (guint8 * d, const guint8 * sy,
+    const guint8 * su, const guint8 * sv, const gint * p, gint width);
+
 typedef struct
 {
   const GstVideoFrame *src;
@@ -3308,6 +3914,7 @@ typedef struct
   gint in_x, in_y;
   gint out_x, out_y;
   gpointer tmpline;
+  FusedLineFunc fused_line;
 } FConvertTask;
 
 static void
@@ -5783,6 +6390,210 @@ convert_I420_pack_ARGB (GstVideoConverter * convert, const GstVideoFrame * src,
   convert_fill_border (convert, dest);
 }
 
+/* Fused YUV -> 4 byte RGB kernels. These go from the source planes straight
+ * into the destination in one pass, without the unpack, matrix and pack line
+ * caches of the generic path. The arithmetic is the same as the one of
+ * video_orc_convert_I420_BGRA() so that all fastpaths produce the same
+ * result. The line functions are specialized at compile time for the
+ * layout of the source and the byte order of the destination. */
+#define FUSED_SPLAT(x) ((gint16) (((guint8) ((x) - 128) << 8) | (guint8) ((x) - 128)))
+#define FUSED_MULHSW(a,b) ((gint16) (((gint32) (a) * (gint16) (b)) >> 16))
+#define FUSED_CLAMP(x) ((guint8) (CLAMP ((gint16) (x), -128, 127) + 128))
+
+static inline void
+fused_yuv_to_rgb_line (guint8 * d, const guint8 * sy, const guint8 * su,
+    const guint8 * sv, const gint * p, gint width, gint y_pstride,
+    gint uv_pstride, gint r_off, gint g_off, gint b_off, gint a_off)
+{
+  gint i;
+  gint16 p1 = p[0], p2 = p[1], p3 = p[2], p4 = p[3], p5 = p[4];
+
+  for (i = 0; i < width; i++) {
+    gint16 wy, wu, wv, wr, wg, wb;
+
+    wy = FUSED_MULHSW (FUSED_SPLAT (sy[i * y_pstride]), p1);
+    wu = FUSED_SPLAT (su[(i >> 1) * uv_pstride]);
+    wv = FUSED_SPLAT (sv[(i >> 1) * uv_pstride]);
+
+    wr = wy + FUSED_MULHSW (wv, p2);
+    wb = wy + FUSED_MULHSW (wu, p3);
+    wg = wy + FUSED_MULHSW (wu, p4);
+    wg = wg + FUSED_MULHSW (wv, p5);
+
+    d[r_off] = FUSED_CLAMP (wr);
+    d[g_off] = FUSED_CLAMP (wg);
+    d[b_off] = FUSED_CLAMP (wb);
+    d[a_off] = 0xff;
+    d += 4;
+  }
+}
+
+#define DEFINE_FUSED_LINE(layout,y_pstride,uv_pstride,order,r,g,b,a)     \
+static void                                                             \
+fused_line_##layout##_##order (guint8 * d, const guint8 * sy,           \
+    const guint8 * su, const guint8 * sv, const gint * p, gint width)    \
+{                                                                       \
+  fused_yuv_to_rgb_line (d, sy, su, sv, p, width, y_pstride, uv_pstride, \
+      r, g, b, a);                                                      \
+}
+
+#define DEFINE_FUSED_LINES(layout,y_pstride,uv_pstride)                 \
+  DEFINE_FUSED_LINE (layout, y_pstride, uv_pstride, BGRA, 2, 1, 0, 3)   \
+  DEFINE_FUSED_LINE (layout, y_pstride, uv_pstride, ARGB, 1, 2, 3, 0)   \
+  DEFINE_FUSED_LINE (layout, y_pstride, uv_pstride, RGBA, 0, 1, 2, 3)   \
+  DEFINE_FUSED_LINE (layout, y_pstride, uv_pstride, ABGR, 3, 2, 1, 0)
+
+/* I420 and YV12 */
+DEFINE_FUSED_LINES (planar, 1, 1)
+/* NV12 and NV21 */
+DEFINE_FUSED_LINES (semiplanar, 1, 2)
+/* YUY2, UYVY and YVYU */
+DEFINE_FUSED_LINES (packed, 2, 4)
+
+#undef DEFINE_FUSED_LINES
+#undef DEFINE_FUSED_LINE
+
+static FusedLineFunc
+fused_get_line_func (GstVideoFormat in_format, GstVideoFormat out_format)
+{
+  static const FusedLineFunc funcs[3][4] = {
+    {fused_line_planar_BGRA, fused_line_planar_ARGB,
+        fused_line_planar_RGBA, fused_line_planar_ABGR},
+    {fused_line_semiplanar_BGRA, fused_line_semiplanar_ARGB,
+        fused_line_semiplanar_RGBA, fused_line_semiplanar_ABGR},
+    {fused_line_packed_BGRA, fused_line_packed_ARGB,
+        fused_line_packed_RGBA, fused_line_packed_ABGR},
+  };
+  gint layout, order;
+
+  switch (in_format) {
+    case GST_VIDEO_FORMAT_I420:
+    case GST_VIDEO_FORMAT_YV12:
+      layout = 0;
+      break;
+    case GST_VIDEO_FORMAT_NV12:
+    case GST_VIDEO_FORMAT_NV21:
+      layout = 1;
+      break;
+    case GST_VIDEO_FORMAT_YUY2:
+    case GST_VIDEO_FORMAT_UYVY:
+    case GST_VIDEO_FORMAT_YVYU:
+      layout = 2;
+      break;
+    default:
+      g_return_val_if_reached (NULL);
+  }
+
+  switch (out_format) {
+    case GST_VIDEO_FORMAT_BGRA:
+    case GST_VIDEO_FORMAT_BGRx:
+      order = 0;
+      break;
+    case GST_VIDEO_FORMAT_ARGB:
+    case GST_VIDEO_FORMAT_xRGB:
+      order = 1;
+      break;
+    case GST_VIDEO_FORMAT_RGBA:
+    case GST_VIDEO_FORMAT_RGBx:
+      order = 2;
+      break;
+    case GST_VIDEO_FORMAT_ABGR:
+    case GST_VIDEO_FORMAT_xBGR:
+      order = 3;
+      break;
+    default:
+      g_return_val_if_reached (NULL);
+  }
+
+  return funcs[layout][order];
+}
+
+static void
+convert_YUV_fused_RGB_task (FConvertTask * task)
+{
+  const GstVideoFormatInfo *finfo = task->src->info.finfo;
+  gint i, y_pstride, uv_pstride, uv_hsub, in_uv_x;
+  gint p[5];
+
+  y_pstride = GST_VIDEO_FORMAT_INFO_PSTRIDE (finfo, GST_VIDEO_COMP_Y);
+  uv_pstride = GST_VIDEO_FORMAT_INFO_PSTRIDE (finfo, GST_VIDEO_COMP_U);
+  uv_hsub = GST_VIDEO_FORMAT_INFO_H_SUB (finfo, GST_VIDEO_COMP_U);
+  in_uv_x = (task->in_x >> 1) * uv_pstride;
+
+  p[0] = task->data->im[0][0];
+  p[1] = task->data->im[0][2];
+  p[2] = task->data->im[2][1];
+  p[3] = task->data->im[1][1];
+  p[4] = task->data->im[1][2];
+
+  for (i = task->height_0; i < task->height_1; i++) {
+    guint8 *sy, *su, *sv, *d;
+
+    d = FRAME_GET_LINE (task->dest, i + task->out_y);
+    d += (task->out_x * 4);
+    sy = FRAME_GET_Y_LINE (task->src, i + task->in_y);
+    sy += task->in_x * y_pstride;
+    su = FRAME_GET_U_LINE (task->src, (i + task->in_y) >> uv_hsub);
+    su += in_uv_x;
+    sv = FRAME_GET_V_LINE (task->src, (i + task->in_y) >> uv_hsub);
+    sv += in_uv_x;
+
+    task->fused_line (d, sy, su, sv, p, task->width);
+  }
+}
+
+static void
+convert_YUV_fused_RGB (GstVideoConverter * convert, const GstVideoFrame * src,
+    GstVideoFrame * dest)
+{
+  int i;
+  gint width = convert->in_width;
+  gint height = convert->in_height;
+  MatrixData *data = &convert->convert_matrix;
+  FConvertTask *tasks;
+  FConvertTask **tasks_p;
+  FusedLineFunc fused_line;
+  gint n_threads;
+  gint lines_per_thread;
+
+  fused_line = fused_get_line_func (GST_VIDEO_FRAME_FORMAT (src),
+      GST_VIDEO_FRAME_FORMAT (dest));
+
+  n_threads = convert->conversion_runner->n_threads;
+  tasks = g_newa (FConvertTask, n_threads);
+  tasks_p = g_newa (FConvertTask *, n_threads);
+
+  lines_per_thread = (height + n_threads - 1) / n_threads;
+
+  for (i = 0; i < n_threads; i++) {
+    tasks[i].src = src;
+    tasks[i].dest = dest;
+
+    tasks[i].width = width;
+    tasks[i].data = data;
+    tasks[i].in_x = convert->in_x;
+    tasks[i].in_y = convert->in_y;
+    tasks[i].out_x = convert->out_x;
+    tasks[i].out_y = convert->out_y;
+    tasks[i].fused_line = fused_line;
+
+    tasks[i].height_0 = i * lines_per_thread;
+    tasks[i].height_1 = tasks[i].height_0 + lines_per_thread;
+    tasks[i].height_1 = MIN (height, tasks[i].height_1);
+
+    tasks_p[i] = &tasks[i];
+  }
+
+  gst_parallelized_task_runner_run (convert->conversion_runner,
+      (GstParallelizedTaskFunc) convert_YUV_fused_RGB_task, (gpointer) tasks_p);
+
+  convert_fill_border (convert, dest);
+}
+
+#undef FUSED_SPLAT
+#undef FUSED_MULHSW
+#undef FUSED_CLAMP
+
 static void
 memset_u24 (guint8 * data, guint8 col[3], unsigned int n)
 {
@@ -7165,13 +7976,13 @@ static const VideoTransform transforms[] = {
       TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_ARGB},
 
   {GST_VIDEO_FORMAT_I420, GST_VIDEO_FORMAT_ABGR, FALSE, TRUE, TRUE, TRUE,
-      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_pack_ARGB},
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
   {GST_VIDEO_FORMAT_I420, GST_VIDEO_FORMAT_xBGR, FALSE, TRUE, TRUE, TRUE,
-      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_pack_ARGB},
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
   {GST_VIDEO_FORMAT_I420, GST_VIDEO_FORMAT_RGBA, FALSE, TRUE, TRUE, TRUE,
-      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_pack_ARGB},
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
   {GST_VIDEO_FORMAT_I420, GST_VIDEO_FORMAT_RGBx, FALSE, TRUE, TRUE, TRUE,
-      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_pack_ARGB},
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
   {GST_VIDEO_FORMAT_I420, GST_VIDEO_FORMAT_RGB, FALSE, TRUE, TRUE, TRUE,
       TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_pack_ARGB},
   {GST_VIDEO_FORMAT_I420, GST_VIDEO_FORMAT_BGR, FALSE, TRUE, TRUE, TRUE,
@@ -7186,13 +7997,13 @@ static const VideoTransform transforms[] = {
       TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_pack_ARGB},
 
   {GST_VIDEO_FORMAT_YV12, GST_VIDEO_FORMAT_ABGR, FALSE, TRUE, TRUE, TRUE,
-      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_pack_ARGB},
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
   {GST_VIDEO_FORMAT_YV12, GST_VIDEO_FORMAT_xBGR, FALSE, TRUE, TRUE, TRUE,
-      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_pack_ARGB},
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
   {GST_VIDEO_FORMAT_YV12, GST_VIDEO_FORMAT_RGBA, FALSE, TRUE, TRUE, TRUE,
-      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_pack_ARGB},
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
   {GST_VIDEO_FORMAT_YV12, GST_VIDEO_FORMAT_RGBx, FALSE, TRUE, TRUE, TRUE,
-      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_pack_ARGB},
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
   {GST_VIDEO_FORMAT_YV12, GST_VIDEO_FORMAT_RGB, FALSE, TRUE, TRUE, TRUE,
       TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_pack_ARGB},
   {GST_VIDEO_FORMAT_YV12, GST_VIDEO_FORMAT_BGR, FALSE, TRUE, TRUE, TRUE,
@@ -7206,6 +8017,91 @@ static const VideoTransform transforms[] = {
   {GST_VIDEO_FORMAT_YV12, GST_VIDEO_FORMAT_BGR16, FALSE, TRUE, TRUE, TRUE,
       TRUE, FALSE, FALSE, FALSE, 0, 0, convert_I420_pack_ARGB},
 
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_BGRA, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_BGRx, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_ARGB, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_xRGB, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_RGBA, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_RGBx, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_ABGR, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_xBGR, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+
+  {GST_VIDEO_FORMAT_NV21, GST_VIDEO_FORMAT_BGRA, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_NV21, GST_VIDEO_FORMAT_BGRx, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_NV21, GST_VIDEO_FORMAT_ARGB, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_NV21, GST_VIDEO_FORMAT_xRGB, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_NV21, GST_VIDEO_FORMAT_RGBA, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_NV21, GST_VIDEO_FORMAT_RGBx, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_NV21, GST_VIDEO_FORMAT_ABGR, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_NV21, GST_VIDEO_FORMAT_xBGR, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+
+  {GST_VIDEO_FORMAT_YUY2, GST_VIDEO_FORMAT_BGRA, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_YUY2, GST_VIDEO_FORMAT_BGRx, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_YUY2, GST_VIDEO_FORMAT_ARGB, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_YUY2, GST_VIDEO_FORMAT_xRGB, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_YUY2, GST_VIDEO_FORMAT_RGBA, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_YUY2, GST_VIDEO_FORMAT_RGBx, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_YUY2, GST_VIDEO_FORMAT_ABGR, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_YUY2, GST_VIDEO_FORMAT_xBGR, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+
+  {GST_VIDEO_FORMAT_UYVY, GST_VIDEO_FORMAT_BGRA, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_UYVY, GST_VIDEO_FORMAT_BGRx, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_UYVY, GST_VIDEO_FORMAT_ARGB, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_UYVY, GST_VIDEO_FORMAT_xRGB, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_UYVY, GST_VIDEO_FORMAT_RGBA, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_UYVY, GST_VIDEO_FORMAT_RGBx, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_UYVY, GST_VIDEO_FORMAT_ABGR, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_UYVY, GST_VIDEO_FORMAT_xBGR, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+
+  {GST_VIDEO_FORMAT_YVYU, GST_VIDEO_FORMAT_BGRA, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_YVYU, GST_VIDEO_FORMAT_BGRx, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_YVYU, GST_VIDEO_FORMAT_ARGB, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_YVYU, GST_VIDEO_FORMAT_xRGB, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_YVYU, GST_VIDEO_FORMAT_RGBA, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_YVYU, GST_VIDEO_FORMAT_RGBx, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_YVYU, GST_VIDEO_FORMAT_ABGR, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+  {GST_VIDEO_FORMAT_YVYU, GST_VIDEO_FORMAT_xBGR, FALSE, TRUE, TRUE, TRUE,
+      TRUE, FALSE, FALSE, FALSE, 0, 0, convert_YUV_fused_RGB},
+
   /* scalers */
   {GST_VIDEO_FORMAT_GBR, GST_VIDEO_FORMAT_GBR, TRUE, FALSE, FALSE, TRUE,
       TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
@@ -7331,11 +8227,13 @@ video_converter_lookup_fastpath (GstVideoConverter * convert)
       || convert->out_width < convert->out_maxwidth
       || convert->out_height < convert->out_maxheight;
 
+  /* the fastpaths can apply the YUV<->RGB matrix but they never convert the
+   * primaries, that needs linear light */
   for (i = 0; i < G_N_ELEMENTS (transforms); i++) {
     if (transforms[i].in_format == in_format &&
         transforms[i].out_format == out_format &&
         (transforms[i].keeps_interlaced || !interlaced) &&
-        (transforms[i].needs_color_matrix || (same_matrix && same_primaries))
+        (transforms[i].needs_color_matrix || same_matrix) && same_primaries
         && (!transforms[i].keeps_size || same_size)
         && (transforms[i].width_align & width) == 0
         && (transforms[i].height_align & height) == 0
@@ -265,11 +265,36 @@ typedef enum {
  */
 #define GST_VIDEO_CONVERTER_OPT_PRIMARIES_MODE   "GstVideoConverter.primaries-mode"
 
+/**
+ * GST_VIDEO_CONVERTER_OPT_COLOR_LUT:
+ *
+ * #G_TYPE_BOOLEAN, replace the gamma and primaries conversion with an
+ * interpolated 3D lookup table when #GST_VIDEO_CONVERTER_OPT_GAMMA_MODE is
+ * #GST_VIDEO_GAMMA_MODE_REMAP and no scaling is done. The table is only used
+ * when it is within #GST_VIDEO_CONVERTER_OPT_COLOR_LUT_MAX_ERROR.
+ * Default %FALSE.
+ *
+ * Since: 1.20
+ */
+#define GST_VIDEO_CONVERTER_OPT_COLOR_LUT   "GstVideoConverter.color-lut"
+
+/**
+ * GST_VIDEO_CONVERTER_OPT_COLOR_LUT_MAX_ERROR:
+ *
+ * #G_TYPE_DOUBLE, the maximum allowed difference between the lookup table
+ * and the exact conversion, as a fraction of the output range.
+ * Default 0.002.
+ *
+ * Since: 1.20
+ */
+#define GST_VIDEO_CONVERTER_OPT_COLOR_LUT_MAX_ERROR   "GstVideoConverter.color-lut-max-error"
+
 /**
  * GST_VIDEO_CONVERTER_OPT_THREADS:
  *
  * #G_TYPE_UINT, maximum number of threads to use. Default 1, 0 for the number
- * of cores.
+ * of cores. The threads are taken from a #GstVideoTaskPool, see
+ * gst_video_converter_new_with_pool().
  */
 #define GST_VIDEO_CONVERTER_OPT_THREADS   "GstVideoConverter.threads"
 
@@ -280,6 +305,12 @@ GstVideoConverter *  gst_video_converter_new            (GstVideoInfo *in_info,
                                                          GstVideoInfo *out_info,
                                                          GstStructure *config);
 
+GST_VIDEO_API
+GstVideoConverter *  gst_video_converter_new_with_pool  (GstVideoInfo *in_info,
+                                                         GstVideoInfo *out_info,
+                                                         GstStructure *config,
+                                                         GstVideoTaskPool *pool);
+
 GST_VIDEO_API
 void                 gst_video_converter_free           (GstVideoConverter * convert);
 
@@ -293,6 +324,22 @@ GST_VIDEO_API
 void                 gst_video_converter_frame          (GstVideoConverter * convert,
                                                          const GstVideoFrame *src, GstVideoFrame *dest);
 
+GST_VIDEO_API
+gboolean             gst_video_converter_frame_rect     (GstVideoConverter * convert,
+                                                         const GstVideoFrame *src,
+                                                         gint src_x, gint src_y,
+                                                         gint src_width, gint src_height,
+                                                         GstVideoFrame *dest,
+                                                         gint dest_x, gint dest_y,
+                                                         gint dest_width, gint dest_height);
+
+GST_VIDEO_API
+gboolean             gst_video_converter_frame_crop     (GstVideoConverter * convert,
+                                                         const GstVideoFrame *src,
+                                                         gint crop_x, gint crop_y,
+                                                         gint crop_width, gint crop_height,
+                                                         GstVideoFrame *dest);
+
 
 G_END_DECLS
 
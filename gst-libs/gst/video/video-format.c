@@ -28,6 +28,7 @@
 
 #include "video-format.h"
 #include "video-orc.h"
+#include "video-simd-private.h"
 
 #ifndef restrict
 #if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
@@ -110,7 +111,7 @@ unpack_planar_420 (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
     width--;
     d += 4;
   }
-  video_orc_unpack_I420 (d, sy, su, sv, width);
+  gst_video_simd_get_funcs ()->unpack_I420 (d, sy, su, sv, width);
 }
 
 static void
@@ -127,7 +128,7 @@ pack_planar_420 (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
 
   if (IS_CHROMA_LINE_420 (y, flags)) {
     if (IS_ALIGNED (s, 8))
-      video_orc_pack_I420 (dy, du, dv, s, width / 2);
+      gst_video_simd_get_funcs ()->pack_I420 (dy, du, dv, s, width / 2);
     else {
       gint i;
 
@@ -170,7 +171,7 @@ unpack_YUY2 (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
   }
 
   if (IS_ALIGNED (d, 8))
-    video_orc_unpack_YUY2 (d, s, width / 2);
+    gst_video_simd_get_funcs ()->unpack_YUY2 (d, s, width / 2);
   else {
     gint i;
 
@@ -206,7 +207,7 @@ pack_YUY2 (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
   const guint8 *restrict s = src;
 
   if (IS_ALIGNED (s, 8))
-    video_orc_pack_YUY2 (d, s, width / 2);
+    gst_video_simd_get_funcs ()->pack_YUY2 (d, s, width / 2);
   else {
     gint i;
     for (i = 0; i < width / 2; i++) {
@@ -571,7 +572,10 @@ unpack_v210 (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
   /* FIXME */
   s += x * 2;
 
-  for (i = 0; i < width; i += 6) {
+  gst_video_simd_get_funcs ()->unpack_v210 (d, s,
+      !(flags & GST_VIDEO_PACK_FLAG_TRUNCATE_RANGE), width / 6);
+
+  for (i = (width / 6) * 6; i < width; i += 6) {
     a0 = GST_READ_UINT32_LE (s + (i / 6) * 16 + 0);
     a1 = GST_READ_UINT32_LE (s + (i / 6) * 16 + 4);
     a2 = GST_READ_UINT32_LE (s + (i / 6) * 16 + 8);
@@ -661,32 +665,9 @@ pack_v210 (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
   guint16 u0, u1, u2;
   guint16 v0, v1, v2;
 
-  for (i = 0; i < width - 5; i += 6) {
-    y0 = s[4 * (i + 0) + 1] >> 6;
-    y1 = s[4 * (i + 1) + 1] >> 6;
-    y2 = s[4 * (i + 2) + 1] >> 6;
-    y3 = s[4 * (i + 3) + 1] >> 6;
-    y4 = s[4 * (i + 4) + 1] >> 6;
-    y5 = s[4 * (i + 5) + 1] >> 6;
-
-    u0 = s[4 * (i + 0) + 2] >> 6;
-    u1 = s[4 * (i + 2) + 2] >> 6;
-    u2 = s[4 * (i + 4) + 2] >> 6;
-
-    v0 = s[4 * (i + 0) + 3] >> 6;
-    v1 = s[4 * (i + 2) + 3] >> 6;
-    v2 = s[4 * (i + 4) + 3] >> 6;
-
-    a0 = u0 | (y0 << 10) | (v0 << 20);
-    a1 = y1 | (u1 << 10) | (y2 << 20);
-    a2 = v1 | (y3 << 10) | (u2 << 20);
-    a3 = y4 | (v2 << 10) | (y5 << 20);
+  gst_video_simd_get_funcs ()->pack_v210 (d, s, width / 6);
 
-    GST_WRITE_UINT32_LE (d + (i / 6) * 16 + 0, a0);
-    GST_WRITE_UINT32_LE (d + (i / 6) * 16 + 4, a1);
-    GST_WRITE_UINT32_LE (d + (i / 6) * 16 + 8, a2);
-    GST_WRITE_UINT32_LE (d + (i / 6) * 16 + 12, a3);
-  }
+  i = (width / 6) * 6;
   if (i < width) {
     y0 = s[4 * (i + 0) + 1] >> 6;
     u0 = s[4 * (i + 0) + 2] >> 6;
@@ -817,28 +798,8 @@ unpack_Y210 (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
     width--;
   }
 
-  for (i = 0; i < width / 2; i++) {
-    Y0 = GST_READ_UINT16_LE (s + i * 8 + 0);
-    U = GST_READ_UINT16_LE (s + i * 8 + 2);
-    V = GST_READ_UINT16_LE (s + i * 8 + 6);
-    Y1 = GST_READ_UINT16_LE (s + i * 8 + 4);
-
-    if (!(flags & GST_VIDEO_PACK_FLAG_TRUNCATE_RANGE)) {
-      Y0 |= (Y0 >> 10);
-      U |= (U >> 10);
-      V |= (V >> 10);
-    }
-
-    d[i * 8 + 0] = 0xffff;
-    d[i * 8 + 1] = Y0;
-    d[i * 8 + 2] = U;
-    d[i * 8 + 3] = V;
-
-    d[i * 8 + 4] = 0xffff;
-    d[i * 8 + 5] = Y1;
-    d[i * 8 + 6] = U;
-    d[i * 8 + 7] = V;
-  }
+  gst_video_simd_get_funcs ()->unpack_Y216 (d, s, 10,
+      !(flags & GST_VIDEO_PACK_FLAG_TRUNCATE_RANGE), width / 2);
 
   if (width & 1) {
     i = width - 1;
@@ -867,22 +828,22 @@ pack_Y210 (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
     gint y, gint width)
 {
   int i;
-  guint16 Y0, Y1, U, V;
+  guint16 Y0, U, V;
   guint8 *restrict d = GET_LINE (y);
   const guint16 *restrict s = src;
 
-  for (i = 0; i < width; i += 2) {
+  gst_video_simd_get_funcs ()->pack_Y216 (d, s, 10, width / 2);
+
+  if (width & 1) {
+    i = width - 1;
+
     Y0 = s[i * 4 + 1] & 0xffc0;
     U = s[i * 4 + 2] & 0xffc0;
     V = s[i * 4 + 3] & 0xffc0;
-    if (i == width - 1)
-      Y1 = s[i * 4 + 1] & 0xffc0;
-    else
-      Y1 = s[(i + 1) * 4 + 1] & 0xffc0;
 
     GST_WRITE_UINT16_LE (d + i * 4 + 0, Y0);
     GST_WRITE_UINT16_LE (d + i * 4 + 2, U);
-    GST_WRITE_UINT16_LE (d + i * 4 + 4, Y1);
+    GST_WRITE_UINT16_LE (d + i * 4 + 4, Y0);
     GST_WRITE_UINT16_LE (d + i * 4 + 6, V);
   }
 }
@@ -1467,7 +1428,7 @@ unpack_BGRA (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
 
   s += x * 4;
 
-  video_orc_unpack_BGRA (dest, s, width);
+  gst_video_simd_get_funcs ()->unpack_BGRA (dest, s, width);
 }
 
 static void
@@ -1478,7 +1439,7 @@ pack_BGRA (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
 {
   guint8 *restrict d = GET_LINE (y);
 
-  video_orc_pack_BGRA (d, src, width);
+  gst_video_simd_get_funcs ()->pack_BGRA (d, src, width);
 }
 
 #define PACK_ABGR GST_VIDEO_FORMAT_ARGB, unpack_ABGR, 1, pack_ABGR
@@ -1644,7 +1605,7 @@ unpack_NV12 (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
   }
 
   if (IS_ALIGNED (d, 8))
-    video_orc_unpack_NV12 (d, sy, suv, width / 2);
+    gst_video_simd_get_funcs ()->unpack_NV12 (d, sy, suv, width / 2);
   else {
     gint i;
     for (i = 0; i < width / 2; i++) {
@@ -1682,7 +1643,7 @@ pack_NV12 (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
 
   if (IS_CHROMA_LINE_420 (y, flags)) {
     if (IS_ALIGNED (s, 8))
-      video_orc_pack_NV12 (dy, duv, s, width / 2);
+      gst_video_simd_get_funcs ()->pack_NV12 (dy, duv, s, width / 2);
     else {
       gint i;
       for (i = 0; i < width / 2; i++) {
@@ -1811,7 +1772,7 @@ unpack_NV16 (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
   }
 
   if (IS_ALIGNED (d, 8))
-    video_orc_unpack_NV12 (d, sy, suv, width / 2);
+    gst_video_simd_get_funcs ()->unpack_NV12 (d, sy, suv, width / 2);
   else {
     gint i;
     for (i = 0; i < width / 2; i++) {
@@ -1847,7 +1808,7 @@ pack_NV16 (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
   const guint8 *restrict s = src;
 
   if (IS_ALIGNED (s, 8))
-    video_orc_pack_NV12 (dy, duv, s, width / 2);
+    gst_video_simd_get_funcs ()->pack_NV12 (dy, duv, s, width / 2);
   else {
     gint i;
     for (i = 0; i < width / 2; i++) {
@@ -1989,7 +1950,10 @@ unpack_UYVP (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
   /* FIXME */
   s += x << 1;
 
-  for (i = 0; i < width; i += 2) {
+  gst_video_simd_get_funcs ()->unpack_UYVP (d, s,
+      !(flags & GST_VIDEO_PACK_FLAG_TRUNCATE_RANGE), width / 2);
+
+  for (i = (width / 2) * 2; i < width; i += 2) {
     guint16 y0, y1;
     guint16 u0;
     guint16 v0;
@@ -2030,7 +1994,9 @@ pack_UYVP (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
   guint8 *restrict d = GET_LINE (y);
   const guint16 *restrict s = src;
 
-  for (i = 0; i < width; i += 2) {
+  gst_video_simd_get_funcs ()->pack_UYVP (d, s, width / 2);
+
+  for (i = (width / 2) * 2; i < width; i += 2) {
     guint16 y0, y1;
     guint16 u0;
     guint16 v0;
@@ -3084,47 +3050,75 @@ pack_Y444_10BE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
   }
 }
 
-#define PACK_I420_10LE GST_VIDEO_FORMAT_AYUV64, unpack_I420_10LE, 1, pack_I420_10LE
+static inline void
+unpack_planar_16_LE_pixel (guint16 * d, guint16 Y, guint16 U, guint16 V,
+    gint bits, gboolean expand)
+{
+  Y <<= 16 - bits;
+  U <<= 16 - bits;
+  V <<= 16 - bits;
+
+  if (expand) {
+    Y |= (Y >> bits);
+    U |= (U >> bits);
+    V |= (V >> bits);
+  }
+
+  d[0] = 0xffff;
+  d[1] = Y;
+  d[2] = U;
+  d[3] = V;
+}
+
+/* unpack a line of planar 4:2:x samples that are stored in the low @bits
+ * bits of little endian words */
 static void
-unpack_I420_10LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
-    gpointer dest, const gpointer data[GST_VIDEO_MAX_PLANES],
-    const gint stride[GST_VIDEO_MAX_PLANES], gint x, gint y, gint width)
+unpack_planar_16_LE (guint16 * d, const guint16 * sy, const guint16 * su,
+    const guint16 * sv, gint bits, GstVideoPackFlags flags, gint x,
+    gint width)
 {
-  int i;
-  gint uv = GET_UV_420 (y, flags);
-  const guint16 *restrict sy = GET_Y_LINE (y);
-  const guint16 *restrict su = GET_U_LINE (uv);
-  const guint16 *restrict sv = GET_V_LINE (uv);
-  guint16 *restrict d = dest, Y, U, V;
+  gboolean expand = !(flags & GST_VIDEO_PACK_FLAG_TRUNCATE_RANGE);
 
   sy += x;
   su += x >> 1;
   sv += x >> 1;
 
-  for (i = 0; i < width; i++) {
-    Y = GST_READ_UINT16_LE (sy + i) << 6;
-    U = GST_READ_UINT16_LE (su + (i >> 1)) << 6;
-    V = GST_READ_UINT16_LE (sv + (i >> 1)) << 6;
+  if (x & 1) {
+    unpack_planar_16_LE_pixel (d, GST_READ_UINT16_LE (sy),
+        GST_READ_UINT16_LE (su), GST_READ_UINT16_LE (sv), bits, expand);
+    d += 4;
+    sy++;
+    su++;
+    sv++;
+    width--;
+  }
 
-    if (!(flags & GST_VIDEO_PACK_FLAG_TRUNCATE_RANGE)) {
-      Y |= (Y >> 10);
-      U |= (U >> 10);
-      V |= (V >> 10);
-    }
+  gst_video_simd_get_funcs ()->unpack_I420_16 (d, sy, su, sv, bits, expand,
+      width / 2);
 
-    d[i * 4 + 0] = 0xffff;
-    d[i * 4 + 1] = Y;
-    d[i * 4 + 2] = U;
-    d[i * 4 + 3] = V;
+  if (width & 1) {
+    gint i = width - 1;
 
-    if (x & 1) {
-      x = 0;
-      su++;
-      sv++;
-    }
+    unpack_planar_16_LE_pixel (d + i * 4, GST_READ_UINT16_LE (sy + i),
+        GST_READ_UINT16_LE (su + (i >> 1)), GST_READ_UINT16_LE (sv + (i >> 1)),
+        bits, expand);
   }
 }
 
+#define PACK_I420_10LE GST_VIDEO_FORMAT_AYUV64, unpack_I420_10LE, 1, pack_I420_10LE
+static void
+unpack_I420_10LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
+    gpointer dest, const gpointer data[GST_VIDEO_MAX_PLANES],
+    const gint stride[GST_VIDEO_MAX_PLANES], gint x, gint y, gint width)
+{
+  gint uv = GET_UV_420 (y, flags);
+  const guint16 *restrict sy = GET_Y_LINE (y);
+  const guint16 *restrict su = GET_U_LINE (uv);
+  const guint16 *restrict sv = GET_V_LINE (uv);
+
+  unpack_planar_16_LE (dest, sy, su, sv, 10, flags, x, width);
+}
+
 static void
 pack_I420_10LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
     const gpointer src, gint sstride, gpointer data[GST_VIDEO_MAX_PLANES],
@@ -3136,22 +3130,15 @@ pack_I420_10LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
   guint16 *restrict dy = GET_Y_LINE (y);
   guint16 *restrict du = GET_U_LINE (uv);
   guint16 *restrict dv = GET_V_LINE (uv);
-  guint16 Y0, Y1, U, V;
+  guint16 Y0, U, V;
   const guint16 *restrict s = src;
 
   if (IS_CHROMA_LINE_420 (y, flags)) {
-    for (i = 0; i < width - 1; i += 2) {
-      Y0 = s[i * 4 + 1] >> 6;
-      Y1 = s[i * 4 + 5] >> 6;
-      U = s[i * 4 + 2] >> 6;
-      V = s[i * 4 + 3] >> 6;
+    gst_video_simd_get_funcs ()->pack_I420_16 (dy, du, dv, s, 10,
+        width / 2);
+    if (width & 1) {
+      i = width - 1;
 
-      GST_WRITE_UINT16_LE (dy + i + 0, Y0);
-      GST_WRITE_UINT16_LE (dy + i + 1, Y1);
-      GST_WRITE_UINT16_LE (du + (i >> 1), U);
-      GST_WRITE_UINT16_LE (dv + (i >> 1), V);
-    }
-    if (i == width - 1) {
       Y0 = s[i * 4 + 1] >> 6;
       U = s[i * 4 + 2] >> 6;
       V = s[i * 4 + 3] >> 6;
@@ -3161,10 +3148,7 @@ pack_I420_10LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
       GST_WRITE_UINT16_LE (dv + (i >> 1), V);
     }
   } else {
-    for (i = 0; i < width; i++) {
-      Y0 = s[i * 4 + 1] >> 6;
-      GST_WRITE_UINT16_LE (dy + i, Y0);
-    }
+    gst_video_simd_get_funcs ()->pack_Y16 (dy, s, 10, FALSE, width);
   }
 }
 
@@ -3258,38 +3242,11 @@ unpack_I422_10LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
     gpointer dest, const gpointer data[GST_VIDEO_MAX_PLANES],
     const gint stride[GST_VIDEO_MAX_PLANES], gint x, gint y, gint width)
 {
-  int i;
   const guint16 *restrict sy = GET_Y_LINE (y);
   const guint16 *restrict su = GET_U_LINE (y);
   const guint16 *restrict sv = GET_V_LINE (y);
-  guint16 *restrict d = dest, Y, U, V;
 
-  sy += x;
-  su += x >> 1;
-  sv += x >> 1;
-
-  for (i = 0; i < width; i++) {
-    Y = GST_READ_UINT16_LE (sy + i) << 6;
-    U = GST_READ_UINT16_LE (su + (i >> 1)) << 6;
-    V = GST_READ_UINT16_LE (sv + (i >> 1)) << 6;
-
-    if (!(flags & GST_VIDEO_PACK_FLAG_TRUNCATE_RANGE)) {
-      Y |= (Y >> 10);
-      U |= (U >> 10);
-      V |= (V >> 10);
-    }
-
-    d[i * 4 + 0] = 0xffff;
-    d[i * 4 + 1] = Y;
-    d[i * 4 + 2] = U;
-    d[i * 4 + 3] = V;
-
-    if (x & 1) {
-      x = 0;
-      su++;
-      sv++;
-    }
-  }
+  unpack_planar_16_LE (dest, sy, su, sv, 10, flags, x, width);
 }
 
 static void
@@ -3302,21 +3259,13 @@ pack_I422_10LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
   guint16 *restrict dy = GET_Y_LINE (y);
   guint16 *restrict du = GET_U_LINE (y);
   guint16 *restrict dv = GET_V_LINE (y);
-  guint16 Y0, Y1, U, V;
+  guint16 Y0, U, V;
   const guint16 *restrict s = src;
 
-  for (i = 0; i < width - 1; i += 2) {
-    Y0 = s[i * 4 + 1] >> 6;
-    Y1 = s[i * 4 + 5] >> 6;
-    U = s[i * 4 + 2] >> 6;
-    V = s[i * 4 + 3] >> 6;
+  gst_video_simd_get_funcs ()->pack_I420_16 (dy, du, dv, s, 10, width / 2);
+  if (width & 1) {
+    i = width - 1;
 
-    GST_WRITE_UINT16_LE (dy + i + 0, Y0);
-    GST_WRITE_UINT16_LE (dy + i + 1, Y1);
-    GST_WRITE_UINT16_LE (du + (i >> 1), U);
-    GST_WRITE_UINT16_LE (dv + (i >> 1), V);
-  }
-  if (i == width - 1) {
     Y0 = s[i * 4 + 1] >> 6;
     U = s[i * 4 + 2] >> 6;
     V = s[i * 4 + 3] >> 6;
@@ -3524,39 +3473,12 @@ unpack_I420_12LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
     gpointer dest, const gpointer data[GST_VIDEO_MAX_PLANES],
     const gint stride[GST_VIDEO_MAX_PLANES], gint x, gint y, gint width)
 {
-  int i;
   gint uv = GET_UV_420 (y, flags);
   const guint16 *restrict sy = GET_Y_LINE (y);
   const guint16 *restrict su = GET_U_LINE (uv);
   const guint16 *restrict sv = GET_V_LINE (uv);
-  guint16 *restrict d = dest, Y, U, V;
-
-  sy += x;
-  su += x >> 1;
-  sv += x >> 1;
-
-  for (i = 0; i < width; i++) {
-    Y = GST_READ_UINT16_LE (sy + i) << 4;
-    U = GST_READ_UINT16_LE (su + (i >> 1)) << 4;
-    V = GST_READ_UINT16_LE (sv + (i >> 1)) << 4;
-
-    if (!(flags & GST_VIDEO_PACK_FLAG_TRUNCATE_RANGE)) {
-      Y |= (Y >> 12);
-      U |= (U >> 12);
-      V |= (V >> 12);
-    }
 
-    d[i * 4 + 0] = 0xffff;
-    d[i * 4 + 1] = Y;
-    d[i * 4 + 2] = U;
-    d[i * 4 + 3] = V;
-
-    if (x & 1) {
-      x = 0;
-      su++;
-      sv++;
-    }
-  }
+  unpack_planar_16_LE (dest, sy, su, sv, 12, flags, x, width);
 }
 
 static void
@@ -3570,22 +3492,15 @@ pack_I420_12LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
   guint16 *restrict dy = GET_Y_LINE (y);
   guint16 *restrict du = GET_U_LINE (uv);
   guint16 *restrict dv = GET_V_LINE (uv);
-  guint16 Y0, Y1, U, V;
+  guint16 Y0, U, V;
   const guint16 *restrict s = src;
 
   if (IS_CHROMA_LINE_420 (y, flags)) {
-    for (i = 0; i < width - 1; i += 2) {
-      Y0 = s[i * 4 + 1] >> 4;
-      Y1 = s[i * 4 + 5] >> 4;
-      U = s[i * 4 + 2] >> 4;
-      V = s[i * 4 + 3] >> 4;
+    gst_video_simd_get_funcs ()->pack_I420_16 (dy, du, dv, s, 12,
+        width / 2);
+    if (width & 1) {
+      i = width - 1;
 
-      GST_WRITE_UINT16_LE (dy + i + 0, Y0);
-      GST_WRITE_UINT16_LE (dy + i + 1, Y1);
-      GST_WRITE_UINT16_LE (du + (i >> 1), U);
-      GST_WRITE_UINT16_LE (dv + (i >> 1), V);
-    }
-    if (i == width - 1) {
       Y0 = s[i * 4 + 1] >> 4;
       U = s[i * 4 + 2] >> 4;
       V = s[i * 4 + 3] >> 4;
@@ -3595,10 +3510,7 @@ pack_I420_12LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
       GST_WRITE_UINT16_LE (dv + (i >> 1), V);
     }
   } else {
-    for (i = 0; i < width; i++) {
-      Y0 = s[i * 4 + 1] >> 4;
-      GST_WRITE_UINT16_LE (dy + i, Y0);
-    }
+    gst_video_simd_get_funcs ()->pack_Y16 (dy, s, 12, FALSE, width);
   }
 }
 
@@ -3692,38 +3604,11 @@ unpack_I422_12LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
     gpointer dest, const gpointer data[GST_VIDEO_MAX_PLANES],
     const gint stride[GST_VIDEO_MAX_PLANES], gint x, gint y, gint width)
 {
-  int i;
   const guint16 *restrict sy = GET_Y_LINE (y);
   const guint16 *restrict su = GET_U_LINE (y);
   const guint16 *restrict sv = GET_V_LINE (y);
-  guint16 *restrict d = dest, Y, U, V;
 
-  sy += x;
-  su += x >> 1;
-  sv += x >> 1;
-
-  for (i = 0; i < width; i++) {
-    Y = GST_READ_UINT16_LE (sy + i) << 4;
-    U = GST_READ_UINT16_LE (su + (i >> 1)) << 4;
-    V = GST_READ_UINT16_LE (sv + (i >> 1)) << 4;
-
-    if (!(flags & GST_VIDEO_PACK_FLAG_TRUNCATE_RANGE)) {
-      Y |= (Y >> 12);
-      U |= (U >> 12);
-      V |= (V >> 12);
-    }
-
-    d[i * 4 + 0] = 0xffff;
-    d[i * 4 + 1] = Y;
-    d[i * 4 + 2] = U;
-    d[i * 4 + 3] = V;
-
-    if (x & 1) {
-      x = 0;
-      su++;
-      sv++;
-    }
-  }
+  unpack_planar_16_LE (dest, sy, su, sv, 12, flags, x, width);
 }
 
 static void
@@ -3736,21 +3621,13 @@ pack_I422_12LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
   guint16 *restrict dy = GET_Y_LINE (y);
   guint16 *restrict du = GET_U_LINE (y);
   guint16 *restrict dv = GET_V_LINE (y);
-  guint16 Y0, Y1, U, V;
+  guint16 Y0, U, V;
   const guint16 *restrict s = src;
 
-  for (i = 0; i < width - 1; i += 2) {
-    Y0 = s[i * 4 + 1] >> 4;
-    Y1 = s[i * 4 + 5] >> 4;
-    U = s[i * 4 + 2] >> 4;
-    V = s[i * 4 + 3] >> 4;
+  gst_video_simd_get_funcs ()->pack_I420_16 (dy, du, dv, s, 12, width / 2);
+  if (width & 1) {
+    i = width - 1;
 
-    GST_WRITE_UINT16_LE (dy + i + 0, Y0);
-    GST_WRITE_UINT16_LE (dy + i + 1, Y1);
-    GST_WRITE_UINT16_LE (du + (i >> 1), U);
-    GST_WRITE_UINT16_LE (dv + (i >> 1), V);
-  }
-  if (i == width - 1) {
     Y0 = s[i * 4 + 1] >> 4;
     U = s[i * 4 + 2] >> 4;
     V = s[i * 4 + 3] >> 4;
@@ -4598,11 +4475,10 @@ unpack_P010_10LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
     gpointer dest, const gpointer data[GST_VIDEO_MAX_PLANES],
     const gint stride[GST_VIDEO_MAX_PLANES], gint x, gint y, gint width)
 {
-  int i;
   gint uv = GET_UV_420 (y, flags);
   const guint16 *restrict sy = GET_PLANE_LINE (0, y);
   const guint16 *restrict suv = GET_PLANE_LINE (1, uv);
-  guint16 *restrict d = dest, Y0, Y1, U, V;
+  guint16 *restrict d = dest, Y0, U, V;
 
   sy += x;
   suv += (x & ~1);
@@ -4628,28 +4504,8 @@ unpack_P010_10LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
     suv += 2;
   }
 
-  for (i = 0; i < width / 2; i++) {
-    Y0 = GST_READ_UINT16_LE (sy + 2 * i);
-    Y1 = GST_READ_UINT16_LE (sy + 2 * i + 1);
-    U = GST_READ_UINT16_LE (suv + 2 * i);
-    V = GST_READ_UINT16_LE (suv + 2 * i + 1);
-
-    if (!(flags & GST_VIDEO_PACK_FLAG_TRUNCATE_RANGE)) {
-      Y0 |= (Y0 >> 10);
-      Y1 |= (Y1 >> 10);
-      U |= (U >> 10);
-      V |= (V >> 10);
-    }
-
-    d[i * 8 + 0] = 0xffff;
-    d[i * 8 + 1] = Y0;
-    d[i * 8 + 2] = U;
-    d[i * 8 + 3] = V;
-    d[i * 8 + 4] = 0xffff;
-    d[i * 8 + 5] = Y1;
-    d[i * 8 + 6] = U;
-    d[i * 8 + 7] = V;
-  }
+  gst_video_simd_get_funcs ()->unpack_P016 (d, sy, suv, 10,
+      !(flags & GST_VIDEO_PACK_FLAG_TRUNCATE_RANGE), width / 2);
 
   if (width & 1) {
     gint i = width - 1;
@@ -4677,25 +4533,14 @@ pack_P010_10LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
     const gint stride[GST_VIDEO_MAX_PLANES], GstVideoChromaSite chroma_site,
     gint y, gint width)
 {
-  int i;
   gint uv = GET_UV_420 (y, flags);
   guint16 *restrict dy = GET_PLANE_LINE (0, y);
   guint16 *restrict duv = GET_PLANE_LINE (1, uv);
-  guint16 Y0, Y1, U, V;
+  guint16 Y0, U, V;
   const guint16 *restrict s = src;
 
   if (IS_CHROMA_LINE_420 (y, flags)) {
-    for (i = 0; i < width / 2; i++) {
-      Y0 = s[i * 8 + 1] & 0xffc0;
-      Y1 = s[i * 8 + 5] & 0xffc0;
-      U = s[i * 8 + 2] & 0xffc0;
-      V = s[i * 8 + 3] & 0xffc0;
-
-      GST_WRITE_UINT16_LE (dy + i * 2 + 0, Y0);
-      GST_WRITE_UINT16_LE (dy + i * 2 + 1, Y1);
-      GST_WRITE_UINT16_LE (duv + i * 2 + 0, U);
-      GST_WRITE_UINT16_LE (duv + i * 2 + 1, V);
-    }
+    gst_video_simd_get_funcs ()->pack_P016 (dy, duv, s, 10, width / 2);
     if (width & 1) {
       gint i = width - 1;
 
@@ -4708,10 +4553,7 @@ pack_P010_10LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
       GST_WRITE_UINT16_LE (duv + i + 1, V);
     }
   } else {
-    for (i = 0; i < width; i++) {
-      Y0 = s[i * 4 + 1] & 0xffc0;
-      GST_WRITE_UINT16_LE (dy + i, Y0);
-    }
+    gst_video_simd_get_funcs ()->pack_Y16 (dy, s, 10, TRUE, width);
   }
 }
 
@@ -5615,11 +5457,10 @@ unpack_P016_LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
     gpointer dest, const gpointer data[GST_VIDEO_MAX_PLANES],
     const gint stride[GST_VIDEO_MAX_PLANES], gint x, gint y, gint width)
 {
-  int i;
   gint uv = GET_UV_420 (y, flags);
   const guint16 *restrict sy = GET_PLANE_LINE (0, y);
   const guint16 *restrict suv = GET_PLANE_LINE (1, uv);
-  guint16 *restrict d = dest, Y0, Y1, U, V;
+  guint16 *restrict d = dest, Y0, U, V;
 
   sy += x;
   suv += (x & ~1);
@@ -5639,21 +5480,8 @@ unpack_P016_LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
     suv += 2;
   }
 
-  for (i = 0; i < width / 2; i++) {
-    Y0 = GST_READ_UINT16_LE (sy + 2 * i);
-    Y1 = GST_READ_UINT16_LE (sy + 2 * i + 1);
-    U = GST_READ_UINT16_LE (suv + 2 * i);
-    V = GST_READ_UINT16_LE (suv + 2 * i + 1);
-
-    d[i * 8 + 0] = 0xffff;
-    d[i * 8 + 1] = Y0;
-    d[i * 8 + 2] = U;
-    d[i * 8 + 3] = V;
-    d[i * 8 + 4] = 0xffff;
-    d[i * 8 + 5] = Y1;
-    d[i * 8 + 6] = U;
-    d[i * 8 + 7] = V;
-  }
+  gst_video_simd_get_funcs ()->unpack_P016 (d, sy, suv, 16,
+      !(flags & GST_VIDEO_PACK_FLAG_TRUNCATE_RANGE), width / 2);
 
   if (width & 1) {
     gint i = width - 1;
@@ -5675,25 +5503,14 @@ pack_P016_LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
     const gint stride[GST_VIDEO_MAX_PLANES], GstVideoChromaSite chroma_site,
     gint y, gint width)
 {
-  int i;
   gint uv = GET_UV_420 (y, flags);
   guint16 *restrict dy = GET_PLANE_LINE (0, y);
   guint16 *restrict duv = GET_PLANE_LINE (1, uv);
-  guint16 Y0, Y1, U, V;
+  guint16 Y0, U, V;
   const guint16 *restrict s = src;
 
   if (IS_CHROMA_LINE_420 (y, flags)) {
-    for (i = 0; i < width / 2; i++) {
-      Y0 = s[i * 8 + 1];
-      Y1 = s[i * 8 + 5];
-      U = s[i * 8 + 2];
-      V = s[i * 8 + 3];
-
-      GST_WRITE_UINT16_LE (dy + i * 2 + 0, Y0);
-      GST_WRITE_UINT16_LE (dy + i * 2 + 1, Y1);
-      GST_WRITE_UINT16_LE (duv + i * 2 + 0, U);
-      GST_WRITE_UINT16_LE (duv + i * 2 + 1, V);
-    }
+    gst_video_simd_get_funcs ()->pack_P016 (dy, duv, s, 16, width / 2);
     if (width & 1) {
       gint i = width - 1;
 
@@ -5706,10 +5523,7 @@ pack_P016_LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
       GST_WRITE_UINT16_LE (duv + i + 1, V);
     }
   } else {
-    for (i = 0; i < width; i++) {
-      Y0 = s[i * 4 + 1];
-      GST_WRITE_UINT16_LE (dy + i, Y0);
-    }
+    gst_video_simd_get_funcs ()->pack_Y16 (dy, s, 16, TRUE, width);
   }
 }
 
@@ -5842,11 +5656,10 @@ unpack_P012_LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
     gpointer dest, const gpointer data[GST_VIDEO_MAX_PLANES],
     const gint stride[GST_VIDEO_MAX_PLANES], gint x, gint y, gint width)
 {
-  int i;
   gint uv = GET_UV_420 (y, flags);
   const guint16 *restrict sy = GET_PLANE_LINE (0, y);
   const guint16 *restrict suv = GET_PLANE_LINE (1, uv);
-  guint16 *restrict d = dest, Y0, Y1, U, V;
+  guint16 *restrict d = dest, Y0, U, V;
 
   sy += x;
   suv += (x & ~1);
@@ -5872,28 +5685,8 @@ unpack_P012_LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
     suv += 2;
   }
 
-  for (i = 0; i < width / 2; i++) {
-    Y0 = GST_READ_UINT16_LE (sy + 2 * i);
-    Y1 = GST_READ_UINT16_LE (sy + 2 * i + 1);
-    U = GST_READ_UINT16_LE (suv + 2 * i);
-    V = GST_READ_UINT16_LE (suv + 2 * i + 1);
-
-    if (!(flags & GST_VIDEO_PACK_FLAG_TRUNCATE_RANGE)) {
-      Y0 |= (Y0 >> 12);
-      Y1 |= (Y1 >> 12);
-      U |= (U >> 12);
-      V |= (V >> 12);
-    }
-
-    d[i * 8 + 0] = 0xffff;
-    d[i * 8 + 1] = Y0;
-    d[i * 8 + 2] = U;
-    d[i * 8 + 3] = V;
-    d[i * 8 + 4] = 0xffff;
-    d[i * 8 + 5] = Y1;
-    d[i * 8 + 6] = U;
-    d[i * 8 + 7] = V;
-  }
+  gst_video_simd_get_funcs ()->unpack_P016 (d, sy, suv, 12,
+      !(flags & GST_VIDEO_PACK_FLAG_TRUNCATE_RANGE), width / 2);
 
   if (width & 1) {
     gint i = width - 1;
@@ -5921,25 +5714,14 @@ pack_P012_LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
     const gint stride[GST_VIDEO_MAX_PLANES], GstVideoChromaSite chroma_site,
     gint y, gint width)
 {
-  int i;
   gint uv = GET_UV_420 (y, flags);
   guint16 *restrict dy = GET_PLANE_LINE (0, y);
   guint16 *restrict duv = GET_PLANE_LINE (1, uv);
-  guint16 Y0, Y1, U, V;
+  guint16 Y0, U, V;
   const guint16 *restrict s = src;
 
   if (IS_CHROMA_LINE_420 (y, flags)) {
-    for (i = 0; i < width / 2; i++) {
-      Y0 = s[i * 8 + 1] & 0xfff0;
-      Y1 = s[i * 8 + 5] & 0xfff0;
-      U = s[i * 8 + 2] & 0xfff0;
-      V = s[i * 8 + 3] & 0xfff0;
-
-      GST_WRITE_UINT16_LE (dy + i * 2 + 0, Y0);
-      GST_WRITE_UINT16_LE (dy + i * 2 + 1, Y1);
-      GST_WRITE_UINT16_LE (duv + i * 2 + 0, U);
-      GST_WRITE_UINT16_LE (duv + i * 2 + 1, V);
-    }
+    gst_video_simd_get_funcs ()->pack_P016 (dy, duv, s, 12, width / 2);
     if (width & 1) {
       gint i = width - 1;
 
@@ -5952,10 +5734,7 @@ pack_P012_LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
       GST_WRITE_UINT16_LE (duv + i + 1, V);
     }
   } else {
-    for (i = 0; i < width; i++) {
-      Y0 = s[i * 4 + 1] & 0xfff0;
-      GST_WRITE_UINT16_LE (dy + i, Y0);
-    }
+    gst_video_simd_get_funcs ()->pack_Y16 (dy, s, 12, TRUE, width);
   }
 }
 
@@ -6095,28 +5874,8 @@ unpack_Y212_LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
     width--;
   }
 
-  for (i = 0; i < width / 2; i++) {
-    Y0 = GST_READ_UINT16_LE (s + i * 8 + 0);
-    U = GST_READ_UINT16_LE (s + i * 8 + 2);
-    V = GST_READ_UINT16_LE (s + i * 8 + 6);
-    Y1 = GST_READ_UINT16_LE (s + i * 8 + 4);
-
-    if (!(flags & GST_VIDEO_PACK_FLAG_TRUNCATE_RANGE)) {
-      Y0 |= (Y0 >> 12);
-      U |= (U >> 12);
-      V |= (V >> 12);
-    }
-
-    d[i * 8 + 0] = 0xffff;
-    d[i * 8 + 1] = Y0;
-    d[i * 8 + 2] = U;
-    d[i * 8 + 3] = V;
-
-    d[i * 8 + 4] = 0xffff;
-    d[i * 8 + 5] = Y1;
-    d[i * 8 + 6] = U;
-    d[i * 8 + 7] = V;
-  }
+  gst_video_simd_get_funcs ()->unpack_Y216 (d, s, 12,
+      !(flags & GST_VIDEO_PACK_FLAG_TRUNCATE_RANGE), width / 2);
 
   if (width & 1) {
     i = width - 1;
@@ -6145,22 +5904,22 @@ pack_Y212_LE (const GstVideoFormatInfo * info, GstVideoPackFlags flags,
     gint y, gint width)
 {
   int i;
-  guint16 Y0, Y1, U, V;
+  guint16 Y0, U, V;
   guint8 *restrict d = GET_LINE (y);
   const guint16 *restrict s = src;
 
-  for (i = 0; i < width; i += 2) {
+  gst_video_simd_get_funcs ()->pack_Y216 (d, s, 12, width / 2);
+
+  if (width & 1) {
+    i = width - 1;
+
     Y0 = s[i * 4 + 1] & 0xfff0;
     U = s[i * 4 + 2] & 0xfff0;
     V = s[i * 4 + 3] & 0xfff0;
-    if (i == width - 1)
-      Y1 = s[i * 4 + 1] & 0xfff0;
-    else
-      Y1 = s[(i + 1) * 4 + 1] & 0xfff0;
 
     GST_WRITE_UINT16_LE (d + i * 4 + 0, Y0);
     GST_WRITE_UINT16_LE (d + i * 4 + 2, U);
-    GST_WRITE_UINT16_LE (d + i * 4 + 4, Y1);
+    GST_WRITE_UINT16_LE (d + i * 4 + 4, Y0);
     GST_WRITE_UINT16_LE (d + i * 4 + 6, V);
   }
 }
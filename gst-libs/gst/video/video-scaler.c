@@ -82,11 +82,16 @@ typedef void (*GstVideoScalerVFunc) (GstVideoScaler * scale,
     gpointer srcs[], gpointer dest, guint dest_offset, guint width,
     guint n_elems);
 
+typedef struct _GstVideoScalerTables GstVideoScalerTables;
+
 struct _GstVideoScaler
 {
   GstVideoResamplerMethod method;
   GstVideoScalerFlags flags;
 
+  /* shared tables, the resampler and the integer coefficients are owned by
+   * them when set */
+  GstVideoScalerTables *tables;
   GstVideoResampler resampler;
 
   gboolean merged;
@@ -192,6 +197,245 @@ scaler_dump (GstVideoScaler * scale)
 
 #define INTERLACE_SHIFT 0.5
 
+/* Scalers with the same parameters have the same resampler and integer
+ * coefficient tables. The tables are never modified after they are made, so
+ * we keep them in a process-wide cache and share them between all scalers.
+ * Some unused tables are kept around for when a converter is freed and a new
+ * one with the same parameters is made right after, like on renegotiation. */
+#define MAX_UNUSED_TABLES 32
+
+enum
+{
+  OPT_SHARPNESS = (1 << 0),
+  OPT_SHARPEN = (1 << 1),
+  OPT_ENVELOPE = (1 << 2),
+  OPT_CUBIC_B = (1 << 3),
+  OPT_CUBIC_C = (1 << 4),
+  OPT_MAX_TAPS = (1 << 5),
+};
+
+typedef struct
+{
+  GstVideoResamplerMethod method;
+  GstVideoScalerFlags flags;
+  guint n_taps;
+  guint in_size;
+  guint out_size;
+
+  /* the resampler options, only valid when set in opts */
+  guint opts;
+  gdouble sharpness;
+  gdouble sharpen;
+  gdouble envelope;
+  gdouble cubic_b;
+  gdouble cubic_c;
+  gint max_taps;
+} GstVideoScalerTablesKey;
+
+typedef struct
+{
+  gint n_elems;
+  gint precision;
+
+  gint16 *taps_s16;
+  gint16 *taps_s16_4;
+  guint32 *offset_n;
+} GstVideoScalerS16Taps;
+
+struct _GstVideoScalerTables
+{
+  GstVideoScalerTablesKey key;
+  gint refcount;
+
+  GstVideoResampler resampler;
+  GSList *s16_taps;
+};
+
+G_LOCK_DEFINE_STATIC (tables_lock);
+static GHashTable *tables_cache;
+static GQueue tables_unused = G_QUEUE_INIT;
+
+static guint
+tables_key_hash (gconstpointer data)
+{
+  const GstVideoScalerTablesKey *key = data;
+
+  return (key->in_size * 31 + key->out_size) * 31 +
+      (key->method << 8) + (key->flags << 4) + key->n_taps;
+}
+
+static gboolean
+tables_key_equal (gconstpointer a, gconstpointer b)
+{
+  const GstVideoScalerTablesKey *ka = a, *kb = b;
+
+  return ka->method == kb->method && ka->flags == kb->flags &&
+      ka->n_taps == kb->n_taps && ka->in_size == kb->in_size &&
+      ka->out_size == kb->out_size && ka->opts == kb->opts &&
+      ka->sharpness == kb->sharpness && ka->sharpen == kb->sharpen &&
+      ka->envelope == kb->envelope && ka->cubic_b == kb->cubic_b &&
+      ka->cubic_c == kb->cubic_c && ka->max_taps == kb->max_taps;
+}
+
+static void
+tables_key_init (GstVideoScalerTablesKey * key,
+    GstVideoResamplerMethod method, GstVideoScalerFlags flags, guint n_taps,
+    guint in_size, guint out_size, GstStructure * options)
+{
+  memset (key, 0, sizeof (GstVideoScalerTablesKey));
+  key->method = method;
+  key->flags = flags;
+  key->n_taps = n_taps;
+  key->in_size = in_size;
+  key->out_size = out_size;
+
+  if (options == NULL)
+    return;
+
+  if (gst_structure_get_double (options, GST_VIDEO_RESAMPLER_OPT_SHARPNESS,
+          &key->sharpness))
+    key->opts |= OPT_SHARPNESS;
+  if (gst_structure_get_double (options, GST_VIDEO_RESAMPLER_OPT_SHARPEN,
+          &key->sharpen))
+    key->opts |= OPT_SHARPEN;
+  if (gst_structure_get_double (options, GST_VIDEO_RESAMPLER_OPT_ENVELOPE,
+          &key->envelope))
+    key->opts |= OPT_ENVELOPE;
+  if (gst_structure_get_double (options, GST_VIDEO_RESAMPLER_OPT_CUBIC_B,
+          &key->cubic_b))
+    key->opts |= OPT_CUBIC_B;
+  if (gst_structure_get_double (options, GST_VIDEO_RESAMPLER_OPT_CUBIC_C,
+          &key->cubic_c))
+    key->opts |= OPT_CUBIC_C;
+  if (gst_structure_get_int (options, GST_VIDEO_RESAMPLER_OPT_MAX_TAPS,
+          &key->max_taps))
+    key->opts |= OPT_MAX_TAPS;
+}
+
+static void
+tables_free (GstVideoScalerTables * tables)
+{
+  GSList *l;
+
+  for (l = tables->s16_taps; l; l = l->next) {
+    GstVideoScalerS16Taps *t = l->data;
+
+    g_free (t->taps_s16);
+    g_free (t->taps_s16_4);
+    g_free (t->offset_n);
+    g_slice_free (GstVideoScalerS16Taps, t);
+  }
+  g_slist_free (tables->s16_taps);
+  gst_video_resampler_clear (&tables->resampler);
+  g_slice_free (GstVideoScalerTables, tables);
+}
+
+static void
+tables_make_resampler (GstVideoScalerTables * tables, GstStructure * options)
+{
+  const GstVideoScalerTablesKey *key = &tables->key;
+  GstVideoResamplerMethod method = key->method;
+  guint n_taps = key->n_taps, in_size = key->in_size;
+  guint out_size = key->out_size;
+
+  if (key->flags & GST_VIDEO_SCALER_FLAG_INTERLACED) {
+    GstVideoResampler tresamp, bresamp;
+    gdouble shift;
+
+    shift = (INTERLACE_SHIFT * out_size) / in_size;
+
+    gst_video_resampler_init (&tresamp, method,
+        GST_VIDEO_RESAMPLER_FLAG_HALF_TAPS, (out_size + 1) / 2, n_taps, shift,
+        (in_size + 1) / 2, (out_size + 1) / 2, options);
+
+    n_taps = tresamp.max_taps;
+
+    gst_video_resampler_init (&bresamp, method, 0, out_size - tresamp.out_size,
+        n_taps, -shift, in_size - tresamp.in_size,
+        out_size - tresamp.out_size, options);
+
+    resampler_zip (&tables->resampler, &tresamp, &bresamp);
+    gst_video_resampler_clear (&tresamp);
+    gst_video_resampler_clear (&bresamp);
+  } else {
+    gst_video_resampler_init (&tables->resampler, method,
+        GST_VIDEO_RESAMPLER_FLAG_NONE, out_size, n_taps, 0.0, in_size, out_size,
+        options);
+  }
+}
+
+/* Get the tables for the given parameters from the cache, making them when
+ * they are not there yet. */
+static GstVideoScalerTables *
+tables_get (GstVideoResamplerMethod method, GstVideoScalerFlags flags,
+    guint n_taps, guint in_size, guint out_size, GstStructure * options)
+{
+  GstVideoScalerTablesKey key;
+  GstVideoScalerTables *tables;
+
+  tables_key_init (&key, method, flags, n_taps, in_size, out_size, options);
+
+  G_LOCK (tables_lock);
+  if (tables_cache == NULL)
+    tables_cache = g_hash_table_new (tables_key_hash, tables_key_equal);
+
+  tables = g_hash_table_lookup (tables_cache, &key);
+  if (tables) {
+    if (tables->refcount++ == 0)
+      g_queue_remove (&tables_unused, tables);
+    G_UNLOCK (tables_lock);
+
+    GST_DEBUG ("reusing tables %p", tables);
+    return tables;
+  }
+  G_UNLOCK (tables_lock);
+
+  /* make the tables without the lock, another thread might make the same
+   * tables at the same time, we keep the first one */
+  tables = g_slice_new0 (GstVideoScalerTables);
+  tables->key = key;
+  tables->refcount = 1;
+  tables_make_resampler (tables, options);
+
+  G_LOCK (tables_lock);
+  {
+    GstVideoScalerTables *other = g_hash_table_lookup (tables_cache, &key);
+
+    if (other) {
+      if (other->refcount++ == 0)
+        g_queue_remove (&tables_unused, other);
+      G_UNLOCK (tables_lock);
+      tables_free (tables);
+      return other;
+    }
+  }
+  g_hash_table_insert (tables_cache, &tables->key, tables);
+  G_UNLOCK (tables_lock);
+
+  GST_DEBUG ("made tables %p", tables);
+
+  return tables;
+}
+
+static void
+tables_unref (GstVideoScalerTables * tables)
+{
+  GstVideoScalerTables *old = NULL;
+
+  G_LOCK (tables_lock);
+  if (--tables->refcount == 0) {
+    g_queue_push_head (&tables_unused, tables);
+    if (tables_unused.length > MAX_UNUSED_TABLES) {
+      old = g_queue_pop_tail (&tables_unused);
+      g_hash_table_remove (tables_cache, &old->key);
+    }
+  }
+  G_UNLOCK (tables_lock);
+
+  if (old)
+    tables_free (old);
+}
+
 /**
  * gst_video_scaler_new: (skip)
  * @method: a #GstVideoResamplerMethod
@@ -226,30 +470,9 @@ gst_video_scaler_new (GstVideoResamplerMethod method, GstVideoScalerFlags flags,
   scale->method = method;
   scale->flags = flags;
 
-  if (flags & GST_VIDEO_SCALER_FLAG_INTERLACED) {
-    GstVideoResampler tresamp, bresamp;
-    gdouble shift;
-
-    shift = (INTERLACE_SHIFT * out_size) / in_size;
-
-    gst_video_resampler_init (&tresamp, method,
-        GST_VIDEO_RESAMPLER_FLAG_HALF_TAPS, (out_size + 1) / 2, n_taps, shift,
-        (in_size + 1) / 2, (out_size + 1) / 2, options);
-
-    n_taps = tresamp.max_taps;
-
-    gst_video_resampler_init (&bresamp, method, 0, out_size - tresamp.out_size,
-        n_taps, -shift, in_size - tresamp.in_size,
-        out_size - tresamp.out_size, options);
-
-    resampler_zip (&scale->resampler, &tresamp, &bresamp);
-    gst_video_resampler_clear (&tresamp);
-    gst_video_resampler_clear (&bresamp);
-  } else {
-    gst_video_resampler_init (&scale->resampler, method,
-        GST_VIDEO_RESAMPLER_FLAG_NONE, out_size, n_taps, 0.0, in_size, out_size,
-        options);
-  }
+  scale->tables = tables_get (method, flags, n_taps, in_size, out_size,
+      options);
+  scale->resampler = scale->tables->resampler;
 
   if (out_size == 1)
     scale->inc = 0;
@@ -273,10 +496,14 @@ gst_video_scaler_free (GstVideoScaler * scale)
 {
   g_return_if_fail (scale != NULL);
 
-  gst_video_resampler_clear (&scale->resampler);
-  g_free (scale->taps_s16);
-  g_free (scale->taps_s16_4);
-  g_free (scale->offset_n);
+  if (scale->tables) {
+    tables_unref (scale->tables);
+  } else {
+    gst_video_resampler_clear (&scale->resampler);
+    g_free (scale->taps_s16);
+    g_free (scale->taps_s16_4);
+    g_free (scale->offset_n);
+  }
   g_free (scale->tmpline1);
   g_free (scale->tmpline2);
   g_slice_free (GstVideoScaler, scale);
@@ -388,7 +615,7 @@ resampler_convert_coeff (const gdouble * src,
 }
 
 static void
-make_s16_taps (GstVideoScaler * scale, gint n_elems, gint precision)
+calculate_s16_taps (GstVideoScaler * scale, gint n_elems, gint precision)
 {
   gint i, j, max_taps, n_phases, out_size, src_inc;
   gint16 *taps_s16, *taps_s16_4;
@@ -448,6 +675,43 @@ make_s16_taps (GstVideoScaler * scale, gint n_elems, gint precision)
   }
 }
 
+/* use the integer coefficients of the shared tables, making them when
+ * needed */
+static void
+make_s16_taps (GstVideoScaler * scale, gint n_elems, gint precision)
+{
+  GstVideoScalerS16Taps *t = NULL;
+  GSList *l;
+
+  if (scale->tables == NULL) {
+    calculate_s16_taps (scale, n_elems, precision);
+    return;
+  }
+
+  G_LOCK (tables_lock);
+  for (l = scale->tables->s16_taps; l; l = l->next) {
+    t = l->data;
+    if (t->n_elems == n_elems && t->precision == precision)
+      break;
+  }
+  if (l == NULL) {
+    calculate_s16_taps (scale, n_elems, precision);
+
+    t = g_slice_new (GstVideoScalerS16Taps);
+    t->n_elems = n_elems;
+    t->precision = precision;
+    t->taps_s16 = scale->taps_s16;
+    t->taps_s16_4 = scale->taps_s16_4;
+    t->offset_n = scale->offset_n;
+    scale->tables->s16_taps = g_slist_prepend (scale->tables->s16_taps, t);
+  }
+  G_UNLOCK (tables_lock);
+
+  scale->taps_s16 = t->taps_s16;
+  scale->taps_s16_4 = t->taps_s16_4;
+  scale->offset_n = t->offset_n;
+}
+
 #undef ACC_SCALE
 
 static void
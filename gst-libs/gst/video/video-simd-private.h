@@ -0,0 +1,95 @@
+/* GStreamer
+ * Copyright (C) <2021> GStreamer developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_VIDEO_SIMD_PRIVATE_H__
+#define __GST_VIDEO_SIMD_PRIVATE_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstVideoSimdFuncs GstVideoSimdFuncs;
+
+/* Line functions that are selected at runtime for the CPU we are running
+ * on. They default to the video-orc functions with the same name, the
+ * unpack/pack functions take the same arguments as the orc functions. */
+struct _GstVideoSimdFuncs
+{
+  void (*unpack_I420) (guint8 * d, const guint8 * y, const guint8 * u,
+      const guint8 * v, int n);
+  void (*pack_I420) (guint8 * y, guint8 * u, guint8 * v, const guint8 * s,
+      int n);
+  void (*unpack_YUY2) (guint8 * d, const guint8 * s, int n);
+  void (*pack_YUY2) (guint8 * d, const guint8 * s, int n);
+  void (*unpack_NV12) (guint8 * d, const guint8 * y, const guint8 * uv,
+      int n);
+  void (*pack_NV12) (guint8 * y, guint8 * uv, const guint8 * s, int n);
+  void (*unpack_BGRA) (guint8 * d, const guint8 * s, int n);
+  void (*pack_BGRA) (guint8 * d, const guint8 * s, int n);
+
+  /* matrix8 takes the packed coefficients of video_orc_matrix8(), matrix16
+   * the 4x4 integer matrix of the converter */
+  void (*matrix8) (guint8 * d, const guint8 * s, gint64 p1, gint64 p2,
+      gint64 p3, gint64 p4, int n);
+  void (*matrix16) (guint16 * d, const guint16 * s, const gint * im, int n);
+
+  /* formats with @bits significant bits in 16 bit little endian words. The
+   * planar (I420_16) formats store the samples in the low bits, the others
+   * in the high bits. With @expand the high bits of the unpacked samples are
+   * replicated into the low bits. n is the number of pixel pairs, except for
+   * pack_Y16 where it is the number of pixels */
+  void (*unpack_I420_16) (guint16 * d, const guint16 * y, const guint16 * u,
+      const guint16 * v, gint bits, gboolean expand, int n);
+  void (*pack_I420_16) (guint16 * y, guint16 * u, guint16 * v,
+      const guint16 * s, gint bits, int n);
+  void (*pack_Y16) (guint16 * y, const guint16 * s, gint bits, gboolean msb,
+      int n);
+  void (*unpack_P016) (guint16 * d, const guint16 * y, const guint16 * uv,
+      gint bits, gboolean expand, int n);
+  void (*pack_P016) (guint16 * y, guint16 * uv, const guint16 * s,
+      gint bits, int n);
+  void (*unpack_Y216) (guint16 * d, const guint8 * s, gint bits,
+      gboolean expand, int n);
+  void (*pack_Y216) (guint8 * d, const guint16 * s, gint bits, int n);
+
+  /* 10 bit packed formats, n is the number of 6 pixel groups for v210 and
+   * the number of pixel pairs for UYVP */
+  void (*unpack_v210) (guint16 * d, const guint8 * s, gboolean expand, int n);
+  void (*pack_v210) (guint8 * d, const guint16 * s, int n);
+  void (*unpack_UYVP) (guint16 * d, const guint8 * s, gboolean expand, int n);
+  void (*pack_UYVP) (guint8 * d, const guint16 * s, int n);
+
+  /* map the 3 color components of n ARGB64/AYUV64 pixels through a 3D
+   * table with tetrahedral interpolation, alpha is copied. The table has
+   * (1 << bits) + 1 points per axis, indexed by the first, second and third
+   * component with the third one varying fastest, and 4 values per point of
+   * which the last is unused. @d and @s can be the same. */
+  void (*lut3d) (guint16 * d, const guint16 * s, const guint16 * lut,
+      gint bits, int n);
+};
+
+G_GNUC_INTERNAL
+const GstVideoSimdFuncs * gst_video_simd_get_funcs (void);
+
+G_GNUC_INTERNAL
+const GstVideoSimdFuncs * gst_video_simd_get_default_funcs (void);
+
+G_END_DECLS
+
+#endif /* __GST_VIDEO_SIMD_PRIVATE_H__ */
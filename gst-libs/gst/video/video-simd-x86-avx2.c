@@ -0,0 +1,1072 @@
+/* GStreamer
+ * Copyright (C) <2021> GStreamer developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "video-simd-x86-avx2.h"
+
+#if defined (HAVE_IMMINTRIN_H) && defined (__AVX2__)
+
+#include <immintrin.h>
+
+/* All functions produce exactly the same output as the video-orc functions
+ * they replace, the remaining pixels that don't fill a vector are handled
+ * with the same C code as the orc backup functions. */
+
+#define LOADU128(p) _mm_loadu_si128 ((const __m128i *) (p))
+#define LOADU256(p) _mm256_loadu_si256 ((const __m256i *) (p))
+#define STOREU128(p,v) _mm_storeu_si128 ((__m128i *) (p), v)
+#define STOREU256(p,v) _mm256_storeu_si256 ((__m256i *) (p), v)
+
+/* combine alpha/Y words with U/V words that are shared by 2 pixels into
+ * 16 AYUV pixels */
+static inline void
+store_ayuv_16 (guint8 * d, __m128i y, __m128i uv)
+{
+  __m256i ay, ay_lo, ay_hi, uv32, uv_lo, uv_hi;
+
+  /* words with 0xff in the low byte and Y in the high byte */
+  ay = _mm256_cvtepu8_epi16 (y);
+  ay = _mm256_or_si256 (_mm256_slli_epi16 (ay, 8), _mm256_set1_epi16 (0xff));
+  ay_lo = _mm256_cvtepu16_epi32 (_mm256_castsi256_si128 (ay));
+  ay_hi = _mm256_cvtepu16_epi32 (_mm256_extracti128_si256 (ay, 1));
+
+  /* each UV word is used for 2 pixels */
+  uv32 = _mm256_slli_epi32 (_mm256_cvtepu16_epi32 (uv), 16);
+  uv_lo = _mm256_permutevar8x32_epi32 (uv32,
+      _mm256_setr_epi32 (0, 0, 1, 1, 2, 2, 3, 3));
+  uv_hi = _mm256_permutevar8x32_epi32 (uv32,
+      _mm256_setr_epi32 (4, 4, 5, 5, 6, 6, 7, 7));
+
+  STOREU256 (d, _mm256_or_si256 (ay_lo, uv_lo));
+  STOREU256 (d + 32, _mm256_or_si256 (ay_hi, uv_hi));
+}
+
+/* extract 8 Y bytes and 4 interleaved UV pairs from 8 AYUV pixels, the Y
+ * bytes end up in the low and the UV pairs in the high 64 bits */
+static inline __m128i
+load_y_uv_8 (const guint8 * s)
+{
+  const __m256i shuf = _mm256_setr_epi8 (1, 5, 9, 13, 2, 3, 10, 11,
+      -1, -1, -1, -1, -1, -1, -1, -1,
+      1, 5, 9, 13, 2, 3, 10, 11,
+      -1, -1, -1, -1, -1, -1, -1, -1);
+  __m256i t;
+
+  t = _mm256_shuffle_epi8 (LOADU256 (s), shuf);
+  t = _mm256_permutevar8x32_epi32 (t,
+      _mm256_setr_epi32 (0, 4, 1, 5, 2, 3, 6, 7));
+
+  return _mm256_castsi256_si128 (t);
+}
+
+void
+video_simd_unpack_I420_avx2 (guint8 * d, const guint8 * y, const guint8 * u,
+    const guint8 * v, int n)
+{
+  int i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    __m128i uv;
+
+    uv = _mm_unpacklo_epi8 (_mm_loadl_epi64 ((const __m128i *) (u + i / 2)),
+        _mm_loadl_epi64 ((const __m128i *) (v + i / 2)));
+    store_ayuv_16 (d + i * 4, LOADU128 (y + i), uv);
+  }
+  for (; i < n; i++) {
+    d[i * 4 + 0] = 0xff;
+    d[i * 4 + 1] = y[i];
+    d[i * 4 + 2] = u[i >> 1];
+    d[i * 4 + 3] = v[i >> 1];
+  }
+}
+
+void
+video_simd_pack_I420_avx2 (guint8 * y, guint8 * u, guint8 * v,
+    const guint8 * s, int n)
+{
+  const __m128i deinterleave = _mm_setr_epi8 (0, 2, 4, 6, 8, 10, 12, 14,
+      1, 3, 5, 7, 9, 11, 13, 15);
+  int i = 0;
+
+  /* n is the number of pixel pairs */
+  for (; i + 8 <= n; i += 8) {
+    __m128i t0, t1, uv;
+
+    t0 = load_y_uv_8 (s + i * 8);
+    t1 = load_y_uv_8 (s + i * 8 + 32);
+
+    STOREU128 (y + i * 2, _mm_unpacklo_epi64 (t0, t1));
+    uv = _mm_shuffle_epi8 (_mm_unpackhi_epi64 (t0, t1), deinterleave);
+    _mm_storel_epi64 ((__m128i *) (u + i), uv);
+    _mm_storel_epi64 ((__m128i *) (v + i), _mm_srli_si128 (uv, 8));
+  }
+  for (; i < n; i++) {
+    y[i * 2 + 0] = s[i * 8 + 1];
+    y[i * 2 + 1] = s[i * 8 + 5];
+    u[i] = s[i * 8 + 2];
+    v[i] = s[i * 8 + 3];
+  }
+}
+
+void
+video_simd_unpack_YUY2_avx2 (guint8 * d, const guint8 * s, int n)
+{
+  const __m256i shuf = _mm256_setr_epi8 (-1, 0, 1, 3, -1, 2, 1, 3,
+      -1, 4, 5, 7, -1, 6, 5, 7,
+      -1, 8, 9, 11, -1, 10, 9, 11,
+      -1, 12, 13, 15, -1, 14, 13, 15);
+  const __m256i alpha = _mm256_set1_epi32 (0xff);
+  int i = 0;
+
+  /* n is the number of pixel pairs */
+  for (; i + 4 <= n; i += 4) {
+    __m256i t;
+
+    t = _mm256_broadcastsi128_si256 (LOADU128 (s + i * 4));
+    t = _mm256_or_si256 (_mm256_shuffle_epi8 (t, shuf), alpha);
+    STOREU256 (d + i * 8, t);
+  }
+  for (; i < n; i++) {
+    d[i * 8 + 0] = 0xff;
+    d[i * 8 + 1] = s[i * 4 + 0];
+    d[i * 8 + 2] = s[i * 4 + 1];
+    d[i * 8 + 3] = s[i * 4 + 3];
+    d[i * 8 + 4] = 0xff;
+    d[i * 8 + 5] = s[i * 4 + 2];
+    d[i * 8 + 6] = s[i * 4 + 1];
+    d[i * 8 + 7] = s[i * 4 + 3];
+  }
+}
+
+void
+video_simd_pack_YUY2_avx2 (guint8 * d, const guint8 * s, int n)
+{
+  const __m256i shuf = _mm256_setr_epi8 (1, 2, 5, 3, 9, 10, 13, 11,
+      -1, -1, -1, -1, -1, -1, -1, -1,
+      1, 2, 5, 3, 9, 10, 13, 11,
+      -1, -1, -1, -1, -1, -1, -1, -1);
+  int i = 0;
+
+  /* n is the number of pixel pairs */
+  for (; i + 4 <= n; i += 4) {
+    __m256i t;
+
+    t = _mm256_shuffle_epi8 (LOADU256 (s + i * 8), shuf);
+    t = _mm256_permute4x64_epi64 (t, 0x08);
+    STOREU128 (d + i * 4, _mm256_castsi256_si128 (t));
+  }
+  for (; i < n; i++) {
+    d[i * 4 + 0] = s[i * 8 + 1];
+    d[i * 4 + 1] = s[i * 8 + 2];
+    d[i * 4 + 2] = s[i * 8 + 5];
+    d[i * 4 + 3] = s[i * 8 + 3];
+  }
+}
+
+void
+video_simd_unpack_NV12_avx2 (guint8 * d, const guint8 * y, const guint8 * uv,
+    int n)
+{
+  int i = 0;
+
+  /* n is the number of pixel pairs */
+  for (; i + 8 <= n; i += 8)
+    store_ayuv_16 (d + i * 8, LOADU128 (y + i * 2), LOADU128 (uv + i * 2));
+
+  for (; i < n; i++) {
+    d[i * 8 + 0] = 0xff;
+    d[i * 8 + 1] = y[i * 2 + 0];
+    d[i * 8 + 2] = uv[i * 2 + 0];
+    d[i * 8 + 3] = uv[i * 2 + 1];
+    d[i * 8 + 4] = 0xff;
+    d[i * 8 + 5] = y[i * 2 + 1];
+    d[i * 8 + 6] = uv[i * 2 + 0];
+    d[i * 8 + 7] = uv[i * 2 + 1];
+  }
+}
+
+void
+video_simd_pack_NV12_avx2 (guint8 * y, guint8 * uv, const guint8 * s, int n)
+{
+  int i = 0;
+
+  /* n is the number of pixel pairs */
+  for (; i + 8 <= n; i += 8) {
+    __m128i t0, t1;
+
+    t0 = load_y_uv_8 (s + i * 8);
+    t1 = load_y_uv_8 (s + i * 8 + 32);
+
+    STOREU128 (y + i * 2, _mm_unpacklo_epi64 (t0, t1));
+    STOREU128 (uv + i * 2, _mm_unpackhi_epi64 (t0, t1));
+  }
+  for (; i < n; i++) {
+    y[i * 2 + 0] = s[i * 8 + 1];
+    y[i * 2 + 1] = s[i * 8 + 5];
+    uv[i * 2 + 0] = s[i * 8 + 2];
+    uv[i * 2 + 1] = s[i * 8 + 3];
+  }
+}
+
+/* reverses the bytes of each pixel, used for both BGRA -> ARGB and
+ * ARGB -> BGRA */
+void
+video_simd_swap_BGRA_avx2 (guint8 * d, const guint8 * s, int n)
+{
+  const __m256i shuf = _mm256_setr_epi8 (3, 2, 1, 0, 7, 6, 5, 4,
+      11, 10, 9, 8, 15, 14, 13, 12,
+      3, 2, 1, 0, 7, 6, 5, 4,
+      11, 10, 9, 8, 15, 14, 13, 12);
+  int i = 0;
+
+  for (; i + 8 <= n; i += 8)
+    STOREU256 (d + i * 4, _mm256_shuffle_epi8 (LOADU256 (s + i * 4), shuf));
+
+  for (; i < n; i++) {
+    guint8 t0 = s[i * 4 + 0], t1 = s[i * 4 + 1];
+
+    d[i * 4 + 0] = s[i * 4 + 3];
+    d[i * 4 + 1] = s[i * 4 + 2];
+    d[i * 4 + 2] = t1;
+    d[i * 4 + 3] = t0;
+  }
+}
+
+#define MATRIX_SCALE 8
+
+/* same as video_converter_matrix16(), the alpha word is copied */
+void
+video_simd_matrix16_avx2 (guint16 * d, const guint16 * s, const gint * im,
+    int n)
+{
+  const __m256i split = _mm256_setr_epi32 (0, 2, 4, 6, 1, 3, 5, 7);
+  const __m256i merge = _mm256_setr_epi32 (0, 4, 1, 5, 2, 6, 3, 7);
+  __m256i ma[3][4], mask, zero, max;
+  int i = 0, j;
+
+  for (j = 0; j < 3; j++) {
+    ma[j][0] = _mm256_set1_epi32 (im[j * 4 + 0]);
+    ma[j][1] = _mm256_set1_epi32 (im[j * 4 + 1]);
+    ma[j][2] = _mm256_set1_epi32 (im[j * 4 + 2]);
+    ma[j][3] = _mm256_set1_epi32 (im[j * 4 + 3]);
+  }
+  mask = _mm256_set1_epi32 (0xffff);
+  zero = _mm256_setzero_si256 ();
+  max = _mm256_set1_epi32 (65535);
+
+  for (; i + 8 <= n; i += 8) {
+    __m256i p0, p1, ar, gb, r, g, b, c[3];
+
+    /* one dword with A and R and one with G and B for each pixel, gather
+     * them in one register each for 8 pixels */
+    p0 = _mm256_permutevar8x32_epi32 (LOADU256 (s + i * 4), split);
+    p1 = _mm256_permutevar8x32_epi32 (LOADU256 (s + i * 4 + 16), split);
+    ar = _mm256_permute2x128_si256 (p0, p1, 0x20);
+    gb = _mm256_permute2x128_si256 (p0, p1, 0x31);
+
+    r = _mm256_srli_epi32 (ar, 16);
+    g = _mm256_and_si256 (gb, mask);
+    b = _mm256_srli_epi32 (gb, 16);
+
+    for (j = 0; j < 3; j++) {
+      c[j] = _mm256_add_epi32 (_mm256_mullo_epi32 (r, ma[j][0]),
+          _mm256_mullo_epi32 (g, ma[j][1]));
+      c[j] = _mm256_add_epi32 (c[j], _mm256_mullo_epi32 (b, ma[j][2]));
+      c[j] = _mm256_srai_epi32 (_mm256_add_epi32 (c[j], ma[j][3]),
+          MATRIX_SCALE);
+      c[j] = _mm256_min_epi32 (_mm256_max_epi32 (c[j], zero), max);
+    }
+
+    ar = _mm256_or_si256 (_mm256_and_si256 (ar, mask),
+        _mm256_slli_epi32 (c[0], 16));
+    gb = _mm256_or_si256 (c[1], _mm256_slli_epi32 (c[2], 16));
+
+    p0 = _mm256_permute2x128_si256 (ar, gb, 0x20);
+    p1 = _mm256_permute2x128_si256 (ar, gb, 0x31);
+    STOREU256 (d + i * 4, _mm256_permutevar8x32_epi32 (p0, merge));
+    STOREU256 (d + i * 4 + 16, _mm256_permutevar8x32_epi32 (p1, merge));
+  }
+
+  for (; i < n; i++) {
+    gint r, g, b, c;
+
+    r = s[i * 4 + 1];
+    g = s[i * 4 + 2];
+    b = s[i * 4 + 3];
+
+    d[i * 4 + 0] = s[i * 4 + 0];
+    for (j = 0; j < 3; j++) {
+      c = (im[j * 4 + 0] * r + im[j * 4 + 1] * g + im[j * 4 + 2] * b +
+          im[j * 4 + 3]) >> MATRIX_SCALE;
+      d[i * 4 + j + 1] = CLAMP (c, 0, 65535);
+    }
+  }
+}
+
+/* The functions for the formats with more than 8 bits per component produce
+ * the same output as the C functions in video-simd.c. */
+
+/* the same 16 byte shuffle for both lanes */
+#define LANES(...) _mm256_setr_epi8 (__VA_ARGS__, __VA_ARGS__)
+
+#define LSB_SHIFT(bits) (16 - (bits))
+#define MSB_MASK(bits) ((0xffff << (16 - (bits))) & 0xffff)
+
+static inline guint16
+read_u16_le (const guint8 * p)
+{
+  return p[0] | (p[1] << 8);
+}
+
+static inline void
+write_u16_le (guint8 * p, guint16 v)
+{
+  p[0] = v & 0xff;
+  p[1] = v >> 8;
+}
+
+/* the shift count to replicate the high bits of @bits bit samples into the
+ * low bits, a count of 16 makes the shift result 0 */
+static inline __m128i
+expand_count (gint bits, gboolean expand)
+{
+  return _mm_cvtsi32_si128 (expand ? bits : 16);
+}
+
+/* combine 16 Y words with 8 U/V word pairs that are shared by 2 pixels into
+ * 16 AYUV64 pixels */
+static inline void
+store_ayuv64_16 (guint16 * d, __m256i y, __m256i uv)
+{
+  const __m256i alpha = _mm256_set1_epi16 (-1);
+  __m256i ay_lo, ay_hi, uv_lo, uv_hi, p0, p1, p2, p3;
+
+  ay_lo = _mm256_unpacklo_epi16 (alpha, y);
+  ay_hi = _mm256_unpackhi_epi16 (alpha, y);
+  uv_lo = _mm256_unpacklo_epi32 (uv, uv);
+  uv_hi = _mm256_unpackhi_epi32 (uv, uv);
+
+  /* pixels 0-1, 2-3, 4-5 and 6-7 in the low lanes, 8-15 in the high lanes */
+  p0 = _mm256_unpacklo_epi32 (ay_lo, uv_lo);
+  p1 = _mm256_unpackhi_epi32 (ay_lo, uv_lo);
+  p2 = _mm256_unpacklo_epi32 (ay_hi, uv_hi);
+  p3 = _mm256_unpackhi_epi32 (ay_hi, uv_hi);
+
+  STOREU256 (d, _mm256_permute2x128_si256 (p0, p1, 0x20));
+  STOREU256 (d + 16, _mm256_permute2x128_si256 (p2, p3, 0x20));
+  STOREU256 (d + 32, _mm256_permute2x128_si256 (p0, p1, 0x31));
+  STOREU256 (d + 48, _mm256_permute2x128_si256 (p2, p3, 0x31));
+}
+
+/* extract 16 Y words and the 8 U/V word pairs of the even pixels from 16
+ * AYUV64 pixels */
+static inline void
+load_y_uv64_16 (const guint16 * s, __m256i * y, __m256i * uv)
+{
+  const __m256i shuf = LANES (2, 3, 10, 11, 4, 5, 6, 7,
+      -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m256i split = _mm256_setr_epi32 (0, 4, 2, 6, 1, 5, 3, 7);
+  __m256i t0, t1, t2, t3, a, b;
+
+  /* Y Y U V of 2 pixels in the low 64 bits of each lane */
+  t0 = _mm256_shuffle_epi8 (LOADU256 (s), shuf);
+  t1 = _mm256_shuffle_epi8 (LOADU256 (s + 16), shuf);
+  t2 = _mm256_shuffle_epi8 (LOADU256 (s + 32), shuf);
+  t3 = _mm256_shuffle_epi8 (LOADU256 (s + 48), shuf);
+
+  a = _mm256_permutevar8x32_epi32 (_mm256_unpacklo_epi64 (t0, t1), split);
+  b = _mm256_permutevar8x32_epi32 (_mm256_unpacklo_epi64 (t2, t3), split);
+
+  *y = _mm256_permute2x128_si256 (a, b, 0x20);
+  *uv = _mm256_permute2x128_si256 (a, b, 0x31);
+}
+
+void
+video_simd_unpack_I420_16_avx2 (guint16 * d, const guint16 * y,
+    const guint16 * u, const guint16 * v, gint bits, gboolean expand, int n)
+{
+  const __m128i lsb = _mm_cvtsi32_si128 (LSB_SHIFT (bits));
+  const __m128i exp = expand_count (bits, expand);
+  int i = 0;
+
+  /* n is the number of pixel pairs */
+  for (; i + 8 <= n; i += 8) {
+    __m128i tu, tv;
+    __m256i ty, tuv;
+
+    tu = LOADU128 (u + i);
+    tv = LOADU128 (v + i);
+    tuv = _mm256_inserti128_si256 (_mm256_castsi128_si256 (_mm_unpacklo_epi16
+            (tu, tv)), _mm_unpackhi_epi16 (tu, tv), 1);
+    ty = LOADU256 (y + i * 2);
+
+    ty = _mm256_sll_epi16 (ty, lsb);
+    ty = _mm256_or_si256 (ty, _mm256_srl_epi16 (ty, exp));
+    tuv = _mm256_sll_epi16 (tuv, lsb);
+    tuv = _mm256_or_si256 (tuv, _mm256_srl_epi16 (tuv, exp));
+
+    store_ayuv64_16 (d + i * 8, ty, tuv);
+  }
+  for (; i < n; i++) {
+    guint16 Y0, Y1, U, V;
+
+    Y0 = y[i * 2 + 0] << LSB_SHIFT (bits);
+    Y1 = y[i * 2 + 1] << LSB_SHIFT (bits);
+    U = u[i] << LSB_SHIFT (bits);
+    V = v[i] << LSB_SHIFT (bits);
+
+    if (expand) {
+      Y0 |= (Y0 >> bits);
+      Y1 |= (Y1 >> bits);
+      U |= (U >> bits);
+      V |= (V >> bits);
+    }
+
+    d[i * 8 + 0] = 0xffff;
+    d[i * 8 + 1] = Y0;
+    d[i * 8 + 2] = U;
+    d[i * 8 + 3] = V;
+    d[i * 8 + 4] = 0xffff;
+    d[i * 8 + 5] = Y1;
+    d[i * 8 + 6] = U;
+    d[i * 8 + 7] = V;
+  }
+}
+
+void
+video_simd_pack_I420_16_avx2 (guint16 * y, guint16 * u, guint16 * v,
+    const guint16 * s, gint bits, int n)
+{
+  const __m256i deinterleave = LANES (0, 1, 4, 5, 8, 9, 12, 13,
+      2, 3, 6, 7, 10, 11, 14, 15);
+  const __m128i lsb = _mm_cvtsi32_si128 (LSB_SHIFT (bits));
+  int i = 0;
+
+  /* n is the number of pixel pairs */
+  for (; i + 8 <= n; i += 8) {
+    __m256i ty, tuv;
+
+    load_y_uv64_16 (s + i * 8, &ty, &tuv);
+
+    STOREU256 (y + i * 2, _mm256_srl_epi16 (ty, lsb));
+    tuv = _mm256_shuffle_epi8 (_mm256_srl_epi16 (tuv, lsb), deinterleave);
+    tuv = _mm256_permute4x64_epi64 (tuv, 0xd8);
+    STOREU128 (u + i, _mm256_castsi256_si128 (tuv));
+    STOREU128 (v + i, _mm256_extracti128_si256 (tuv, 1));
+  }
+  for (; i < n; i++) {
+    y[i * 2 + 0] = s[i * 8 + 1] >> LSB_SHIFT (bits);
+    y[i * 2 + 1] = s[i * 8 + 5] >> LSB_SHIFT (bits);
+    u[i] = s[i * 8 + 2] >> LSB_SHIFT (bits);
+    v[i] = s[i * 8 + 3] >> LSB_SHIFT (bits);
+  }
+}
+
+void
+video_simd_pack_Y16_avx2 (guint16 * y, const guint16 * s, gint bits,
+    gboolean msb, int n)
+{
+  const __m256i mask = _mm256_set1_epi16 (msb ? MSB_MASK (bits) : 0xffff);
+  const __m128i lsb = _mm_cvtsi32_si128 (msb ? 0 : LSB_SHIFT (bits));
+  int i = 0;
+
+  /* n is the number of pixels */
+  for (; i + 16 <= n; i += 16) {
+    __m256i ty, tuv;
+
+    load_y_uv64_16 (s + i * 4, &ty, &tuv);
+    ty = _mm256_and_si256 (_mm256_srl_epi16 (ty, lsb), mask);
+    STOREU256 (y + i, ty);
+  }
+  for (; i < n; i++) {
+    if (msb)
+      y[i] = s[i * 4 + 1] & MSB_MASK (bits);
+    else
+      y[i] = s[i * 4 + 1] >> LSB_SHIFT (bits);
+  }
+}
+
+void
+video_simd_unpack_P016_avx2 (guint16 * d, const guint16 * y,
+    const guint16 * uv, gint bits, gboolean expand, int n)
+{
+  const __m128i exp = expand_count (bits, expand);
+  int i = 0;
+
+  /* n is the number of pixel pairs */
+  for (; i + 8 <= n; i += 8) {
+    __m256i ty, tuv;
+
+    ty = LOADU256 (y + i * 2);
+    ty = _mm256_or_si256 (ty, _mm256_srl_epi16 (ty, exp));
+    tuv = LOADU256 (uv + i * 2);
+    tuv = _mm256_or_si256 (tuv, _mm256_srl_epi16 (tuv, exp));
+
+    store_ayuv64_16 (d + i * 8, ty, tuv);
+  }
+  for (; i < n; i++) {
+    guint16 Y0, Y1, U, V;
+
+    Y0 = y[i * 2 + 0];
+    Y1 = y[i * 2 + 1];
+    U = uv[i * 2 + 0];
+    V = uv[i * 2 + 1];
+
+    if (expand) {
+      Y0 |= (Y0 >> bits);
+      Y1 |= (Y1 >> bits);
+      U |= (U >> bits);
+      V |= (V >> bits);
+    }
+
+    d[i * 8 + 0] = 0xffff;
+    d[i * 8 + 1] = Y0;
+    d[i * 8 + 2] = U;
+    d[i * 8 + 3] = V;
+    d[i * 8 + 4] = 0xffff;
+    d[i * 8 + 5] = Y1;
+    d[i * 8 + 6] = U;
+    d[i * 8 + 7] = V;
+  }
+}
+
+void
+video_simd_pack_P016_avx2 (guint16 * y, guint16 * uv, const guint16 * s,
+    gint bits, int n)
+{
+  const __m256i mask = _mm256_set1_epi16 (MSB_MASK (bits));
+  int i = 0;
+
+  /* n is the number of pixel pairs */
+  for (; i + 8 <= n; i += 8) {
+    __m256i ty, tuv;
+
+    load_y_uv64_16 (s + i * 8, &ty, &tuv);
+    STOREU256 (y + i * 2, _mm256_and_si256 (ty, mask));
+    STOREU256 (uv + i * 2, _mm256_and_si256 (tuv, mask));
+  }
+  for (; i < n; i++) {
+    y[i * 2 + 0] = s[i * 8 + 1] & MSB_MASK (bits);
+    y[i * 2 + 1] = s[i * 8 + 5] & MSB_MASK (bits);
+    uv[i * 2 + 0] = s[i * 8 + 2] & MSB_MASK (bits);
+    uv[i * 2 + 1] = s[i * 8 + 3] & MSB_MASK (bits);
+  }
+}
+
+void
+video_simd_unpack_Y216_avx2 (guint16 * d, const guint8 * s, gint bits,
+    gboolean expand, int n)
+{
+  /* Y0 U Y1 V, the first pair in the low and the second in the high lane */
+  const __m256i shuf = _mm256_setr_epi8 (-1, -1, 0, 1, 2, 3, 6, 7,
+      -1, -1, 4, 5, 2, 3, 6, 7,
+      -1, -1, 8, 9, 10, 11, 14, 15,
+      -1, -1, 12, 13, 10, 11, 14, 15);
+  const __m256i alpha = _mm256_set1_epi64x (0xffff);
+  const __m128i exp = expand_count (bits, expand);
+  int i = 0;
+
+  /* n is the number of pixel pairs */
+  for (; i + 4 <= n; i += 4) {
+    __m256i t, t0, t1;
+
+    t = LOADU256 (s + i * 8);
+    t0 = _mm256_shuffle_epi8 (_mm256_permute4x64_epi64 (t, 0x44), shuf);
+    t1 = _mm256_shuffle_epi8 (_mm256_permute4x64_epi64 (t, 0xee), shuf);
+    t0 = _mm256_or_si256 (t0, _mm256_srl_epi16 (t0, exp));
+    t1 = _mm256_or_si256 (t1, _mm256_srl_epi16 (t1, exp));
+
+    STOREU256 (d + i * 8, _mm256_or_si256 (t0, alpha));
+    STOREU256 (d + i * 8 + 16, _mm256_or_si256 (t1, alpha));
+  }
+  for (; i < n; i++) {
+    guint16 Y0, Y1, U, V;
+
+    Y0 = read_u16_le (s + i * 8 + 0);
+    U = read_u16_le (s + i * 8 + 2);
+    Y1 = read_u16_le (s + i * 8 + 4);
+    V = read_u16_le (s + i * 8 + 6);
+
+    if (expand) {
+      Y0 |= (Y0 >> bits);
+      Y1 |= (Y1 >> bits);
+      U |= (U >> bits);
+      V |= (V >> bits);
+    }
+
+    d[i * 8 + 0] = 0xffff;
+    d[i * 8 + 1] = Y0;
+    d[i * 8 + 2] = U;
+    d[i * 8 + 3] = V;
+    d[i * 8 + 4] = 0xffff;
+    d[i * 8 + 5] = Y1;
+    d[i * 8 + 6] = U;
+    d[i * 8 + 7] = V;
+  }
+}
+
+void
+video_simd_pack_Y216_avx2 (guint8 * d, const guint16 * s, gint bits, int n)
+{
+  const __m256i shuf = LANES (2, 3, 4, 5, 10, 11, 6, 7,
+      -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m256i mask = _mm256_set1_epi16 (MSB_MASK (bits));
+  int i = 0;
+
+  /* n is the number of pixel pairs */
+  for (; i + 4 <= n; i += 4) {
+    __m256i t0, t1, t;
+
+    t0 = _mm256_shuffle_epi8 (LOADU256 (s + i * 8), shuf);
+    t1 = _mm256_shuffle_epi8 (LOADU256 (s + i * 8 + 16), shuf);
+    t = _mm256_permute4x64_epi64 (_mm256_unpacklo_epi64 (t0, t1), 0xd8);
+
+    STOREU256 (d + i * 8, _mm256_and_si256 (t, mask));
+  }
+  for (; i < n; i++) {
+    write_u16_le (d + i * 8 + 0, s[i * 8 + 1] & MSB_MASK (bits));
+    write_u16_le (d + i * 8 + 2, s[i * 8 + 2] & MSB_MASK (bits));
+    write_u16_le (d + i * 8 + 4, s[i * 8 + 5] & MSB_MASK (bits));
+    write_u16_le (d + i * 8 + 6, s[i * 8 + 3] & MSB_MASK (bits));
+  }
+}
+
+/* v210 stores 6 pixels in 4 dwords with 3 10 bit components each:
+ * U0 Y0 V0, Y1 U2 Y2, V2 Y3 U4, Y4 V4 Y5. The components are moved between
+ * the AYUV64 words of 2 pixels per lane and 3 vectors that hold the first,
+ * second and third component of each dword: W (dw) fills an AYUV64 word
+ * from dword dw, D (w) fills a dword from AYUV64 word w. */
+#define W(dw) (dw) * 4, (dw) * 4 + 1
+#define Z -1, -1
+#define D(w) (w) * 2, (w) * 2 + 1, -1, -1
+#define ZZ -1, -1, -1, -1
+
+/* unpack one group of 6 pixels in each lane to 3 vectors with 2 pixels per
+ * lane */
+static inline void
+unpack_v210_12 (__m256i g, __m128i exp, __m256i * o0, __m256i * o1,
+    __m256i * o2)
+{
+  const __m256i o0_c0 = LANES (Z, Z, W (0), Z, Z, W (1), W (0), Z);
+  const __m256i o0_c1 = LANES (Z, W (0), Z, Z, Z, Z, Z, Z);
+  const __m256i o0_c2 = LANES (Z, Z, Z, W (0), Z, Z, Z, W (0));
+  const __m256i o1_c0 = LANES (Z, Z, Z, W (2), Z, Z, Z, W (2));
+  const __m256i o1_c1 = LANES (Z, Z, W (1), Z, Z, W (2), W (1), Z);
+  const __m256i o1_c2 = LANES (Z, W (1), Z, Z, Z, Z, Z, Z);
+  const __m256i o2_c0 = LANES (Z, W (3), Z, Z, Z, Z, Z, Z);
+  const __m256i o2_c1 = LANES (Z, Z, Z, W (3), Z, Z, Z, W (3));
+  const __m256i o2_c2 = LANES (Z, Z, W (2), Z, Z, W (3), W (2), Z);
+  const __m256i mask = _mm256_set1_epi32 (0x3ff);
+  const __m256i alpha = _mm256_set1_epi64x (0xffff);
+  __m256i c0, c1, c2;
+
+  c0 = _mm256_slli_epi32 (_mm256_and_si256 (g, mask), 6);
+  c1 = _mm256_slli_epi32 (_mm256_and_si256 (_mm256_srli_epi32 (g, 10),
+          mask), 6);
+  c2 = _mm256_slli_epi32 (_mm256_and_si256 (_mm256_srli_epi32 (g, 20),
+          mask), 6);
+  c0 = _mm256_or_si256 (c0, _mm256_srl_epi32 (c0, exp));
+  c1 = _mm256_or_si256 (c1, _mm256_srl_epi32 (c1, exp));
+  c2 = _mm256_or_si256 (c2, _mm256_srl_epi32 (c2, exp));
+
+  *o0 = _mm256_or_si256 (_mm256_shuffle_epi8 (c0, o0_c0),
+      _mm256_shuffle_epi8 (c1, o0_c1));
+  *o0 = _mm256_or_si256 (*o0, _mm256_shuffle_epi8 (c2, o0_c2));
+  *o0 = _mm256_or_si256 (*o0, alpha);
+  *o1 = _mm256_or_si256 (_mm256_shuffle_epi8 (c0, o1_c0),
+      _mm256_shuffle_epi8 (c1, o1_c1));
+  *o1 = _mm256_or_si256 (*o1, _mm256_shuffle_epi8 (c2, o1_c2));
+  *o1 = _mm256_or_si256 (*o1, alpha);
+  *o2 = _mm256_or_si256 (_mm256_shuffle_epi8 (c0, o2_c0),
+      _mm256_shuffle_epi8 (c1, o2_c1));
+  *o2 = _mm256_or_si256 (*o2, _mm256_shuffle_epi8 (c2, o2_c2));
+  *o2 = _mm256_or_si256 (*o2, alpha);
+}
+
+/* pack 3 vectors with 2 pixels per lane to one group of 6 pixels in each
+ * lane */
+static inline __m256i
+pack_v210_12 (__m256i p0, __m256i p1, __m256i p2)
+{
+  const __m256i p0_c0 = LANES (D (2), D (5), ZZ, ZZ);
+  const __m256i p0_c1 = LANES (D (1), ZZ, ZZ, ZZ);
+  const __m256i p0_c2 = LANES (D (3), ZZ, ZZ, ZZ);
+  const __m256i p1_c0 = LANES (ZZ, ZZ, D (3), ZZ);
+  const __m256i p1_c1 = LANES (ZZ, D (2), D (5), ZZ);
+  const __m256i p1_c2 = LANES (ZZ, D (1), ZZ, ZZ);
+  const __m256i p2_c0 = LANES (ZZ, ZZ, ZZ, D (1));
+  const __m256i p2_c1 = LANES (ZZ, ZZ, ZZ, D (3));
+  const __m256i p2_c2 = LANES (ZZ, ZZ, D (2), D (5));
+  __m256i c0, c1, c2;
+
+  p0 = _mm256_srli_epi16 (p0, 6);
+  p1 = _mm256_srli_epi16 (p1, 6);
+  p2 = _mm256_srli_epi16 (p2, 6);
+
+  c0 = _mm256_or_si256 (_mm256_shuffle_epi8 (p0, p0_c0),
+      _mm256_shuffle_epi8 (p1, p1_c0));
+  c0 = _mm256_or_si256 (c0, _mm256_shuffle_epi8 (p2, p2_c0));
+  c1 = _mm256_or_si256 (_mm256_shuffle_epi8 (p0, p0_c1),
+      _mm256_shuffle_epi8 (p1, p1_c1));
+  c1 = _mm256_or_si256 (c1, _mm256_shuffle_epi8 (p2, p2_c1));
+  c2 = _mm256_or_si256 (_mm256_shuffle_epi8 (p0, p0_c2),
+      _mm256_shuffle_epi8 (p1, p1_c2));
+  c2 = _mm256_or_si256 (c2, _mm256_shuffle_epi8 (p2, p2_c2));
+
+  c0 = _mm256_or_si256 (c0, _mm256_slli_epi32 (c1, 10));
+  return _mm256_or_si256 (c0, _mm256_slli_epi32 (c2, 20));
+}
+
+#undef W
+#undef Z
+#undef D
+#undef ZZ
+
+void
+video_simd_unpack_v210_avx2 (guint16 * d, const guint8 * s, gboolean expand,
+    int n)
+{
+  const __m128i exp = _mm_cvtsi32_si128 (expand ? 10 : 32);
+  __m256i o0, o1, o2;
+  int i = 0;
+
+  /* n is the number of 6 pixel groups, do 2 per iteration */
+  for (; i + 2 <= n; i += 2) {
+    unpack_v210_12 (LOADU256 (s + i * 16), exp, &o0, &o1, &o2);
+
+    STOREU256 (d + i * 24, _mm256_permute2x128_si256 (o0, o1, 0x20));
+    STOREU256 (d + i * 24 + 16, _mm256_blend_epi32 (o2, o0, 0xf0));
+    STOREU256 (d + i * 24 + 32, _mm256_permute2x128_si256 (o1, o2, 0x31));
+  }
+  /* the last group in the low lane */
+  if (i < n) {
+    unpack_v210_12 (_mm256_castsi128_si256 (LOADU128 (s + i * 16)), exp,
+        &o0, &o1, &o2);
+
+    STOREU128 (d + i * 24, _mm256_castsi256_si128 (o0));
+    STOREU128 (d + i * 24 + 8, _mm256_castsi256_si128 (o1));
+    STOREU128 (d + i * 24 + 16, _mm256_castsi256_si128 (o2));
+  }
+}
+
+void
+video_simd_pack_v210_avx2 (guint8 * d, const guint16 * s, int n)
+{
+  __m256i s0, s1, s2, t;
+  int i = 0;
+
+  /* n is the number of 6 pixel groups, do 2 per iteration */
+  for (; i + 2 <= n; i += 2) {
+    s0 = LOADU256 (s + i * 24);
+    s1 = LOADU256 (s + i * 24 + 16);
+    s2 = LOADU256 (s + i * 24 + 32);
+
+    t = pack_v210_12 (_mm256_blend_epi32 (s0, s1, 0xf0),
+        _mm256_permute2x128_si256 (s0, s2, 0x21),
+        _mm256_blend_epi32 (s1, s2, 0xf0));
+    STOREU256 (d + i * 16, t);
+  }
+  /* the last group in the low lane */
+  if (i < n) {
+    t = pack_v210_12 (_mm256_castsi128_si256 (LOADU128 (s + i * 24)),
+        _mm256_castsi128_si256 (LOADU128 (s + i * 24 + 8)),
+        _mm256_castsi128_si256 (LOADU128 (s + i * 24 + 16)));
+    STOREU128 (d + i * 16, _mm256_castsi256_si128 (t));
+  }
+}
+
+/* UYVP stores 2 pixels as 4 big endian 10 bit components U0 Y0 V0 Y1 in 5
+ * bytes. Each component lies in one big endian byte pair from which it is
+ * shifted into the high bits of the AYUV64 word with a multiplication. */
+void
+video_simd_unpack_UYVP_avx2 (guint16 * d, const guint8 * s, gboolean expand,
+    int n)
+{
+  /* one pair of pixels in each lane, the second starts at byte 5 */
+  const __m256i shuf = _mm256_setr_epi8 (-1, -1, 2, 1, 1, 0, 3, 2,
+      -1, -1, 4, 3, 1, 0, 3, 2,
+      -1, -1, 7, 6, 6, 5, 8, 7,
+      -1, -1, 9, 8, 6, 5, 8, 7);
+  const __m256i mult = _mm256_setr_epi16 (0, 4, 1, 16, 0, 64, 1, 16,
+      0, 4, 1, 16, 0, 64, 1, 16);
+  const __m256i mask = _mm256_set1_epi64x (0xffc0ffc0ffc00000LL);
+  const __m256i alpha = _mm256_set1_epi64x (0xffff);
+  const __m128i exp = _mm_cvtsi32_si128 (expand ? 10 : 16);
+  int i = 0;
+
+  /* n is the number of pixel pairs, 16 bytes are loaded for each 2 pairs */
+  for (; i + 6 <= n; i += 4) {
+    __m256i t0, t1;
+
+    t0 = _mm256_broadcastsi128_si256 (LOADU128 (s + i * 5));
+    t1 = _mm256_broadcastsi128_si256 (LOADU128 (s + i * 5 + 10));
+    t0 = _mm256_mullo_epi16 (_mm256_shuffle_epi8 (t0, shuf), mult);
+    t1 = _mm256_mullo_epi16 (_mm256_shuffle_epi8 (t1, shuf), mult);
+    t0 = _mm256_and_si256 (t0, mask);
+    t1 = _mm256_and_si256 (t1, mask);
+    t0 = _mm256_or_si256 (t0, _mm256_srl_epi16 (t0, exp));
+    t1 = _mm256_or_si256 (t1, _mm256_srl_epi16 (t1, exp));
+
+    STOREU256 (d + i * 8, _mm256_or_si256 (t0, alpha));
+    STOREU256 (d + i * 8 + 16, _mm256_or_si256 (t1, alpha));
+  }
+  for (; i < n; i++) {
+    guint16 y0, y1, u0, v0;
+
+    u0 = ((s[i * 5 + 0] << 2) | (s[i * 5 + 1] >> 6)) << 6;
+    y0 = (((s[i * 5 + 1] & 0x3f) << 4) | (s[i * 5 + 2] >> 4)) << 6;
+    v0 = (((s[i * 5 + 2] & 0x0f) << 6) | (s[i * 5 + 3] >> 2)) << 6;
+    y1 = (((s[i * 5 + 3] & 0x03) << 8) | s[i * 5 + 4]) << 6;
+
+    if (expand) {
+      y0 |= (y0 >> 10);
+      y1 |= (y1 >> 10);
+      u0 |= (u0 >> 10);
+      v0 |= (v0 >> 10);
+    }
+
+    d[i * 8 + 0] = 0xffff;
+    d[i * 8 + 1] = y0;
+    d[i * 8 + 2] = u0;
+    d[i * 8 + 3] = v0;
+    d[i * 8 + 4] = 0xffff;
+    d[i * 8 + 5] = y1;
+    d[i * 8 + 6] = u0;
+    d[i * 8 + 7] = v0;
+  }
+}
+
+void
+video_simd_pack_UYVP_avx2 (guint8 * d, const guint16 * s, int n)
+{
+  /* U0 Y0 V0 Y1 in the low 4 words of each lane */
+  const __m256i order = LANES (4, 5, 2, 3, 6, 7, 10, 11,
+      -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m256i mult = _mm256_setr_epi16 (1 << 10, 1, 1 << 10, 1, 0, 0, 0, 0,
+      1 << 10, 1, 1 << 10, 1, 0, 0, 0, 0);
+  /* the 40 bit value of the first pair to bytes 0-4 and of the second pair
+   * to bytes 5-9 */
+  const __m256i bytes = _mm256_setr_epi8 (4, 3, 2, 1, 0, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, 4, 3, 2,
+      1, 0, -1, -1, -1, -1, -1, -1);
+  int i = 0;
+
+  /* n is the number of pixel pairs, 16 bytes are stored for each 2 pairs and
+   * the bytes after the 10 valid ones are overwritten by the next store */
+  for (; i + 6 <= n; i += 4) {
+    __m256i t0, t1;
+
+    t0 = _mm256_srli_epi16 (LOADU256 (s + i * 8), 6);
+    t1 = _mm256_srli_epi16 (LOADU256 (s + i * 8 + 16), 6);
+
+    /* U << 10 | Y0 and V << 10 | Y1 in 2 dwords */
+    t0 = _mm256_madd_epi16 (_mm256_shuffle_epi8 (t0, order), mult);
+    t1 = _mm256_madd_epi16 (_mm256_shuffle_epi8 (t1, order), mult);
+    /* and combined into 40 bits */
+    t0 = _mm256_or_si256 (_mm256_srli_epi64 (_mm256_slli_epi64 (t0, 32), 12),
+        _mm256_srli_epi64 (t0, 32));
+    t1 = _mm256_or_si256 (_mm256_srli_epi64 (_mm256_slli_epi64 (t1, 32), 12),
+        _mm256_srli_epi64 (t1, 32));
+    t0 = _mm256_shuffle_epi8 (t0, bytes);
+    t1 = _mm256_shuffle_epi8 (t1, bytes);
+
+    STOREU128 (d + i * 5, _mm_or_si128 (_mm256_castsi256_si128 (t0),
+            _mm256_extracti128_si256 (t0, 1)));
+    STOREU128 (d + i * 5 + 10, _mm_or_si128 (_mm256_castsi256_si128 (t1),
+            _mm256_extracti128_si256 (t1, 1)));
+  }
+  for (; i < n; i++) {
+    guint16 y0, y1, u0, v0;
+
+    y0 = s[i * 8 + 1];
+    y1 = s[i * 8 + 5];
+    u0 = s[i * 8 + 2];
+    v0 = s[i * 8 + 3];
+
+    d[i * 5 + 0] = u0 >> 8;
+    d[i * 5 + 1] = (u0 & 0xc0) | y0 >> 10;
+    d[i * 5 + 2] = ((y0 & 0x3c0) >> 2) | (v0 >> 12);
+    d[i * 5 + 3] = ((v0 & 0xfc0) >> 4) | (y1 >> 14);
+    d[i * 5 + 4] = (y1 >> 6);
+  }
+}
+
+static inline void
+lut3d_pixel (guint16 * d, const guint16 * s, const guint16 * lut, gint bits)
+{
+  gint c, size = (1 << bits) + 1;
+  const gint stride[3] = { size * size * 4, size * 4, 4 };
+  const guint16 *v0 = lut, *v1, *v2, *v3;
+  guint pos, idx, f[3];
+  gint hi, lo, mid;
+
+  for (c = 0; c < 3; c++) {
+    pos = (s[c + 1] + (s[c + 1] >> 15)) << bits;
+    idx = MIN (pos >> 16, (1u << bits) - 1);
+    f[c] = (pos - (idx << 16)) >> 4;
+    v0 += idx * stride[c];
+  }
+  if (f[0] >= f[1] && f[0] >= f[2])
+    hi = 0;
+  else if (f[1] >= f[2])
+    hi = 1;
+  else
+    hi = 2;
+  if (f[2] <= f[0] && f[2] <= f[1])
+    lo = 2;
+  else if (f[1] <= f[0])
+    lo = 1;
+  else
+    lo = 0;
+  mid = 3 - hi - lo;
+
+  v1 = v0 + stride[hi];
+  v3 = v0 + stride[0] + stride[1] + stride[2];
+  v2 = v3 - stride[lo];
+
+  d[0] = s[0];
+  for (c = 0; c < 3; c++) {
+    gint r = (v0[c] << 12) + f[hi] * (v1[c] - v0[c]) +
+        f[mid] * (v2[c] - v1[c]) + f[lo] * (v3[c] - v2[c]);
+
+    d[c + 1] = (r + 2048) >> 12;
+  }
+}
+
+/* interpolate the components of 2 pixels, one in each lane, in 32 bits */
+static inline __m256i
+lut3d_interp (__m256i v0, __m256i v1, __m256i v2, __m256i v3, __m256i whi,
+    __m256i wmid, __m256i wlo)
+{
+  __m256i r;
+
+  r = _mm256_slli_epi32 (v0, 12);
+  r = _mm256_add_epi32 (r, _mm256_mullo_epi32 (whi, _mm256_sub_epi32 (v1,
+              v0)));
+  r = _mm256_add_epi32 (r, _mm256_mullo_epi32 (wmid, _mm256_sub_epi32 (v2,
+              v1)));
+  r = _mm256_add_epi32 (r, _mm256_mullo_epi32 (wlo, _mm256_sub_epi32 (v3,
+              v2)));
+
+  return _mm256_srli_epi32 (_mm256_add_epi32 (r, _mm256_set1_epi32 (2048)),
+      12);
+}
+
+void
+video_simd_lut3d_avx2 (guint16 * d, const guint16 * s, const guint16 * lut,
+    gint bits, int n)
+{
+  const gint size = (1 << bits) + 1;
+  const __m128i s0 = _mm_set1_epi32 (size * size);
+  const __m128i s1 = _mm_set1_epi32 (size);
+  const __m128i s2 = _mm_set1_epi32 (1);
+  const __m128i last = _mm_set1_epi32 ((1 << bits) - 1);
+  const __m256i comps = _mm256_setr_epi32 (0, 2, 4, 6, 1, 3, 5, 7);
+  const __m256i bcast_lo = _mm256_setr_epi32 (0, 0, 0, 0, 2, 2, 2, 2);
+  const __m256i bcast_hi = _mm256_setr_epi32 (1, 1, 1, 1, 3, 3, 3, 3);
+  const __m256i zero = _mm256_setzero_si256 ();
+  const long long *table = (const long long *) lut;
+  int i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    __m256i px, t, v[4], w[3], lo, hi;
+    __m128i x[3], pos, idx[3], f[3], gt21;
+    __m128i hi0, hi1, hi2, lo0, lo1, lo2, whi, wlo, wmid, shi, slo, base;
+    gint c;
+
+    px = LOADU256 (s + i * 4);
+    for (c = 0; c < 3; c++) {
+      /* component c + 1 of the 4 pixels in 32 bits */
+      t = _mm256_and_si256 (_mm256_srli_epi64 (px, 16 * (c + 1)),
+          _mm256_set1_epi64x (0xffff));
+      x[c] = _mm256_castsi256_si128 (_mm256_permutevar8x32_epi32 (t, comps));
+
+      /* same as LUT3D_POS */
+      pos = _mm_slli_epi32 (_mm_add_epi32 (x[c], _mm_srli_epi32 (x[c], 15)),
+          bits);
+      idx[c] = _mm_min_epu32 (_mm_srli_epi32 (pos, 16), last);
+      f[c] = _mm_srli_epi32 (_mm_sub_epi32 (pos, _mm_slli_epi32 (idx[c], 16)),
+          4);
+    }
+
+    /* the axis with the largest and smallest fraction, see lut3d_c */
+    hi0 = _mm_andnot_si128 (_mm_or_si128 (_mm_cmpgt_epi32 (f[1], f[0]),
+            _mm_cmpgt_epi32 (f[2], f[0])), _mm_set1_epi32 (-1));
+    gt21 = _mm_cmpgt_epi32 (f[2], f[1]);
+    hi1 = _mm_andnot_si128 (_mm_or_si128 (hi0, gt21), _mm_set1_epi32 (-1));
+    hi2 = _mm_andnot_si128 (_mm_or_si128 (hi0, hi1), _mm_set1_epi32 (-1));
+    lo2 = _mm_andnot_si128 (_mm_or_si128 (_mm_cmpgt_epi32 (f[2], f[0]),
+            gt21), _mm_set1_epi32 (-1));
+    lo1 = _mm_andnot_si128 (_mm_or_si128 (lo2, _mm_cmpgt_epi32 (f[1], f[0])),
+        _mm_set1_epi32 (-1));
+    lo0 = _mm_andnot_si128 (_mm_or_si128 (lo2, lo1), _mm_set1_epi32 (-1));
+
+    whi = _mm_or_si128 (_mm_or_si128 (_mm_and_si128 (hi0, f[0]),
+            _mm_and_si128 (hi1, f[1])), _mm_and_si128 (hi2, f[2]));
+    wlo = _mm_or_si128 (_mm_or_si128 (_mm_and_si128 (lo0, f[0]),
+            _mm_and_si128 (lo1, f[1])), _mm_and_si128 (lo2, f[2]));
+    wmid = _mm_sub_epi32 (_mm_add_epi32 (_mm_add_epi32 (f[0], f[1]), f[2]),
+        _mm_add_epi32 (whi, wlo));
+    shi = _mm_or_si128 (_mm_or_si128 (_mm_and_si128 (hi0, s0),
+            _mm_and_si128 (hi1, s1)), _mm_and_si128 (hi2, s2));
+    slo = _mm_or_si128 (_mm_or_si128 (_mm_and_si128 (lo0, s0),
+            _mm_and_si128 (lo1, s1)), _mm_and_si128 (lo2, s2));
+
+    base = _mm_add_epi32 (_mm_add_epi32 (_mm_mullo_epi32 (idx[0], s0),
+            _mm_mullo_epi32 (idx[1], s1)), idx[2]);
+    v[0] = _mm256_i32gather_epi64 (table, base, 8);
+    v[1] = _mm256_i32gather_epi64 (table, _mm_add_epi32 (base, shi), 8);
+    base = _mm_add_epi32 (base, _mm_add_epi32 (_mm_add_epi32 (s0, s1), s2));
+    v[3] = _mm256_i32gather_epi64 (table, base, 8);
+    v[2] = _mm256_i32gather_epi64 (table, _mm_sub_epi32 (base, slo), 8);
+
+    /* pixels 0 and 2 are in the low words of the lanes, 1 and 3 in the high
+     * words */
+    w[0] = _mm256_castsi128_si256 (whi);
+    w[1] = _mm256_castsi128_si256 (wmid);
+    w[2] = _mm256_castsi128_si256 (wlo);
+    lo = lut3d_interp (_mm256_unpacklo_epi16 (v[0], zero),
+        _mm256_unpacklo_epi16 (v[1], zero),
+        _mm256_unpacklo_epi16 (v[2], zero),
+        _mm256_unpacklo_epi16 (v[3], zero),
+        _mm256_permutevar8x32_epi32 (w[0], bcast_lo),
+        _mm256_permutevar8x32_epi32 (w[1], bcast_lo),
+        _mm256_permutevar8x32_epi32 (w[2], bcast_lo));
+    hi = lut3d_interp (_mm256_unpackhi_epi16 (v[0], zero),
+        _mm256_unpackhi_epi16 (v[1], zero),
+        _mm256_unpackhi_epi16 (v[2], zero),
+        _mm256_unpackhi_epi16 (v[3], zero),
+        _mm256_permutevar8x32_epi32 (w[0], bcast_hi),
+        _mm256_permutevar8x32_epi32 (w[1], bcast_hi),
+        _mm256_permutevar8x32_epi32 (w[2], bcast_hi));
+
+    /* the unused 4th value of the table becomes the alpha of the source */
+    t = _mm256_packus_epi32 (lo, hi);
+    t = _mm256_shufflelo_epi16 (_mm256_shufflehi_epi16 (t, 0x93), 0x93);
+    STOREU256 (d + i * 4, _mm256_blend_epi16 (t, px, 0x11));
+  }
+  for (; i < n; i++)
+    lut3d_pixel (d + i * 4, s + i * 4, lut, bits);
+}
+
+#endif
@@ -0,0 +1,95 @@
+/* GStreamer
+ * Copyright (C) <2021> GStreamer developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef VIDEO_SIMD_X86_AVX2_H
+#define VIDEO_SIMD_X86_AVX2_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+G_GNUC_INTERNAL
+void video_simd_unpack_I420_avx2 (guint8 * d, const guint8 * y,
+    const guint8 * u, const guint8 * v, int n);
+G_GNUC_INTERNAL
+void video_simd_pack_I420_avx2 (guint8 * y, guint8 * u, guint8 * v,
+    const guint8 * s, int n);
+
+G_GNUC_INTERNAL
+void video_simd_unpack_YUY2_avx2 (guint8 * d, const guint8 * s, int n);
+G_GNUC_INTERNAL
+void video_simd_pack_YUY2_avx2 (guint8 * d, const guint8 * s, int n);
+
+G_GNUC_INTERNAL
+void video_simd_unpack_NV12_avx2 (guint8 * d, const guint8 * y,
+    const guint8 * uv, int n);
+G_GNUC_INTERNAL
+void video_simd_pack_NV12_avx2 (guint8 * y, guint8 * uv, const guint8 * s,
+    int n);
+
+G_GNUC_INTERNAL
+void video_simd_swap_BGRA_avx2 (guint8 * d, const guint8 * s, int n);
+
+G_GNUC_INTERNAL
+void video_simd_matrix16_avx2 (guint16 * d, const guint16 * s,
+    const gint * im, int n);
+
+G_GNUC_INTERNAL
+void video_simd_unpack_I420_16_avx2 (guint16 * d, const guint16 * y,
+    const guint16 * u, const guint16 * v, gint bits, gboolean expand, int n);
+G_GNUC_INTERNAL
+void video_simd_pack_I420_16_avx2 (guint16 * y, guint16 * u, guint16 * v,
+    const guint16 * s, gint bits, int n);
+G_GNUC_INTERNAL
+void video_simd_pack_Y16_avx2 (guint16 * y, const guint16 * s, gint bits,
+    gboolean msb, int n);
+
+G_GNUC_INTERNAL
+void video_simd_unpack_P016_avx2 (guint16 * d, const guint16 * y,
+    const guint16 * uv, gint bits, gboolean expand, int n);
+G_GNUC_INTERNAL
+void video_simd_pack_P016_avx2 (guint16 * y, guint16 * uv,
+    const guint16 * s, gint bits, int n);
+
+G_GNUC_INTERNAL
+void video_simd_unpack_Y216_avx2 (guint16 * d, const guint8 * s, gint bits,
+    gboolean expand, int n);
+G_GNUC_INTERNAL
+void video_simd_pack_Y216_avx2 (guint8 * d, const guint16 * s, gint bits,
+    int n);
+
+G_GNUC_INTERNAL
+void video_simd_unpack_v210_avx2 (guint16 * d, const guint8 * s,
+    gboolean expand, int n);
+G_GNUC_INTERNAL
+void video_simd_pack_v210_avx2 (guint8 * d, const guint16 * s, int n);
+
+G_GNUC_INTERNAL
+void video_simd_unpack_UYVP_avx2 (guint16 * d, const guint8 * s,
+    gboolean expand, int n);
+G_GNUC_INTERNAL
+void video_simd_pack_UYVP_avx2 (guint8 * d, const guint16 * s, int n);
+
+G_GNUC_INTERNAL
+void video_simd_lut3d_avx2 (guint16 * d, const guint16 * s,
+    const guint16 * lut, gint bits, int n);
+
+G_END_DECLS
+
+#endif /* VIDEO_SIMD_X86_AVX2_H */
@@ -0,0 +1,600 @@
+/* GStreamer
+ * Copyright (C) <2021> GStreamer developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "video-simd-private.h"
+#include "video-orc.h"
+
+#if defined (HAVE_AVX2) && (defined (__i386__) || defined (__x86_64__))
+#define CHECK_AVX2
+#include "video-simd-x86-avx2.h"
+#endif
+
+#ifndef GST_DISABLE_GST_DEBUG
+#define GST_CAT_DEFAULT ensure_debug_category()
+static GstDebugCategory *
+ensure_debug_category (void)
+{
+  static gsize cat_gonce = 0;
+
+  if (g_once_init_enter (&cat_gonce)) {
+    gsize cat_done;
+
+    cat_done = (gsize) _gst_debug_category_new ("video-simd", 0,
+        "video-simd object");
+
+    g_once_init_leave (&cat_gonce, cat_done);
+  }
+
+  return (GstDebugCategory *) cat_gonce;
+}
+#else
+#define ensure_debug_category() /* NOOP */
+#endif /* GST_DISABLE_GST_DEBUG */
+
+static void
+matrix8_orc (guint8 * d, const guint8 * s, gint64 p1, gint64 p2, gint64 p3,
+    gint64 p4, int n)
+{
+  video_orc_matrix8 (d, s, p1, p2, p3, p4, n);
+}
+
+#define SCALE 8
+
+/* the C backup of video_orc_matrix8() */
+void
+_custom_video_orc_matrix8 (guint8 * ORC_RESTRICT d1,
+    const guint8 * ORC_RESTRICT s1, orc_int64 p1, orc_int64 p2, orc_int64 p3,
+    orc_int64 p4, int n)
+{
+  gint i;
+  gint r, g, b;
+  gint y, u, v;
+  gint a00, a01, a02, a03;
+  gint a10, a11, a12, a13;
+  gint a20, a21, a22, a23;
+
+  a00 = (gint16) (p1 >> 16);
+  a01 = (gint16) (p2 >> 16);
+  a02 = (gint16) (p3 >> 16);
+  a03 = (gint16) (p4 >> 16);
+  a10 = (gint16) (p1 >> 32);
+  a11 = (gint16) (p2 >> 32);
+  a12 = (gint16) (p3 >> 32);
+  a13 = (gint16) (p4 >> 32);
+  a20 = (gint16) (p1 >> 48);
+  a21 = (gint16) (p2 >> 48);
+  a22 = (gint16) (p3 >> 48);
+  a23 = (gint16) (p4 >> 48);
+
+  for (i = 0; i < n; i++) {
+    r = s1[i * 4 + 1];
+    g = s1[i * 4 + 2];
+    b = s1[i * 4 + 3];
+
+    y = ((a00 * r + a01 * g + a02 * b) >> SCALE) + a03;
+    u = ((a10 * r + a11 * g + a12 * b) >> SCALE) + a13;
+    v = ((a20 * r + a21 * g + a22 * b) >> SCALE) + a23;
+
+    d1[i * 4 + 1] = CLAMP (y, 0, 255);
+    d1[i * 4 + 2] = CLAMP (u, 0, 255);
+    d1[i * 4 + 3] = CLAMP (v, 0, 255);
+  }
+}
+
+static void
+matrix16_c (guint16 * d, const guint16 * s, const gint * im, int n)
+{
+  int i;
+  int r, g, b;
+  int y, u, v;
+
+  for (i = 0; i < n; i++) {
+    r = s[i * 4 + 1];
+    g = s[i * 4 + 2];
+    b = s[i * 4 + 3];
+
+    y = (im[0] * r + im[1] * g + im[2] * b + im[3]) >> SCALE;
+    u = (im[4] * r + im[5] * g + im[6] * b + im[7]) >> SCALE;
+    v = (im[8] * r + im[9] * g + im[10] * b + im[11]) >> SCALE;
+
+    d[i * 4 + 0] = s[i * 4 + 0];
+    d[i * 4 + 1] = CLAMP (y, 0, 65535);
+    d[i * 4 + 2] = CLAMP (u, 0, 65535);
+    d[i * 4 + 3] = CLAMP (v, 0, 65535);
+  }
+}
+
+/* samples of the planar formats are stored in the low bits, the semi-planar
+ * and packed formats store them in the high bits */
+#define LSB_SHIFT(bits) (16 - (bits))
+#define MSB_MASK(bits) ((0xffff << (16 - (bits))) & 0xffff)
+
+static void
+unpack_I420_16_c (guint16 * d, const guint16 * y, const guint16 * u,
+    const guint16 * v, gint bits, gboolean expand, int n)
+{
+  int i;
+  guint16 Y0, Y1, U, V;
+
+  for (i = 0; i < n; i++) {
+    Y0 = GST_READ_UINT16_LE (y + i * 2 + 0) << LSB_SHIFT (bits);
+    Y1 = GST_READ_UINT16_LE (y + i * 2 + 1) << LSB_SHIFT (bits);
+    U = GST_READ_UINT16_LE (u + i) << LSB_SHIFT (bits);
+    V = GST_READ_UINT16_LE (v + i) << LSB_SHIFT (bits);
+
+    if (expand) {
+      Y0 |= (Y0 >> bits);
+      Y1 |= (Y1 >> bits);
+      U |= (U >> bits);
+      V |= (V >> bits);
+    }
+
+    d[i * 8 + 0] = 0xffff;
+    d[i * 8 + 1] = Y0;
+    d[i * 8 + 2] = U;
+    d[i * 8 + 3] = V;
+    d[i * 8 + 4] = 0xffff;
+    d[i * 8 + 5] = Y1;
+    d[i * 8 + 6] = U;
+    d[i * 8 + 7] = V;
+  }
+}
+
+static void
+pack_I420_16_c (guint16 * y, guint16 * u, guint16 * v, const guint16 * s,
+    gint bits, int n)
+{
+  int i;
+
+  for (i = 0; i < n; i++) {
+    GST_WRITE_UINT16_LE (y + i * 2 + 0, s[i * 8 + 1] >> LSB_SHIFT (bits));
+    GST_WRITE_UINT16_LE (y + i * 2 + 1, s[i * 8 + 5] >> LSB_SHIFT (bits));
+    GST_WRITE_UINT16_LE (u + i, s[i * 8 + 2] >> LSB_SHIFT (bits));
+    GST_WRITE_UINT16_LE (v + i, s[i * 8 + 3] >> LSB_SHIFT (bits));
+  }
+}
+
+static void
+pack_Y16_c (guint16 * y, const guint16 * s, gint bits, gboolean msb, int n)
+{
+  int i;
+
+  if (msb) {
+    for (i = 0; i < n; i++)
+      GST_WRITE_UINT16_LE (y + i, s[i * 4 + 1] & MSB_MASK (bits));
+  } else {
+    for (i = 0; i < n; i++)
+      GST_WRITE_UINT16_LE (y + i, s[i * 4 + 1] >> LSB_SHIFT (bits));
+  }
+}
+
+static void
+unpack_P016_c (guint16 * d, const guint16 * y, const guint16 * uv, gint bits,
+    gboolean expand, int n)
+{
+  int i;
+  guint16 Y0, Y1, U, V;
+
+  for (i = 0; i < n; i++) {
+    Y0 = GST_READ_UINT16_LE (y + i * 2 + 0);
+    Y1 = GST_READ_UINT16_LE (y + i * 2 + 1);
+    U = GST_READ_UINT16_LE (uv + i * 2 + 0);
+    V = GST_READ_UINT16_LE (uv + i * 2 + 1);
+
+    if (expand) {
+      Y0 |= (Y0 >> bits);
+      Y1 |= (Y1 >> bits);
+      U |= (U >> bits);
+      V |= (V >> bits);
+    }
+
+    d[i * 8 + 0] = 0xffff;
+    d[i * 8 + 1] = Y0;
+    d[i * 8 + 2] = U;
+    d[i * 8 + 3] = V;
+    d[i * 8 + 4] = 0xffff;
+    d[i * 8 + 5] = Y1;
+    d[i * 8 + 6] = U;
+    d[i * 8 + 7] = V;
+  }
+}
+
+static void
+pack_P016_c (guint16 * y, guint16 * uv, const guint16 * s, gint bits, int n)
+{
+  int i;
+
+  for (i = 0; i < n; i++) {
+    GST_WRITE_UINT16_LE (y + i * 2 + 0, s[i * 8 + 1] & MSB_MASK (bits));
+    GST_WRITE_UINT16_LE (y + i * 2 + 1, s[i * 8 + 5] & MSB_MASK (bits));
+    GST_WRITE_UINT16_LE (uv + i * 2 + 0, s[i * 8 + 2] & MSB_MASK (bits));
+    GST_WRITE_UINT16_LE (uv + i * 2 + 1, s[i * 8 + 3] & MSB_MASK (bits));
+  }
+}
+
+static void
+unpack_Y216_c (guint16 * d, const guint8 * s, gint bits, gboolean expand,
+    int n)
+{
+  int i;
+  guint16 Y0, Y1, U, V;
+
+  for (i = 0; i < n; i++) {
+    Y0 = GST_READ_UINT16_LE (s + i * 8 + 0);
+    U = GST_READ_UINT16_LE (s + i * 8 + 2);
+    Y1 = GST_READ_UINT16_LE (s + i * 8 + 4);
+    V = GST_READ_UINT16_LE (s + i * 8 + 6);
+
+    if (expand) {
+      Y0 |= (Y0 >> bits);
+      Y1 |= (Y1 >> bits);
+      U |= (U >> bits);
+      V |= (V >> bits);
+    }
+
+    d[i * 8 + 0] = 0xffff;
+    d[i * 8 + 1] = Y0;
+    d[i * 8 + 2] = U;
+    d[i * 8 + 3] = V;
+    d[i * 8 + 4] = 0xffff;
+    d[i * 8 + 5] = Y1;
+    d[i * 8 + 6] = U;
+    d[i * 8 + 7] = V;
+  }
+}
+
+static void
+pack_Y216_c (guint8 * d, const guint16 * s, gint bits, int n)
+{
+  int i;
+
+  for (i = 0; i < n; i++) {
+    GST_WRITE_UINT16_LE (d + i * 8 + 0, s[i * 8 + 1] & MSB_MASK (bits));
+    GST_WRITE_UINT16_LE (d + i * 8 + 2, s[i * 8 + 2] & MSB_MASK (bits));
+    GST_WRITE_UINT16_LE (d + i * 8 + 4, s[i * 8 + 5] & MSB_MASK (bits));
+    GST_WRITE_UINT16_LE (d + i * 8 + 6, s[i * 8 + 3] & MSB_MASK (bits));
+  }
+}
+
+/* n is the number of 6 pixel groups */
+static void
+unpack_v210_c (guint16 * d, const guint8 * s, gboolean expand, int n)
+{
+  int i;
+  guint32 a0, a1, a2, a3;
+  guint16 y0, y1, y2, y3, y4, y5;
+  guint16 u0, u2, u4;
+  guint16 v0, v2, v4;
+
+  for (i = 0; i < n; i++) {
+    a0 = GST_READ_UINT32_LE (s + i * 16 + 0);
+    a1 = GST_READ_UINT32_LE (s + i * 16 + 4);
+    a2 = GST_READ_UINT32_LE (s + i * 16 + 8);
+    a3 = GST_READ_UINT32_LE (s + i * 16 + 12);
+
+    u0 = ((a0 >> 0) & 0x3ff) << 6;
+    y0 = ((a0 >> 10) & 0x3ff) << 6;
+    v0 = ((a0 >> 20) & 0x3ff) << 6;
+    y1 = ((a1 >> 0) & 0x3ff) << 6;
+
+    u2 = ((a1 >> 10) & 0x3ff) << 6;
+    y2 = ((a1 >> 20) & 0x3ff) << 6;
+    v2 = ((a2 >> 0) & 0x3ff) << 6;
+    y3 = ((a2 >> 10) & 0x3ff) << 6;
+
+    u4 = ((a2 >> 20) & 0x3ff) << 6;
+    y4 = ((a3 >> 0) & 0x3ff) << 6;
+    v4 = ((a3 >> 10) & 0x3ff) << 6;
+    y5 = ((a3 >> 20) & 0x3ff) << 6;
+
+    if (expand) {
+      y0 |= (y0 >> 10);
+      y1 |= (y1 >> 10);
+      u0 |= (u0 >> 10);
+      v0 |= (v0 >> 10);
+
+      y2 |= (y2 >> 10);
+      y3 |= (y3 >> 10);
+      u2 |= (u2 >> 10);
+      v2 |= (v2 >> 10);
+
+      y4 |= (y4 >> 10);
+      y5 |= (y5 >> 10);
+      u4 |= (u4 >> 10);
+      v4 |= (v4 >> 10);
+    }
+
+    d[i * 24 + 0] = 0xffff;
+    d[i * 24 + 1] = y0;
+    d[i * 24 + 2] = u0;
+    d[i * 24 + 3] = v0;
+    d[i * 24 + 4] = 0xffff;
+    d[i * 24 + 5] = y1;
+    d[i * 24 + 6] = u0;
+    d[i * 24 + 7] = v0;
+
+    d[i * 24 + 8] = 0xffff;
+    d[i * 24 + 9] = y2;
+    d[i * 24 + 10] = u2;
+    d[i * 24 + 11] = v2;
+    d[i * 24 + 12] = 0xffff;
+    d[i * 24 + 13] = y3;
+    d[i * 24 + 14] = u2;
+    d[i * 24 + 15] = v2;
+
+    d[i * 24 + 16] = 0xffff;
+    d[i * 24 + 17] = y4;
+    d[i * 24 + 18] = u4;
+    d[i * 24 + 19] = v4;
+    d[i * 24 + 20] = 0xffff;
+    d[i * 24 + 21] = y5;
+    d[i * 24 + 22] = u4;
+    d[i * 24 + 23] = v4;
+  }
+}
+
+static void
+pack_v210_c (guint8 * d, const guint16 * s, int n)
+{
+  int i;
+  guint32 a0, a1, a2, a3;
+  guint16 y0, y1, y2, y3, y4, y5;
+  guint16 u0, u1, u2;
+  guint16 v0, v1, v2;
+
+  for (i = 0; i < n; i++) {
+    y0 = s[i * 24 + 1] >> 6;
+    y1 = s[i * 24 + 5] >> 6;
+    y2 = s[i * 24 + 9] >> 6;
+    y3 = s[i * 24 + 13] >> 6;
+    y4 = s[i * 24 + 17] >> 6;
+    y5 = s[i * 24 + 21] >> 6;
+
+    u0 = s[i * 24 + 2] >> 6;
+    u1 = s[i * 24 + 10] >> 6;
+    u2 = s[i * 24 + 18] >> 6;
+
+    v0 = s[i * 24 + 3] >> 6;
+    v1 = s[i * 24 + 11] >> 6;
+    v2 = s[i * 24 + 19] >> 6;
+
+    a0 = u0 | (y0 << 10) | (v0 << 20);
+    a1 = y1 | (u1 << 10) | (y2 << 20);
+    a2 = v1 | (y3 << 10) | (u2 << 20);
+    a3 = y4 | (v2 << 10) | (y5 << 20);
+
+    GST_WRITE_UINT32_LE (d + i * 16 + 0, a0);
+    GST_WRITE_UINT32_LE (d + i * 16 + 4, a1);
+    GST_WRITE_UINT32_LE (d + i * 16 + 8, a2);
+    GST_WRITE_UINT32_LE (d + i * 16 + 12, a3);
+  }
+}
+
+static void
+unpack_UYVP_c (guint16 * d, const guint8 * s, gboolean expand, int n)
+{
+  int i;
+  guint16 y0, y1, u0, v0;
+
+  for (i = 0; i < n; i++) {
+    u0 = ((s[i * 5 + 0] << 2) | (s[i * 5 + 1] >> 6)) << 6;
+    y0 = (((s[i * 5 + 1] & 0x3f) << 4) | (s[i * 5 + 2] >> 4)) << 6;
+    v0 = (((s[i * 5 + 2] & 0x0f) << 6) | (s[i * 5 + 3] >> 2)) << 6;
+    y1 = (((s[i * 5 + 3] & 0x03) << 8) | s[i * 5 + 4]) << 6;
+
+    if (expand) {
+      y0 |= (y0 >> 10);
+      y1 |= (y1 >> 10);
+      u0 |= (u0 >> 10);
+      v0 |= (v0 >> 10);
+    }
+
+    d[i * 8 + 0] = 0xffff;
+    d[i * 8 + 1] = y0;
+    d[i * 8 + 2] = u0;
+    d[i * 8 + 3] = v0;
+    d[i * 8 + 4] = 0xffff;
+    d[i * 8 + 5] = y1;
+    d[i * 8 + 6] = u0;
+    d[i * 8 + 7] = v0;
+  }
+}
+
+static void
+pack_UYVP_c (guint8 * d, const guint16 * s, int n)
+{
+  int i;
+  guint16 y0, y1, u0, v0;
+
+  for (i = 0; i < n; i++) {
+    y0 = s[i * 8 + 1];
+    y1 = s[i * 8 + 5];
+    u0 = s[i * 8 + 2];
+    v0 = s[i * 8 + 3];
+
+    d[i * 5 + 0] = u0 >> 8;
+    d[i * 5 + 1] = (u0 & 0xc0) | y0 >> 10;
+    d[i * 5 + 2] = ((y0 & 0x3c0) >> 2) | (v0 >> 12);
+    d[i * 5 + 3] = ((v0 & 0xfc0) >> 4) | (y1 >> 14);
+    d[i * 5 + 4] = (y1 >> 6);
+  }
+}
+
+/* position of a 16 bit component in a table with (1 << bits) + 1 points, as
+ * the index of the cell and the 12 bit fraction in it. 0xffff maps to the
+ * last point. */
+#define LUT3D_POS(x,bits,idx,frac) G_STMT_START { \
+  guint _pos = ((x) + ((x) >> 15)) << (bits); \
+  idx = MIN (_pos >> 16, (1u << (bits)) - 1); \
+  frac = (_pos - (idx << 16)) >> 4; \
+} G_STMT_END
+
+static void
+lut3d_c (guint16 * d, const guint16 * s, const guint16 * lut, gint bits,
+    int n)
+{
+  gint i, c, size = (1 << bits) + 1;
+  const gint stride[3] = { size * size * 4, size * 4, 4 };
+
+  for (i = 0; i < n; i++) {
+    const guint16 *v0, *v1, *v2, *v3;
+    guint idx, f[3];
+    gint hi, lo, mid;
+
+    v0 = lut;
+    for (c = 0; c < 3; c++) {
+      LUT3D_POS (s[i * 4 + c + 1], bits, idx, f[c]);
+      v0 += idx * stride[c];
+    }
+
+    /* the tetrahedron goes from v0 to v3 along the axis with the largest
+     * fraction first and the smallest last. Ties are resolved in the same
+     * way as the SIMD versions so that hi and lo are never the same. */
+    if (f[0] >= f[1] && f[0] >= f[2])
+      hi = 0;
+    else if (f[1] >= f[2])
+      hi = 1;
+    else
+      hi = 2;
+    if (f[2] <= f[0] && f[2] <= f[1])
+      lo = 2;
+    else if (f[1] <= f[0])
+      lo = 1;
+    else
+      lo = 0;
+    mid = 3 - hi - lo;
+
+    v1 = v0 + stride[hi];
+    v3 = v0 + stride[0] + stride[1] + stride[2];
+    v2 = v3 - stride[lo];
+
+    d[i * 4 + 0] = s[i * 4 + 0];
+    for (c = 0; c < 3; c++) {
+      gint r = (v0[c] << 12) + f[hi] * (v1[c] - v0[c]) +
+          f[mid] * (v2[c] - v1[c]) + f[lo] * (v3[c] - v2[c]);
+
+      d[i * 4 + c + 1] = (r + 2048) >> 12;
+    }
+  }
+}
+
+static const GstVideoSimdFuncs default_funcs = {
+  video_orc_unpack_I420,
+  video_orc_pack_I420,
+  video_orc_unpack_YUY2,
+  video_orc_pack_YUY2,
+  video_orc_unpack_NV12,
+  video_orc_pack_NV12,
+  video_orc_unpack_BGRA,
+  video_orc_pack_BGRA,
+  matrix8_orc,
+  matrix16_c,
+  unpack_I420_16_c,
+  pack_I420_16_c,
+  pack_Y16_c,
+  unpack_P016_c,
+  pack_P016_c,
+  unpack_Y216_c,
+  pack_Y216_c,
+  unpack_v210_c,
+  pack_v210_c,
+  unpack_UYVP_c,
+  pack_UYVP_c,
+  lut3d_c,
+};
+
+static GstVideoSimdFuncs simd_funcs;
+
+#ifdef CHECK_AVX2
+/* clang claims to be gcc 4.2, so check for the builtin itself when we can.
+ * The builtin also checks that the OS saves the AVX state. */
+#if defined (__has_builtin)
+#if __has_builtin (__builtin_cpu_supports)
+#define HAVE_BUILTIN_CPU_SUPPORTS
+#endif
+#elif defined (__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 8))
+#define HAVE_BUILTIN_CPU_SUPPORTS
+#endif
+
+static gboolean
+cpu_has_avx2 (void)
+{
+#ifdef HAVE_BUILTIN_CPU_SUPPORTS
+  __builtin_cpu_init ();
+  return __builtin_cpu_supports ("avx2");
+#else
+  return FALSE;
+#endif
+}
+#endif
+
+/* The ORC and C versions of the line functions, for comparing the
+ * optimised versions against in the tests. */
+const GstVideoSimdFuncs *
+gst_video_simd_get_default_funcs (void)
+{
+  return &default_funcs;
+}
+
+/* Get the line functions for the CPU we are running on. The functions are
+ * selected the first time this is called. */
+const GstVideoSimdFuncs *
+gst_video_simd_get_funcs (void)
+{
+  static gsize init_gonce = 0;
+
+  if (g_once_init_enter (&init_gonce)) {
+    simd_funcs = default_funcs;
+#ifdef CHECK_AVX2
+    if (cpu_has_avx2 ()) {
+      GST_DEBUG ("enable AVX2 optimisations");
+      simd_funcs.unpack_I420 = video_simd_unpack_I420_avx2;
+      simd_funcs.pack_I420 = video_simd_pack_I420_avx2;
+      simd_funcs.unpack_YUY2 = video_simd_unpack_YUY2_avx2;
+      simd_funcs.pack_YUY2 = video_simd_pack_YUY2_avx2;
+      simd_funcs.unpack_NV12 = video_simd_unpack_NV12_avx2;
+      simd_funcs.pack_NV12 = video_simd_pack_NV12_avx2;
+      simd_funcs.unpack_BGRA = video_simd_swap_BGRA_avx2;
+      simd_funcs.pack_BGRA = video_simd_swap_BGRA_avx2;
+      simd_funcs.matrix16 = video_simd_matrix16_avx2;
+      simd_funcs.unpack_I420_16 = video_simd_unpack_I420_16_avx2;
+      simd_funcs.pack_I420_16 = video_simd_pack_I420_16_avx2;
+      simd_funcs.pack_Y16 = video_simd_pack_Y16_avx2;
+      simd_funcs.unpack_P016 = video_simd_unpack_P016_avx2;
+      simd_funcs.pack_P016 = video_simd_pack_P016_avx2;
+      simd_funcs.unpack_Y216 = video_simd_unpack_Y216_avx2;
+      simd_funcs.pack_Y216 = video_simd_pack_Y216_avx2;
+      simd_funcs.unpack_v210 = video_simd_unpack_v210_avx2;
+      simd_funcs.pack_v210 = video_simd_pack_v210_avx2;
+      simd_funcs.unpack_UYVP = video_simd_unpack_UYVP_avx2;
+      simd_funcs.pack_UYVP = video_simd_pack_UYVP_avx2;
+      simd_funcs.lut3d = video_simd_lut3d_avx2;
+    } else {
+      GST_DEBUG ("AVX2 optimisations not enabled");
+    }
+#endif
+    g_once_init_leave (&init_gonce, 1);
+  }
+
+  return &simd_funcs;
+}
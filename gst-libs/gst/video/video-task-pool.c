@@ -0,0 +1,366 @@
+/* GStreamer
+ * Copyright (C) <2021> GStreamer developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#include "video-task-pool.h"
+
+/**
+ * SECTION:gstvideotaskpool
+ * @title: GstVideoTaskPool
+ * @short_description: Shared worker threads for slice based video processing
+ *
+ * #GstVideoTaskPool is a refcounted set of worker threads that video
+ * processing objects such as #GstVideoConverter submit their slices to.
+ *
+ * A job is submitted with gst_video_task_pool_run() as an array of task
+ * data. The calling thread executes tasks of its own job as well and the
+ * call returns once all tasks of the job are finished. Jobs from different
+ * threads are queued and served in order, so sharing one pool between many
+ * users bounds the total number of threads in the process, while the number
+ * of tasks per job bounds the concurrency of a single user.
+ *
+ * gst_video_task_pool_get_shared() returns the process-wide pool that is
+ * used by default. Its size is the number of processors, or the value of
+ * the `GST_VIDEO_TASK_POOL_THREADS` environment variable when set.
+ *
+ * Since: 1.20
+ */
+
+#ifndef GST_DISABLE_GST_DEBUG
+#define GST_CAT_DEFAULT ensure_debug_category()
+static GstDebugCategory *
+ensure_debug_category (void)
+{
+  static gsize cat_gonce = 0;
+
+  if (g_once_init_enter (&cat_gonce)) {
+    gsize cat_done;
+
+    cat_done = (gsize) _gst_debug_category_new ("video-task-pool", 0,
+        "video-task-pool object");
+
+    g_once_init_leave (&cat_gonce, cat_done);
+  }
+
+  return (GstDebugCategory *) cat_gonce;
+}
+#else
+#define ensure_debug_category() /* NOOP */
+#endif /* GST_DISABLE_GST_DEBUG */
+
+typedef struct _GstVideoTaskJob GstVideoTaskJob;
+
+/* lives on the stack of the thread calling gst_video_task_pool_run() */
+struct _GstVideoTaskJob
+{
+  GList link;
+
+  GstVideoTaskFunc func;
+  gpointer *task_data;
+  guint n_tasks;
+
+  guint next_task;
+  guint n_done;
+};
+
+struct _GstVideoTaskPool
+{
+  gint refcount;
+
+  guint n_threads;
+  GThread **threads;
+
+  GMutex lock;
+  GCond cond_todo, cond_done;
+  GQueue jobs;
+  gboolean quit;
+};
+
+G_DEFINE_BOXED_TYPE (GstVideoTaskPool, gst_video_task_pool,
+    (GBoxedCopyFunc) gst_video_task_pool_ref,
+    (GBoxedFreeFunc) gst_video_task_pool_unref);
+
+/* call with lock. Takes the next task of the first queued job and removes
+ * the job from the queue when all its tasks have been handed out. */
+static guint
+gst_video_task_job_take (GstVideoTaskPool * pool, GstVideoTaskJob * job)
+{
+  guint idx;
+
+  idx = job->next_task++;
+  if (job->next_task == job->n_tasks)
+    g_queue_unlink (&pool->jobs, &job->link);
+
+  return idx;
+}
+
+static gpointer
+gst_video_task_pool_thread_func (gpointer data)
+{
+  GstVideoTaskPool *pool = data;
+
+  g_mutex_lock (&pool->lock);
+  do {
+    GstVideoTaskJob *job;
+    guint idx;
+
+    while (g_queue_is_empty (&pool->jobs) && !pool->quit)
+      g_cond_wait (&pool->cond_todo, &pool->lock);
+
+    if (pool->quit)
+      break;
+
+    job = g_queue_peek_head (&pool->jobs);
+    idx = gst_video_task_job_take (pool, job);
+    g_mutex_unlock (&pool->lock);
+
+    job->func (job->task_data[idx]);
+
+    g_mutex_lock (&pool->lock);
+    job->n_done++;
+    if (job->n_done == job->n_tasks)
+      g_cond_broadcast (&pool->cond_done);
+  } while (TRUE);
+  g_mutex_unlock (&pool->lock);
+
+  return NULL;
+}
+
+static void
+gst_video_task_pool_free (GstVideoTaskPool * pool)
+{
+  guint i;
+
+  GST_DEBUG ("free pool %p", pool);
+
+  g_mutex_lock (&pool->lock);
+  pool->quit = TRUE;
+  g_cond_broadcast (&pool->cond_todo);
+  g_mutex_unlock (&pool->lock);
+
+  for (i = 0; i < pool->n_threads; i++)
+    g_thread_join (pool->threads[i]);
+
+  g_mutex_clear (&pool->lock);
+  g_cond_clear (&pool->cond_todo);
+  g_cond_clear (&pool->cond_done);
+  g_free (pool->threads);
+  g_slice_free (GstVideoTaskPool, pool);
+}
+
+/**
+ * gst_video_task_pool_new:
+ * @n_threads: the number of worker threads, 0 for the number of processors
+ *
+ * Create a new pool with @n_threads worker threads. The threads are started
+ * immediately and live as long as the pool.
+ *
+ * Returns: (transfer full): a new #GstVideoTaskPool
+ *
+ * Since: 1.20
+ */
+GstVideoTaskPool *
+gst_video_task_pool_new (guint n_threads)
+{
+  GstVideoTaskPool *pool;
+  GError *err = NULL;
+  guint i;
+
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+
+  pool = g_slice_new0 (GstVideoTaskPool);
+  pool->refcount = 1;
+  pool->threads = g_new0 (GThread *, n_threads);
+  g_mutex_init (&pool->lock);
+  g_cond_init (&pool->cond_todo);
+  g_cond_init (&pool->cond_done);
+  g_queue_init (&pool->jobs);
+
+  for (i = 0; i < n_threads; i++) {
+    pool->threads[i] = g_thread_try_new ("videotaskpool",
+        gst_video_task_pool_thread_func, pool, &err);
+    if (!pool->threads[i]) {
+      /* callers always execute tasks themselves too, so we can continue
+       * with the threads we have */
+      GST_ERROR ("Failed to start thread %u: %s", i, err->message);
+      g_clear_error (&err);
+      break;
+    }
+  }
+  pool->n_threads = i;
+
+  GST_DEBUG ("new pool %p with %u threads", pool, pool->n_threads);
+
+  return pool;
+}
+
+/**
+ * gst_video_task_pool_get_shared:
+ *
+ * Get the process-wide #GstVideoTaskPool. It is created on first use with
+ * as many threads as there are processors, unless the
+ * `GST_VIDEO_TASK_POOL_THREADS` environment variable specifies another size.
+ * The shared pool keeps a reference to itself and is never freed, its
+ * threads run until the process exits.
+ *
+ * Returns: (transfer full): the shared #GstVideoTaskPool
+ *
+ * Since: 1.20
+ */
+GstVideoTaskPool *
+gst_video_task_pool_get_shared (void)
+{
+  static gsize shared_pool = 0;
+
+  if (g_once_init_enter (&shared_pool)) {
+    const gchar *env;
+    guint n_threads = 0;
+
+    env = g_getenv ("GST_VIDEO_TASK_POOL_THREADS");
+    if (env != NULL)
+      n_threads = (guint) strtoul (env, NULL, 10);
+
+    /* intentionally never freed, see gst-plugins-base.supp for the tests */
+    g_once_init_leave (&shared_pool,
+        (gsize) gst_video_task_pool_new (n_threads));
+  }
+
+  return gst_video_task_pool_ref ((GstVideoTaskPool *) shared_pool);
+}
+
+/**
+ * gst_video_task_pool_ref:
+ * @pool: a #GstVideoTaskPool
+ *
+ * Increases the refcount of @pool by one.
+ *
+ * Returns: @pool
+ *
+ * Since: 1.20
+ */
+GstVideoTaskPool *
+gst_video_task_pool_ref (GstVideoTaskPool * pool)
+{
+  g_return_val_if_fail (pool != NULL, NULL);
+
+  g_atomic_int_inc (&pool->refcount);
+
+  return pool;
+}
+
+/**
+ * gst_video_task_pool_unref:
+ * @pool: a #GstVideoTaskPool
+ *
+ * Decreases the refcount of @pool by one. When the refcount drops to 0,
+ * the worker threads are stopped and the pool is freed.
+ *
+ * Since: 1.20
+ */
+void
+gst_video_task_pool_unref (GstVideoTaskPool * pool)
+{
+  g_return_if_fail (pool != NULL);
+  g_return_if_fail (pool->refcount > 0);
+
+  if (g_atomic_int_dec_and_test (&pool->refcount))
+    gst_video_task_pool_free (pool);
+}
+
+/**
+ * gst_video_task_pool_get_n_threads:
+ * @pool: a #GstVideoTaskPool
+ *
+ * Returns: the number of worker threads of @pool
+ *
+ * Since: 1.20
+ */
+guint
+gst_video_task_pool_get_n_threads (GstVideoTaskPool * pool)
+{
+  g_return_val_if_fail (pool != NULL, 0);
+
+  return pool->n_threads;
+}
+
+/**
+ * gst_video_task_pool_run:
+ * @pool: a #GstVideoTaskPool
+ * @func: (scope call): the function to call for each task
+ * @task_data: (array length=n_tasks): the data of each task
+ * @n_tasks: the number of tasks
+ *
+ * Call @func for each of the @n_tasks entries of @task_data, distributing
+ * the calls over the worker threads of @pool and the calling thread. At most
+ * @n_tasks threads work on this job at the same time.
+ *
+ * This function blocks until all tasks have been executed.
+ *
+ * Since: 1.20
+ */
+void
+gst_video_task_pool_run (GstVideoTaskPool * pool, GstVideoTaskFunc func,
+    gpointer * task_data, guint n_tasks)
+{
+  GstVideoTaskJob job;
+  guint i;
+
+  g_return_if_fail (pool != NULL);
+  g_return_if_fail (func != NULL);
+  g_return_if_fail (task_data != NULL || n_tasks == 0);
+
+  if (n_tasks < 2 || pool->n_threads == 0) {
+    for (i = 0; i < n_tasks; i++)
+      func (task_data[i]);
+    return;
+  }
+
+  job.link.data = &job;
+  job.link.prev = job.link.next = NULL;
+  job.func = func;
+  job.task_data = task_data;
+  job.n_tasks = n_tasks;
+  job.next_task = 0;
+  job.n_done = 0;
+
+  g_mutex_lock (&pool->lock);
+  g_queue_push_tail_link (&pool->jobs, &job.link);
+  g_cond_broadcast (&pool->cond_todo);
+
+  /* help with our own job until all its tasks are handed out */
+  while (job.next_task < job.n_tasks) {
+    i = gst_video_task_job_take (pool, &job);
+    g_mutex_unlock (&pool->lock);
+
+    func (task_data[i]);
+
+    g_mutex_lock (&pool->lock);
+    job.n_done++;
+  }
+
+  while (job.n_done < job.n_tasks)
+    g_cond_wait (&pool->cond_done, &pool->lock);
+  g_mutex_unlock (&pool->lock);
+}
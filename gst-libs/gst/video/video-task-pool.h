@@ -0,0 +1,68 @@
+/* GStreamer
+ * Copyright (C) <2021> GStreamer developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_VIDEO_TASK_POOL_H__
+#define __GST_VIDEO_TASK_POOL_H__
+
+#include <gst/gst.h>
+#include <gst/video/video-prelude.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GstVideoTaskFunc:
+ * @user_data: the task data passed to gst_video_task_pool_run()
+ *
+ * Function executed for each task of a job submitted to a #GstVideoTaskPool.
+ *
+ * Since: 1.20
+ */
+typedef void (*GstVideoTaskFunc) (gpointer user_data);
+
+typedef struct _GstVideoTaskPool GstVideoTaskPool;
+
+#define GST_TYPE_VIDEO_TASK_POOL (gst_video_task_pool_get_type ())
+
+GST_VIDEO_API
+GType                gst_video_task_pool_get_type      (void);
+
+GST_VIDEO_API
+GstVideoTaskPool *   gst_video_task_pool_new           (guint n_threads);
+
+GST_VIDEO_API
+GstVideoTaskPool *   gst_video_task_pool_get_shared    (void);
+
+GST_VIDEO_API
+GstVideoTaskPool *   gst_video_task_pool_ref           (GstVideoTaskPool * pool);
+
+GST_VIDEO_API
+void                 gst_video_task_pool_unref         (GstVideoTaskPool * pool);
+
+GST_VIDEO_API
+guint                gst_video_task_pool_get_n_threads (GstVideoTaskPool * pool);
+
+GST_VIDEO_API
+void                 gst_video_task_pool_run           (GstVideoTaskPool * pool,
+                                                        GstVideoTaskFunc func,
+                                                        gpointer * task_data,
+                                                        guint n_tasks);
+
+G_END_DECLS
+
+#endif /* __GST_VIDEO_TASK_POOL_H__ */
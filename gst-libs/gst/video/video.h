@@ -32,6 +32,7 @@ typedef struct _GstVideoAlignment GstVideoAlignment;
 #include <gst/video/video-info.h>
 #include <gst/video/video-frame.h>
 #include <gst/video/video-enumtypes.h>
+#include <gst/video/video-task-pool.h>
 #include <gst/video/video-converter.h>
 #include <gst/video/video-scaler.h>
 #include <gst/video/video-multiview.h>
@@ -161,6 +162,29 @@ GstSample *   gst_video_convert_sample       (GstSample     * sample,
                                               GstClockTime    timeout,
                                               GError       ** error);
 
+/**
+ * GstVideoConvertSampleCache:
+ *
+ * Opaque cache of sample conversions, see
+ * gst_video_convert_sample_cache_new().
+ *
+ * Since: 1.20
+ */
+typedef struct _GstVideoConvertSampleCache GstVideoConvertSampleCache;
+
+GST_VIDEO_API
+GstVideoConvertSampleCache * gst_video_convert_sample_cache_new     (guint max_entries);
+
+GST_VIDEO_API
+void                         gst_video_convert_sample_cache_free    (GstVideoConvertSampleCache * cache);
+
+GST_VIDEO_API
+GstSample *                  gst_video_convert_sample_cache_convert (GstVideoConvertSampleCache * cache,
+                                                                     GstSample                  * sample,
+                                                                     const GstCaps              * to_caps,
+                                                                     GstClockTime                 timeout,
+                                                                     GError                    ** error);
+
 G_END_DECLS
 
 #include <gst/video/colorbalancechannel.h>
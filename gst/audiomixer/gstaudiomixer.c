@@ -166,11 +166,44 @@ gst_audiomixer_pad_init (GstAudioMixerPad * pad)
   pad->mute = DEFAULT_PAD_MUTE;
 }
 
+#define DEFAULT_N_THREADS 1
+
+/* fewer output frames per thread are not worth the synchronisation */
+#define MIN_FRAMES_PER_TASK 256
+
 enum
 {
-  PROP_0
+  PROP_0,
+  PROP_N_THREADS
 };
 
+/* A range of an input buffer that is added to the output buffer. When
+ * mixing on several threads these are collected for all pads and only
+ * added once the output buffer is complete. */
+typedef struct
+{
+  GstBuffer *buffer;
+  GstMapInfo map;
+  guint in_offset;
+  guint out_offset;
+  guint num_frames;
+  gdouble volume;
+  gint volume_i32;
+  gint volume_i16;
+  gint volume_i8;
+} GstAudioMixerJob;
+
+/* The output frames one thread adds all jobs to, in pad order, so the
+ * result is the same as when mixing on a single thread */
+typedef struct
+{
+  const GstAudioInfo *info;
+  GArray *jobs;
+  guint8 *out;
+  guint start;
+  guint end;
+} GstAudioMixerTask;
+
 /* These are the formats we can mix natively */
 
 #if G_BYTE_ORDER == G_LITTLE_ENDIAN
@@ -216,14 +249,93 @@ static gboolean
 gst_audiomixer_aggregate_one_buffer (GstAudioAggregator * aagg,
     GstAudioAggregatorPad * aaggpad, GstBuffer * inbuf, guint in_offset,
     GstBuffer * outbuf, guint out_offset, guint num_samples);
+static GstFlowReturn gst_audiomixer_finish_buffer (GstAggregator * agg,
+    GstBuffer * buffer);
+static gboolean gst_audiomixer_negotiated_src_caps (GstAggregator * agg,
+    GstCaps * caps);
+static gboolean gst_audiomixer_start (GstAggregator * agg);
+static gboolean gst_audiomixer_stop (GstAggregator * agg);
+static GstFlowReturn gst_audiomixer_flush (GstAggregator * agg);
+
+static void
+gst_audiomixer_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (object);
+
+  switch (prop_id) {
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (audiomixer);
+      audiomixer->n_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (audiomixer);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_audiomixer_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (object);
+
+  switch (prop_id) {
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (audiomixer);
+      g_value_set_uint (value, audiomixer->n_threads);
+      GST_OBJECT_UNLOCK (audiomixer);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_audiomixer_finalize (GObject * object)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (object);
 
+  if (audiomixer->thread_pool)
+    g_thread_pool_free (audiomixer->thread_pool, FALSE, TRUE);
+  g_array_free (audiomixer->jobs, TRUE);
+  g_array_free (audiomixer->mix_jobs, TRUE);
+  g_mutex_clear (&audiomixer->thread_lock);
+  g_cond_clear (&audiomixer->thread_cond);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
 
 static void
 gst_audiomixer_class_init (GstAudioMixerClass * klass)
 {
+  GObjectClass *gobject_class = (GObjectClass *) klass;
   GstElementClass *gstelement_class = (GstElementClass *) klass;
+  GstAggregatorClass *agg_class = (GstAggregatorClass *) klass;
   GstAudioAggregatorClass *aagg_class = (GstAudioAggregatorClass *) klass;
 
+  gobject_class->set_property = gst_audiomixer_set_property;
+  gobject_class->get_property = gst_audiomixer_get_property;
+  gobject_class->finalize = gst_audiomixer_finalize;
+
+  /**
+   * GstAudioMixer:n-threads:
+   *
+   * Maximum number of threads to mix with. With more than one thread the
+   * pads are added to the output buffer once all of them have been
+   * collected, and every thread adds all pads to its own part of the
+   * output buffer. 0 uses the number of processors.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Threads",
+          "Maximum number of threads to use for mixing (0 = auto)",
+          0, G_MAXINT, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_static_pad_template_with_gtype (gstelement_class,
       &gst_audiomixer_src_template, GST_TYPE_AUDIO_AGGREGATOR_CONVERT_PAD);
   gst_element_class_add_static_pad_template_with_gtype (gstelement_class,
@@ -237,14 +349,36 @@ gst_audiomixer_class_init (GstAudioMixerClass * klass)
   gstelement_class->release_pad =
       GST_DEBUG_FUNCPTR (gst_audiomixer_release_pad);
 
+  agg_class->finish_buffer = gst_audiomixer_finish_buffer;
+  agg_class->negotiated_src_caps = gst_audiomixer_negotiated_src_caps;
+  agg_class->start = gst_audiomixer_start;
+  agg_class->stop = gst_audiomixer_stop;
+  agg_class->flush = gst_audiomixer_flush;
+
   aagg_class->aggregate_one_buffer = gst_audiomixer_aggregate_one_buffer;
 
   gst_type_mark_as_plugin_api (GST_TYPE_AUDIO_MIXER_PAD, 0);
 }
 
+static void
+gst_audiomixer_job_clear (GstAudioMixerJob * job)
+{
+  gst_buffer_unref (job->buffer);
+}
+
 static void
 gst_audiomixer_init (GstAudioMixer * audiomixer)
 {
+  audiomixer->n_threads = DEFAULT_N_THREADS;
+  audiomixer->jobs = g_array_new (FALSE, FALSE, sizeof (GstAudioMixerJob));
+  g_array_set_clear_func (audiomixer->jobs,
+      (GDestroyNotify) gst_audiomixer_job_clear);
+  audiomixer->mix_jobs =
+      g_array_new (FALSE, FALSE, sizeof (GstAudioMixerJob));
+  g_array_set_clear_func (audiomixer->mix_jobs,
+      (GDestroyNotify) gst_audiomixer_job_clear);
+  g_mutex_init (&audiomixer->thread_lock);
+  g_cond_init (&audiomixer->thread_cond);
 }
 
 static GstPad *
@@ -288,129 +422,148 @@ gst_audiomixer_release_pad (GstElement * element, GstPad * pad)
 }
 
 
-static gboolean
-gst_audiomixer_aggregate_one_buffer (GstAudioAggregator * aagg,
-    GstAudioAggregatorPad * aaggpad, GstBuffer * inbuf, guint in_offset,
-    GstBuffer * outbuf, guint out_offset, guint num_frames)
+/* Adds @num_frames frames of @in to @out, with the volume of @job */
+static void
+gst_audiomixer_mix (const GstAudioInfo * info, const GstAudioMixerJob * job,
+    gpointer out, gconstpointer in, guint num_frames)
 {
-  GstAudioMixerPad *pad = GST_AUDIO_MIXER_PAD (aaggpad);
-  GstMapInfo inmap;
-  GstMapInfo outmap;
-  gint bpf;
-  GstAggregator *agg = GST_AGGREGATOR (aagg);
-  GstAudioAggregatorPad *srcpad = GST_AUDIO_AGGREGATOR_PAD (agg->srcpad);
+  guint num_samples = num_frames * GST_AUDIO_INFO_CHANNELS (info);
 
-  GST_OBJECT_LOCK (aagg);
-  GST_OBJECT_LOCK (aaggpad);
-
-  if (pad->mute || pad->volume < G_MINDOUBLE) {
-    GST_DEBUG_OBJECT (pad, "Skipping muted pad");
-    GST_OBJECT_UNLOCK (aaggpad);
-    GST_OBJECT_UNLOCK (aagg);
-    return FALSE;
-  }
-
-  bpf = GST_AUDIO_INFO_BPF (&srcpad->info);
-
-  gst_buffer_map (outbuf, &outmap, GST_MAP_READWRITE);
-  gst_buffer_map (inbuf, &inmap, GST_MAP_READ);
-  GST_LOG_OBJECT (pad, "mixing %u bytes at offset %u from offset %u",
-      num_frames * bpf, out_offset * bpf, in_offset * bpf);
-
-  /* further buffers, need to add them */
-  if (pad->volume == 1.0) {
-    switch (srcpad->info.finfo->format) {
+  if (job->volume == 1.0) {
+    switch (GST_AUDIO_INFO_FORMAT (info)) {
       case GST_AUDIO_FORMAT_U8:
-        audiomixer_orc_add_u8 ((gpointer) (outmap.data + out_offset * bpf),
-            (gpointer) (inmap.data + in_offset * bpf),
-            num_frames * srcpad->info.channels);
+        audiomixer_orc_add_u8 (out, in, num_samples);
         break;
       case GST_AUDIO_FORMAT_S8:
-        audiomixer_orc_add_s8 ((gpointer) (outmap.data + out_offset * bpf),
-            (gpointer) (inmap.data + in_offset * bpf),
-            num_frames * srcpad->info.channels);
+        audiomixer_orc_add_s8 (out, in, num_samples);
         break;
       case GST_AUDIO_FORMAT_U16:
-        audiomixer_orc_add_u16 ((gpointer) (outmap.data + out_offset * bpf),
-            (gpointer) (inmap.data + in_offset * bpf),
-            num_frames * srcpad->info.channels);
+        audiomixer_orc_add_u16 (out, in, num_samples);
         break;
       case GST_AUDIO_FORMAT_S16:
-        audiomixer_orc_add_s16 ((gpointer) (outmap.data + out_offset * bpf),
-            (gpointer) (inmap.data + in_offset * bpf),
-            num_frames * srcpad->info.channels);
+        audiomixer_orc_add_s16 (out, in, num_samples);
         break;
       case GST_AUDIO_FORMAT_U32:
-        audiomixer_orc_add_u32 ((gpointer) (outmap.data + out_offset * bpf),
-            (gpointer) (inmap.data + in_offset * bpf),
-            num_frames * srcpad->info.channels);
+        audiomixer_orc_add_u32 (out, in, num_samples);
         break;
       case GST_AUDIO_FORMAT_S32:
-        audiomixer_orc_add_s32 ((gpointer) (outmap.data + out_offset * bpf),
-            (gpointer) (inmap.data + in_offset * bpf),
-            num_frames * srcpad->info.channels);
+        audiomixer_orc_add_s32 (out, in, num_samples);
         break;
       case GST_AUDIO_FORMAT_F32:
-        audiomixer_orc_add_f32 ((gpointer) (outmap.data + out_offset * bpf),
-            (gpointer) (inmap.data + in_offset * bpf),
-            num_frames * srcpad->info.channels);
+        audiomixer_orc_add_f32 (out, in, num_samples);
         break;
       case GST_AUDIO_FORMAT_F64:
-        audiomixer_orc_add_f64 ((gpointer) (outmap.data + out_offset * bpf),
-            (gpointer) (inmap.data + in_offset * bpf),
-            num_frames * srcpad->info.channels);
+        audiomixer_orc_add_f64 (out, in, num_samples);
         break;
       default:
         g_assert_not_reached ();
         break;
     }
   } else {
-    switch (srcpad->info.finfo->format) {
+    switch (GST_AUDIO_INFO_FORMAT (info)) {
       case GST_AUDIO_FORMAT_U8:
-        audiomixer_orc_add_volume_u8 ((gpointer) (outmap.data +
-                out_offset * bpf), (gpointer) (inmap.data + in_offset * bpf),
-            pad->volume_i8, num_frames * srcpad->info.channels);
+        audiomixer_orc_add_volume_u8 (out, in, job->volume_i8, num_samples);
         break;
       case GST_AUDIO_FORMAT_S8:
-        audiomixer_orc_add_volume_s8 ((gpointer) (outmap.data +
-                out_offset * bpf), (gpointer) (inmap.data + in_offset * bpf),
-            pad->volume_i8, num_frames * srcpad->info.channels);
+        audiomixer_orc_add_volume_s8 (out, in, job->volume_i8, num_samples);
         break;
       case GST_AUDIO_FORMAT_U16:
-        audiomixer_orc_add_volume_u16 ((gpointer) (outmap.data +
-                out_offset * bpf), (gpointer) (inmap.data + in_offset * bpf),
-            pad->volume_i16, num_frames * srcpad->info.channels);
+        audiomixer_orc_add_volume_u16 (out, in, job->volume_i16, num_samples);
         break;
       case GST_AUDIO_FORMAT_S16:
-        audiomixer_orc_add_volume_s16 ((gpointer) (outmap.data +
-                out_offset * bpf), (gpointer) (inmap.data + in_offset * bpf),
-            pad->volume_i16, num_frames * srcpad->info.channels);
+        audiomixer_orc_add_volume_s16 (out, in, job->volume_i16, num_samples);
         break;
       case GST_AUDIO_FORMAT_U32:
-        audiomixer_orc_add_volume_u32 ((gpointer) (outmap.data +
-                out_offset * bpf), (gpointer) (inmap.data + in_offset * bpf),
-            pad->volume_i32, num_frames * srcpad->info.channels);
+        audiomixer_orc_add_volume_u32 (out, in, job->volume_i32, num_samples);
         break;
       case GST_AUDIO_FORMAT_S32:
-        audiomixer_orc_add_volume_s32 ((gpointer) (outmap.data +
-                out_offset * bpf), (gpointer) (inmap.data + in_offset * bpf),
-            pad->volume_i32, num_frames * srcpad->info.channels);
+        audiomixer_orc_add_volume_s32 (out, in, job->volume_i32, num_samples);
         break;
       case GST_AUDIO_FORMAT_F32:
-        audiomixer_orc_add_volume_f32 ((gpointer) (outmap.data +
-                out_offset * bpf), (gpointer) (inmap.data + in_offset * bpf),
-            pad->volume, num_frames * srcpad->info.channels);
+        audiomixer_orc_add_volume_f32 (out, in, job->volume, num_samples);
         break;
       case GST_AUDIO_FORMAT_F64:
-        audiomixer_orc_add_volume_f64 ((gpointer) (outmap.data +
-                out_offset * bpf), (gpointer) (inmap.data + in_offset * bpf),
-            pad->volume, num_frames * srcpad->info.channels);
+        audiomixer_orc_add_volume_f64 (out, in, job->volume, num_samples);
         break;
       default:
         g_assert_not_reached ();
         break;
     }
   }
+}
+
+/* Called with the object lock held */
+static guint
+gst_audiomixer_get_n_threads (GstAudioMixer * audiomixer)
+{
+  if (audiomixer->n_threads == 0)
+    return g_get_num_processors ();
+
+  return audiomixer->n_threads;
+}
+
+static gboolean
+gst_audiomixer_aggregate_one_buffer (GstAudioAggregator * aagg,
+    GstAudioAggregatorPad * aaggpad, GstBuffer * inbuf, guint in_offset,
+    GstBuffer * outbuf, guint out_offset, guint num_frames)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (aagg);
+  GstAudioMixerPad *pad = GST_AUDIO_MIXER_PAD (aaggpad);
+  GstAudioMixerJob job;
+  GstMapInfo inmap;
+  GstMapInfo outmap;
+  gint bpf;
+  GstAggregator *agg = GST_AGGREGATOR (aagg);
+  GstAudioAggregatorPad *srcpad = GST_AUDIO_AGGREGATOR_PAD (agg->srcpad);
+
+  GST_OBJECT_LOCK (aagg);
+  GST_OBJECT_LOCK (aaggpad);
+
+  if (pad->mute || pad->volume < G_MINDOUBLE) {
+    GST_DEBUG_OBJECT (pad, "Skipping muted pad");
+    GST_OBJECT_UNLOCK (aaggpad);
+    GST_OBJECT_UNLOCK (aagg);
+    return FALSE;
+  }
+
+  job.volume = pad->volume;
+  job.volume_i32 = pad->volume_i32;
+  job.volume_i16 = pad->volume_i16;
+  job.volume_i8 = pad->volume_i8;
+
+  if (gst_audiomixer_get_n_threads (audiomixer) > 1) {
+    /* only keep the jobs of the buffer that is being filled */
+    if (audiomixer->jobs_outbuf != outbuf) {
+      g_array_set_size (audiomixer->jobs, 0);
+      audiomixer->jobs_outbuf = outbuf;
+    }
+
+    GST_LOG_OBJECT (pad, "queueing %u frames at offset %u from offset %u",
+        num_frames, out_offset, in_offset);
+
+    job.buffer = gst_buffer_ref (inbuf);
+    job.in_offset = in_offset;
+    job.out_offset = out_offset;
+    job.num_frames = num_frames;
+    g_array_append_val (audiomixer->jobs, job);
+
+    GST_OBJECT_UNLOCK (aaggpad);
+    GST_OBJECT_UNLOCK (aagg);
+
+    return TRUE;
+  }
+
+  bpf = GST_AUDIO_INFO_BPF (&srcpad->info);
+
+  gst_buffer_map (outbuf, &outmap, GST_MAP_READWRITE);
+  gst_buffer_map (inbuf, &inmap, GST_MAP_READ);
+  GST_LOG_OBJECT (pad, "mixing %u bytes at offset %u from offset %u",
+      num_frames * bpf, out_offset * bpf, in_offset * bpf);
+
+  /* further buffers, need to add them */
+  gst_audiomixer_mix (&srcpad->info, &job, outmap.data + out_offset * bpf,
+      inmap.data + in_offset * bpf, num_frames);
+
   gst_buffer_unmap (inbuf, &inmap);
   gst_buffer_unmap (outbuf, &outmap);
 
@@ -420,6 +573,208 @@ gst_audiomixer_aggregate_one_buffer (GstAudioAggregator * aagg,
   return TRUE;
 }
 
+static void
+gst_audiomixer_mix_task (GstAudioMixerTask * task)
+{
+  gint bpf = GST_AUDIO_INFO_BPF (task->info);
+  guint i;
+
+  for (i = 0; i < task->jobs->len; i++) {
+    GstAudioMixerJob *job = &g_array_index (task->jobs, GstAudioMixerJob, i);
+    guint start, end;
+
+    start = MAX (job->out_offset, task->start);
+    end = MIN (job->out_offset + job->num_frames, task->end);
+    if (start >= end)
+      continue;
+
+    gst_audiomixer_mix (task->info, job, task->out + start * bpf,
+        job->map.data + (job->in_offset + start - job->out_offset) * bpf,
+        end - start);
+  }
+}
+
+static void
+gst_audiomixer_mix_thread_func (gpointer data, gpointer user_data)
+{
+  GstAudioMixer *audiomixer = user_data;
+
+  gst_audiomixer_mix_task (data);
+
+  g_mutex_lock (&audiomixer->thread_lock);
+  if (--audiomixer->n_pending_tasks == 0)
+    g_cond_signal (&audiomixer->thread_cond);
+  g_mutex_unlock (&audiomixer->thread_lock);
+}
+
+static void
+gst_audiomixer_setup_threads (GstAudioMixer * audiomixer, guint n_threads)
+{
+  if (n_threads == audiomixer->pool_threads)
+    return;
+
+  if (audiomixer->thread_pool)
+    g_thread_pool_free (audiomixer->thread_pool, FALSE, TRUE);
+  audiomixer->thread_pool = NULL;
+
+  GST_DEBUG_OBJECT (audiomixer, "using %u threads", n_threads);
+  audiomixer->pool_threads = n_threads;
+
+  /* the calling thread mixes one of the parts */
+  if (n_threads > 1)
+    audiomixer->thread_pool = g_thread_pool_new (gst_audiomixer_mix_thread_func,
+        audiomixer, n_threads - 1, FALSE, NULL);
+}
+
+/* Adds the queued jobs to @outbuf. The output frames are split into one
+ * part per thread and each thread adds all jobs to its part, which needs
+ * no extra memory and keeps the order of the additions.
+ *
+ * Called from the aggregating thread, without the object lock */
+static void
+gst_audiomixer_run_jobs (GstAudioMixer * audiomixer, GstBuffer * outbuf)
+{
+  GstAggregator *agg = GST_AGGREGATOR (audiomixer);
+  GstAudioAggregatorPad *srcpad = GST_AUDIO_AGGREGATOR_PAD (agg->srcpad);
+  GArray *jobs;
+  GstAudioMixerTask *tasks;
+  GstMapInfo outmap;
+  guint i, n_frames, n_tasks, n_threads;
+
+  /* take the queued jobs, the mixing itself doesn't need the lock */
+  GST_OBJECT_LOCK (audiomixer);
+  jobs = audiomixer->jobs;
+  if (jobs->len == 0) {
+    GST_OBJECT_UNLOCK (audiomixer);
+    return;
+  }
+  if (audiomixer->jobs_outbuf != outbuf) {
+    GST_WARNING_OBJECT (audiomixer, "dropping jobs of another buffer");
+    g_array_set_size (jobs, 0);
+    audiomixer->jobs_outbuf = NULL;
+    GST_OBJECT_UNLOCK (audiomixer);
+    return;
+  }
+  audiomixer->jobs = audiomixer->mix_jobs;
+  audiomixer->mix_jobs = jobs;
+  audiomixer->jobs_outbuf = NULL;
+  n_threads = gst_audiomixer_get_n_threads (audiomixer);
+  GST_OBJECT_UNLOCK (audiomixer);
+
+  gst_buffer_map (outbuf, &outmap, GST_MAP_READWRITE);
+  /* the buffer might have been shortened after the jobs were queued */
+  n_frames = outmap.size / GST_AUDIO_INFO_BPF (&srcpad->info);
+
+  for (i = 0; i < jobs->len; i++) {
+    GstAudioMixerJob *job = &g_array_index (jobs, GstAudioMixerJob, i);
+
+    gst_buffer_map (job->buffer, &job->map, GST_MAP_READ);
+  }
+
+  gst_audiomixer_setup_threads (audiomixer, n_threads);
+
+  n_tasks = CLAMP (n_frames / MIN_FRAMES_PER_TASK, 1,
+      audiomixer->pool_threads);
+  tasks = g_newa (GstAudioMixerTask, n_tasks);
+
+  for (i = 0; i < n_tasks; i++) {
+    tasks[i].info = &srcpad->info;
+    tasks[i].jobs = jobs;
+    tasks[i].out = outmap.data;
+    /* keep the parts aligned for the vectorized additions */
+    tasks[i].start = i == 0 ? 0 : tasks[i - 1].end;
+    tasks[i].end = i == n_tasks - 1 ? n_frames :
+        ((guint64) n_frames * (i + 1) / n_tasks) & ~15;
+  }
+
+  GST_LOG_OBJECT (audiomixer, "mixing %u jobs into %u frames on %u threads",
+      jobs->len, n_frames, n_tasks);
+
+  if (n_tasks > 1) {
+    audiomixer->n_pending_tasks = n_tasks - 1;
+    for (i = 1; i < n_tasks; i++)
+      g_thread_pool_push (audiomixer->thread_pool, &tasks[i], NULL);
+
+    gst_audiomixer_mix_task (&tasks[0]);
+
+    g_mutex_lock (&audiomixer->thread_lock);
+    while (audiomixer->n_pending_tasks > 0)
+      g_cond_wait (&audiomixer->thread_cond, &audiomixer->thread_lock);
+    g_mutex_unlock (&audiomixer->thread_lock);
+  } else {
+    gst_audiomixer_mix_task (&tasks[0]);
+  }
+
+  for (i = 0; i < jobs->len; i++) {
+    GstAudioMixerJob *job = &g_array_index (jobs, GstAudioMixerJob, i);
+
+    gst_buffer_unmap (job->buffer, &job->map);
+  }
+  gst_buffer_unmap (outbuf, &outmap);
+
+  g_array_set_size (jobs, 0);
+}
+
+static GstFlowReturn
+gst_audiomixer_finish_buffer (GstAggregator * agg, GstBuffer * buffer)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (agg);
+
+  gst_audiomixer_run_jobs (audiomixer, buffer);
+
+  return GST_AGGREGATOR_CLASS (parent_class)->finish_buffer (agg, buffer);
+}
+
+static gboolean
+gst_audiomixer_negotiated_src_caps (GstAggregator * agg, GstCaps * caps)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (agg);
+  GstBuffer *outbuf;
+
+  /* the jobs are in the current output format, add them before a partially
+   * mixed output buffer gets converted to the new one */
+  GST_OBJECT_LOCK (agg);
+  outbuf = audiomixer->jobs_outbuf;
+  GST_OBJECT_UNLOCK (agg);
+  if (outbuf)
+    gst_audiomixer_run_jobs (audiomixer, outbuf);
+
+  return GST_AGGREGATOR_CLASS (parent_class)->negotiated_src_caps (agg, caps);
+}
+
+static void
+gst_audiomixer_clear_jobs (GstAudioMixer * audiomixer)
+{
+  GST_OBJECT_LOCK (audiomixer);
+  g_array_set_size (audiomixer->jobs, 0);
+  audiomixer->jobs_outbuf = NULL;
+  GST_OBJECT_UNLOCK (audiomixer);
+}
+
+static gboolean
+gst_audiomixer_start (GstAggregator * agg)
+{
+  gst_audiomixer_clear_jobs (GST_AUDIO_MIXER (agg));
+
+  return GST_AGGREGATOR_CLASS (parent_class)->start (agg);
+}
+
+static gboolean
+gst_audiomixer_stop (GstAggregator * agg)
+{
+  gst_audiomixer_clear_jobs (GST_AUDIO_MIXER (agg));
+
+  return GST_AGGREGATOR_CLASS (parent_class)->stop (agg);
+}
+
+static GstFlowReturn
+gst_audiomixer_flush (GstAggregator * agg)
+{
+  gst_audiomixer_clear_jobs (GST_AUDIO_MIXER (agg));
+
+  return GST_AGGREGATOR_CLASS (parent_class)->flush (agg);
+}
+
 
 /* GstChildProxy implementation */
 static GObject *
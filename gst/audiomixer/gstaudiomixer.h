@@ -41,6 +41,20 @@ G_DECLARE_FINAL_TYPE (GstAudioMixer, gst_audiomixer, GST, AUDIO_MIXER,
  */
 struct _GstAudioMixer {
   GstAudioAggregator element;
+
+  /*< private >*/
+  /* protected by the object lock */
+  guint n_threads;
+  GArray *jobs;
+  GstBuffer *jobs_outbuf;
+
+  /* the jobs being mixed, only used from the aggregating thread */
+  GArray *mix_jobs;
+  GThreadPool *thread_pool;
+  guint pool_threads;
+  GMutex thread_lock;
+  GCond thread_cond;
+  gint n_pending_tasks;
 };
 
 #define GST_TYPE_AUDIO_MIXER_PAD (gst_audiomixer_pad_get_type())
@@ -42,11 +42,12 @@ GST_DEBUG_CATEGORY_STATIC (gst_compositor_blend_debug);
 #define BLEND_A32(name, method, LOOP)		\
 static void \
 method##_ ##name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
-    gdouble src_alpha, GstVideoFrame * destframe, GstCompositorBlendMode mode) \
+    gdouble src_alpha, GstVideoFrame * destframe, gint dst_y_start, \
+    gint dst_y_end, GstCompositorBlendMode mode) \
 { \
   guint s_alpha; \
   gint src_stride, dest_stride; \
-  gint dest_width, dest_height; \
+  gint dest_width; \
   guint8 *src, *dest; \
   gint src_width, src_height; \
   \
@@ -57,7 +58,6 @@ method##_ ##name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
   dest = GST_VIDEO_FRAME_PLANE_DATA (destframe, 0); \
   dest_stride = GST_VIDEO_FRAME_COMP_STRIDE (destframe, 0); \
   dest_width = GST_VIDEO_FRAME_COMP_WIDTH (destframe, 0); \
-  dest_height = GST_VIDEO_FRAME_COMP_HEIGHT (destframe, 0); \
   \
   s_alpha = CLAMP ((gint) (src_alpha * 255), 0, 255); \
   \
@@ -71,17 +71,17 @@ method##_ ##name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
     src_width -= -xpos; \
     xpos = 0; \
   } \
-  if (ypos < 0) { \
-    src += -ypos * src_stride; \
-    src_height -= -ypos; \
-    ypos = 0; \
+  if (ypos < dst_y_start) { \
+    src += (dst_y_start - ypos) * src_stride; \
+    src_height -= dst_y_start - ypos; \
+    ypos = dst_y_start; \
   } \
   /* adjust width/height if the src is bigger than dest */ \
   if (xpos + src_width > dest_width) { \
     src_width = dest_width - xpos; \
   } \
-  if (ypos + src_height > dest_height) { \
-    src_height = dest_height - ypos; \
+  if (ypos + src_height > dst_y_end) { \
+    src_height = dst_y_end - ypos; \
   } \
   \
   if (src_height > 0 && src_width > 0) { \
@@ -173,20 +173,20 @@ BLEND_A32 (bgra, overlay, _overlay_loop_argb);
 
 #define A32_CHECKER_C(name, RGB, A, C1, C2, C3) \
 static void \
-fill_checker_##name##_c (GstVideoFrame * frame) \
+fill_checker_##name##_c (GstVideoFrame * frame, guint y_start, guint y_end) \
 { \
   gint i, j; \
   gint val; \
   static const gint tab[] = { 80, 160, 80, 160 }; \
-  gint width, height; \
+  gint width, stride; \
   guint8 *dest; \
   \
-  dest = GST_VIDEO_FRAME_PLANE_DATA (frame, 0); \
   width = GST_VIDEO_FRAME_COMP_WIDTH (frame, 0); \
-  height = GST_VIDEO_FRAME_COMP_HEIGHT (frame, 0); \
+  stride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0); \
   \
   if (!RGB) { \
-    for (i = 0; i < height; i++) { \
+    for (i = y_start; i < y_end; i++) { \
+      dest = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (frame, 0) + i * stride; \
       for (j = 0; j < width; j++) { \
         dest[A] = 0xff; \
         dest[C1] = tab[((i & 0x8) >> 3) + ((j & 0x8) >> 3)]; \
@@ -196,7 +196,8 @@ fill_checker_##name##_c (GstVideoFrame * frame) \
       } \
     } \
   } else { \
-    for (i = 0; i < height; i++) { \
+    for (i = y_start; i < y_end; i++) { \
+      dest = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (frame, 0) + i * stride; \
       for (j = 0; j < width; j++) { \
         val = tab[((i & 0x8) >> 3) + ((j & 0x8) >> 3)]; \
         dest[A] = 0xFF; \
@@ -220,16 +221,17 @@ A32_CHECKER_C (vuya, FALSE, 3, 2, 1, 0);
 
 #define A32_COLOR(name, RGB, A, C1, C2, C3) \
 static void \
-fill_color_##name (GstVideoFrame * frame, gint Y, gint U, gint V) \
+fill_color_##name (GstVideoFrame * frame, guint y_start, guint y_end, \
+    gint Y, gint U, gint V) \
 { \
   gint c1, c2, c3; \
   guint32 val; \
-  gint width, height; \
+  gint i, width, stride; \
   guint8 *dest; \
   \
   dest = GST_VIDEO_FRAME_PLANE_DATA (frame, 0); \
   width = GST_VIDEO_FRAME_COMP_WIDTH (frame, 0); \
-  height = GST_VIDEO_FRAME_COMP_HEIGHT (frame, 0); \
+  stride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0); \
   \
   if (RGB) { \
     c1 = YUV_TO_R (Y, U, V); \
@@ -242,7 +244,13 @@ fill_color_##name (GstVideoFrame * frame, gint Y, gint U, gint V) \
   } \
   val = GUINT32_FROM_BE ((0xff << A) | (c1 << C1) | (c2 << C2) | (c3 << C3)); \
   \
-  compositor_orc_splat_u32 ((guint32 *) dest, val, height * width); \
+  if (stride == width * 4) { \
+    compositor_orc_splat_u32 ((guint32 *) (dest + y_start * stride), val, \
+        (y_end - y_start) * width); \
+  } else { \
+    for (i = y_start; i < y_end; i++) \
+      compositor_orc_splat_u32 ((guint32 *) (dest + i * stride), val, width); \
+  } \
 }
 
 A32_COLOR (argb, TRUE, 24, 16, 8, 0);
@@ -291,7 +299,8 @@ _blend_##format_name (const guint8 * src, guint8 * dest, \
 \
 static void \
 blend_##format_name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
-    gdouble src_alpha, GstVideoFrame * destframe, GstCompositorBlendMode mode) \
+    gdouble src_alpha, GstVideoFrame * destframe, gint dst_y_start, \
+    gint dst_y_end, GstCompositorBlendMode mode) \
 { \
   const guint8 *b_src; \
   guint8 *b_dest; \
@@ -304,7 +313,7 @@ blend_##format_name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
   gint src_comp_width; \
   gint comp_ypos, comp_xpos; \
   gint comp_yoffset, comp_xoffset; \
-  gint dest_width, dest_height; \
+  gint dest_width; \
   const GstVideoFormatInfo *info; \
   gint src_width, src_height; \
   \
@@ -313,7 +322,6 @@ blend_##format_name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
   \
   info = srcframe->info.finfo; \
   dest_width = GST_VIDEO_FRAME_WIDTH (destframe); \
-  dest_height = GST_VIDEO_FRAME_HEIGHT (destframe); \
   \
   xpos = x_round (xpos); \
   ypos = y_round (ypos); \
@@ -327,10 +335,10 @@ blend_##format_name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
     b_src_width -= -xpos; \
     xpos = 0; \
   } \
-  if (ypos < 0) { \
-    yoffset = -ypos; \
-    b_src_height -= -ypos; \
-    ypos = 0; \
+  if (ypos < dst_y_start) { \
+    yoffset = dst_y_start - ypos; \
+    b_src_height -= dst_y_start - ypos; \
+    ypos = dst_y_start; \
   } \
   /* If x or y offset are larger then the source it's outside of the picture */ \
   if (xoffset >= src_width || yoffset >= src_height) { \
@@ -341,8 +349,8 @@ blend_##format_name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
   if (xpos + b_src_width > dest_width) { \
     b_src_width = dest_width - xpos; \
   } \
-  if (ypos + b_src_height > dest_height) { \
-    b_src_height = dest_height - ypos; \
+  if (ypos + b_src_height > dst_y_end) { \
+    b_src_height = dst_y_end - ypos; \
   } \
   if (b_src_width <= 0 || b_src_height <= 0) { \
     return; \
@@ -400,20 +408,21 @@ blend_##format_name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
 
 #define PLANAR_YUV_FILL_CHECKER(format_name, format_enum, MEMSET) \
 static void \
-fill_checker_##format_name (GstVideoFrame * frame) \
+fill_checker_##format_name (GstVideoFrame * frame, guint y_start, guint y_end) \
 { \
   gint i, j; \
   static const int tab[] = { 80, 160, 80, 160 }; \
   guint8 *p; \
-  gint comp_width, comp_height; \
+  gint comp_width, comp_y_start, comp_y_end; \
   gint rowstride; \
+  const GstVideoFormatInfo *info = frame->info.finfo; \
   \
   p = GST_VIDEO_FRAME_COMP_DATA (frame, 0); \
   comp_width = GST_VIDEO_FRAME_COMP_WIDTH (frame, 0); \
-  comp_height = GST_VIDEO_FRAME_COMP_HEIGHT (frame, 0); \
   rowstride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0); \
+  p += y_start * rowstride; \
   \
-  for (i = 0; i < comp_height; i++) { \
+  for (i = y_start; i < y_end; i++) { \
     for (j = 0; j < comp_width; j++) { \
       *p++ = tab[((i & 0x8) >> 3) + ((j & 0x8) >> 3)]; \
     } \
@@ -422,20 +431,24 @@ fill_checker_##format_name (GstVideoFrame * frame) \
   \
   p = GST_VIDEO_FRAME_COMP_DATA (frame, 1); \
   comp_width = GST_VIDEO_FRAME_COMP_WIDTH (frame, 1); \
-  comp_height = GST_VIDEO_FRAME_COMP_HEIGHT (frame, 1); \
+  comp_y_start = GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (info, 1, y_start); \
+  comp_y_end = GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (info, 1, y_end); \
   rowstride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 1); \
+  p += comp_y_start * rowstride; \
   \
-  for (i = 0; i < comp_height; i++) { \
+  for (i = comp_y_start; i < comp_y_end; i++) { \
     MEMSET (p, 0x80, comp_width); \
     p += rowstride; \
   } \
   \
   p = GST_VIDEO_FRAME_COMP_DATA (frame, 2); \
   comp_width = GST_VIDEO_FRAME_COMP_WIDTH (frame, 2); \
-  comp_height = GST_VIDEO_FRAME_COMP_HEIGHT (frame, 2); \
+  comp_y_start = GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (info, 2, y_start); \
+  comp_y_end = GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (info, 2, y_end); \
   rowstride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 2); \
+  p += comp_y_start * rowstride; \
   \
-  for (i = 0; i < comp_height; i++) { \
+  for (i = comp_y_start; i < comp_y_end; i++) { \
     MEMSET (p, 0x80, comp_width); \
     p += rowstride; \
   } \
@@ -444,39 +457,44 @@ fill_checker_##format_name (GstVideoFrame * frame) \
 #define PLANAR_YUV_FILL_COLOR(format_name,format_enum,MEMSET) \
 static void \
 fill_color_##format_name (GstVideoFrame * frame, \
-    gint colY, gint colU, gint colV) \
+    guint y_start, guint y_end, gint colY, gint colU, gint colV) \
 { \
   guint8 *p; \
-  gint comp_width, comp_height; \
+  gint comp_width, comp_y_start, comp_y_end; \
   gint rowstride; \
   gint i; \
+  const GstVideoFormatInfo *info = frame->info.finfo; \
   \
   p = GST_VIDEO_FRAME_COMP_DATA (frame, 0); \
   comp_width = GST_VIDEO_FRAME_COMP_WIDTH (frame, 0); \
-  comp_height = GST_VIDEO_FRAME_COMP_HEIGHT (frame, 0); \
   rowstride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0); \
+  p += y_start * rowstride; \
   \
-  for (i = 0; i < comp_height; i++) { \
+  for (i = y_start; i < y_end; i++) { \
     MEMSET (p, colY, comp_width); \
     p += rowstride; \
   } \
   \
   p = GST_VIDEO_FRAME_COMP_DATA (frame, 1); \
   comp_width = GST_VIDEO_FRAME_COMP_WIDTH (frame, 1); \
-  comp_height = GST_VIDEO_FRAME_COMP_HEIGHT (frame, 1); \
+  comp_y_start = GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (info, 1, y_start); \
+  comp_y_end = GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (info, 1, y_end); \
   rowstride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 1); \
+  p += comp_y_start * rowstride; \
   \
-  for (i = 0; i < comp_height; i++) { \
+  for (i = comp_y_start; i < comp_y_end; i++) { \
     MEMSET (p, colU, comp_width); \
     p += rowstride; \
   } \
   \
   p = GST_VIDEO_FRAME_COMP_DATA (frame, 2); \
   comp_width = GST_VIDEO_FRAME_COMP_WIDTH (frame, 2); \
-  comp_height = GST_VIDEO_FRAME_COMP_HEIGHT (frame, 2); \
+  comp_y_start = GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (info, 2, y_start); \
+  comp_y_end = GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (info, 2, y_end); \
   rowstride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 2); \
+  p += comp_y_start * rowstride; \
   \
-  for (i = 0; i < comp_height; i++) { \
+  for (i = comp_y_start; i < comp_y_end; i++) { \
     MEMSET (p, colV, comp_width); \
     p += rowstride; \
   } \
@@ -541,7 +559,8 @@ _blend_##format_name (const guint8 * src, guint8 * dest, \
 \
 static void \
 blend_##format_name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
-    gdouble src_alpha, GstVideoFrame * destframe, GstCompositorBlendMode mode)                    \
+    gdouble src_alpha, GstVideoFrame * destframe, gint dst_y_start, \
+    gint dst_y_end, GstCompositorBlendMode mode) \
 { \
   const guint8 *b_src; \
   guint8 *b_dest; \
@@ -554,7 +573,7 @@ blend_##format_name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
   gint src_comp_width; \
   gint comp_ypos, comp_xpos; \
   gint comp_yoffset, comp_xoffset; \
-  gint dest_width, dest_height; \
+  gint dest_width; \
   const GstVideoFormatInfo *info; \
   gint src_width, src_height; \
   \
@@ -563,7 +582,6 @@ blend_##format_name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
   \
   info = srcframe->info.finfo; \
   dest_width = GST_VIDEO_FRAME_WIDTH (destframe); \
-  dest_height = GST_VIDEO_FRAME_HEIGHT (destframe); \
   \
   xpos = GST_ROUND_UP_2 (xpos); \
   ypos = GST_ROUND_UP_2 (ypos); \
@@ -577,10 +595,10 @@ blend_##format_name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
     b_src_width -= -xpos; \
     xpos = 0; \
   } \
-  if (ypos < 0) { \
-    yoffset += -ypos; \
-    b_src_height -= -ypos; \
-    ypos = 0; \
+  if (ypos < dst_y_start) { \
+    yoffset += dst_y_start - ypos; \
+    b_src_height -= dst_y_start - ypos; \
+    ypos = dst_y_start; \
   } \
   /* If x or y offset are larger then the source it's outside of the picture */ \
   if (xoffset > src_width || yoffset > src_height) { \
@@ -591,10 +609,10 @@ blend_##format_name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
   if (xpos + b_src_width > dest_width) { \
     b_src_width = dest_width - xpos; \
   } \
-  if (ypos + b_src_height > dest_height) { \
-    b_src_height = dest_height - ypos; \
+  if (ypos + b_src_height > dst_y_end) { \
+    b_src_height = dst_y_end - ypos; \
   } \
-  if (b_src_width < 0 || b_src_height < 0) { \
+  if (b_src_width <= 0 || b_src_height <= 0) { \
     return; \
   } \
   \
@@ -634,20 +652,21 @@ blend_##format_name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
 
 #define NV_YUV_FILL_CHECKER(format_name, MEMSET)        \
 static void \
-fill_checker_##format_name (GstVideoFrame * frame) \
+fill_checker_##format_name (GstVideoFrame * frame, guint y_start, guint y_end) \
 { \
   gint i, j; \
   static const int tab[] = { 80, 160, 80, 160 }; \
   guint8 *p; \
-  gint comp_width, comp_height; \
+  gint comp_width, comp_y_start, comp_y_end; \
   gint rowstride; \
+  const GstVideoFormatInfo *info = frame->info.finfo; \
   \
   p = GST_VIDEO_FRAME_COMP_DATA (frame, 0); \
   comp_width = GST_VIDEO_FRAME_COMP_WIDTH (frame, 0); \
-  comp_height = GST_VIDEO_FRAME_COMP_HEIGHT (frame, 0); \
   rowstride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0); \
+  p += y_start * rowstride; \
   \
-  for (i = 0; i < comp_height; i++) { \
+  for (i = y_start; i < y_end; i++) { \
     for (j = 0; j < comp_width; j++) { \
       *p++ = tab[((i & 0x8) >> 3) + ((j & 0x8) >> 3)]; \
     } \
@@ -656,10 +675,12 @@ fill_checker_##format_name (GstVideoFrame * frame) \
   \
   p = GST_VIDEO_FRAME_PLANE_DATA (frame, 1); \
   comp_width = GST_VIDEO_FRAME_COMP_WIDTH (frame, 1); \
-  comp_height = GST_VIDEO_FRAME_COMP_HEIGHT (frame, 1); \
+  comp_y_start = GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (info, 1, y_start); \
+  comp_y_end = GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (info, 1, y_end); \
   rowstride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 1); \
+  p += comp_y_start * rowstride; \
   \
-  for (i = 0; i < comp_height; i++) { \
+  for (i = comp_y_start; i < comp_y_end; i++) { \
     MEMSET (p, 0x80, comp_width * 2); \
     p += rowstride; \
   } \
@@ -668,19 +689,20 @@ fill_checker_##format_name (GstVideoFrame * frame) \
 #define NV_YUV_FILL_COLOR(format_name,MEMSET) \
 static void \
 fill_color_##format_name (GstVideoFrame * frame, \
-    gint colY, gint colU, gint colV) \
+    guint y_start, guint y_end, gint colY, gint colU, gint colV) \
 { \
   guint8 *y, *u, *v; \
-  gint comp_width, comp_height; \
+  gint comp_width, comp_y_start, comp_y_end; \
   gint rowstride; \
   gint i, j; \
+  const GstVideoFormatInfo *info = frame->info.finfo; \
   \
   y = GST_VIDEO_FRAME_COMP_DATA (frame, 0); \
   comp_width = GST_VIDEO_FRAME_COMP_WIDTH (frame, 0); \
-  comp_height = GST_VIDEO_FRAME_COMP_HEIGHT (frame, 0); \
   rowstride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0); \
+  y += y_start * rowstride; \
   \
-  for (i = 0; i < comp_height; i++) { \
+  for (i = y_start; i < y_end; i++) { \
     MEMSET (y, colY, comp_width); \
     y += rowstride; \
   } \
@@ -688,10 +710,13 @@ fill_color_##format_name (GstVideoFrame * frame, \
   u = GST_VIDEO_FRAME_COMP_DATA (frame, 1); \
   v = GST_VIDEO_FRAME_COMP_DATA (frame, 2); \
   comp_width = GST_VIDEO_FRAME_COMP_WIDTH (frame, 1); \
-  comp_height = GST_VIDEO_FRAME_COMP_HEIGHT (frame, 1); \
+  comp_y_start = GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (info, 1, y_start); \
+  comp_y_end = GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (info, 1, y_end); \
   rowstride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 1); \
+  u += comp_y_start * rowstride; \
+  v += comp_y_start * rowstride; \
   \
-  for (i = 0; i < comp_height; i++) { \
+  for (i = comp_y_start; i < comp_y_end; i++) { \
     for (j = 0; j < comp_width; j++) { \
       u[j*2] = colU; \
       v[j*2] = colV; \
@@ -712,12 +737,13 @@ NV_YUV_FILL_CHECKER (nv21, memset);
 #define RGB_BLEND(name, bpp, MEMCPY, BLENDLOOP) \
 static void \
 blend_##name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
-    gdouble src_alpha, GstVideoFrame * destframe, GstCompositorBlendMode mode) \
+    gdouble src_alpha, GstVideoFrame * destframe, gint dst_y_start, \
+    gint dst_y_end, GstCompositorBlendMode mode) \
 { \
   gint b_alpha; \
   gint i; \
   gint src_stride, dest_stride; \
-  gint dest_width, dest_height; \
+  gint dest_width; \
   guint8 *dest, *src; \
   gint src_width, src_height; \
   \
@@ -728,7 +754,6 @@ blend_##name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
   dest = GST_VIDEO_FRAME_PLANE_DATA (destframe, 0); \
   \
   dest_width = GST_VIDEO_FRAME_WIDTH (destframe); \
-  dest_height = GST_VIDEO_FRAME_HEIGHT (destframe); \
   \
   src_stride = GST_VIDEO_FRAME_COMP_STRIDE (srcframe, 0); \
   dest_stride = GST_VIDEO_FRAME_COMP_STRIDE (destframe, 0); \
@@ -741,19 +766,22 @@ blend_##name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
     src_width -= -xpos; \
     xpos = 0; \
   } \
-  if (ypos < 0) { \
-    src += -ypos * src_stride; \
-    src_height -= -ypos; \
-    ypos = 0; \
+  if (ypos < dst_y_start) { \
+    src += (dst_y_start - ypos) * src_stride; \
+    src_height -= dst_y_start - ypos; \
+    ypos = dst_y_start; \
   } \
   /* adjust width/height if the src is bigger than dest */ \
   if (xpos + src_width > dest_width) { \
     src_width = dest_width - xpos; \
   } \
-  if (ypos + src_height > dest_height) { \
-    src_height = dest_height - ypos; \
+  if (ypos + src_height > dst_y_end) { \
+    src_height = dst_y_end - ypos; \
   } \
   \
+  if (src_height <= 0 || src_width <= 0) \
+    return; \
+  \
   dest = dest + bpp * xpos + (ypos * dest_stride); \
   \
   /* in source mode we just have to copy over things */ \
@@ -783,20 +811,20 @@ blend_##name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
 
 #define RGB_FILL_CHECKER_C(name, bpp, r, g, b) \
 static void \
-fill_checker_##name##_c (GstVideoFrame * frame) \
+fill_checker_##name##_c (GstVideoFrame * frame, guint y_start, guint y_end) \
 { \
   gint i, j; \
   static const int tab[] = { 80, 160, 80, 160 }; \
-  gint stride, dest_add, width, height; \
+  gint stride, dest_add, width; \
   guint8 *dest; \
   \
   width = GST_VIDEO_FRAME_WIDTH (frame); \
-  height = GST_VIDEO_FRAME_HEIGHT (frame); \
   dest = GST_VIDEO_FRAME_PLANE_DATA (frame, 0); \
   stride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0); \
   dest_add = stride - width * bpp; \
+  dest += y_start * stride; \
   \
-  for (i = 0; i < height; i++) { \
+  for (i = y_start; i < y_end; i++) { \
     for (j = 0; j < width; j++) { \
       dest[r] = tab[((i & 0x8) >> 3) + ((j & 0x8) >> 3)];       /* red */ \
       dest[g] = tab[((i & 0x8) >> 3) + ((j & 0x8) >> 3)];       /* green */ \
@@ -810,24 +838,24 @@ fill_checker_##name##_c (GstVideoFrame * frame) \
 #define RGB_FILL_COLOR(name, bpp, MEMSET_RGB) \
 static void \
 fill_color_##name (GstVideoFrame * frame, \
-    gint colY, gint colU, gint colV) \
+    guint y_start, guint y_end, gint colY, gint colU, gint colV) \
 { \
   gint red, green, blue; \
   gint i; \
   gint dest_stride; \
-  gint width, height; \
+  gint width; \
   guint8 *dest; \
   \
   width = GST_VIDEO_FRAME_WIDTH (frame); \
-  height = GST_VIDEO_FRAME_HEIGHT (frame); \
   dest = GST_VIDEO_FRAME_PLANE_DATA (frame, 0); \
   dest_stride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0); \
+  dest += y_start * dest_stride; \
   \
   red = YUV_TO_R (colY, colU, colV); \
   green = YUV_TO_G (colY, colU, colV); \
   blue = YUV_TO_B (colY, colU, colV); \
   \
-  for (i = 0; i < height; i++) { \
+  for (i = y_start; i < y_end; i++) { \
     MEMSET_RGB (dest, red, green, blue, width); \
     dest += dest_stride; \
   } \
@@ -885,12 +913,13 @@ RGB_FILL_COLOR (bgrx, 4, _memset_bgrx);
 #define PACKED_422_BLEND(name, MEMCPY, BLENDLOOP) \
 static void \
 blend_##name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
-    gdouble src_alpha, GstVideoFrame * destframe, GstCompositorBlendMode mode) \
+    gdouble src_alpha, GstVideoFrame * destframe, gint dst_y_start, \
+    gint dst_y_end, GstCompositorBlendMode mode) \
 { \
   gint b_alpha; \
   gint i; \
   gint src_stride, dest_stride; \
-  gint dest_width, dest_height; \
+  gint dest_width; \
   guint8 *src, *dest; \
   gint src_width, src_height; \
   \
@@ -898,7 +927,6 @@ blend_##name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
   src_height = GST_VIDEO_FRAME_HEIGHT (srcframe); \
   \
   dest_width = GST_VIDEO_FRAME_WIDTH (destframe); \
-  dest_height = GST_VIDEO_FRAME_HEIGHT (destframe); \
   \
   src = GST_VIDEO_FRAME_PLANE_DATA (srcframe, 0); \
   dest = GST_VIDEO_FRAME_PLANE_DATA (destframe, 0); \
@@ -916,20 +944,23 @@ blend_##name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
     src_width -= -xpos; \
     xpos = 0; \
   } \
-  if (ypos < 0) { \
-    src += -ypos * src_stride; \
-    src_height -= -ypos; \
-    ypos = 0; \
+  if (ypos < dst_y_start) { \
+    src += (dst_y_start - ypos) * src_stride; \
+    src_height -= dst_y_start - ypos; \
+    ypos = dst_y_start; \
   } \
   \
   /* adjust width/height if the src is bigger than dest */ \
   if (xpos + src_width > dest_width) { \
     src_width = dest_width - xpos; \
   } \
-  if (ypos + src_height > dest_height) { \
-    src_height = dest_height - ypos; \
+  if (ypos + src_height > dst_y_end) { \
+    src_height = dst_y_end - ypos; \
   } \
   \
+  if (src_height <= 0 || src_width <= 0) \
+    return; \
+  \
   dest = dest + 2 * xpos + (ypos * dest_stride); \
   \
   /* in source mode we just have to copy over things */ \
@@ -959,22 +990,22 @@ blend_##name (GstVideoFrame * srcframe, gint xpos, gint ypos, \
 
 #define PACKED_422_FILL_CHECKER_C(name, Y1, U, Y2, V) \
 static void \
-fill_checker_##name##_c (GstVideoFrame * frame) \
+fill_checker_##name##_c (GstVideoFrame * frame, guint y_start, guint y_end) \
 { \
   gint i, j; \
   static const int tab[] = { 80, 160, 80, 160 }; \
   gint dest_add; \
-  gint width, height; \
+  gint width; \
   guint8 *dest; \
   \
   width = GST_VIDEO_FRAME_WIDTH (frame); \
   width = GST_ROUND_UP_2 (width); \
-  height = GST_VIDEO_FRAME_HEIGHT (frame); \
   dest = GST_VIDEO_FRAME_PLANE_DATA (frame, 0); \
   dest_add = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0) - width * 2; \
+  dest += y_start * GST_VIDEO_FRAME_COMP_STRIDE (frame, 0); \
   width /= 2; \
   \
-  for (i = 0; i < height; i++) { \
+  for (i = y_start; i < y_end; i++) { \
     for (j = 0; j < width; j++) { \
       dest[Y1] = tab[((i & 0x8) >> 3) + (((2 * j + 0) & 0x8) >> 3)]; \
       dest[Y2] = tab[((i & 0x8) >> 3) + (((2 * j + 1) & 0x8) >> 3)]; \
@@ -989,24 +1020,24 @@ fill_checker_##name##_c (GstVideoFrame * frame) \
 #define PACKED_422_FILL_COLOR(name, Y1, U, Y2, V) \
 static void \
 fill_color_##name (GstVideoFrame * frame, \
-    gint colY, gint colU, gint colV) \
+    guint y_start, guint y_end, gint colY, gint colU, gint colV) \
 { \
   gint i; \
   gint dest_stride; \
   guint32 val; \
-  gint width, height; \
+  gint width; \
   guint8 *dest; \
   \
   width = GST_VIDEO_FRAME_WIDTH (frame); \
   width = GST_ROUND_UP_2 (width); \
-  height = GST_VIDEO_FRAME_HEIGHT (frame); \
   dest = GST_VIDEO_FRAME_PLANE_DATA (frame, 0); \
   dest_stride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0); \
+  dest += y_start * dest_stride; \
   width /= 2; \
   \
   val = GUINT32_FROM_BE ((colY << Y1) | (colY << Y2) | (colU << U) | (colV << V)); \
   \
-  for (i = 0; i < height; i++) { \
+  for (i = y_start; i < y_end; i++) { \
     compositor_orc_splat_u32 ((guint32 *) dest, val, width); \
     dest += dest_stride; \
   } \
@@ -38,10 +38,14 @@ typedef enum
   COMPOSITOR_BLEND_MODE_ADD,
 } GstCompositorBlendMode;
 
+/* All functions only touch the destination lines [y_start, y_end), which
+ * allows the output frame to be processed in independent horizontal
+ * stripes. Stripe boundaries must be multiples of the vertical chroma
+ * subsampling of the format. */
 typedef void (*BlendFunction) (GstVideoFrame *srcframe, gint xpos, gint ypos, gdouble src_alpha, GstVideoFrame * destframe,
-    GstCompositorBlendMode mode);
-typedef void (*FillCheckerFunction) (GstVideoFrame * frame);
-typedef void (*FillColorFunction) (GstVideoFrame * frame, gint c1, gint c2, gint c3);
+    gint dst_y_start, gint dst_y_end, GstCompositorBlendMode mode);
+typedef void (*FillCheckerFunction) (GstVideoFrame * frame, guint y_start, guint y_end);
+typedef void (*FillColorFunction) (GstVideoFrame * frame, guint y_start, guint y_end, gint c1, gint c2, gint c3);
 
 extern BlendFunction gst_compositor_blend_argb;
 extern BlendFunction gst_compositor_blend_bgra;
@@ -441,6 +441,20 @@ done:
   return TRUE;
 }
 
+/* Any property change, including the ones of the parent classes like
+ * zorder or converter-config, invalidates the incremental compositing of
+ * the pad. The notification is emitted after the new value was set. */
+static void
+gst_compositor_pad_notify (GObject * object, GParamSpec * pspec)
+{
+  GstCompositorPad *pad = GST_COMPOSITOR_PAD (object);
+
+  g_atomic_int_inc (&pad->config_cookie);
+
+  if (G_OBJECT_CLASS (gst_compositor_pad_parent_class)->notify)
+    G_OBJECT_CLASS (gst_compositor_pad_parent_class)->notify (object, pspec);
+}
+
 static void
 gst_compositor_pad_create_conversion_info (GstVideoAggregatorConvertPad * pad,
     GstVideoAggregator * vagg, GstVideoInfo * conversion_info)
@@ -494,6 +508,7 @@ gst_compositor_pad_class_init (GstCompositorPadClass * klass)
 
   gobject_class->set_property = gst_compositor_pad_set_property;
   gobject_class->get_property = gst_compositor_pad_get_property;
+  gobject_class->notify = gst_compositor_pad_notify;
 
   g_object_class_install_property (gobject_class, PROP_PAD_XPOS,
       g_param_spec_int ("xpos", "X Position", "X Position of the picture",
@@ -526,6 +541,9 @@ gst_compositor_pad_class_init (GstCompositorPadClass * klass)
 
   vaggcpadclass->create_conversion_info =
       GST_DEBUG_FUNCPTR (gst_compositor_pad_create_conversion_info);
+  /* prepare_frame only reads the other pads, with the object lock of the
+   * aggregator taken */
+  vaggcpadclass->parallel_prepare_frame = TRUE;
 }
 
 static void
@@ -540,10 +558,14 @@ gst_compositor_pad_init (GstCompositorPad * compo_pad)
 
 /* GstCompositor */
 #define DEFAULT_BACKGROUND COMPOSITOR_BACKGROUND_CHECKER
+#define DEFAULT_N_THREADS 1
+#define DEFAULT_INCREMENTAL FALSE
 enum
 {
   PROP_0,
   PROP_BACKGROUND,
+  PROP_N_THREADS,
+  PROP_INCREMENTAL,
 };
 
 static void
@@ -556,6 +578,16 @@ gst_compositor_get_property (GObject * object,
     case PROP_BACKGROUND:
       g_value_set_enum (value, self->background);
       break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, self->n_threads);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_INCREMENTAL:
+      GST_OBJECT_LOCK (self);
+      g_value_set_boolean (value, self->incremental);
+      GST_OBJECT_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -572,6 +604,16 @@ gst_compositor_set_property (GObject * object,
     case PROP_BACKGROUND:
       self->background = g_value_get_enum (value);
       break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (self);
+      self->n_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_INCREMENTAL:
+      GST_OBJECT_LOCK (self);
+      self->incremental = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -583,6 +625,29 @@ G_DEFINE_TYPE_WITH_CODE (GstCompositor, gst_compositor,
     GST_TYPE_VIDEO_AGGREGATOR, G_IMPLEMENT_INTERFACE (GST_TYPE_CHILD_PROXY,
         gst_compositor_child_proxy_init));
 
+static void
+gst_compositor_reset_cache (GstCompositor * self)
+{
+  gst_clear_buffer (&self->cache);
+  g_clear_pointer (&self->dirty_lines, g_free);
+  g_array_set_size (self->cache_pads, 0);
+}
+
+static void
+gst_compositor_finalize (GObject * object)
+{
+  GstCompositor *self = GST_COMPOSITOR (object);
+
+  if (self->task_pool)
+    gst_video_task_pool_unref (self->task_pool);
+  self->task_pool = NULL;
+
+  gst_compositor_reset_cache (self);
+  g_array_free (self->cache_pads, TRUE);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static gboolean
 set_functions (GstCompositor * self, GstVideoInfo * info)
 {
@@ -845,6 +910,9 @@ _negotiated_caps (GstAggregator * agg, GstCaps * caps)
     return FALSE;
   }
 
+  /* the previous output frame has the old size and format */
+  gst_compositor_reset_cache (GST_COMPOSITOR (agg));
+
   return GST_AGGREGATOR_CLASS (parent_class)->negotiated_src_caps (agg, caps);
 }
 
@@ -872,9 +940,10 @@ _should_draw_background (GstVideoAggregator * vagg)
   return draw;
 }
 
+/* Returns whether the background has to be drawn and sets @composite to the
+ * function to use for blending the pads */
 static gboolean
-_draw_background (GstVideoAggregator * vagg, GstVideoFrame * outframe,
-    BlendFunction * composite)
+_prepare_background (GstVideoAggregator * vagg, BlendFunction * composite)
 {
   GstCompositor *comp = GST_COMPOSITOR (vagg);
 
@@ -886,42 +955,52 @@ _draw_background (GstVideoAggregator * vagg, GstVideoFrame * outframe,
   if (!_should_draw_background (vagg))
     return FALSE;
 
+  /* use overlay to keep background transparent */
+  if (comp->background == COMPOSITOR_BACKGROUND_TRANSPARENT)
+    *composite = comp->overlay;
+
+  return TRUE;
+}
+
+static void
+_draw_background (GstCompositor * comp, GstVideoFrame * outframe,
+    guint y_start, guint y_end)
+{
   switch (comp->background) {
     case COMPOSITOR_BACKGROUND_CHECKER:
-      comp->fill_checker (outframe);
+      comp->fill_checker (outframe, y_start, y_end);
       break;
     case COMPOSITOR_BACKGROUND_BLACK:
-      comp->fill_color (outframe, 16, 128, 128);
+      comp->fill_color (outframe, y_start, y_end, 16, 128, 128);
       break;
     case COMPOSITOR_BACKGROUND_WHITE:
-      comp->fill_color (outframe, 240, 128, 128);
+      comp->fill_color (outframe, y_start, y_end, 240, 128, 128);
       break;
     case COMPOSITOR_BACKGROUND_TRANSPARENT:
     {
-      guint i, plane, num_planes, height;
+      const GstVideoFormatInfo *finfo = outframe->info.finfo;
+      guint i, plane, num_planes, line_start, line_end;
 
       num_planes = GST_VIDEO_FRAME_N_PLANES (outframe);
       for (plane = 0; plane < num_planes; ++plane) {
         guint8 *pdata;
         gsize rowsize, plane_stride;
 
-        pdata = GST_VIDEO_FRAME_PLANE_DATA (outframe, plane);
         plane_stride = GST_VIDEO_FRAME_PLANE_STRIDE (outframe, plane);
         rowsize = GST_VIDEO_FRAME_COMP_WIDTH (outframe, plane)
             * GST_VIDEO_FRAME_COMP_PSTRIDE (outframe, plane);
-        height = GST_VIDEO_FRAME_COMP_HEIGHT (outframe, plane);
-        for (i = 0; i < height; ++i) {
+        line_start = GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (finfo, plane, y_start);
+        line_end = GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (finfo, plane, y_end);
+        pdata = GST_VIDEO_FRAME_PLANE_DATA (outframe, plane);
+        pdata += line_start * plane_stride;
+        for (i = line_start; i < line_end; ++i) {
           memset (pdata, 0, rowsize);
           pdata += plane_stride;
         }
       }
-      /* use overlay to keep background transparent */
-      *composite = comp->overlay;
       break;
     }
   }
-
-  return TRUE;
 }
 
 static gboolean
@@ -936,14 +1015,230 @@ frames_can_copy (const GstVideoFrame * frame1, const GstVideoFrame * frame2)
   return TRUE;
 }
 
+/* Like gst_video_frame_copy() but only for the lines [y_start, y_end) */
+static void
+frame_copy_lines (GstVideoFrame * dest, const GstVideoFrame * src,
+    guint y_start, guint y_end)
+{
+  const GstVideoFormatInfo *finfo = dest->info.finfo;
+  guint i, plane, num_planes, line_start, line_end;
+
+  num_planes = GST_VIDEO_FRAME_N_PLANES (dest);
+  for (plane = 0; plane < num_planes; ++plane) {
+    const guint8 *sp;
+    guint8 *dp;
+    gsize rowsize;
+    gint ss, ds;
+
+    ss = GST_VIDEO_FRAME_PLANE_STRIDE (src, plane);
+    ds = GST_VIDEO_FRAME_PLANE_STRIDE (dest, plane);
+    rowsize = GST_VIDEO_FRAME_COMP_WIDTH (dest, plane)
+        * GST_VIDEO_FRAME_COMP_PSTRIDE (dest, plane);
+    line_start = GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (finfo, plane, y_start);
+    line_end = GST_VIDEO_FORMAT_INFO_SCALE_HEIGHT (finfo, plane, y_end);
+    sp = GST_VIDEO_FRAME_PLANE_DATA (src, plane);
+    dp = GST_VIDEO_FRAME_PLANE_DATA (dest, plane);
+    sp += line_start * ss;
+    dp += line_start * ds;
+    for (i = line_start; i < line_end; ++i) {
+      memcpy (dp, sp, rowsize);
+      sp += ss;
+      dp += ds;
+    }
+  }
+}
+
+typedef struct
+{
+  GstPad *pad;
+  /* identity of the input frame, see blend_pad_changed() */
+  GstBuffer *buffer;
+  gint config_cookie;
+  /* only valid during the current aggregate_frames() call */
+  GstVideoFrame *prepared_frame;
+  gint xpos, ypos;
+  gint width, height;
+  gdouble alpha;
+  GstCompositorBlendMode blend_mode;
+  /* copy the frame as-is instead of blending it */
+  gboolean copy;
+} CompositorBlendPad;
+
+typedef struct
+{
+  GstCompositor *compositor;
+  GstVideoFrame *out_frame;
+  /* copy of the previous output and the lines of it that have to be
+   * composited again, or NULL to composite all lines */
+  GstVideoFrame *cache_frame;
+  const guint8 *dirty_lines;
+  guint dst_line_start, dst_line_end;
+  gboolean draw_background;
+  BlendFunction composite;
+  const CompositorBlendPad *pads;
+  guint n_pads;
+} CompositorBlendTask;
+
+/* Produces the output lines [y_start, y_end): background first, then all
+ * pads in z-order, exactly like a full frame would be done */
+static void
+gst_compositor_blend_lines (CompositorBlendTask * task, guint y_start,
+    guint y_end)
+{
+  guint i;
+
+  if (task->draw_background)
+    _draw_background (task->compositor, task->out_frame, y_start, y_end);
+
+  for (i = 0; i < task->n_pads; i++) {
+    const CompositorBlendPad *pad = &task->pads[i];
+
+    if (pad->copy)
+      frame_copy_lines (task->out_frame, pad->prepared_frame, y_start, y_end);
+    else
+      task->composite (pad->prepared_frame, pad->xpos, pad->ypos, pad->alpha,
+          task->out_frame, y_start, y_end, pad->blend_mode);
+  }
+}
+
+static void
+gst_compositor_blend_task (CompositorBlendTask * task)
+{
+  guint y, y_end;
+
+  if (task->cache_frame == NULL) {
+    gst_compositor_blend_lines (task, task->dst_line_start,
+        task->dst_line_end);
+    return;
+  }
+
+  /* Dirty lines are composited and stored for the next frame, all others
+   * are taken from the previous output */
+  for (y = task->dst_line_start; y < task->dst_line_end; y = y_end) {
+    guint8 dirty = task->dirty_lines[y];
+
+    y_end = y + 1;
+    while (y_end < task->dst_line_end && task->dirty_lines[y_end] == dirty)
+      y_end++;
+
+    if (dirty) {
+      gst_compositor_blend_lines (task, y, y_end);
+      frame_copy_lines (task->cache_frame, task->out_frame, y, y_end);
+    } else {
+      frame_copy_lines (task->out_frame, task->cache_frame, y, y_end);
+    }
+  }
+}
+
+/* Buffers are compared by pointer: a pad that has no new input keeps the
+ * very same buffer. The cached pads hold a reference to their buffer, so it
+ * can't be freed or recycled by a pool and come back at the same address. */
+static gboolean
+blend_pad_changed (const CompositorBlendPad * old,
+    const CompositorBlendPad * pad)
+{
+  if (pad->buffer != old->buffer || pad->config_cookie != old->config_cookie)
+    return TRUE;
+
+  return pad->xpos != old->xpos || pad->ypos != old->ypos
+      || pad->width != old->width || pad->height != old->height
+      || pad->alpha != old->alpha || pad->blend_mode != old->blend_mode;
+}
+
+static void
+compositor_blend_pad_clear (CompositorBlendPad * pad)
+{
+  gst_object_unref (pad->pad);
+  if (pad->buffer)
+    gst_buffer_unref (pad->buffer);
+}
+
+static void
+mark_dirty_lines (guint8 * dirty_lines, gint out_height,
+    const CompositorBlendPad * pad)
+{
+  gint y_start, y_end;
+
+  if (pad->copy) {
+    y_start = 0;
+    y_end = out_height;
+  } else {
+    /* the blend functions round ypos up to the chroma subsampling, which
+     * moves the frame down by at most one line */
+    y_start = CLAMP (pad->ypos, 0, out_height);
+    y_end = CLAMP ((gint64) pad->ypos + pad->height + 1, 0, out_height);
+    /* keep chroma lines of subsampled formats complete */
+    y_start = GST_ROUND_DOWN_2 (y_start);
+    y_end = MIN (GST_ROUND_UP_2 (y_end), out_height);
+  }
+
+  if (y_start < y_end)
+    memset (dirty_lines + y_start, 1, y_end - y_start);
+}
+
+/* Sets the lines of the output that have to be composited again because the
+ * pads contributing to them differ from the ones the cached frame was
+ * composited from, and remembers @pads for the next frame. */
+static void
+gst_compositor_update_dirty_lines (GstCompositor * self, gboolean full,
+    gboolean drew_background, const CompositorBlendPad * pads, guint n_pads,
+    gint out_height)
+{
+  const CompositorBlendPad *old;
+  guint i;
+
+  /* pads added, removed, reordered or switching between copy and blend, and
+   * background changes affect the whole frame */
+  old = (const CompositorBlendPad *) self->cache_pads->data;
+  if (self->cache_pads->len != n_pads
+      || self->cache_drew_background != drew_background
+      || self->cache_background != self->background)
+    full = TRUE;
+  for (i = 0; i < n_pads && !full; i++) {
+    if (pads[i].pad != old[i].pad || pads[i].copy != old[i].copy)
+      full = TRUE;
+  }
+
+  if (full) {
+    memset (self->dirty_lines, 1, out_height);
+  } else {
+    memset (self->dirty_lines, 0, out_height);
+    for (i = 0; i < n_pads; i++) {
+      if (blend_pad_changed (&old[i], &pads[i])) {
+        mark_dirty_lines (self->dirty_lines, out_height, &old[i]);
+        mark_dirty_lines (self->dirty_lines, out_height, &pads[i]);
+      }
+    }
+  }
+
+  g_array_set_size (self->cache_pads, 0);
+  for (i = 0; i < n_pads; i++) {
+    CompositorBlendPad cached = pads[i];
+
+    gst_object_ref (cached.pad);
+    if (cached.buffer)
+      gst_buffer_ref (cached.buffer);
+    cached.prepared_frame = NULL;
+    g_array_append_val (self->cache_pads, cached);
+  }
+  self->cache_drew_background = drew_background;
+  self->cache_background = self->background;
+}
+
 static GstFlowReturn
 gst_compositor_aggregate_frames (GstVideoAggregator * vagg, GstBuffer * outbuf)
 {
+  GstCompositor *self = GST_COMPOSITOR (vagg);
   GList *l;
   BlendFunction composite;
   GstVideoFrame out_frame, *outframe;
+  GstVideoFrame cache_frame, *cacheframe = NULL;
   gboolean drew_background;
   guint drawn_pads = 0;
+  CompositorBlendPad *pads;
+  CompositorBlendTask *tasks;
+  gpointer *tasks_p;
+  guint i, n_threads, out_height, lines_per_thread;
 
   if (!gst_video_frame_map (&out_frame, &vagg->info, outbuf, GST_MAP_WRITE)) {
     GST_WARNING_OBJECT (vagg, "Could not map output buffer");
@@ -951,9 +1246,11 @@ gst_compositor_aggregate_frames (GstVideoAggregator * vagg, GstBuffer * outbuf)
   }
 
   outframe = &out_frame;
-  drew_background = _draw_background (vagg, outframe, &composite);
+  out_height = GST_VIDEO_FRAME_HEIGHT (outframe);
+  drew_background = _prepare_background (vagg, &composite);
 
   GST_OBJECT_LOCK (vagg);
+  pads = g_newa (CompositorBlendPad, GST_ELEMENT (vagg)->numsinkpads);
   for (l = GST_ELEMENT (vagg)->sinkpads; l; l = l->next) {
     GstVideoAggregatorPad *pad = l->data;
     GstCompositorPad *compo_pad = GST_COMPOSITOR_PAD (pad);
@@ -977,27 +1274,106 @@ gst_compositor_aggregate_frames (GstVideoAggregator * vagg, GstBuffer * outbuf)
     }
 
     if (prepared_frame != NULL) {
+      CompositorBlendPad *bpad = &pads[drawn_pads];
+      GstBuffer *buffer = gst_video_aggregator_pad_get_current_buffer (pad);
+
+      bpad->pad = GST_PAD (pad);
+      bpad->buffer = buffer;
+      bpad->config_cookie = g_atomic_int_get (&compo_pad->config_cookie);
+      bpad->prepared_frame = prepared_frame;
+      bpad->xpos = compo_pad->xpos;
+      bpad->ypos = compo_pad->ypos;
+      bpad->width = GST_VIDEO_FRAME_WIDTH (prepared_frame);
+      bpad->height = GST_VIDEO_FRAME_HEIGHT (prepared_frame);
+      bpad->alpha = compo_pad->alpha;
+      bpad->blend_mode = blend_mode;
       /* If this is the first pad we're drawing, and we didn't draw the
        * background, and @prepared_frame has the same format, height, and width
        * as @outframe, then we can just copy it as-is. Subsequent pads (if any)
        * will be composited on top of it. */
-      if (drawn_pads == 0 && !drew_background &&
-          frames_can_copy (prepared_frame, outframe))
-        gst_video_frame_copy (outframe, prepared_frame);
-      else
-        composite (prepared_frame,
-            compo_pad->xpos,
-            compo_pad->ypos, compo_pad->alpha, outframe, blend_mode);
+      bpad->copy = drawn_pads == 0 && !drew_background &&
+          frames_can_copy (prepared_frame, outframe);
       drawn_pads++;
     }
   }
+
+  /* Keep a copy of the output so that the next frame only has to composite
+   * the lines whose inputs changed */
+  if (self->incremental) {
+    gboolean full = FALSE;
+
+    if (self->cache == NULL) {
+      self->cache = gst_buffer_new_allocate (NULL,
+          GST_VIDEO_INFO_SIZE (&vagg->info), NULL);
+      self->dirty_lines = g_malloc (out_height);
+      full = TRUE;
+    }
+
+    if (gst_video_frame_map (&cache_frame, &vagg->info, self->cache,
+            GST_MAP_READWRITE)) {
+      cacheframe = &cache_frame;
+      gst_compositor_update_dirty_lines (self, full, drew_background, pads,
+          drawn_pads, out_height);
+    } else {
+      GST_WARNING_OBJECT (vagg, "Could not map cache buffer");
+      gst_compositor_reset_cache (self);
+    }
+  } else if (self->cache != NULL) {
+    gst_compositor_reset_cache (self);
+  }
+
+  /* Split the output into horizontal stripes that are each composited
+   * completely by one thread. Stripes are a multiple of 2 lines high so that
+   * no chroma line of the subsampled formats is shared between two of them */
+  n_threads = self->n_threads;
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+  n_threads = CLAMP (n_threads, 1, MAX (out_height / 2, 1));
+  lines_per_thread =
+      MAX (GST_ROUND_UP_2 ((out_height + n_threads - 1) / n_threads), 2);
+  n_threads = (out_height + lines_per_thread - 1) / lines_per_thread;
+
+  tasks = g_newa (CompositorBlendTask, MAX (n_threads, 1));
+  tasks_p = g_newa (gpointer, MAX (n_threads, 1));
+  for (i = 0; i < n_threads; i++) {
+    tasks[i].compositor = self;
+    tasks[i].out_frame = outframe;
+    tasks[i].cache_frame = cacheframe;
+    tasks[i].dirty_lines = self->dirty_lines;
+    tasks[i].dst_line_start = i * lines_per_thread;
+    tasks[i].dst_line_end = MIN ((i + 1) * lines_per_thread, out_height);
+    tasks[i].draw_background = drew_background;
+    tasks[i].composite = composite;
+    tasks[i].pads = pads;
+    tasks[i].n_pads = drawn_pads;
+    tasks_p[i] = &tasks[i];
+  }
+
+  if (n_threads > 1) {
+    if (self->task_pool == NULL)
+      self->task_pool = gst_video_task_pool_get_shared ();
+    gst_video_task_pool_run (self->task_pool,
+        (GstVideoTaskFunc) gst_compositor_blend_task, tasks_p, n_threads);
+  } else if (n_threads == 1) {
+    gst_compositor_blend_task (&tasks[0]);
+  }
   GST_OBJECT_UNLOCK (vagg);
 
+  if (cacheframe)
+    gst_video_frame_unmap (cacheframe);
   gst_video_frame_unmap (outframe);
 
   return GST_FLOW_OK;
 }
 
+static gboolean
+_stop (GstAggregator * agg)
+{
+  gst_compositor_reset_cache (GST_COMPOSITOR (agg));
+
+  return GST_AGGREGATOR_CLASS (parent_class)->stop (agg);
+}
+
 static GstPad *
 gst_compositor_request_new_pad (GstElement * element, GstPadTemplate * templ,
     const gchar * req_name, const GstCaps * caps)
@@ -1092,6 +1468,7 @@ gst_compositor_class_init (GstCompositorClass * klass)
 
   gobject_class->get_property = gst_compositor_get_property;
   gobject_class->set_property = gst_compositor_set_property;
+  gobject_class->finalize = gst_compositor_finalize;
 
   gstelement_class->request_new_pad =
       GST_DEBUG_FUNCPTR (gst_compositor_request_new_pad);
@@ -1100,6 +1477,7 @@ gst_compositor_class_init (GstCompositorClass * klass)
   agg_class->sink_query = _sink_query;
   agg_class->fixate_src_caps = _fixate_caps;
   agg_class->negotiated_src_caps = _negotiated_caps;
+  agg_class->stop = _stop;
   videoaggregator_class->aggregate_frames = gst_compositor_aggregate_frames;
 
   g_object_class_install_property (gobject_class, PROP_BACKGROUND,
@@ -1107,6 +1485,37 @@ gst_compositor_class_init (GstCompositorClass * klass)
           GST_TYPE_COMPOSITOR_BACKGROUND,
           DEFAULT_BACKGROUND, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstCompositor:n-threads:
+   *
+   * Number of horizontal stripes the output frame is split into, each
+   * composited on a thread of the shared #GstVideoTaskPool. 0 uses the
+   * number of processors. The output is identical for any value.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Threads",
+          "Maximum number of threads to use for compositing (0 = auto)",
+          0, G_MAXINT, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstCompositor:incremental:
+   *
+   * Keep a copy of the previous output frame and only composite the lines
+   * whose pads changed since then: a new input buffer, or another position,
+   * size, alpha or operator. All other lines are copied from the previous
+   * frame. This is useful when most pads are static, for example logos or
+   * paused sources, but costs an additional copy of the frame otherwise.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_INCREMENTAL,
+      g_param_spec_boolean ("incremental", "Incremental",
+          "Only composite the parts of the output whose inputs changed",
+          DEFAULT_INCREMENTAL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_static_pad_template_with_gtype (gstelement_class,
       &src_factory, GST_TYPE_AGGREGATOR_PAD);
   gst_element_class_add_static_pad_template_with_gtype (gstelement_class,
@@ -1127,6 +1536,11 @@ gst_compositor_init (GstCompositor * self)
 {
   /* initialize variables */
   self->background = DEFAULT_BACKGROUND;
+  self->n_threads = DEFAULT_N_THREADS;
+  self->incremental = DEFAULT_INCREMENTAL;
+  self->cache_pads = g_array_new (FALSE, FALSE, sizeof (CompositorBlendPad));
+  g_array_set_clear_func (self->cache_pads,
+      (GDestroyNotify) compositor_blend_pad_clear);
 }
 
 /* GstChildProxy implementation */
@@ -92,6 +92,18 @@ struct _GstCompositor
   BlendFunction blend, overlay;
   FillCheckerFunction fill_checker;
   FillColorFunction fill_color;
+
+  /* protected by the object lock */
+  guint n_threads;
+  gboolean incremental;
+  /* only used by the aggregate thread */
+  GstVideoTaskPool *task_pool;
+  /* copy of the previous output frame and the pads it was composited from */
+  GstBuffer *cache;
+  GArray *cache_pads;
+  gboolean cache_drew_background;
+  GstCompositorBackground cache_background;
+  guint8 *dirty_lines;
 };
 
 /**
@@ -109,6 +121,10 @@ struct _GstCompositorPad
   gdouble alpha;
 
   GstCompositorOperator op;
+
+  /* changed with every property of the pad, the incremental compositing
+   * redraws the pad when it changes */
+  gint config_cookie;
 };
 
 G_END_DECLS
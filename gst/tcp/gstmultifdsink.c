@@ -77,6 +77,14 @@
  * #GstMultiFdSink::add-full signal to make sure that a burst connect can
  * actually be honored.
  *
+ * Amounts of time, in these properties, in the burst values and with a
+ * #GstMultiHandleSink:unit-format of %GST_FORMAT_TIME, are measured from the
+ * timestamps of the queued buffers. The time only advances with timestamps
+ * above the highest one so far, so that reordered timestamps are not counted,
+ * and it continues from the new timestamp after a jump back of more than a
+ * second. Since 1.20; before, the timestamp of a buffer was subtracted from the
+ * most recent one.
+ *
  * When streaming data, clients are allowed to read at a different rate than
  * the rate at which multifdsink receives data. If the client is reading too
  * fast, no data will be send to the client until multifdsink receives more
@@ -147,6 +155,10 @@ enum
 /* this is really arbitrarily chosen */
 #define DEFAULT_HANDLE_READ             TRUE
 
+/* the poll set of the sender thread of a client */
+#define CLIENT_FDSET(sink,client) \
+    ((sink)->fdsets[((GstMultiHandleClient *) (client))->sender])
+
 enum
 {
   PROP_0,
@@ -156,7 +168,8 @@ enum
 static void gst_multi_fd_sink_stop_pre (GstMultiHandleSink * mhsink);
 static void gst_multi_fd_sink_stop_post (GstMultiHandleSink * mhsink);
 static gboolean gst_multi_fd_sink_start_pre (GstMultiHandleSink * mhsink);
-static gpointer gst_multi_fd_sink_thread (GstMultiHandleSink * mhsink);
+static gpointer gst_multi_fd_sink_thread (GstMultiHandleSink * mhsink,
+    guint sender);
 
 static void gst_multi_fd_sink_add (GstMultiFdSink * sink, int fd);
 static void gst_multi_fd_sink_add_full (GstMultiFdSink * sink, int fd,
@@ -494,6 +507,7 @@ gst_multi_fd_sink_new_client (GstMultiHandleSink * mhsink,
   struct stat statbuf;
   GstTCPClient *client;
   GstMultiHandleClient *mhclient;
+  gboolean do_read = FALSE;
   GstMultiFdSink *sink = GST_MULTI_FD_SINK (mhsink);
   GstMultiHandleSinkClass *mhsinkclass =
       GST_MULTI_HANDLE_SINK_GET_CLASS (mhsink);
@@ -509,6 +523,7 @@ gst_multi_fd_sink_new_client (GstMultiHandleSink * mhsink,
 
   gst_multi_handle_sink_client_init (mhclient, sync_method);
   mhsinkclass->handle_debug (handle, mhclient->debug);
+  gst_multi_handle_sink_client_assign_sender (mhsink, mhclient);
 
   /* set the socket to non blocking */
   if (fcntl (handle.fd, F_SETFL, O_NONBLOCK) < 0) {
@@ -516,17 +531,26 @@ gst_multi_fd_sink_new_client (GstMultiHandleSink * mhsink,
         mhclient->debug, g_strerror (errno));
   }
 
-  /* we always read from a client */
-  gst_poll_add_fd (sink->fdset, &client->gfd);
-
   /* we don't try to read from write only fds */
   if (sink->handle_read) {
     gint flags;
 
     flags = fcntl (handle.fd, F_GETFL, 0);
-    if ((flags & O_ACCMODE) != O_WRONLY) {
-      gst_poll_fd_ctl_read (sink->fdset, &client->gfd, TRUE);
+    do_read = (flags & O_ACCMODE) != O_WRONLY;
+  }
+
+  if (GST_MULTI_HANDLE_SINK_USES_EPOLL (mhsink)) {
+    if (!gst_multi_handle_sink_epoll_add_client (mhsink, mhclient, handle.fd,
+            do_read)) {
+      /* let the sender thread remove it */
+      mhclient->status = GST_CLIENT_STATUS_ERROR;
+      gst_multi_handle_sink_client_set_ready (mhsink, mhclient, G_IO_ERR);
     }
+  } else {
+    /* we always read from a client */
+    gst_poll_add_fd (CLIENT_FDSET (sink, client), &client->gfd);
+    if (do_read)
+      gst_poll_fd_ctl_read (CLIENT_FDSET (sink, client), &client->gfd, TRUE);
   }
   /* figure out the mode, can't use send() for non sockets */
   if (fstat (handle.fd, &statbuf) == 0 && S_ISSOCK (statbuf.st_mode)) {
@@ -561,8 +585,10 @@ static void
 gst_multi_fd_sink_hash_changed (GstMultiHandleSink * mhsink)
 {
   GstMultiFdSink *sink = GST_MULTI_FD_SINK (mhsink);
+  guint i;
 
-  gst_poll_restart (sink->fdset);
+  for (i = 0; i < mhsink->n_senders; i++)
+    gst_poll_restart (sink->fdsets[i]);
 }
 
 /* handle a read on a client fd,
@@ -679,17 +705,20 @@ gst_multi_fd_sink_handle_client_write (GstMultiFdSink * sink,
 
   more = TRUE;
   do {
-    gint maxsize;
+    gint maxsize, errsv;
 
     now = g_get_real_time () * GST_USECOND;
 
     if (!mhclient->sending) {
       /* client is not working on a buffer */
-      if (mhclient->bufpos == -1) {
+      if (CLIENT_BUFPOS (mhsink, mhclient) == -1) {
         /* client is too fast, remove from write queue until new buffer is
          * available */
         /* FIXME: specific */
-        gst_poll_fd_ctl_write (sink->fdset, &client->gfd, FALSE);
+        if (!GST_MULTI_HANDLE_SINK_USES_EPOLL (mhsink))
+          gst_poll_fd_ctl_write (CLIENT_FDSET (sink, client), &client->gfd,
+              FALSE);
+        gst_multi_handle_sink_client_wait (mhsink, mhclient);
 
         /* if we flushed out all of the client buffers, we can stop */
         if (mhclient->flushcount == 0)
@@ -710,11 +739,14 @@ gst_multi_fd_sink_handle_client_write (GstMultiFdSink * sink,
           if (position >= 0) {
             /* we got a valid spot in the queue */
             mhclient->new_connection = FALSE;
-            mhclient->bufpos = position;
+            CLIENT_SET_BUFPOS (mhsink, mhclient, position);
           } else {
             /* cannot send data to this client yet */
             /* FIXME: specific */
-            gst_poll_fd_ctl_write (sink->fdset, &client->gfd, FALSE);
+            if (!GST_MULTI_HANDLE_SINK_USES_EPOLL (mhsink))
+              gst_poll_fd_ctl_write (CLIENT_FDSET (sink, client), &client->gfd,
+                  FALSE);
+            gst_multi_handle_sink_client_wait (mhsink, mhclient);
             return TRUE;
           }
         }
@@ -724,8 +756,9 @@ gst_multi_fd_sink_handle_client_write (GstMultiFdSink * sink,
           goto flushed;
 
         /* grab buffer */
-        buf = g_array_index (mhsink->bufqueue, GstBuffer *, mhclient->bufpos);
-        mhclient->bufpos--;
+        buf = BUFQUEUE_BUFFER (mhsink, CLIENT_BUFPOS (mhsink, mhclient));
+        gst_multi_handle_sink_client_set_seq (mhsink, mhclient,
+            mhclient->bufseq + 1);
 
         /* update stats */
         timestamp = GST_BUFFER_TIMESTAMP (buf);
@@ -739,7 +772,7 @@ gst_multi_fd_sink_handle_client_write (GstMultiFdSink * sink,
           mhclient->flushcount--;
 
         GST_LOG_OBJECT (sink, "%s client %p at position %d",
-            mhclient->debug, client, mhclient->bufpos);
+            mhclient->debug, client, CLIENT_BUFPOS (mhsink, mhclient));
 
         /* queueing a buffer will ref it */
         mhsinkclass->client_queue_buffer (mhsink, mhclient, buf);
@@ -772,17 +805,27 @@ gst_multi_fd_sink_handle_client_write (GstMultiFdSink * sink,
 #else
 #define FLAGS 0
 #endif
+      /* other senders and the streaming thread can continue meanwhile */
+      gst_multi_handle_sink_client_begin_io (mhsink, mhclient);
       if (client->is_socket) {
         wrote = send (fd, data + mhclient->bufoffset, maxsize, FLAGS);
       } else {
         wrote = write (fd, data + mhclient->bufoffset, maxsize);
       }
+      errsv = errno;
+      gst_multi_handle_sink_client_end_io (mhsink, mhclient);
+      errno = errsv;
       gst_buffer_unmap (head, &info);
 
+      /* the client was removed meanwhile, our caller finishes that */
+      if (mhclient->currently_removing)
+        return FALSE;
+
       if (wrote < 0) {
         /* hmm error.. */
         if (errno == EAGAIN) {
           /* nothing serious, resource was unavailable, try again later */
+          gst_multi_handle_sink_client_blocked (mhsink, mhclient);
           more = FALSE;
         } else if (errno == ECONNRESET) {
           goto connection_reset;
@@ -797,6 +840,7 @@ gst_multi_fd_sink_handle_client_write (GstMultiFdSink * sink,
               "partial write on %s of %" G_GSSIZE_FORMAT " bytes",
               mhclient->debug, wrote);
           mhclient->bufoffset += wrote;
+          gst_multi_handle_sink_client_blocked (mhsink, mhclient);
           more = FALSE;
         } else {
           /* complete buffer was written, we can proceed to the next one */
@@ -807,7 +851,7 @@ gst_multi_fd_sink_handle_client_write (GstMultiFdSink * sink,
         }
         /* update stats */
         mhclient->bytes_sent += wrote;
-        mhclient->last_activity_time = now;
+        gst_multi_handle_sink_client_active (mhsink, mhclient, now);
         mhsink->bytes_served += wrote;
       }
     }
@@ -846,7 +890,13 @@ gst_multi_fd_sink_hash_adding (GstMultiHandleSink * mhsink,
   GstMultiFdSink *sink = GST_MULTI_FD_SINK (mhsink);
   GstTCPClient *client = (GstTCPClient *) mhclient;
 
-  gst_poll_fd_ctl_write (sink->fdset, &client->gfd, TRUE);
+  if (GST_MULTI_HANDLE_SINK_USES_EPOLL (mhsink)) {
+    /* we only get an edge when a blocked client becomes writable again */
+    if (mhclient->can_write)
+      gst_multi_handle_sink_client_set_ready (mhsink, mhclient, G_IO_OUT);
+  } else {
+    gst_poll_fd_ctl_write (CLIENT_FDSET (sink, client), &client->gfd, TRUE);
+  }
 }
 
 static void
@@ -856,11 +906,72 @@ gst_multi_fd_sink_hash_removing (GstMultiHandleSink * mhsink,
   GstMultiFdSink *sink = GST_MULTI_FD_SINK (mhsink);
   GstTCPClient *client = (GstTCPClient *) mhclient;
 
-  gst_poll_remove_fd (sink->fdset, &client->gfd);
+  if (GST_MULTI_HANDLE_SINK_USES_EPOLL (mhsink))
+    gst_multi_handle_sink_epoll_remove_client (mhsink, mhclient,
+        client->gfd.fd);
+  else
+    gst_poll_remove_fd (CLIENT_FDSET (sink, client), &client->gfd);
+}
+
+/* Handle the clients that have pending events in the epoll set or that were
+ * queued because they got new data while they were writable. */
+static void
+gst_multi_fd_sink_handle_ready_clients (GstMultiFdSink * sink, guint sender)
+{
+  GstMultiHandleSink *mhsink = GST_MULTI_HANDLE_SINK (sink);
+  GstMultiHandleSinkClass *mhsinkclass =
+      GST_MULTI_HANDLE_SINK_GET_CLASS (mhsink);
+  GstMultiHandleClient *mhclient;
+  GIOCondition condition;
+
+  CLIENTS_LOCK (mhsink);
+  gst_multi_handle_sink_epoll_collect (mhsink, sender);
+
+  while ((mhclient =
+          gst_multi_handle_sink_pop_ready_client (mhsink, sender,
+              &condition))) {
+    GstTCPClient *client = (GstTCPClient *) mhclient;
+    GList *clink;
+
+    clink = g_hash_table_lookup (mhsink->handle_hash,
+        mhsinkclass->handle_hash_key (mhclient->handle));
+
+    if (mhclient->status != GST_CLIENT_STATUS_FLUSHING
+        && mhclient->status != GST_CLIENT_STATUS_OK) {
+      gst_multi_handle_sink_remove_client_link (mhsink, clink);
+      continue;
+    }
+    if (condition & G_IO_ERR) {
+      GST_WARNING_OBJECT (sink, "epoll error for %d", client->gfd.fd);
+      mhclient->status = GST_CLIENT_STATUS_ERROR;
+      gst_multi_handle_sink_remove_client_link (mhsink, clink);
+      continue;
+    }
+    if (condition & G_IO_HUP) {
+      mhclient->status = GST_CLIENT_STATUS_CLOSED;
+      gst_multi_handle_sink_remove_client_link (mhsink, clink);
+      continue;
+    }
+    if (condition & G_IO_IN) {
+      /* handle client read */
+      if (!gst_multi_fd_sink_handle_client_read (sink, client)) {
+        gst_multi_handle_sink_remove_client_link (mhsink, clink);
+        continue;
+      }
+    }
+    if (condition & G_IO_OUT) {
+      /* handle client write */
+      if (!gst_multi_fd_sink_handle_client_write (sink, client)) {
+        gst_multi_handle_sink_remove_client_link (mhsink, clink);
+        continue;
+      }
+    }
+  }
+  CLIENTS_UNLOCK (mhsink);
 }
 
 
-/* Handle the clients. Basically does a blocking select for one
+/* Handle the clients of a sender. Basically does a blocking select for one
  * of the client fds to become read or writable. We also have a
  * filedescriptor to receive commands on that we need to check.
  *
@@ -869,7 +980,7 @@ gst_multi_fd_sink_hash_removing (GstMultiHandleSink * mhsink,
  * garbage list and removed.
  */
 static void
-gst_multi_fd_sink_handle_clients (GstMultiFdSink * sink)
+gst_multi_fd_sink_handle_clients (GstMultiFdSink * sink, guint sender)
 {
   int result;
   GList *clients, *next;
@@ -877,6 +988,7 @@ gst_multi_fd_sink_handle_clients (GstMultiFdSink * sink)
   GstMultiFdSinkClass *fclass;
   guint cookie;
   GstMultiHandleSink *mhsink = GST_MULTI_HANDLE_SINK (sink);
+  GstPoll *fdset = sink->fdsets[sender];
   int fd;
 
 
@@ -892,7 +1004,7 @@ gst_multi_fd_sink_handle_clients (GstMultiFdSink * sink)
     GST_LOG_OBJECT (sink, "waiting on action on fdset");
 
     result =
-        gst_poll_wait (sink->fdset,
+        gst_poll_wait (fdset,
         mhsink->timeout != 0 ? mhsink->timeout : GST_CLOCK_TIME_NONE);
 
     /* Handle the special case in which the sink is not receiving more buffers
@@ -903,19 +1015,7 @@ gst_multi_fd_sink_handle_clients (GstMultiFdSink * sink)
       now = g_get_real_time () * GST_USECOND;
 
       CLIENTS_LOCK (mhsink);
-      for (clients = mhsink->clients; clients; clients = next) {
-        GstTCPClient *client;
-        GstMultiHandleClient *mhclient;
-
-        client = (GstTCPClient *) clients->data;
-        mhclient = (GstMultiHandleClient *) client;
-        next = g_list_next (clients);
-        if (mhsink->timeout > 0
-            && now - mhclient->last_activity_time > mhsink->timeout) {
-          mhclient->status = GST_CLIENT_STATUS_SLOW;
-          gst_multi_handle_sink_remove_client_link (mhsink, clients);
-        }
-      }
+      gst_multi_handle_sink_remove_idle_clients (mhsink, now);
       CLIENTS_UNLOCK (mhsink);
       return;
     } else if (result < 0) {
@@ -927,7 +1027,8 @@ gst_multi_fd_sink_handle_clients (GstMultiFdSink * sink)
         CLIENTS_LOCK (mhsink);
       restart:
         cookie = mhsink->clients_cookie;
-        for (clients = mhsink->clients; clients; clients = next) {
+        for (clients = mhsink->senders[sender].clients.head; clients;
+            clients = next) {
           GstTCPClient *client;
           GstMultiHandleClient *mhclient;
           long flags;
@@ -978,14 +1079,20 @@ gst_multi_fd_sink_handle_clients (GstMultiFdSink * sink)
 
   /* subclasses can check fdset with this virtual function */
   if (fclass->wait)
-    fclass->wait (sink, sink->fdset);
+    fclass->wait (sink, fdset);
+
+  if (GST_MULTI_HANDLE_SINK_USES_EPOLL (mhsink)) {
+    gst_multi_fd_sink_handle_ready_clients (sink, sender);
+    return;
+  }
 
   /* Check the clients */
   CLIENTS_LOCK (mhsink);
 
 restart2:
   cookie = mhsink->clients_cookie;
-  for (clients = mhsink->clients; clients; clients = next) {
+  for (clients = mhsink->senders[sender].clients.head; clients;
+      clients = next) {
     GstTCPClient *client;
     GstMultiHandleClient *mhclient;
 
@@ -1004,25 +1111,25 @@ restart2:
       continue;
     }
 
-    if (gst_poll_fd_has_closed (sink->fdset, &client->gfd)) {
+    if (gst_poll_fd_has_closed (fdset, &client->gfd)) {
       mhclient->status = GST_CLIENT_STATUS_CLOSED;
       gst_multi_handle_sink_remove_client_link (mhsink, clients);
       continue;
     }
-    if (gst_poll_fd_has_error (sink->fdset, &client->gfd)) {
+    if (gst_poll_fd_has_error (fdset, &client->gfd)) {
       GST_WARNING_OBJECT (sink, "gst_poll_fd_has_error for %d", client->gfd.fd);
       mhclient->status = GST_CLIENT_STATUS_ERROR;
       gst_multi_handle_sink_remove_client_link (mhsink, clients);
       continue;
     }
-    if (gst_poll_fd_can_read (sink->fdset, &client->gfd)) {
+    if (gst_poll_fd_can_read (fdset, &client->gfd)) {
       /* handle client read */
       if (!gst_multi_fd_sink_handle_client_read (sink, client)) {
         gst_multi_handle_sink_remove_client_link (mhsink, clients);
         continue;
       }
     }
-    if (gst_poll_fd_can_write (sink->fdset, &client->gfd)) {
+    if (gst_poll_fd_can_write (fdset, &client->gfd)) {
       /* handle client write */
       if (!gst_multi_fd_sink_handle_client_write (sink, client)) {
         gst_multi_handle_sink_remove_client_link (mhsink, clients);
@@ -1036,12 +1143,12 @@ restart2:
 /* we handle the client communication in another thread so that we do not block
  * the gstreamer thread while we select() on the client fds */
 static gpointer
-gst_multi_fd_sink_thread (GstMultiHandleSink * mhsink)
+gst_multi_fd_sink_thread (GstMultiHandleSink * mhsink, guint sender)
 {
   GstMultiFdSink *sink = GST_MULTI_FD_SINK (mhsink);
 
   while (mhsink->running) {
-    gst_multi_fd_sink_handle_clients (sink);
+    gst_multi_fd_sink_handle_clients (sink, sender);
   }
   return NULL;
 }
@@ -1084,14 +1191,48 @@ gst_multi_fd_sink_get_property (GObject * object, guint prop_id, GValue * value,
   }
 }
 
+static void
+gst_multi_fd_sink_free_fdsets (GstMultiFdSink * mfsink)
+{
+  GstMultiHandleSink *mhsink = GST_MULTI_HANDLE_SINK (mfsink);
+  guint i;
+
+  if (mfsink->fdsets == NULL)
+    return;
+
+  for (i = 0; i < mhsink->n_senders; i++) {
+    if (mfsink->fdsets[i])
+      gst_poll_free (mfsink->fdsets[i]);
+  }
+  g_free (mfsink->fdsets);
+  mfsink->fdsets = NULL;
+  g_free (mfsink->epoll_gfds);
+  mfsink->epoll_gfds = NULL;
+}
+
 static gboolean
 gst_multi_fd_sink_start_pre (GstMultiHandleSink * mhsink)
 {
   GstMultiFdSink *mfsink = GST_MULTI_FD_SINK (mhsink);
+  guint i;
 
   GST_INFO_OBJECT (mfsink, "starting");
-  if ((mfsink->fdset = gst_poll_new (TRUE)) == NULL)
-    goto socket_pair;
+
+  mfsink->fdsets = g_new0 (GstPoll *, mhsink->n_senders);
+  mfsink->epoll_gfds = g_new0 (GstPollFD, mhsink->n_senders);
+
+  for (i = 0; i < mhsink->n_senders; i++) {
+    if ((mfsink->fdsets[i] = gst_poll_new (TRUE)) == NULL)
+      goto socket_pair;
+
+    /* with epoll, the fdset only watches the epoll set of the clients */
+    if (GST_MULTI_HANDLE_SINK_USES_EPOLL (mhsink)) {
+      gst_poll_fd_init (&mfsink->epoll_gfds[i]);
+      mfsink->epoll_gfds[i].fd = mhsink->senders[i].epoll_fd;
+      gst_poll_add_fd (mfsink->fdsets[i], &mfsink->epoll_gfds[i]);
+      gst_poll_fd_ctl_read (mfsink->fdsets[i], &mfsink->epoll_gfds[i], TRUE);
+    }
+  }
 
   return TRUE;
 
@@ -1100,6 +1241,7 @@ socket_pair:
   {
     GST_ELEMENT_ERROR (mfsink, RESOURCE, OPEN_READ_WRITE, (NULL),
         GST_ERROR_SYSTEM);
+    gst_multi_fd_sink_free_fdsets (mfsink);
     return FALSE;
   }
 }
@@ -1114,8 +1256,10 @@ static void
 gst_multi_fd_sink_stop_pre (GstMultiHandleSink * mhsink)
 {
   GstMultiFdSink *mfsink = GST_MULTI_FD_SINK (mhsink);
+  guint i;
 
-  gst_poll_set_flushing (mfsink->fdset, TRUE);
+  for (i = 0; i < mhsink->n_senders; i++)
+    gst_poll_set_flushing (mfsink->fdsets[i], TRUE);
 }
 
 static void
@@ -1123,10 +1267,7 @@ gst_multi_fd_sink_stop_post (GstMultiHandleSink * mhsink)
 {
   GstMultiFdSink *mfsink = GST_MULTI_FD_SINK (mhsink);
 
-  if (mfsink->fdset) {
-    gst_poll_free (mfsink->fdset);
-    mfsink->fdset = NULL;
-  }
+  gst_multi_fd_sink_free_fdsets (mfsink);
   g_hash_table_foreach_remove (mhsink->handle_hash, multifdsink_hash_remove,
       mfsink);
 }
@@ -66,7 +66,8 @@ struct _GstMultiFdSink {
   GstMultiHandleSink element;
 
   /*< private >*/
-  GstPoll *fdset;
+  GstPoll **fdsets;     /* the poll set of each sender thread */
+  GstPollFD *epoll_gfds; /* the epoll set of each sender, when used */
 
   gboolean handle_read;
 };
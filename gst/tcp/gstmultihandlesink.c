@@ -38,6 +38,12 @@
 #include <netinet/in.h>
 #endif
 
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
 #include <string.h>
 
 #define NOT_IMPLEMENTED 0
@@ -89,6 +95,9 @@ enum
 
 #define DEFAULT_RESEND_STREAMHEADER      TRUE
 
+#define DEFAULT_USE_EPOLL               FALSE
+#define DEFAULT_N_SENDER_THREADS        1
+
 enum
 {
   PROP_0,
@@ -120,6 +129,9 @@ enum
 
   PROP_RESEND_STREAMHEADER,
 
+  PROP_USE_EPOLL,
+  PROP_N_SENDER_THREADS,
+
   PROP_NUM_HANDLES
 };
 
@@ -366,6 +378,39 @@ gst_multi_handle_sink_class_init (GstMultiHandleSinkClass * klass)
           "The current number of client handles",
           0, G_MAXUINT, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstMultiHandleSink:use-epoll:
+   *
+   * Watch the clients with an edge-triggered epoll set instead of polling
+   * all of them after every wakeup. With many clients this makes the cost
+   * of delivering a buffer proportional to the number of clients that can
+   * actually be written to. Only available on Linux, ignored elsewhere.
+   * Takes effect the next time the element is started.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_USE_EPOLL,
+      g_param_spec_boolean ("use-epoll", "Use epoll",
+          "Use an edge-triggered epoll set to watch the clients (Linux only)",
+          DEFAULT_USE_EPOLL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstMultiHandleSink:n-sender-threads:
+   *
+   * The number of threads that write to the clients. Every client is handled
+   * by one of the threads, so its data is sent in order, and all threads
+   * share the same queue of buffers. Use more than one thread when a single
+   * core can't keep up with the amount of clients. 0 starts one thread per
+   * processor. Takes effect the next time the element is started.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_N_SENDER_THREADS,
+      g_param_spec_uint ("n-sender-threads", "Number of sender threads",
+          "Number of threads that write to the clients (0 = number of "
+          "processors)", 0, G_MAXINT, DEFAULT_N_SENDER_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstMultiHandleSink::clear:
    * @gstmultihandlesink: the multihandlesink element to emit this signal on
@@ -422,7 +467,6 @@ gst_multi_handle_sink_init (GstMultiHandleSink * this)
   CLIENTS_LOCK_INIT (this);
   this->clients = NULL;
 
-  this->bufqueue = g_array_new (FALSE, TRUE, sizeof (GstBuffer *));
   this->unit_format = DEFAULT_UNIT_FORMAT;
   this->units_max = DEFAULT_UNITS_MAX;
   this->units_soft_max = DEFAULT_UNITS_SOFT_MAX;
@@ -440,6 +484,11 @@ gst_multi_handle_sink_init (GstMultiHandleSink * this)
   this->qos_dscp = DEFAULT_QOS_DSCP;
 
   this->resend_streamheader = DEFAULT_RESEND_STREAMHEADER;
+
+  this->use_epoll = DEFAULT_USE_EPOLL;
+  this->n_sender_threads = DEFAULT_N_SENDER_THREADS;
+
+  this->index_ts = GST_CLOCK_TIME_NONE;
 }
 
 static void
@@ -450,7 +499,9 @@ gst_multi_handle_sink_finalize (GObject * object)
   this = GST_MULTI_HANDLE_SINK (object);
 
   CLIENTS_LOCK_CLEAR (this);
-  g_array_free (this->bufqueue, TRUE);
+  g_free (this->bufqueue);
+  g_free (this->bufindex);
+  g_free (this->client_count);
   g_hash_table_destroy (this->handle_hash);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
@@ -528,7 +579,8 @@ gst_multi_handle_sink_client_init (GstMultiHandleClient * client,
     GstSyncMethod sync_method)
 {
   client->status = GST_CLIENT_STATUS_OK;
-  client->bufpos = -1;
+  client->bufseq = 0;
+  client->counted = FALSE;
   client->flushcount = -1;
   client->bufoffset = 0;
   client->sending = NULL;
@@ -540,6 +592,21 @@ gst_multi_handle_sink_client_init (GstMultiHandleClient * client,
   client->new_connection = TRUE;
   client->sync_method = sync_method;
   client->currently_removing = FALSE;
+  client->remove_pending = FALSE;
+  client->sender = 0;
+  client->sender_link.data = client;
+  client->sender_link.prev = client->sender_link.next = NULL;
+  client->in_io = FALSE;
+  client->activity_link.data = client;
+  client->activity_link.prev = client->activity_link.next = NULL;
+  client->waiting_link.data = client;
+  client->waiting_link.prev = client->waiting_link.next = NULL;
+  client->waiting = FALSE;
+  client->ready_link.data = client;
+  client->ready_link.prev = client->ready_link.next = NULL;
+  client->ready_condition = 0;
+  client->can_write = FALSE;
+  client->always_writable = FALSE;
 
   /* update start time */
   client->connect_time = g_get_real_time () * GST_USECOND;
@@ -607,12 +674,16 @@ gst_multi_handle_sink_add_full (GstMultiHandleSink * sink,
    * GstMultiHandleSink relies on the derived class to take a reference for us
    * in new_client: */
   mhclient = mhsinkclass->new_client (mhsink, handle, sync_method);
+  /* new clients wait for the next buffer */
+  CLIENT_SET_BUFPOS (mhsink, mhclient, -1);
+  gst_multi_handle_sink_client_wait (mhsink, mhclient);
 
   /* we can add the handle now */
   clink = mhsink->clients = g_list_prepend (mhsink->clients, mhclient);
   g_hash_table_insert (mhsink->handle_hash,
       mhsinkclass->handle_hash_key (mhclient->handle), clink);
   mhsink->clients_cookie++;
+  g_queue_push_tail_link (&mhsink->activity_clients, &mhclient->activity_link);
 
 
   mhclient->burst_min_format = min_format;
@@ -729,7 +800,7 @@ gst_multi_handle_sink_remove_flush (GstMultiHandleSink * sink,
     /* take the position of the client as the number of buffers left to flush.
      * If the client was at position -1, we flush 0 buffers, 0 == flush 1
      * buffer, etc... */
-    mhclient->flushcount = mhclient->bufpos + 1;
+    mhclient->flushcount = CLIENT_BUFPOS (mhsink, mhclient) + 1;
     /* mark client as flushing. We can not remove the client right away because
      * it might have some buffers to flush in the ->sending queue. */
     mhclient->status = GST_CLIENT_STATUS_FLUSHING;
@@ -836,10 +907,16 @@ noclient:
   return result;
 }
 
-/* should be called with the clientslock held.
+/* should be called with the clientslock held. @link has the client as its
+ * data, it can be the link of the client in the clients list, or in the
+ * clients of its sender.
  * Note that we don't close the fd as we didn't open it in the first
  * place. An application should connect to the client-fd-removed signal and
  * close the fd itself.
+ *
+ * When the sender of the client is writing to it without the lock, the
+ * client is only marked as removed here. The sender notices that when its
+ * I/O ended and calls this function again to finish the removal.
  */
 void
 gst_multi_handle_sink_remove_client_link (GstMultiHandleSink * sink,
@@ -849,11 +926,31 @@ gst_multi_handle_sink_remove_client_link (GstMultiHandleSink * sink,
   GstMultiHandleSinkClass *mhsinkclass = GST_MULTI_HANDLE_SINK_GET_CLASS (sink);
 
   if (mhclient->currently_removing) {
-    GST_WARNING_OBJECT (sink, "%s client is already being removed",
-        mhclient->debug);
-    return;
+    if (!mhclient->remove_pending || mhclient->in_io) {
+      GST_DEBUG_OBJECT (sink, "%s client is already being removed",
+          mhclient->debug);
+      return;
+    }
+    GST_DEBUG_OBJECT (sink, "%s finishing the removal", mhclient->debug);
+    mhclient->remove_pending = FALSE;
   } else {
     mhclient->currently_removing = TRUE;
+
+    /* the client does not hold back the queue anymore */
+    gst_multi_handle_sink_client_set_seq (sink, mhclient, mhclient->bufseq);
+    if (mhclient->waiting) {
+      g_queue_unlink (&sink->waiting_clients, &mhclient->waiting_link);
+      mhclient->waiting = FALSE;
+    }
+    /* and is not checked for the timeout anymore */
+    g_queue_unlink (&sink->activity_clients, &mhclient->activity_link);
+
+    if (mhclient->in_io) {
+      GST_DEBUG_OBJECT (sink, "%s client is being written to, its sender "
+          "removes it", mhclient->debug);
+      mhclient->remove_pending = TRUE;
+      return;
+    }
   }
 
   /* FIXME: if we keep track of ip we can log it here and signal */
@@ -889,6 +986,8 @@ gst_multi_handle_sink_remove_client_link (GstMultiHandleSink * sink,
   }
 
   mhsinkclass->hash_removing (sink, mhclient);
+  g_queue_unlink (&sink->senders[mhclient->sender].clients,
+      &mhclient->sender_link);
 
   mhclient->disconnect_time = g_get_real_time () * GST_USECOND;
 
@@ -1068,6 +1167,130 @@ is_sync_frame (GstMultiHandleSink * sink, GstBuffer * buffer)
   return TRUE;
 }
 
+/* Add the index entry of @buffer, which is about to be queued with the next
+ * sequence number.
+ *
+ * The running time only advances with timestamps above the highest timestamp
+ * so far, which keeps it monotonic with reordered timestamps. It is the
+ * timestamp difference for streams with increasing timestamps. A jump back of
+ * more than a second starts counting from the new timestamp. */
+static void
+gst_multi_handle_sink_index_buffer (GstMultiHandleSink * sink,
+    GstBuffer * buffer)
+{
+  GstMultiHandleSinkIndex *entry;
+  GstClockTime ts;
+  guint64 seq;
+
+  seq = sink->bufqueue_seq;
+  entry = &sink->bufindex[seq & (sink->bufqueue_size - 1)];
+
+  entry->offset = sink->index_bytes;
+  sink->index_bytes += gst_buffer_get_size (buffer);
+
+  ts = GST_BUFFER_TIMESTAMP (buffer);
+  if (GST_CLOCK_TIME_IS_VALID (ts)) {
+    if (!GST_CLOCK_TIME_IS_VALID (sink->index_ts) ||
+        ts + GST_SECOND < sink->index_ts) {
+      sink->index_ts = ts;
+    } else if (ts > sink->index_ts) {
+      sink->index_time += ts - sink->index_ts;
+      sink->index_ts = ts;
+    }
+    sink->index_last_ts = seq + 1;
+  }
+  if (is_sync_frame (sink, buffer))
+    sink->index_last_sync = seq + 1;
+
+  entry->time = sink->index_time;
+  entry->last_ts = sink->index_last_ts;
+  entry->last_sync = sink->index_last_sync;
+}
+
+/* Get the position of the buffer with sequence number @seq1 - 1 as stored
+ * in the last_ts and last_sync fields of the index.
+ * Returns: the position or -1 if the buffer is not in the queue. */
+static gint
+index_position (GstMultiHandleSink * sink, guint64 seq1)
+{
+  guint64 pos;
+
+  if (seq1 == 0)
+    return -1;
+
+  pos = sink->bufqueue_seq - seq1;
+  if (pos >= sink->bufqueue_len)
+    return -1;
+
+  return pos;
+}
+
+/* Get the lowest position in the queue for which the index field at
+ * @field_offset is at most @limit. The index values grow with the sequence
+ * number, so they decrease with the position and we can do a binary search.
+ * Returns: the position or -1 if there is none. */
+static gint
+index_find (GstMultiHandleSink * sink, glong field_offset, guint64 limit)
+{
+#define INDEX_VALUE(pos) \
+    G_STRUCT_MEMBER (guint64, &BUFQUEUE_INDEX (sink, pos), field_offset)
+  gint lo, hi;
+
+  lo = 0;
+  hi = (gint) sink->bufqueue_len - 1;
+  if (hi < 0 || INDEX_VALUE (hi) > limit)
+    return -1;
+
+  while (lo < hi) {
+    gint mid = lo + (hi - lo) / 2;
+
+    if (INDEX_VALUE (mid) <= limit)
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+  return lo;
+#undef INDEX_VALUE
+}
+
+/* Get the lowest position so that the buffers from the start of the queue
+ * up to and including it contain at least @bytes bytes.
+ * Returns: the position or -1 if there is not enough data in the queue. */
+static gint
+find_bytes_position (GstMultiHandleSink * sink, guint64 bytes)
+{
+  if (bytes > sink->index_bytes)
+    return -1;
+
+  return index_find (sink, G_STRUCT_OFFSET (GstMultiHandleSinkIndex, offset),
+      sink->index_bytes - bytes);
+}
+
+/* Get the lowest position of a buffer with a timestamp that is at least
+ * @time older than the most recent timestamp in the queue.
+ * Returns: the position or -1 if there is not enough data in the queue. */
+static gint
+find_time_position (GstMultiHandleSink * sink, guint64 time)
+{
+  gint pos;
+
+  /* no timestamps in the queue */
+  if (index_position (sink, sink->index_last_ts) == -1)
+    return -1;
+
+  if (time > sink->index_time)
+    return -1;
+
+  pos = index_find (sink, G_STRUCT_OFFSET (GstMultiHandleSinkIndex, time),
+      sink->index_time - time);
+  if (pos == -1)
+    return -1;
+
+  /* buffers without timestamp share the time of the previous one, take the
+   * buffer that carries it */
+  return index_position (sink, BUFQUEUE_INDEX (sink, pos).last_ts);
+}
+
 /* find the keyframe in the list of buffers starting the
  * search from @idx. @direction as -1 will search backwards,
  * 1 will search forwards.
@@ -1076,25 +1299,40 @@ is_sync_frame (GstMultiHandleSink * sink, GstBuffer * buffer)
 gint
 find_syncframe (GstMultiHandleSink * sink, gint idx, gint direction)
 {
-  gint i, len, result;
-
-  /* take length of queued buffers */
-  len = sink->bufqueue->len;
-
-  /* assume we don't find a keyframe */
-  result = -1;
+  gint result;
 
-  /* then loop over all buffers to find the first keyframe */
-  for (i = idx; i >= 0 && i < len; i += direction) {
-    GstBuffer *buf;
+  if (idx < 0 || (guint) idx >= sink->bufqueue_len)
+    return -1;
 
-    buf = g_array_index (sink->bufqueue, GstBuffer *, i);
-    if (is_sync_frame (sink, buf)) {
-      GST_LOG_OBJECT (sink, "found keyframe at %d from %d, direction %d",
-          i, idx, direction);
-      result = i;
-      break;
+  if (direction > 0) {
+    /* the last sync frame that was queued before or at idx */
+    result = index_position (sink, BUFQUEUE_INDEX (sink, idx).last_sync);
+  } else {
+    guint64 seq1 = sink->bufqueue_seq - idx;
+    gint lo, hi;
+
+    /* no sync frame at or after idx */
+    if (sink->index_last_sync < seq1)
+      return -1;
+
+    /* find the highest position up to idx whose last sync frame is not
+     * older than idx, that sync frame is the first one after idx */
+    lo = 0;
+    hi = idx;
+    while (lo < hi) {
+      gint mid = lo + (hi - lo + 1) / 2;
+
+      if (BUFQUEUE_INDEX (sink, mid).last_sync >= seq1)
+        lo = mid;
+      else
+        hi = mid - 1;
     }
+    result = index_position (sink, BUFQUEUE_INDEX (sink, lo).last_sync);
+  }
+
+  if (result != -1) {
+    GST_LOG_OBJECT (sink, "found keyframe at %d from %d, direction %d",
+        result, idx, direction);
   }
   return result;
 }
@@ -1106,51 +1344,23 @@ find_syncframe (GstMultiHandleSink * sink, gint idx, gint direction)
 gint
 get_buffers_max (GstMultiHandleSink * sink, gint64 max)
 {
+  gint pos;
+
   switch (sink->unit_format) {
     case GST_FORMAT_BUFFERS:
       return max;
     case GST_FORMAT_TIME:
-    {
-      GstBuffer *buf;
-      int i;
-      int len;
-      gint64 diff;
-      GstClockTime first = GST_CLOCK_TIME_NONE;
-
-      len = sink->bufqueue->len;
-
-      for (i = 0; i < len; i++) {
-        buf = g_array_index (sink->bufqueue, GstBuffer *, i);
-        if (GST_BUFFER_TIMESTAMP_IS_VALID (buf)) {
-          if (first == -1)
-            first = GST_BUFFER_TIMESTAMP (buf);
-
-          diff = first - GST_BUFFER_TIMESTAMP (buf);
-
-          if (diff > max)
-            return i + 1;
-        }
-      }
-      return len + 1;
-    }
+      /* the first buffer that is more than max older than the first one */
+      pos = find_time_position (sink, MAX (max + 1, 0));
+      if (pos == -1)
+        return sink->bufqueue_len + 1;
+      return pos + 1;
     case GST_FORMAT_BYTES:
-    {
-      GstBuffer *buf;
-      int i;
-      int len;
-      gint acc = 0;
-
-      len = sink->bufqueue->len;
-
-      for (i = 0; i < len; i++) {
-        buf = g_array_index (sink->bufqueue, GstBuffer *, i);
-        acc += gst_buffer_get_size (buf);
-
-        if (acc > max)
-          return i + 1;
-      }
-      return len + 1;
-    }
+      /* the first buffer where we have more than max bytes */
+      pos = find_bytes_position (sink, MAX (max + 1, 0));
+      if (pos == -1)
+        return sink->bufqueue_len + 1;
+      return pos + 1;
     default:
       return max;
   }
@@ -1173,12 +1383,11 @@ find_limits (GstMultiHandleSink * sink,
     gint * min_idx, gint bytes_min, gint buffers_min, gint64 time_min,
     gint * max_idx, gint bytes_max, gint buffers_max, gint64 time_max)
 {
-  GstClockTime first, time;
-  gint i, len, bytes;
-  gboolean result, max_hit;
+  gint len, pos, min_pos, max_pos;
+  gboolean result, min_set, min_ok;
 
   /* take length of queue */
-  len = sink->bufqueue->len;
+  len = sink->bufqueue_len;
 
   /* this must hold */
   g_assert (len > 0);
@@ -1196,73 +1405,53 @@ find_limits (GstMultiHandleSink * sink,
     return FALSE;
   }
 
-  result = FALSE;
-  /* else count bytes and time */
-  first = -1;
-  bytes = 0;
-  /* unset limits */
-  *min_idx = -1;
-  *max_idx = -1;
-  max_hit = FALSE;
-
-  i = 0;
-  /* loop through the buffers, when a limit is ok, mark it
-   * as -1, we have at least one buffer in the queue. */
-  do {
-    GstBuffer *buf;
-
-    /* if we checked all min limits, update result */
-    if (bytes_min == -1 && time_min == -1 && *min_idx == -1) {
-      /* don't go below 0 */
-      *min_idx = MAX (i - 1, 0);
-    }
-    /* if we reached one max limit break out */
-    if (max_hit) {
-      /* i > 0 when we get here, we subtract one to get the position
-       * of the previous buffer. */
-      *max_idx = i - 1;
-      /* we have valid complete result if we found a min_idx too */
-      result = *min_idx != -1;
-      break;
-    }
-    buf = g_array_index (sink->bufqueue, GstBuffer *, i);
-
-    bytes += gst_buffer_get_size (buf);
-
-    /* take timestamp and save for the base first timestamp */
-    if ((time = GST_BUFFER_TIMESTAMP (buf)) != -1) {
-      GST_LOG_OBJECT (sink, "Ts %" GST_TIME_FORMAT " on buffer",
-          GST_TIME_ARGS (time));
-      if (first == -1)
-        first = time;
-
-      /* increase max usage if we did not fill enough. Note that
-       * buffers are sorted from new to old, so the first timestamp is
-       * bigger than the next one. */
-      if (time_min != -1 && first - time >= time_min)
-        time_min = -1;
-      if (time_max != -1 && first - time >= time_max)
-        max_hit = TRUE;
-    } else {
-      GST_LOG_OBJECT (sink, "No timestamp on buffer");
-    }
-    /* time is OK or unknown, check and increase if not enough bytes */
-    if (bytes_min != -1) {
-      if (bytes >= bytes_min)
-        bytes_min = -1;
-    }
-    if (bytes_max != -1) {
-      if (bytes >= bytes_max) {
-        max_hit = TRUE;
-      }
-    }
-    i++;
+  /* find the buffer where all min limits are satisfied. We need at least one
+   * buffer after it in the queue to take it. */
+  min_set = bytes_min != -1 || time_min != -1;
+  min_ok = TRUE;
+  min_pos = 0;
+  if (bytes_min != -1) {
+    pos = find_bytes_position (sink, bytes_min);
+    if (pos == -1)
+      min_ok = FALSE;
+    else
+      min_pos = MAX (min_pos, pos);
+  }
+  if (time_min != -1) {
+    pos = find_time_position (sink, time_min);
+    if (pos == -1)
+      min_ok = FALSE;
+    else
+      min_pos = MAX (min_pos, pos);
+  }
+  if (min_set && min_pos + 1 >= len)
+    min_ok = FALSE;
+
+  /* find the first buffer where one of the max limits is hit */
+  max_pos = -1;
+  if (bytes_max != -1)
+    max_pos = find_bytes_position (sink, bytes_max);
+  if (time_max != -1) {
+    pos = find_time_position (sink, time_max);
+    if (pos != -1 && (max_pos == -1 || pos < max_pos))
+      max_pos = pos;
   }
-  while (i < len);
 
-  /* if we did not hit the max or min limit, set to buffer size */
-  if (*max_idx == -1)
+  result = FALSE;
+  *min_idx = -1;
+  if (max_pos != -1 && max_pos + 1 < len) {
+    /* we hit a max limit, we have a valid complete result if the min
+     * limits are satisfied before it */
+    *max_idx = max_pos;
+    if (min_ok && min_pos <= max_pos)
+      *min_idx = min_pos;
+    result = *min_idx != -1;
+  } else {
+    /* if we did not hit the max limit, set to buffer size */
     *max_idx = len - 1;
+    if (min_ok)
+      *min_idx = min_pos;
+  }
   /* make sure min does not exceed max */
   if (*min_idx == -1)
     *min_idx = *max_idx;
@@ -1341,11 +1530,11 @@ gst_multi_handle_sink_new_client_position (GstMultiHandleSink * sink,
   GST_DEBUG_OBJECT (sink,
       "%s new client, deciding where to start in queue", client->debug);
   GST_DEBUG_OBJECT (sink, "queue is currently %d buffers long",
-      sink->bufqueue->len);
+      sink->bufqueue_len);
   switch (client->sync_method) {
     case GST_SYNC_METHOD_LATEST:
       /* no syncing, we are happy with whatever the client is going to get */
-      result = client->bufpos;
+      result = CLIENT_BUFPOS (sink, client);
       GST_DEBUG_OBJECT (sink,
           "%s SYNC_METHOD_LATEST, position %d", client->debug, result);
       break;
@@ -1355,9 +1544,9 @@ gst_multi_handle_sink_new_client_position (GstMultiHandleSink * sink,
        * is a sync point, we can proceed, otherwise we need to keep waiting */
       GST_LOG_OBJECT (sink,
           "%s new client, bufpos %d, waiting for keyframe",
-          client->debug, client->bufpos);
+          client->debug, CLIENT_BUFPOS (sink, client));
 
-      result = find_prev_syncframe (sink, client->bufpos);
+      result = find_prev_syncframe (sink, CLIENT_BUFPOS (sink, client));
       if (result != -1) {
         GST_DEBUG_OBJECT (sink,
             "%s SYNC_METHOD_NEXT_KEYFRAME: result %d", client->debug, result);
@@ -1369,7 +1558,7 @@ gst_multi_handle_sink_new_client_position (GstMultiHandleSink * sink,
       GST_LOG_OBJECT (sink,
           "%s new client, skipping buffer(s), no syncpoint found",
           client->debug);
-      client->bufpos = -1;
+      CLIENT_SET_BUFPOS (sink, client, -1);
       break;
     }
     case GST_SYNC_METHOD_LATEST_KEYFRAME:
@@ -1392,7 +1581,7 @@ gst_multi_handle_sink_new_client_position (GstMultiHandleSink * sink,
           "%s SYNC_METHOD_LATEST_KEYFRAME: no keyframe found, "
           "switching to SYNC_METHOD_NEXT_KEYFRAME", client->debug);
       /* throw client to the waiting state */
-      client->bufpos = -1;
+      CLIENT_SET_BUFPOS (sink, client, -1);
       /* and make client sync to next keyframe */
       client->sync_method = GST_SYNC_METHOD_NEXT_KEYFRAME;
       break;
@@ -1467,7 +1656,7 @@ gst_multi_handle_sink_new_client_position (GstMultiHandleSink * sink,
           "no prev keyframe found in BURST_KEYFRAME sync mode, waiting for next");
 
       /* throw client to the waiting state */
-      client->bufpos = -1;
+      CLIENT_SET_BUFPOS (sink, client, -1);
       /* and make client sync to next keyframe */
       client->sync_method = GST_SYNC_METHOD_NEXT_KEYFRAME;
       result = -1;
@@ -1514,7 +1703,7 @@ gst_multi_handle_sink_new_client_position (GstMultiHandleSink * sink,
     }
     default:
       g_warning ("unknown sync method %d", client->sync_method);
-      result = client->bufpos;
+      result = CLIENT_BUFPOS (sink, client);
       break;
   }
   return result;
@@ -1532,13 +1721,14 @@ gst_multi_handle_sink_recover_client (GstMultiHandleSink * sink,
 
   GST_WARNING_OBJECT (sink,
       "%s client %p is lagging at %d, recover using policy %d",
-      client->debug, client, client->bufpos, sink->recover_policy);
+      client->debug, client, CLIENT_BUFPOS (sink, client),
+      sink->recover_policy);
 
   switch (sink->recover_policy) {
     case GST_RECOVER_POLICY_NONE:
       /* do nothing, client will catch up or get kicked out when it reaches
        * the hard max */
-      newbufpos = client->bufpos;
+      newbufpos = CLIENT_BUFPOS (sink, client);
       break;
     case GST_RECOVER_POLICY_RESYNC_LATEST:
       /* move to beginning of queue */
@@ -1551,19 +1741,9 @@ gst_multi_handle_sink_recover_client (GstMultiHandleSink * sink,
     case GST_RECOVER_POLICY_RESYNC_KEYFRAME:
       /* find keyframe in buffers, we search backwards to find the
        * closest keyframe relative to what this client already received. */
-      newbufpos = MIN (sink->bufqueue->len - 1,
+      newbufpos = MIN (sink->bufqueue_len - 1,
           get_buffers_max (sink, sink->units_soft_max) - 1);
-
-      while (newbufpos >= 0) {
-        GstBuffer *buf;
-
-        buf = g_array_index (sink->bufqueue, GstBuffer *, newbufpos);
-        if (is_sync_frame (sink, buf)) {
-          /* found a buffer that is not a delta unit */
-          break;
-        }
-        newbufpos--;
-      }
+      newbufpos = find_prev_syncframe (sink, newbufpos);
       break;
     default:
       /* unknown recovery procedure */
@@ -1573,44 +1753,268 @@ gst_multi_handle_sink_recover_client (GstMultiHandleSink * sink,
   return newbufpos;
 }
 
+/* Make room for one more buffer in the global queue. The ring buffer is
+ * doubled in size, buffers keep their sequence number. */
+static void
+gst_multi_handle_sink_grow_bufqueue (GstMultiHandleSink * mhsink)
+{
+  GstBuffer **bufqueue;
+  GstMultiHandleSinkIndex *bufindex;
+  guint *client_count;
+  guint i, size;
+
+  size = MAX (mhsink->bufqueue_size * 2, 16);
+  bufqueue = g_new0 (GstBuffer *, size);
+  bufindex = g_new0 (GstMultiHandleSinkIndex, size);
+  client_count = g_new0 (guint, size);
+  for (i = 0; i < mhsink->bufqueue_len; i++) {
+    guint64 seq = mhsink->bufqueue_seq - 1 - i;
+
+    bufqueue[seq & (size - 1)] = BUFQUEUE_BUFFER (mhsink, i);
+    bufindex[seq & (size - 1)] = BUFQUEUE_INDEX (mhsink, i);
+    client_count[seq & (size - 1)] =
+        mhsink->client_count[seq & (mhsink->bufqueue_size - 1)];
+  }
+  g_free (mhsink->bufqueue);
+  g_free (mhsink->bufindex);
+  g_free (mhsink->client_count);
+  mhsink->bufqueue = bufqueue;
+  mhsink->bufindex = bufindex;
+  mhsink->client_count = client_count;
+  mhsink->bufqueue_size = size;
+
+  GST_DEBUG_OBJECT (mhsink, "bufqueue grown to %u buffers", size);
+}
+
+/* Every client with a position in the queue is counted in client_count at
+ * the sequence number of the next buffer it sends, or in n_front_clients
+ * when it waits for the next buffer. This gives the position of the client
+ * that is furthest behind without walking the clients. Clients that are
+ * being removed are not counted.
+ *
+ * Should be called with the clientslock held. */
+void
+gst_multi_handle_sink_client_set_seq (GstMultiHandleSink * sink,
+    GstMultiHandleClient * client, guint64 seq)
+{
+  if (client->counted) {
+    if (client->bufseq == sink->bufqueue_seq)
+      sink->n_front_clients--;
+    else
+      sink->client_count[client->bufseq & (sink->bufqueue_size - 1)]--;
+    client->counted = FALSE;
+  }
+
+  /* positions are always inside the queue or waiting for the next buffer */
+  seq = CLAMP (seq, sink->bufqueue_seq - sink->bufqueue_len,
+      sink->bufqueue_seq);
+  client->bufseq = seq;
+
+  if (client->currently_removing)
+    return;
+
+  if (seq == sink->bufqueue_seq) {
+    sink->n_front_clients++;
+  } else {
+    sink->client_count[seq & (sink->bufqueue_size - 1)]++;
+    if (seq < sink->oldest_seq)
+      sink->oldest_seq = seq;
+  }
+  client->counted = TRUE;
+}
+
+/* Put a client that has nothing left to send on the waiting list, it will
+ * be handed back to the subclass with hash_adding when the next buffer is
+ * queued.
+ *
+ * Should be called with the clientslock held. */
+void
+gst_multi_handle_sink_client_wait (GstMultiHandleSink * sink,
+    GstMultiHandleClient * client)
+{
+  if (client->waiting || client->currently_removing)
+    return;
+
+  g_queue_push_tail_link (&sink->waiting_clients, &client->waiting_link);
+  client->waiting = TRUE;
+}
+
+/* the position of the client that is furthest behind, -1 if all clients
+ * wait for the next buffer */
+static gint
+gst_multi_handle_sink_oldest_client_pos (GstMultiHandleSink * sink)
+{
+  guint64 seq;
+
+  seq = MAX (sink->oldest_seq, sink->bufqueue_seq - sink->bufqueue_len);
+  while (seq < sink->bufqueue_seq &&
+      sink->client_count[seq & (sink->bufqueue_size - 1)] == 0)
+    seq++;
+  sink->oldest_seq = seq;
+
+  return (gint) (sink->bufqueue_seq - 1 - seq);
+}
+
+/* should be called with the clientslock held. Records that @client sent
+ * data at @now, which moves it to the tail of the activity_clients. */
+void
+gst_multi_handle_sink_client_active (GstMultiHandleSink * sink,
+    GstMultiHandleClient * client, GstClockTime now)
+{
+  client->last_activity_time = now;
+
+  /* the client is not checked anymore while it is being removed */
+  if (client->currently_removing)
+    return;
+
+  g_queue_unlink (&sink->activity_clients, &client->activity_link);
+  g_queue_push_tail_link (&sink->activity_clients, &client->activity_link);
+}
+
+/* should be called with the clientslock held. Removes the clients that did
+ * not do anything for longer than the timeout. The clients are ordered by
+ * their last activity, so only the ones that timed out and the next one are
+ * looked at. */
+void
+gst_multi_handle_sink_remove_idle_clients (GstMultiHandleSink * sink,
+    GstClockTime now)
+{
+  GstMultiHandleSinkClass *mhsinkclass = GST_MULTI_HANDLE_SINK_GET_CLASS (sink);
+  GstMultiHandleClient *mhclient;
+
+  if (sink->timeout == 0)
+    return;
+
+  while ((mhclient = g_queue_peek_head (&sink->activity_clients)) &&
+      now - mhclient->last_activity_time > sink->timeout) {
+    GList *link;
+
+    GST_WARNING_OBJECT (sink, "%s client %p timed out, removing",
+        mhclient->debug, mhclient);
+    link = g_hash_table_lookup (sink->handle_hash,
+        mhsinkclass->handle_hash_key (mhclient->handle));
+    mhclient->status = GST_CLIENT_STATUS_SLOW;
+    /* set client to invalid position while being removed */
+    CLIENT_SET_BUFPOS (sink, mhclient, -1);
+    /* unlinks the client from the activity_clients */
+    gst_multi_handle_sink_remove_client_link (sink, link);
+  }
+}
+
+/* Check all client positions in the queue. If a client moved over the soft
+ * max, we start the recovery procedure for this slow client. If it goes over
+ * the hard max, it is removed. Returns TRUE when clients were removed. */
+static gboolean
+gst_multi_handle_sink_check_clients (GstMultiHandleSink * mhsink,
+    gint max_buffers, gint soft_max_buffers)
+{
+  GList *clients, *next;
+  gboolean hash_changed = FALSE;
+  guint cookie;
+
+restart:
+  cookie = mhsink->clients_cookie;
+  for (clients = mhsink->clients; clients; clients = next) {
+    GstMultiHandleClient *mhclient = clients->data;
+    gint bufpos;
+
+    if (cookie != mhsink->clients_cookie) {
+      GST_DEBUG_OBJECT (mhsink, "Clients cookie outdated, restarting");
+      goto restart;
+    }
+
+    next = g_list_next (clients);
+
+    bufpos = CLIENT_BUFPOS (mhsink, mhclient);
+    GST_LOG_OBJECT (mhsink, "%s client %p at position %d",
+        mhclient->debug, mhclient, bufpos);
+
+    /* check soft max if needed, recover client */
+    if (soft_max_buffers > 0 && bufpos >= soft_max_buffers) {
+      gint newpos;
+
+      newpos = gst_multi_handle_sink_recover_client (mhsink, mhclient);
+      if (newpos != bufpos) {
+        mhclient->dropped_buffers += bufpos - newpos;
+        bufpos = newpos;
+        CLIENT_SET_BUFPOS (mhsink, mhclient, bufpos);
+        mhclient->discont = TRUE;
+        GST_INFO_OBJECT (mhsink, "%s client %p position reset to %d",
+            mhclient->debug, mhclient, bufpos);
+      } else {
+        GST_INFO_OBJECT (mhsink,
+            "%s client %p not recovering position", mhclient->debug, mhclient);
+      }
+    }
+
+    /* check hard max, remove client */
+    if (max_buffers > 0 && bufpos >= max_buffers) {
+      /* remove client */
+      GST_WARNING_OBJECT (mhsink, "%s client %p is too slow, removing",
+          mhclient->debug, mhclient);
+      /* remove the client, the handle set will be cleared and the select thread
+       * will be signaled */
+      mhclient->status = GST_CLIENT_STATUS_SLOW;
+      /* set client to invalid position while being removed */
+      CLIENT_SET_BUFPOS (mhsink, mhclient, -1);
+      gst_multi_handle_sink_remove_client_link (mhsink, clients);
+      hash_changed = TRUE;
+    }
+  }
+
+  return hash_changed;
+}
+
 /* Queue a buffer on the global queue.
  *
- * This function adds the buffer to the front of a GArray. It removes the
- * tail buffer if the max queue size is exceeded, unreffing the queued buffer.
+ * This function stores the buffer in the ring buffer with the next sequence
+ * number, which moves all clients one position further away from the front
+ * of the queue without having to touch them. It removes the tail buffers if
+ * the max queue size is exceeded, unreffing the queued buffers.
  * Note that unreffing the buffer is not a problem as clients who
  * started writing out this buffer will still have a reference to it in the
  * mhclient->sending queue.
  *
- * After adding the buffer, we update all client positions in the queue. If
- * a client moves over the soft max, we start the recovery procedure for this
- * slow client. If it goes over the hard max, it is put into the slow list
- * and removed.
+ * The position of the client that is furthest behind is known from the
+ * client counts, so the clients are only checked when one of them might have
+ * moved over the soft or hard max. See gst_multi_handle_sink_check_clients().
+ * Only the idlest clients are looked at for the timeout.
  *
- * Special care is taken of clients that were waiting for a new buffer (they
- * had a position of -1) because they can proceed after adding this new buffer.
- * This is done by adding the client back into the write fd_set and signaling
- * the select thread that the fd_set changed.
+ * Clients that were waiting for a new buffer (they had a position of -1) can
+ * proceed after adding this new buffer. They are taken from the waiting list
+ * and added back into the write fd_set, and the select thread is signaled
+ * that the fd_set changed.
  */
 static void
 gst_multi_handle_sink_queue_buffer (GstMultiHandleSink * mhsink,
     GstBuffer * buffer)
 {
-  GList *clients, *next;
+  GList *link;
   gint queuelen;
   gboolean hash_changed = FALSE;
   gint max_buffer_usage;
+  gint oldest;
   gint i;
   GstClockTime now;
   gint max_buffers, soft_max_buffers;
-  guint cookie;
+  guint slot;
   GstMultiHandleSink *sink = GST_MULTI_HANDLE_SINK (mhsink);
   GstMultiHandleSinkClass *mhsinkclass =
       GST_MULTI_HANDLE_SINK_GET_CLASS (mhsink);
 
   CLIENTS_LOCK (mhsink);
   /* add buffer to queue */
-  g_array_prepend_val (mhsink->bufqueue, buffer);
-  queuelen = mhsink->bufqueue->len;
+  if (mhsink->bufqueue_len == mhsink->bufqueue_size)
+    gst_multi_handle_sink_grow_bufqueue (mhsink);
+  gst_multi_handle_sink_index_buffer (mhsink, buffer);
+  slot = mhsink->bufqueue_seq & (mhsink->bufqueue_size - 1);
+  mhsink->bufqueue[slot] = buffer;
+  /* the clients that waited for this buffer are now at position 0 */
+  mhsink->client_count[slot] = mhsink->n_front_clients;
+  mhsink->n_front_clients = 0;
+  mhsink->bufqueue_seq++;
+  mhsink->bufqueue_len++;
+  queuelen = mhsink->bufqueue_len;
 
   if (mhsink->units_max > 0)
     max_buffers = get_buffers_max (mhsink, mhsink->units_max);
@@ -1624,77 +2028,40 @@ gst_multi_handle_sink_queue_buffer (GstMultiHandleSink * mhsink,
   GST_LOG_OBJECT (sink, "Using max %d, softmax %d", max_buffers,
       soft_max_buffers);
 
-  /* then loop over the clients and update the positions */
-  cookie = mhsink->clients_cookie;
-  for (clients = mhsink->clients; clients; clients = clients->next) {
-    GstMultiHandleClient *mhclient = clients->data;
-
-    mhclient->bufpos++;
-    GST_LOG_OBJECT (sink, "%s client %p at position %d",
-        mhclient->debug, mhclient, mhclient->bufpos);
-
-    /* check soft max if needed, recover client */
-    if (soft_max_buffers > 0 && mhclient->bufpos >= soft_max_buffers) {
-      gint newpos;
-
-      newpos = gst_multi_handle_sink_recover_client (mhsink, mhclient);
-      if (newpos != mhclient->bufpos) {
-        mhclient->dropped_buffers += mhclient->bufpos - newpos;
-        mhclient->bufpos = newpos;
-        mhclient->discont = TRUE;
-        GST_INFO_OBJECT (sink, "%s client %p position reset to %d",
-            mhclient->debug, mhclient, mhclient->bufpos);
-      } else {
-        GST_INFO_OBJECT (sink,
-            "%s client %p not recovering position", mhclient->debug, mhclient);
-      }
-    }
-  }
-
-  max_buffer_usage = 0;
   now = g_get_real_time () * GST_USECOND;
+  oldest = gst_multi_handle_sink_oldest_client_pos (mhsink);
 
-  /* now check for new or slow clients */
-restart:
-  cookie = mhsink->clients_cookie;
-  for (clients = mhsink->clients; clients; clients = next) {
-    GstMultiHandleClient *mhclient = clients->data;
-
-    if (cookie != mhsink->clients_cookie) {
-      GST_DEBUG_OBJECT (sink, "Clients cookie outdated, restarting");
-      goto restart;
-    }
-
-    next = g_list_next (clients);
+  /* now check for idle, lagging or slow clients */
+  if (mhsink->timeout > 0) {
+    guint cookie = mhsink->clients_cookie;
 
-    /* check hard max and timeout, remove client */
-    if ((max_buffers > 0 && mhclient->bufpos >= max_buffers) ||
-        (mhsink->timeout > 0
-            && now - mhclient->last_activity_time > mhsink->timeout)) {
-      /* remove client */
-      GST_WARNING_OBJECT (sink, "%s client %p is too slow, removing",
-          mhclient->debug, mhclient);
-      /* remove the client, the handle set will be cleared and the select thread
-       * will be signaled */
-      mhclient->status = GST_CLIENT_STATUS_SLOW;
-      /* set client to invalid position while being removed */
-      mhclient->bufpos = -1;
-      gst_multi_handle_sink_remove_client_link (mhsink, clients);
+    gst_multi_handle_sink_remove_idle_clients (mhsink, now);
+    if (cookie != mhsink->clients_cookie)
       hash_changed = TRUE;
-      continue;
-    } else if (mhclient->bufpos == 0 || mhclient->new_connection) {
-      /* can send data to this client now. need to signal the select thread that
-       * the handle_set changed */
-      mhsinkclass->hash_adding (mhsink, mhclient);
+  }
+  if ((max_buffers > 0 && oldest >= max_buffers) ||
+      (soft_max_buffers > 0 && oldest >= soft_max_buffers &&
+          mhsink->recover_policy != GST_RECOVER_POLICY_NONE)) {
+    GST_LOG_OBJECT (sink, "checking clients, oldest at %d", oldest);
+    if (gst_multi_handle_sink_check_clients (mhsink, max_buffers,
+            soft_max_buffers))
       hash_changed = TRUE;
-    }
+  }
+  oldest = gst_multi_handle_sink_oldest_client_pos (mhsink);
 
-    /* keep track of maximum buffer usage */
-    if (mhclient->bufpos > max_buffer_usage) {
-      max_buffer_usage = mhclient->bufpos;
-    }
+  /* wake up the clients that were waiting for this buffer. Need to signal
+   * the select thread that the handle_set changed */
+  while ((link = g_queue_pop_head_link (&mhsink->waiting_clients))) {
+    GstMultiHandleClient *mhclient = link->data;
+
+    mhclient->waiting = FALSE;
+    mhsinkclass->hash_adding (mhsink, mhclient);
+    hash_changed = TRUE;
   }
 
+  /* keep track of maximum buffer usage */
+  max_buffer_usage = MAX (oldest, 0);
+
   /* make sure we respect bytes-min, buffers-min and time-min when they are set */
   {
     gint usage, max;
@@ -1722,7 +2089,7 @@ restart:
       mhsink->def_sync_method == GST_SYNC_METHOD_BURST_KEYFRAME) {
     /* no point in searching beyond the queue length */
     gint limit = queuelen;
-    GstBuffer *buf;
+    gint syncframe;
 
     /* no point in searching beyond the soft-max if any. */
     if (soft_max_buffers > 0) {
@@ -1731,14 +2098,11 @@ restart:
     GST_LOG_OBJECT (sink,
         "extending queue to include sync point, now at %d, limit is %d",
         max_buffer_usage, limit);
-    for (i = 0; i < limit; i++) {
-      buf = g_array_index (mhsink->bufqueue, GstBuffer *, i);
-      if (is_sync_frame (mhsink, buf)) {
-        /* found a sync frame, now extend the buffer usage to
-         * include at least this frame. */
-        max_buffer_usage = MAX (max_buffer_usage, i);
-        break;
-      }
+    syncframe = find_next_syncframe (mhsink, 0);
+    if (syncframe != -1 && syncframe < limit) {
+      /* found a sync frame, now extend the buffer usage to
+       * include at least this frame. */
+      max_buffer_usage = MAX (max_buffer_usage, syncframe);
     }
     GST_LOG_OBJECT (sink, "max buffer usage is now %d", max_buffer_usage);
   }
@@ -1746,19 +2110,19 @@ restart:
   GST_LOG_OBJECT (sink, "len %d, usage %d", queuelen, max_buffer_usage);
 
   /* nobody is referencing units after max_buffer_usage so we can
-   * remove them from the queue. We remove them in reverse order as
-   * this is the most optimal for GArray. */
+   * remove them from the tail of the queue. */
   for (i = queuelen - 1; i > max_buffer_usage; i--) {
     GstBuffer *old;
 
     /* queue exceeded max size */
     queuelen--;
-    old = g_array_index (mhsink->bufqueue, GstBuffer *, i);
-    mhsink->bufqueue = g_array_remove_index (mhsink->bufqueue, i);
+    old = BUFQUEUE_BUFFER (mhsink, i);
+    BUFQUEUE_BUFFER (mhsink, i) = NULL;
 
     /* unref tail buffer */
     gst_buffer_unref (old);
   }
+  mhsink->bufqueue_len = queuelen;
   /* save for stats */
   mhsink->buffers_queued = max_buffer_usage + 1;
   CLIENTS_UNLOCK (sink);
@@ -1970,6 +2334,12 @@ gst_multi_handle_sink_set_property (GObject * object, guint prop_id,
     case PROP_RESEND_STREAMHEADER:
       multihandlesink->resend_streamheader = g_value_get_boolean (value);
       break;
+    case PROP_USE_EPOLL:
+      multihandlesink->use_epoll = g_value_get_boolean (value);
+      break;
+    case PROP_N_SENDER_THREADS:
+      multihandlesink->n_sender_threads = g_value_get_uint (value);
+      break;
 
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -2046,6 +2416,12 @@ gst_multi_handle_sink_get_property (GObject * object, guint prop_id,
     case PROP_RESEND_STREAMHEADER:
       g_value_set_boolean (value, multihandlesink->resend_streamheader);
       break;
+    case PROP_USE_EPOLL:
+      g_value_set_boolean (value, multihandlesink->use_epoll);
+      break;
+    case PROP_N_SENDER_THREADS:
+      g_value_set_uint (value, multihandlesink->n_sender_threads);
+      break;
     case PROP_NUM_HANDLES:
       g_value_set_uint (value,
           g_hash_table_size (multihandlesink->handle_hash));
@@ -2056,12 +2432,297 @@ gst_multi_handle_sink_get_property (GObject * object, guint prop_id,
   }
 }
 
+/* Sender threads.
+ *
+ * The clients are spread over n-sender-threads threads that each watch their
+ * own clients. All senders share the global buffer queue and the clients
+ * lock, but they write to their clients without holding the lock, see
+ * gst_multi_handle_sink_client_begin_io(). A client is handled by the same
+ * sender for its whole life, so its data is always written in order.
+ *
+ * Edge-triggered client set.
+ *
+ * With use-epoll, every client handle is registered once in the epoll set
+ * of its sender with EPOLLET, so we never have to toggle the write interest
+ * of a client that caught up and the sender only visits the clients that
+ * have something to do instead of walking the whole client list.
+ *
+ * Edges are only reported once, so we remember in can_write whether the
+ * socket of a client is known to be writable. It is set when EPOLLOUT
+ * fires and cleared by the subclass when a write was short or would block.
+ * A writable client that gets new data is queued on ready_clients directly
+ * from hash_adding. All of this is protected by the clients lock. */
+#define EPOLL_MAX_EVENTS 256
+
+static gpointer
+gst_multi_handle_sink_sender_func (GstMultiHandleSinkSender * sender)
+{
+  GstMultiHandleSinkClass *mhsclass =
+      GST_MULTI_HANDLE_SINK_GET_CLASS (sender->sink);
+
+  return mhsclass->thread (sender->sink, sender->index);
+}
+
+static void
+gst_multi_handle_sink_senders_open (GstMultiHandleSink * mhsink)
+{
+  guint i, n_senders;
+
+  n_senders = mhsink->n_sender_threads;
+  if (n_senders == 0)
+    n_senders = g_get_num_processors ();
+
+  mhsink->senders = g_new0 (GstMultiHandleSinkSender, n_senders);
+  mhsink->n_senders = n_senders;
+  for (i = 0; i < n_senders; i++) {
+    GstMultiHandleSinkSender *sender = &mhsink->senders[i];
+
+    sender->sink = mhsink;
+    sender->index = i;
+    sender->epoll_fd = -1;
+    g_queue_init (&sender->clients);
+    g_queue_init (&sender->ready_clients);
+  }
+  GST_DEBUG_OBJECT (mhsink, "using %u sender threads", n_senders);
+
+  mhsink->using_epoll = FALSE;
+  if (!mhsink->use_epoll)
+    return;
+
+#ifdef HAVE_SYS_EPOLL_H
+  for (i = 0; i < n_senders; i++) {
+    mhsink->senders[i].epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+    if (mhsink->senders[i].epoll_fd < 0)
+      goto epoll_failed;
+  }
+  GST_DEBUG_OBJECT (mhsink, "watching clients with epoll");
+  mhsink->using_epoll = TRUE;
+  return;
+
+epoll_failed:
+  {
+    GST_WARNING_OBJECT (mhsink, "failed to create epoll set, using poll: %s",
+        g_strerror (errno));
+    for (i = 0; i < n_senders; i++) {
+      if (mhsink->senders[i].epoll_fd >= 0)
+        close (mhsink->senders[i].epoll_fd);
+      mhsink->senders[i].epoll_fd = -1;
+    }
+  }
+#else
+  GST_WARNING_OBJECT (mhsink, "epoll is not available, using poll");
+#endif
+}
+
+/* all clients are removed by now */
+static void
+gst_multi_handle_sink_senders_close (GstMultiHandleSink * mhsink)
+{
+#ifdef HAVE_SYS_EPOLL_H
+  guint i;
+
+  for (i = 0; i < mhsink->n_senders; i++) {
+    if (mhsink->senders[i].epoll_fd >= 0)
+      close (mhsink->senders[i].epoll_fd);
+  }
+#endif
+
+  g_free (mhsink->senders);
+  mhsink->senders = NULL;
+  mhsink->n_senders = 0;
+  mhsink->using_epoll = FALSE;
+}
+
+/* should be called with the clientslock held, before the handle of @client
+ * is added to the poll set of its sender. Assigns @client to the sender
+ * that has the fewest clients. */
+void
+gst_multi_handle_sink_client_assign_sender (GstMultiHandleSink * sink,
+    GstMultiHandleClient * client)
+{
+  guint i, sender = 0;
+
+  for (i = 1; i < sink->n_senders; i++) {
+    if (sink->senders[i].clients.length < sink->senders[sender].clients.length)
+      sender = i;
+  }
+
+  client->sender = sender;
+  g_queue_push_tail_link (&sink->senders[sender].clients,
+      &client->sender_link);
+
+  GST_LOG_OBJECT (sink, "%s handled by sender %u", client->debug, sender);
+}
+
+/* should be called with the clientslock held exactly once by the sender of
+ * @client. Releases the lock so that the sender can write to @client while
+ * the other senders and the streaming thread continue. @client stays valid
+ * until gst_multi_handle_sink_client_end_io() took the lock again, after
+ * which the sender has to check currently_removing: a client that was
+ * removed meanwhile must not be used anymore but passed to
+ * gst_multi_handle_sink_remove_client_link(). */
+void
+gst_multi_handle_sink_client_begin_io (GstMultiHandleSink * sink,
+    GstMultiHandleClient * client)
+{
+  /* the lock would still be held after unlocking once */
+  g_assert (sink->clientslock_depth == 1);
+
+  client->in_io = TRUE;
+  CLIENTS_UNLOCK (sink);
+}
+
+void
+gst_multi_handle_sink_client_end_io (GstMultiHandleSink * sink,
+    GstMultiHandleClient * client)
+{
+  CLIENTS_LOCK (sink);
+  client->in_io = FALSE;
+}
+
+/* should be called with the clientslock held. Returns FALSE when the handle
+ * could not be added, handles that epoll can't watch (regular files) are
+ * accepted and considered to be always writable. */
+gboolean
+gst_multi_handle_sink_epoll_add_client (GstMultiHandleSink * sink,
+    GstMultiHandleClient * client, gint fd, gboolean do_read)
+{
+#ifdef HAVE_SYS_EPOLL_H
+  struct epoll_event ev = { 0, };
+
+  ev.events = EPOLLOUT | EPOLLET;
+  if (do_read)
+    ev.events |= EPOLLIN;
+  ev.data.ptr = client;
+
+  if (epoll_ctl (sink->senders[client->sender].epoll_fd, EPOLL_CTL_ADD, fd,
+          &ev) == 0)
+    return TRUE;
+
+  if (errno == EPERM) {
+    GST_DEBUG_OBJECT (sink, "%s can't be watched, always writable",
+        client->debug);
+    client->always_writable = TRUE;
+    client->can_write = TRUE;
+    return TRUE;
+  }
+
+  GST_WARNING_OBJECT (sink, "%s could not be added to the epoll set: %s",
+      client->debug, g_strerror (errno));
+#endif
+  return FALSE;
+}
+
+/* should be called with the clientslock held */
+void
+gst_multi_handle_sink_epoll_remove_client (GstMultiHandleSink * sink,
+    GstMultiHandleClient * client, gint fd)
+{
+#ifdef HAVE_SYS_EPOLL_H
+  struct epoll_event ev = { 0, };
+
+  /* the handle might already be closed, which removed it from the set */
+  if (!client->always_writable)
+    epoll_ctl (sink->senders[client->sender].epoll_fd, EPOLL_CTL_DEL, fd, &ev);
+#endif
+
+  if (client->ready_condition != 0) {
+    g_queue_unlink (&sink->senders[client->sender].ready_clients,
+        &client->ready_link);
+    client->ready_condition = 0;
+  }
+}
+
+/* should be called with the clientslock held. Queues @client for its sender
+ * thread with @condition added to its pending events. */
+void
+gst_multi_handle_sink_client_set_ready (GstMultiHandleSink * sink,
+    GstMultiHandleClient * client, GIOCondition condition)
+{
+  if (client->ready_condition == 0)
+    g_queue_push_tail_link (&sink->senders[client->sender].ready_clients,
+        &client->ready_link);
+  client->ready_condition |= condition;
+}
+
+/* should be called with the clientslock held when a write to @client was
+ * short or would block, we will get an EPOLLOUT when it can take more. */
+void
+gst_multi_handle_sink_client_blocked (GstMultiHandleSink * sink,
+    GstMultiHandleClient * client)
+{
+  if (!client->always_writable)
+    client->can_write = FALSE;
+}
+
+/* should be called with the clientslock held. Moves all pending epoll events
+ * of @sender to its ready queue without blocking. */
+void
+gst_multi_handle_sink_epoll_collect (GstMultiHandleSink * sink, guint sender)
+{
+#ifdef HAVE_SYS_EPOLL_H
+  struct epoll_event events[EPOLL_MAX_EVENTS];
+  gint i, n;
+
+  do {
+    n = epoll_wait (sink->senders[sender].epoll_fd, events, EPOLL_MAX_EVENTS,
+        0);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      GST_WARNING_OBJECT (sink, "epoll_wait failed: %s", g_strerror (errno));
+      return;
+    }
+
+    for (i = 0; i < n; i++) {
+      GstMultiHandleClient *client = events[i].data.ptr;
+      GIOCondition condition = 0;
+
+      if (events[i].events & EPOLLIN)
+        condition |= G_IO_IN;
+      if (events[i].events & EPOLLOUT) {
+        condition |= G_IO_OUT;
+        client->can_write = TRUE;
+      }
+      if (events[i].events & EPOLLERR)
+        condition |= G_IO_ERR;
+      if (events[i].events & EPOLLHUP)
+        condition |= G_IO_HUP;
+
+      gst_multi_handle_sink_client_set_ready (sink, client, condition);
+    }
+  } while (n < 0 || n == EPOLL_MAX_EVENTS);
+#endif
+}
+
+/* should be called with the clientslock held. Returns the first client of
+ * the ready queue of @sender and its pending events, or %NULL when the queue
+ * is empty */
+GstMultiHandleClient *
+gst_multi_handle_sink_pop_ready_client (GstMultiHandleSink * sink,
+    guint sender, GIOCondition * condition)
+{
+  GstMultiHandleClient *client;
+  GList *link;
+
+  link = g_queue_pop_head_link (&sink->senders[sender].ready_clients);
+  if (link == NULL)
+    return NULL;
+
+  client = link->data;
+  *condition = client->ready_condition;
+  client->ready_condition = 0;
+
+  return client;
+}
+
 /* create a socket for sending to remote machine */
 static gboolean
 gst_multi_handle_sink_start (GstBaseSink * bsink)
 {
   GstMultiHandleSinkClass *mhsclass;
   GstMultiHandleSink *mhsink;
+  guint i;
 
   if (GST_OBJECT_FLAG_IS_SET (bsink, GST_MULTI_HANDLE_SINK_OPEN))
     return TRUE;
@@ -2069,8 +2730,12 @@ gst_multi_handle_sink_start (GstBaseSink * bsink)
   mhsink = GST_MULTI_HANDLE_SINK (bsink);
   mhsclass = GST_MULTI_HANDLE_SINK_GET_CLASS (mhsink);
 
-  if (!mhsclass->start_pre (mhsink))
+  gst_multi_handle_sink_senders_open (mhsink);
+
+  if (!mhsclass->start_pre (mhsink)) {
+    gst_multi_handle_sink_senders_close (mhsink);
     return FALSE;
+  }
 
   mhsink->bytes_to_serve = 0;
   mhsink->bytes_served = 0;
@@ -2081,8 +2746,10 @@ gst_multi_handle_sink_start (GstBaseSink * bsink)
 
   mhsink->running = TRUE;
 
-  mhsink->thread = g_thread_new ("multihandlesink",
-      (GThreadFunc) mhsclass->thread, mhsink);
+  for (i = 0; i < mhsink->n_senders; i++) {
+    mhsink->senders[i].thread = g_thread_new ("multihandlesink",
+        (GThreadFunc) gst_multi_handle_sink_sender_func, &mhsink->senders[i]);
+  }
 
   GST_OBJECT_FLAG_SET (bsink, GST_MULTI_HANDLE_SINK_OPEN);
 
@@ -2106,11 +2773,13 @@ gst_multi_handle_sink_stop (GstBaseSink * bsink)
 
   mhclass->stop_pre (mhsink);
 
-  if (mhsink->thread) {
-    GST_DEBUG_OBJECT (mhsink, "joining thread");
-    g_thread_join (mhsink->thread);
-    GST_DEBUG_OBJECT (mhsink, "joined thread");
-    mhsink->thread = NULL;
+  for (i = 0; i < mhsink->n_senders; i++) {
+    if (mhsink->senders[i].thread) {
+      GST_DEBUG_OBJECT (mhsink, "joining thread %d", i);
+      g_thread_join (mhsink->senders[i].thread);
+      GST_DEBUG_OBJECT (mhsink, "joined thread %d", i);
+      mhsink->senders[i].thread = NULL;
+    }
   }
 
   /* free the clients */
@@ -2121,19 +2790,24 @@ gst_multi_handle_sink_stop (GstBaseSink * bsink)
 
   mhclass->stop_post (mhsink);
 
+  gst_multi_handle_sink_senders_close (mhsink);
+
   /* remove all queued buffers */
-  if (mhsink->bufqueue) {
-    GST_DEBUG_OBJECT (mhsink, "Emptying bufqueue with %d buffers",
-        mhsink->bufqueue->len);
-    for (i = mhsink->bufqueue->len - 1; i >= 0; --i) {
-      buf = g_array_index (mhsink->bufqueue, GstBuffer *, i);
-      GST_LOG_OBJECT (mhsink, "Removing buffer %p (%d) with refcount %d", buf,
-          i, GST_MINI_OBJECT_REFCOUNT (buf));
-      gst_buffer_unref (buf);
-      mhsink->bufqueue = g_array_remove_index (mhsink->bufqueue, i);
-    }
-    /* freeing the array is done in _finalize */
+  GST_DEBUG_OBJECT (mhsink, "Emptying bufqueue with %d buffers",
+      mhsink->bufqueue_len);
+  for (i = mhsink->bufqueue_len - 1; i >= 0; --i) {
+    buf = BUFQUEUE_BUFFER (mhsink, i);
+    GST_LOG_OBJECT (mhsink, "Removing buffer %p (%d) with refcount %d", buf,
+        i, GST_MINI_OBJECT_REFCOUNT (buf));
+    gst_buffer_unref (buf);
+    BUFQUEUE_BUFFER (mhsink, i) = NULL;
   }
+  mhsink->bufqueue_len = 0;
+  mhsink->n_front_clients = 0;
+  mhsink->oldest_seq = mhsink->bufqueue_seq;
+  /* the next stream can start with any timestamp */
+  mhsink->index_ts = GST_CLOCK_TIME_NONE;
+  /* freeing the ring buffer is done in _finalize */
   GST_OBJECT_FLAG_UNSET (mhsink, GST_MULTI_HANDLE_SINK_OPEN);
 
   return TRUE;
@@ -2145,19 +2819,14 @@ gst_multi_handle_sink_change_state (GstElement * element,
 {
   GstMultiHandleSink *sink;
   GstStateChangeReturn ret;
+  guint i;
 
   sink = GST_MULTI_HANDLE_SINK (element);
 
   /* we disallow changing the state from the streaming thread */
-  if (g_thread_self () == sink->thread) {
-    g_warning
-        ("\nTrying to change %s's state from its streaming thread would deadlock.\n"
-        "You cannot change the state of an element from its streaming\n"
-        "thread. Use g_idle_add() or post a GstMessage on the bus to\n"
-        "schedule the state change from the main thread.\n",
-        GST_ELEMENT_NAME (sink));
-
-    return GST_STATE_CHANGE_FAILURE;
+  for (i = 0; i < sink->n_senders; i++) {
+    if (g_thread_self () == sink->senders[i].thread)
+      goto sender_thread;
   }
 
   switch (transition) {
@@ -2189,6 +2858,17 @@ gst_multi_handle_sink_change_state (GstElement * element,
   return ret;
 
   /* ERRORS */
+sender_thread:
+  {
+    g_warning
+        ("\nTrying to change %s's state from its streaming thread would deadlock.\n"
+        "You cannot change the state of an element from its streaming\n"
+        "thread. Use g_idle_add() or post a GstMessage on the bus to\n"
+        "schedule the state change from the main thread.\n",
+        GST_ELEMENT_NAME (sink));
+
+    return GST_STATE_CHANGE_FAILURE;
+  }
 start_failed:
   {
     /* error message was posted */
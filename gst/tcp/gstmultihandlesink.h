@@ -136,7 +136,10 @@ typedef struct {
 
   gchar debug[30];              /* a debug string used in debug calls to
                                    identify the client */
-  gint bufpos;                  /* position of this client in the global queue */
+  guint64 bufseq;               /* sequence number of the next buffer to send,
+                                   see CLIENT_BUFPOS() */
+  gboolean counted;             /* bufseq is counted in the client_count of
+                                   the sink */
   gint flushcount;              /* the remaining number of buffers to flush out or -1 if the 
                                    client is not flushing. */
 
@@ -149,7 +152,23 @@ typedef struct {
 
   gboolean new_connection;
   gboolean currently_removing;
+  gboolean remove_pending;      /* removed during in_io, see
+                                   gst_multi_handle_sink_remove_client_link() */
 
+  GList waiting_link;           /* link in the waiting_clients of the sink */
+  gboolean waiting;             /* waits for the next buffer to be queued */
+
+  guint sender;                 /* index of the sender thread of the client */
+  GList sender_link;            /* link in the clients of the sender */
+  gboolean in_io;               /* the sender is writing without the lock */
+  GList activity_link;          /* link in the activity_clients of the sink */
+
+  /* edge-triggered readiness when the sink uses epoll, protected by the
+   * clients lock, see gst_multi_handle_sink_client_set_ready() */
+  GList ready_link;             /* link in the ready_clients of the sender */
+  GIOCondition ready_condition; /* pending events, 0 when not queued */
+  gboolean can_write;           /* no short write since the last EPOLLOUT */
+  gboolean always_writable;     /* handle can't be watched with epoll */
 
   /* method to sync client when connecting */
   GstSyncMethod sync_method;
@@ -173,14 +192,86 @@ typedef struct {
 
 #define CLIENTS_LOCK_INIT(mhsink)       (g_rec_mutex_init(&(mhsink)->clientslock))
 #define CLIENTS_LOCK_CLEAR(mhsink)      (g_rec_mutex_clear(&(mhsink)->clientslock))
-#define CLIENTS_LOCK(mhsink)            (g_rec_mutex_lock(&(mhsink)->clientslock))
-#define CLIENTS_UNLOCK(mhsink)          (g_rec_mutex_unlock(&(mhsink)->clientslock))
+#define CLIENTS_LOCK(mhsink)            G_STMT_START { \
+  g_rec_mutex_lock(&(mhsink)->clientslock); \
+  (mhsink)->clientslock_depth++; \
+} G_STMT_END
+#define CLIENTS_UNLOCK(mhsink)          G_STMT_START { \
+  (mhsink)->clientslock_depth--; \
+  g_rec_mutex_unlock(&(mhsink)->clientslock); \
+} G_STMT_END
+
+/* The global queue is a ring buffer in which every buffer is numbered by a
+ * sequence number that increases by one for each queued buffer. Positions in
+ * the queue count backwards from the most recent buffer at position 0.
+ * Clients store the sequence number of the next buffer they have to send, so
+ * that their position moves when a buffer is queued without touching them.
+ * A position of -1 means the client is waiting for the next buffer. */
+#define BUFQUEUE_BUFFER(mhsink,pos)     ((mhsink)->bufqueue[((mhsink)->bufqueue_seq - 1 - (pos)) & ((mhsink)->bufqueue_size - 1)])
+#define CLIENT_BUFPOS(mhsink,client)    ((gint) (gint64) ((mhsink)->bufqueue_seq - 1 - (client)->bufseq))
+#define CLIENT_SET_BUFPOS(mhsink,client,pos) gst_multi_handle_sink_client_set_seq ((mhsink), (client), (mhsink)->bufqueue_seq - 1 - (pos))
+
+/* For every queued buffer an index entry is kept in a ring buffer parallel to
+ * the queue. The values only grow with the sequence number so that sync
+ * points and byte and time limits can be located with a binary search. */
+typedef struct {
+  guint64 offset;     /* number of bytes queued before this buffer */
+  guint64 time;       /* running time of the stream up to this buffer */
+  guint64 last_ts;    /* 1 + seq of the last buffer with a timestamp, 0 = none */
+  guint64 last_sync;  /* 1 + seq of the last sync frame, 0 = none */
+} GstMultiHandleSinkIndex;
+
+#define BUFQUEUE_INDEX(mhsink,pos)      ((mhsink)->bufindex[((mhsink)->bufqueue_seq - 1 - (pos)) & ((mhsink)->bufqueue_size - 1)])
+
+void gst_multi_handle_sink_client_set_seq (GstMultiHandleSink * sink,
+    GstMultiHandleClient * client, guint64 seq);
+void gst_multi_handle_sink_client_wait (GstMultiHandleSink * sink,
+    GstMultiHandleClient * client);
+void gst_multi_handle_sink_client_active (GstMultiHandleSink * sink,
+    GstMultiHandleClient * client, GstClockTime now);
+void gst_multi_handle_sink_remove_idle_clients (GstMultiHandleSink * sink,
+    GstClockTime now);
 
 gint gst_multi_handle_sink_setup_dscp_client (GstMultiHandleSink * sink, GstMultiHandleClient * client);
 gint
 gst_multi_handle_sink_new_client_position (GstMultiHandleSink * sink,
     GstMultiHandleClient * client);
 
+/* a sender thread and the state of the clients it handles */
+typedef struct {
+  GstMultiHandleSink *sink;
+  guint index;
+  GThread *thread;
+
+  GQueue clients;       /* clients handled by this sender */
+  gint epoll_fd;        /* epoll set of the clients, -1 when not used */
+  GQueue ready_clients; /* clients with a pending ready_condition */
+} GstMultiHandleSinkSender;
+
+void gst_multi_handle_sink_client_assign_sender (GstMultiHandleSink * sink,
+    GstMultiHandleClient * client);
+void gst_multi_handle_sink_client_begin_io (GstMultiHandleSink * sink,
+    GstMultiHandleClient * client);
+void gst_multi_handle_sink_client_end_io (GstMultiHandleSink * sink,
+    GstMultiHandleClient * client);
+
+/* TRUE when the clients are managed in edge-triggered epoll sets */
+#define GST_MULTI_HANDLE_SINK_USES_EPOLL(mhsink) ((mhsink)->using_epoll)
+
+gboolean gst_multi_handle_sink_epoll_add_client (GstMultiHandleSink * sink,
+    GstMultiHandleClient * client, gint fd, gboolean do_read);
+void gst_multi_handle_sink_epoll_remove_client (GstMultiHandleSink * sink,
+    GstMultiHandleClient * client, gint fd);
+void gst_multi_handle_sink_epoll_collect (GstMultiHandleSink * sink,
+    guint sender);
+void gst_multi_handle_sink_client_set_ready (GstMultiHandleSink * sink,
+    GstMultiHandleClient * client, GIOCondition condition);
+void gst_multi_handle_sink_client_blocked (GstMultiHandleSink * sink,
+    GstMultiHandleClient * client);
+GstMultiHandleClient *
+gst_multi_handle_sink_pop_ready_client (GstMultiHandleSink * sink,
+    guint sender, GIOCondition * condition);
+
 /**
  * GstMultiHandleSink:
  *
@@ -194,6 +285,7 @@ struct _GstMultiHandleSink {
   guint64 bytes_served; /* how much bytes have we served */
 
   GRecMutex clientslock;  /* lock to protect the clients list */
+  guint clientslock_depth; /* times the owner of clientslock took it */
   GList *clients;       /* list of clients we are serving */
   guint clients_cookie; /* Cookie to detect changes to the clients list */
 
@@ -204,10 +296,30 @@ struct _GstMultiHandleSink {
 
   gint qos_dscp;
 
-  GArray *bufqueue;     /* global queue of buffers */
+  gboolean use_epoll;   /* use epoll sets for the clients when starting */
+  gboolean using_epoll; /* the senders watch their clients with epoll */
+
+  GstBuffer **bufqueue; /* global queue of buffers, see BUFQUEUE_BUFFER() */
+  guint bufqueue_size;  /* allocated size of bufqueue, a power of 2 */
+  guint bufqueue_len;   /* number of queued buffers */
+  guint64 bufqueue_seq; /* sequence number of the next buffer to queue */
+  GstMultiHandleSinkIndex *bufindex; /* index of bufqueue, see BUFQUEUE_INDEX() */
+  guint *client_count;  /* number of clients at each queued buffer, see
+                           gst_multi_handle_sink_client_set_seq() */
+  guint n_front_clients;/* number of clients waiting for the next buffer */
+  guint64 oldest_seq;   /* no client is at a lower sequence number */
+  GQueue waiting_clients; /* clients to wake up for the next buffer */
+  GQueue activity_clients; /* clients by last activity, the idlest first */
+  guint64 index_bytes;  /* number of bytes queued so far */
+  guint64 index_time;   /* running time of the queued buffers so far */
+  GstClockTime index_ts;/* highest timestamp of the running time */
+  guint64 index_last_ts;   /* last_ts of the next index entry */
+  guint64 index_last_sync; /* last_sync of the next index entry */
 
   gboolean running;     /* the thread state */
-  GThread *thread;      /* the sender thread */
+  guint n_sender_threads;   /* number of sender threads to start, 0 = auto */
+  GstMultiHandleSinkSender *senders; /* the sender threads while running */
+  guint n_senders;
 
   /* these values are used to check if a client is reading fast
    * enough and to control receovery */
@@ -244,7 +356,7 @@ struct _GstMultiHandleSinkClass {
   void          (*stop_pre)     (GstMultiHandleSink *sink);
   void          (*stop_post)    (GstMultiHandleSink *sink);
   gboolean      (*start_pre)    (GstMultiHandleSink *sink);
-  gpointer      (*thread)       (GstMultiHandleSink *sink);
+  gpointer      (*thread)       (GstMultiHandleSink *sink, guint sender);
   /* called by subclass when it has a new buffer to queue for a client */
   gboolean      (*client_queue_buffer)
                                 (GstMultiHandleSink *sink,
@@ -76,6 +76,14 @@
  * #GstMultiSocketSink::add-full signal to make sure that a burst connect can
  * actually be honored.
  *
+ * Amounts of time, in these properties, in the burst values and with a
+ * #GstMultiHandleSink:unit-format of %GST_FORMAT_TIME, are measured from the
+ * timestamps of the queued buffers. The time only advances with timestamps
+ * above the highest one so far, so that reordered timestamps are not counted,
+ * and it continues from the new timestamp after a jump back of more than a
+ * second. Since 1.20; before, the timestamp of a buffer was subtracted from the
+ * most recent one.
+ *
  * When streaming data, clients are allowed to read at a different rate than
  * the rate at which multisocketsink receives data. If the client is reading too
  * fast, no data will be send to the client until multisocketsink receives more
@@ -114,6 +122,16 @@
 #include <netinet/in.h>
 #endif
 
+#ifdef HAVE_LINUX_ERRQUEUE_H
+#include <errno.h>
+#include <sys/socket.h>
+#include <linux/errqueue.h>
+#if defined (SO_ZEROCOPY) && defined (MSG_ZEROCOPY) && \
+    defined (SO_EE_ORIGIN_ZEROCOPY)
+#define HAVE_MSG_ZEROCOPY 1
+#endif
+#endif
+
 #define NOT_IMPLEMENTED 0
 
 GST_DEBUG_CATEGORY_STATIC (multisocketsink_debug);
@@ -139,17 +157,56 @@ enum
 
 #define DEFAULT_SEND_DISPATCHED FALSE
 #define DEFAULT_SEND_MESSAGES   FALSE
+#define DEFAULT_BATCH_SIZE      1
+#define DEFAULT_ZEROCOPY        FALSE
+
+/* the most buffers and memory chunks that are sent with one call */
+#define BATCH_SIZE_MAX          64
+#define BATCH_VECTORS_MAX       256
+/* smaller sends are cheaper to copy than to wait for their completion */
+#define ZEROCOPY_MIN_SIZE       10240
+/* clients with more bytes of uncompleted zerocopy sends get copies, which
+ * bounds the memory that a slow client keeps alive */
+#define ZEROCOPY_MAX_PENDING    (4 * 1024 * 1024)
+
+#define IS_BATCHING(sink) ((sink)->batch_size > 1 || (sink)->zerocopy)
 
 enum
 {
   PROP_0,
   PROP_SEND_DISPATCHED,
   PROP_SEND_MESSAGES,
+  PROP_BATCH_SIZE,
+  PROP_ZEROCOPY,
   PROP_LAST
 };
 
+/* The memory of a buffer, mapped once and shared by all clients that send
+ * the buffer in the batched mode. */
+typedef struct
+{
+  GstBuffer *buffer;
+  /* the number of clients that are writing from the mapping or that wait
+   * for the completion of a zerocopy send of it */
+  gint users;
+  guint n_vectors;
+  GstMapInfo *maps;
+  GOutputVector *vectors;
+} GstMultiSocketSinkMapping;
+
+/* a zerocopy send of a client that the kernel did not complete yet */
+typedef struct
+{
+  guint32 id;
+  GstMultiSocketSinkMapping *mapping;
+  gsize size;                   /* bytes of the send accounted to this entry */
+} GstMultiSocketSinkZerocopy;
+
 static void gst_multi_socket_sink_finalize (GObject * object);
 
+static void gst_multi_socket_sink_mapping_free (GstMultiSocketSinkMapping *
+    mapping);
+
 static void gst_multi_socket_sink_add (GstMultiSocketSink * sink,
     GSocket * socket);
 static void gst_multi_socket_sink_add_full (GstMultiSocketSink * sink,
@@ -170,7 +227,8 @@ static void gst_multi_socket_sink_emit_client_removed (GstMultiHandleSink * mhs,
 static void gst_multi_socket_sink_stop_pre (GstMultiHandleSink * mhsink);
 static void gst_multi_socket_sink_stop_post (GstMultiHandleSink * mhsink);
 static gboolean gst_multi_socket_sink_start_pre (GstMultiHandleSink * mhsink);
-static gpointer gst_multi_socket_sink_thread (GstMultiHandleSink * mhsink);
+static gpointer gst_multi_socket_sink_thread (GstMultiHandleSink * mhsink,
+    guint sender);
 static GstMultiHandleClient
     * gst_multi_socket_sink_new_client (GstMultiHandleSink * mhsink,
     GstMultiSinkHandle handle, GstSyncMethod sync_method);
@@ -184,6 +242,7 @@ static gpointer gst_multi_socket_sink_handle_hash_key (GstMultiSinkHandle
     handle);
 static void gst_multi_socket_sink_hash_adding (GstMultiHandleSink * mhsink,
     GstMultiHandleClient * mhclient);
+static void gst_multi_socket_sink_hash_changed (GstMultiHandleSink * mhsink);
 static void gst_multi_socket_sink_hash_removing (GstMultiHandleSink * mhsink,
     GstMultiHandleClient * mhclient);
 static void gst_multi_socket_sink_stop_sending (GstMultiSocketSink * sink,
@@ -261,6 +320,44 @@ gst_multi_socket_sink_class_init (GstMultiSocketSinkClass * klass)
           "If GstNetworkMessage events should be pushed", DEFAULT_SEND_MESSAGES,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstMultiSocketSink:batch-size:
+   *
+   * The maximum number of queued buffers that are sent to a client with a
+   * single system call. When larger than 1, the memory of every buffer is
+   * mapped only once for all clients. Stream sockets get the buffers as one
+   * gathered write, datagram sockets get one message per buffer with
+   * sendmmsg() where available. Buffers with control messages are always
+   * sent on their own.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_BATCH_SIZE,
+      g_param_spec_uint ("batch-size", "Batch size",
+          "Maximum number of buffers sent to a client with one system call",
+          1, BATCH_SIZE_MAX, DEFAULT_BATCH_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstMultiSocketSink:zerocopy:
+   *
+   * Send large buffers with MSG_ZEROCOPY, so that the kernel does not copy
+   * them into the socket buffers. A buffer is kept alive until the kernel
+   * reported that it is done with it, a client with more than 4 MiB of such
+   * sends gets copies until the kernel caught up. When a client is removed,
+   * its buffers are released right away. Sockets added while this is enabled
+   * use zerocopy if the kernel supports it for them (Linux 4.14 for TCP), all
+   * others are sent as usual. Like with #GstMultiSocketSink:batch-size, the
+   * memory of every buffer is mapped only once.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_ZEROCOPY,
+      g_param_spec_boolean ("zerocopy", "Zerocopy",
+          "Send large buffers without copying them into the socket buffers "
+          "(Linux only)", DEFAULT_ZEROCOPY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstMultiSocketSink::add:
    * @gstmultisocketsink: the multisocketsink element to emit this signal on
@@ -433,6 +530,8 @@ gst_multi_socket_sink_class_init (GstMultiSocketSinkClass * klass)
       GST_DEBUG_FUNCPTR (gst_multi_socket_sink_hash_adding);
   gstmultihandlesink_class->hash_removing =
       GST_DEBUG_FUNCPTR (gst_multi_socket_sink_hash_removing);
+  gstmultihandlesink_class->hash_changed =
+      GST_DEBUG_FUNCPTR (gst_multi_socket_sink_hash_changed);
 
   GST_DEBUG_CATEGORY_INIT (multisocketsink_debug, "multisocketsink", 0,
       "Multi socket sink");
@@ -448,6 +547,11 @@ gst_multi_socket_sink_init (GstMultiSocketSink * this)
   this->cancellable = g_cancellable_new ();
   this->send_dispatched = DEFAULT_SEND_DISPATCHED;
   this->send_messages = DEFAULT_SEND_MESSAGES;
+  this->batch_size = DEFAULT_BATCH_SIZE;
+  this->zerocopy = DEFAULT_ZEROCOPY;
+
+  this->mappings = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+      (GDestroyNotify) gst_multi_socket_sink_mapping_free);
 }
 
 static void
@@ -460,6 +564,8 @@ gst_multi_socket_sink_finalize (GObject * object)
     this->cancellable = NULL;
   }
 
+  g_hash_table_destroy (this->mappings);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -551,12 +657,37 @@ gst_multi_socket_sink_new_client (GstMultiHandleSink * mhsink,
 
   gst_multi_handle_sink_client_init (mhclient, sync_method);
   mhsinkclass->handle_debug (handle, mhclient->debug);
+  gst_multi_handle_sink_client_assign_sender (mhsink, mhclient);
 
   /* set the socket to non blocking */
   g_socket_set_blocking (handle.socket, FALSE);
 
+  g_queue_init (&client->zerocopy_pending);
+#ifdef HAVE_MSG_ZEROCOPY
+  if (GST_MULTI_SOCKET_SINK (mhsink)->zerocopy) {
+    GError *err = NULL;
+
+    client->zerocopy = g_socket_set_option (handle.socket, SOL_SOCKET,
+        SO_ZEROCOPY, 1, &err);
+    if (!client->zerocopy) {
+      GST_DEBUG_OBJECT (mhsink, "%s can't use zerocopy: %s", mhclient->debug,
+          err->message);
+      g_clear_error (&err);
+    }
+  }
+#endif
+
   /* we always read from a client */
-  mhsinkclass->hash_adding (mhsink, mhclient);
+  if (GST_MULTI_HANDLE_SINK_USES_EPOLL (mhsink)) {
+    if (!gst_multi_handle_sink_epoll_add_client (mhsink, mhclient,
+            g_socket_get_fd (handle.socket), TRUE)) {
+      /* let the sender thread remove it */
+      mhclient->status = GST_CLIENT_STATUS_ERROR;
+      gst_multi_handle_sink_client_set_ready (mhsink, mhclient, G_IO_ERR);
+    }
+  } else {
+    mhsinkclass->hash_adding (mhsink, mhclient);
+  }
 
   gst_multi_handle_sink_setup_dscp_client (mhsink, mhclient);
 
@@ -794,6 +925,395 @@ gst_multi_socket_sink_write (GstMultiSocketSink * sink,
   return wrote;
 }
 
+static void
+gst_multi_socket_sink_mapping_free (GstMultiSocketSinkMapping * mapping)
+{
+  guint i;
+
+  for (i = 0; i < mapping->n_vectors; i++)
+    gst_memory_unmap (mapping->maps[i].memory, &mapping->maps[i]);
+  g_free (mapping->maps);
+  g_free (mapping->vectors);
+  gst_buffer_unref (mapping->buffer);
+  g_slice_free (GstMultiSocketSinkMapping, mapping);
+}
+
+static gboolean
+gst_multi_socket_sink_mapping_has_no_users (gpointer key, gpointer value,
+    gpointer user_data)
+{
+  GstMultiSocketSinkMapping *mapping = value;
+
+  return mapping->users == 0;
+}
+
+static gboolean
+gst_multi_socket_sink_mapping_is_unused (gpointer key, gpointer value,
+    gpointer user_data)
+{
+  GstMultiSocketSinkMapping *mapping = value;
+
+  /* when we hold the last reference, the buffer left the queue and all
+   * clients are done with it */
+  return mapping->users == 0 &&
+      GST_MINI_OBJECT_REFCOUNT_VALUE (mapping->buffer) == 1;
+}
+
+/* should be called with the clientslock held. Returns the mapping of
+ * @buffer with an additional user, or NULL when it can't be mapped. */
+static GstMultiSocketSinkMapping *
+gst_multi_socket_sink_mapping_get (GstMultiSocketSink * sink,
+    GstBuffer * buffer)
+{
+  GstMultiSocketSinkMapping *mapping;
+  guint i, n_mem;
+
+  mapping = g_hash_table_lookup (sink->mappings, buffer);
+  if (mapping == NULL) {
+    /* drop the mappings that are not needed anymore every time the table
+     * doubled in size, that keeps this cheap per buffer */
+    if (g_hash_table_size (sink->mappings) >= sink->mappings_prune_size) {
+      g_hash_table_foreach_remove (sink->mappings,
+          gst_multi_socket_sink_mapping_is_unused, NULL);
+      sink->mappings_prune_size =
+          MAX (64, 2 * g_hash_table_size (sink->mappings));
+    }
+
+    n_mem = gst_buffer_n_memory (buffer);
+    mapping = g_slice_new0 (GstMultiSocketSinkMapping);
+    mapping->buffer = gst_buffer_ref (buffer);
+    mapping->maps = g_new (GstMapInfo, n_mem);
+    mapping->vectors = g_new (GOutputVector, n_mem);
+
+    for (i = 0; i < n_mem; i++) {
+      GstMemory *mem = gst_buffer_peek_memory (buffer, i);
+
+      if (!gst_memory_map (mem, &mapping->maps[i], GST_MAP_READ)) {
+        GST_WARNING_OBJECT (sink, "could not map memory %p", mem);
+        gst_multi_socket_sink_mapping_free (mapping);
+        return NULL;
+      }
+      mapping->vectors[i].buffer = mapping->maps[i].data;
+      mapping->vectors[i].size = mapping->maps[i].size;
+      mapping->n_vectors++;
+    }
+    g_hash_table_insert (sink->mappings, buffer, mapping);
+  }
+  mapping->users++;
+
+  return mapping;
+}
+
+/* should be called with the clientslock held. Releases the pending
+ * zerocopy sends of @client up to and including @id, or all of them. */
+static void
+gst_multi_socket_sink_release_zerocopy (GstSocketClient * client, guint32 id,
+    gboolean all)
+{
+  GstMultiSocketSinkZerocopy *zc;
+
+  while ((zc = g_queue_peek_head (&client->zerocopy_pending))) {
+    /* the ids wrap around */
+    if (!all && (gint32) (zc->id - id) > 0)
+      break;
+
+    g_queue_pop_head (&client->zerocopy_pending);
+    client->zerocopy_bytes -= zc->size;
+    zc->mapping->users--;
+    g_slice_free (GstMultiSocketSinkZerocopy, zc);
+  }
+}
+
+#ifdef HAVE_MSG_ZEROCOPY
+/* should be called with the clientslock held. Reads the completions of the
+ * pending zerocopy sends of @client from the error queue of its socket.
+ * Returns FALSE when the socket has a real error. */
+static gboolean
+gst_multi_socket_sink_complete_zerocopy (GstMultiSocketSink * sink,
+    GstSocketClient * client)
+{
+  GstMultiHandleClient *mhclient = (GstMultiHandleClient *) client;
+  gint fd, error = 0;
+  socklen_t len = sizeof (error);
+
+  fd = g_socket_get_fd (mhclient->handle.socket);
+
+  while (TRUE) {
+    gchar control[128];
+    struct msghdr msg = { 0, };
+    struct cmsghdr *cm;
+
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof (control);
+
+    if (recvmsg (fd, &msg, MSG_ERRQUEUE) < 0) {
+      if (errno == EINTR)
+        continue;
+      /* the error queue is empty */
+      break;
+    }
+
+    for (cm = CMSG_FIRSTHDR (&msg); cm; cm = CMSG_NXTHDR (&msg, cm)) {
+      struct sock_extended_err *serr;
+
+      if (!(cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) &&
+          !(cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR))
+        continue;
+
+      serr = (struct sock_extended_err *) CMSG_DATA (cm);
+      if (serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+        continue;
+
+      /* the sends with the ids from ee_info to ee_data are done */
+      GST_LOG_OBJECT (sink, "%s zerocopy sends %u-%u completed%s",
+          mhclient->debug, serr->ee_info, serr->ee_data,
+          (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) ? ", copied" : "");
+      gst_multi_socket_sink_release_zerocopy (client, serr->ee_data, FALSE);
+    }
+  }
+
+  if (getsockopt (fd, SOL_SOCKET, SO_ERROR, &error, &len) < 0)
+    return FALSE;
+
+  return error == 0;
+}
+#endif
+
+/* should be called with the clientslock held. Accounts for @wrote bytes
+ * that were sent from the first @n_buffers buffers of the sending queue of
+ * @client, starting at its bufoffset. */
+static void
+gst_multi_socket_sink_client_advance (GstMultiSocketSink * sink,
+    GstSocketClient * client, gsize wrote, guint n_buffers, GstClockTime now)
+{
+  GstMultiHandleSink *mhsink = GST_MULTI_HANDLE_SINK (sink);
+  GstMultiHandleClient *mhclient = (GstMultiHandleClient *) client;
+  gsize left = wrote;
+
+  while (mhclient->sending && n_buffers-- > 0) {
+    GstBuffer *head = GST_BUFFER (mhclient->sending->data);
+    gsize size = gst_buffer_get_size (head) - mhclient->bufoffset;
+
+    if (left < size) {
+      /* partial write, try again now */
+      GST_LOG_OBJECT (sink,
+          "partial write on %p of %" G_GSIZE_FORMAT " bytes",
+          mhclient->handle.socket, left);
+      mhclient->bufoffset += left;
+      break;
+    }
+
+    if (sink->send_dispatched) {
+      gst_pad_push_event (GST_BASE_SINK_PAD (mhsink),
+          gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
+              gst_structure_new ("GstNetworkMessageDispatched",
+                  "object", G_TYPE_OBJECT, mhclient->handle.socket,
+                  "buffer", GST_TYPE_BUFFER, head, NULL)));
+    }
+    /* complete buffer was written, we can proceed to the next one */
+    mhclient->sending = g_slist_remove (mhclient->sending, head);
+    gst_buffer_unref (head);
+    /* make sure we start from byte 0 for the next buffer */
+    mhclient->bufoffset = 0;
+    left -= size;
+  }
+
+  /* update stats */
+  mhclient->bytes_sent += wrote;
+  gst_multi_handle_sink_client_active (mhsink, mhclient, now);
+  mhsink->bytes_served += wrote;
+}
+
+/* should be called with the clientslock held. Sends up to batch-size
+ * buffers of the sending queue of @client with one call, from the shared
+ * mappings of the buffers.
+ *
+ * Returns the number of bytes written or -1 on error. */
+static gssize
+gst_multi_socket_sink_write_batch (GstMultiSocketSink * sink,
+    GstSocketClient * client, guint * n_buffers, GError ** err)
+{
+  GstMultiHandleSink *mhsink = GST_MULTI_HANDLE_SINK (sink);
+  GstMultiHandleClient *mhclient = (GstMultiHandleClient *) client;
+  GstMultiSocketSinkMapping *mappings[BATCH_SIZE_MAX];
+  GOutputMessage messages[BATCH_SIZE_MAX];
+  GOutputVector vectors[BATCH_VECTORS_MAX];
+  GSocketControlMessage *cmsgs[CMSG_MAX];
+  guint n_mappings = 0, n_messages = 0, n_vectors = 0, i, j;
+  gsize offset, bytes = 0;
+  gboolean stream;
+  gint flags = 0, n_sent;
+  gssize wrote;
+  GSList *walk;
+
+  /* stream sockets get all buffers as one message, a partial write of it
+   * can't leave holes in the stream */
+  stream = g_socket_get_socket_type (mhclient->handle.socket) ==
+      G_SOCKET_TYPE_STREAM;
+
+  offset = mhclient->bufoffset;
+  for (walk = mhclient->sending; walk && n_mappings < sink->batch_size;
+      walk = walk->next) {
+    GstBuffer *buf = GST_BUFFER (walk->data);
+    GstMultiSocketSinkMapping *mapping;
+    GOutputMessage *msg;
+    gsize msg_count, skip;
+
+    /* buffers with control messages are sent on their own */
+    msg_count = gst_buffer_get_cmsg_list (buf, cmsgs, CMSG_MAX);
+    if (msg_count > 0 && n_mappings > 0)
+      break;
+
+    mapping = gst_multi_socket_sink_mapping_get (sink, buf);
+    if (mapping == NULL) {
+      if (n_mappings > 0)
+        break;
+      g_set_error (err, G_IO_ERROR, G_IO_ERROR_FAILED,
+          "Could not map buffer");
+      return -1;
+    }
+
+    /* a datagram must fit completely */
+    if (!stream && n_mappings > 0
+        && n_vectors + mapping->n_vectors > BATCH_VECTORS_MAX) {
+      mapping->users--;
+      break;
+    }
+
+    if (!stream || n_messages == 0) {
+      msg = &messages[n_messages++];
+      msg->address = NULL;
+      msg->vectors = &vectors[n_vectors];
+      msg->num_vectors = 0;
+      msg->bytes_sent = 0;
+      msg->control_messages = msg_count > 0 ? cmsgs : NULL;
+      msg->num_control_messages = msg_count;
+    } else {
+      msg = &messages[n_messages - 1];
+    }
+
+    skip = offset;
+    for (j = 0; j < mapping->n_vectors && n_vectors < BATCH_VECTORS_MAX; j++) {
+      if (skip >= mapping->vectors[j].size) {
+        skip -= mapping->vectors[j].size;
+        continue;
+      }
+      vectors[n_vectors].buffer =
+          (const guint8 *) mapping->vectors[j].buffer + skip;
+      vectors[n_vectors].size = mapping->vectors[j].size - skip;
+      bytes += vectors[n_vectors].size;
+      skip = 0;
+      n_vectors++;
+      msg->num_vectors++;
+    }
+    mappings[n_mappings++] = mapping;
+    offset = 0;
+
+    /* the rest of a buffer that did not fit goes out with the next call */
+    if (j < mapping->n_vectors || msg_count > 0)
+      break;
+  }
+
+#ifdef HAVE_MSG_ZEROCOPY
+  if (client->zerocopy && bytes >= ZEROCOPY_MIN_SIZE) {
+    if (client->zerocopy_bytes < ZEROCOPY_MAX_PENDING)
+      flags |= MSG_ZEROCOPY;
+    else
+      GST_LOG_OBJECT (sink, "%s has %" G_GSIZE_FORMAT " bytes of zerocopy "
+          "sends pending, copying", mhclient->debug, client->zerocopy_bytes);
+  }
+#endif
+
+  GST_LOG_OBJECT (sink, "%s sending %u buffers, %" G_GSIZE_FORMAT " bytes "
+      "in %u messages", mhclient->debug, n_mappings, bytes, n_messages);
+
+  gst_multi_handle_sink_client_begin_io (mhsink, mhclient);
+  n_sent = g_socket_send_messages (mhclient->handle.socket, messages,
+      n_messages, flags, sink->cancellable, err);
+  if (n_sent < 0 && flags != 0
+      && !g_error_matches (*err, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK)) {
+    /* the kernel refuses zerocopy when too many completions are pending,
+     * sending a copy works in that case */
+    g_clear_error (err);
+    flags = 0;
+    n_sent = g_socket_send_messages (mhclient->handle.socket, messages,
+        n_messages, flags, sink->cancellable, err);
+  }
+  gst_multi_handle_sink_client_end_io (mhsink, mhclient);
+
+  wrote = n_sent < 0 ? -1 : 0;
+  for (i = 0; n_sent > 0 && i < (guint) n_sent; i++) {
+    wrote += messages[i].bytes_sent;
+
+#ifdef HAVE_MSG_ZEROCOPY
+    /* every send that wrote something gets the next id, the memory has to
+     * stay around until the kernel completed it */
+    if ((flags & MSG_ZEROCOPY) && messages[i].bytes_sent > 0) {
+      guint32 id = client->zerocopy_next++;
+
+      for (j = 0; j < n_mappings; j++) {
+        GstMultiSocketSinkZerocopy *zc;
+
+        if (!stream && j != i)
+          continue;
+
+        zc = g_slice_new (GstMultiSocketSinkZerocopy);
+        zc->id = id;
+        zc->mapping = mappings[j];
+        zc->mapping->users++;
+        /* the whole send is accounted to its first mapping */
+        zc->size = (!stream || j == 0) ? messages[i].bytes_sent : 0;
+        client->zerocopy_bytes += zc->size;
+        g_queue_push_tail (&client->zerocopy_pending, zc);
+      }
+    }
+#endif
+  }
+
+  for (i = 0; i < n_mappings; i++)
+    mappings[i]->users--;
+
+  *n_buffers = n_mappings;
+
+  return wrote;
+}
+
+/* should be called with the clientslock held and a valid position of
+ * @client in the buffer queue. Queues the next buffer for @client. */
+static void
+gst_multi_socket_sink_client_next_buffer (GstMultiSocketSink * sink,
+    GstSocketClient * client)
+{
+  GstMultiHandleSink *mhsink = GST_MULTI_HANDLE_SINK (sink);
+  GstMultiHandleClient *mhclient = (GstMultiHandleClient *) client;
+  GstMultiHandleSinkClass *mhsinkclass =
+      GST_MULTI_HANDLE_SINK_GET_CLASS (mhsink);
+  GstBuffer *buf;
+  GstClockTime timestamp;
+
+  /* grab buffer */
+  buf = BUFQUEUE_BUFFER (mhsink, CLIENT_BUFPOS (mhsink, mhclient));
+  gst_multi_handle_sink_client_set_seq (mhsink, mhclient,
+      mhclient->bufseq + 1);
+
+  /* update stats */
+  timestamp = GST_BUFFER_TIMESTAMP (buf);
+  if (mhclient->first_buffer_ts == GST_CLOCK_TIME_NONE)
+    mhclient->first_buffer_ts = timestamp;
+  if (timestamp != -1)
+    mhclient->last_buffer_ts = timestamp;
+
+  /* decrease flushcount */
+  if (mhclient->flushcount != -1)
+    mhclient->flushcount--;
+
+  GST_LOG_OBJECT (sink, "%s client %p at position %d",
+      mhclient->debug, client, CLIENT_BUFPOS (mhsink, mhclient));
+
+  /* queueing a buffer will ref it */
+  mhsinkclass->client_queue_buffer (mhsink, mhclient, buf);
+}
+
 /* Handle a write on a client,
  * which indicates a read request from a client.
  *
@@ -826,8 +1346,6 @@ gst_multi_socket_sink_handle_client_write (GstMultiSocketSink * sink,
   GError *err = NULL;
   GstMultiHandleSink *mhsink = GST_MULTI_HANDLE_SINK (sink);
   GstMultiHandleClient *mhclient = (GstMultiHandleClient *) client;
-  GstMultiHandleSinkClass *mhsinkclass =
-      GST_MULTI_HANDLE_SINK_GET_CLASS (mhsink);
 
 
   now = g_get_real_time () * GST_USECOND;
@@ -838,7 +1356,7 @@ gst_multi_socket_sink_handle_client_write (GstMultiSocketSink * sink,
   do {
     if (!mhclient->sending) {
       /* client is not working on a buffer */
-      if (mhclient->bufpos == -1) {
+      if (CLIENT_BUFPOS (mhsink, mhclient) == -1) {
         /* client is too fast, remove from write queue until new buffer is
          * available */
         gst_multi_socket_sink_stop_sending (sink, client);
@@ -850,8 +1368,6 @@ gst_multi_socket_sink_handle_client_write (GstMultiSocketSink * sink,
         return TRUE;
       } else {
         /* client can pick a buffer from the global queue */
-        GstBuffer *buf;
-        GstClockTime timestamp;
 
         /* for new connections, we need to find a good spot in the
          * bufqueue to start streaming from */
@@ -862,7 +1378,7 @@ gst_multi_socket_sink_handle_client_write (GstMultiSocketSink * sink,
           if (position >= 0) {
             /* we got a valid spot in the queue */
             mhclient->new_connection = FALSE;
-            mhclient->bufpos = position;
+            CLIENT_SET_BUFPOS (mhsink, mhclient, position);
           } else {
             /* cannot send data to this client yet */
             gst_multi_socket_sink_stop_sending (sink, client);
@@ -874,42 +1390,48 @@ gst_multi_socket_sink_handle_client_write (GstMultiSocketSink * sink,
         if (mhclient->flushcount == 0)
           goto flushed;
 
-        /* grab buffer */
-        buf = g_array_index (mhsink->bufqueue, GstBuffer *, mhclient->bufpos);
-        mhclient->bufpos--;
-
-        /* update stats */
-        timestamp = GST_BUFFER_TIMESTAMP (buf);
-        if (mhclient->first_buffer_ts == GST_CLOCK_TIME_NONE)
-          mhclient->first_buffer_ts = timestamp;
-        if (timestamp != -1)
-          mhclient->last_buffer_ts = timestamp;
-
-        /* decrease flushcount */
-        if (mhclient->flushcount != -1)
-          mhclient->flushcount--;
-
-        GST_LOG_OBJECT (sink, "%s client %p at position %d",
-            mhclient->debug, client, mhclient->bufpos);
-
-        /* queueing a buffer will ref it */
-        mhsinkclass->client_queue_buffer (mhsink, mhclient, buf);
+        gst_multi_socket_sink_client_next_buffer (sink, client);
 
         /* need to start from the first byte for this new buffer */
         mhclient->bufoffset = 0;
       }
     }
 
+    /* pick more buffers so that they can go out with one call */
+    if (mhclient->sending && IS_BATCHING (sink)) {
+      guint n_sending = g_slist_length (mhclient->sending);
+
+      while (n_sending < sink->batch_size
+          && !mhclient->new_connection && mhclient->flushcount != 0
+          && CLIENT_BUFPOS (mhsink, mhclient) >= 0) {
+        gst_multi_socket_sink_client_next_buffer (sink, client);
+        n_sending++;
+      }
+    }
+
     /* see if we need to send something */
     if (mhclient->sending) {
       gssize wrote;
-      GstBuffer *head;
+      guint n_buffers = 1;
 
-      /* pick first buffer from list */
-      head = GST_BUFFER (mhclient->sending->data);
+      if (IS_BATCHING (sink)) {
+        wrote = gst_multi_socket_sink_write_batch (sink, client, &n_buffers,
+            &err);
+      } else {
+        /* pick first buffer from list */
+        GstBuffer *head = GST_BUFFER (mhclient->sending->data);
 
-      wrote = gst_multi_socket_sink_write (sink, mhclient->handle.socket, head,
-          mhclient->bufoffset, sink->cancellable, &err);
+        gst_multi_handle_sink_client_begin_io (mhsink, mhclient);
+        wrote = gst_multi_socket_sink_write (sink, mhclient->handle.socket,
+            head, mhclient->bufoffset, sink->cancellable, &err);
+        gst_multi_handle_sink_client_end_io (mhsink, mhclient);
+      }
+
+      /* the client was removed meanwhile, our caller finishes that */
+      if (mhclient->currently_removing) {
+        g_clear_error (&err);
+        return FALSE;
+      }
 
       if (wrote < 0) {
         /* hmm error.. */
@@ -919,36 +1441,15 @@ gst_multi_socket_sink_handle_client_write (GstMultiSocketSink * sink,
           /* write would block, try again later */
           GST_LOG_OBJECT (sink, "write would block %p",
               mhclient->handle.socket);
+          gst_multi_handle_sink_client_blocked (mhsink, mhclient);
           more = FALSE;
           g_clear_error (&err);
         } else {
           goto write_error;
         }
       } else {
-        if (wrote < (gst_buffer_get_size (head) - mhclient->bufoffset)) {
-          /* partial write, try again now */
-          GST_LOG_OBJECT (sink,
-              "partial write on %p of %" G_GSSIZE_FORMAT " bytes",
-              mhclient->handle.socket, wrote);
-          mhclient->bufoffset += wrote;
-        } else {
-          if (sink->send_dispatched) {
-            gst_pad_push_event (GST_BASE_SINK_PAD (mhsink),
-                gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
-                    gst_structure_new ("GstNetworkMessageDispatched",
-                        "object", G_TYPE_OBJECT, mhclient->handle.socket,
-                        "buffer", GST_TYPE_BUFFER, head, NULL)));
-          }
-          /* complete buffer was written, we can proceed to the next one */
-          mhclient->sending = g_slist_remove (mhclient->sending, head);
-          gst_buffer_unref (head);
-          /* make sure we start from byte 0 for the next buffer */
-          mhclient->bufoffset = 0;
-        }
-        /* update stats */
-        mhclient->bytes_sent += wrote;
-        mhclient->last_activity_time = now;
-        mhsink->bytes_served += wrote;
+        gst_multi_socket_sink_client_advance (sink, client, wrote, n_buffers,
+            now);
       }
     }
   } while (more);
@@ -981,6 +1482,19 @@ write_error:
   }
 }
 
+static void
+gst_multi_socket_sink_wakeup (GstMultiSocketSink * sink)
+{
+  GstMultiHandleSink *mhsink = GST_MULTI_HANDLE_SINK (sink);
+  guint i;
+
+  if (sink->main_contexts == NULL)
+    return;
+
+  for (i = 0; i < mhsink->n_senders; i++)
+    g_main_context_wakeup (sink->main_contexts[i]);
+}
+
 static void
 ensure_condition (GstMultiSocketSink * sink, GstSocketClient * client,
     GIOCondition condition)
@@ -994,13 +1508,13 @@ ensure_condition (GstMultiSocketSink * sink, GstSocketClient * client,
     g_source_destroy (client->source);
     g_source_unref (client->source);
   }
-  if (condition && sink->main_context) {
+  if (condition && sink->main_contexts) {
     client->source = g_socket_create_source (mhclient->handle.socket,
         condition, sink->cancellable);
     g_source_set_callback (client->source,
         (GSourceFunc) gst_multi_socket_sink_socket_condition,
         gst_object_ref (sink), (GDestroyNotify) gst_object_unref);
-    g_source_attach (client->source, sink->main_context);
+    g_source_attach (client->source, sink->main_contexts[mhclient->sender]);
   } else {
     client->source = NULL;
     condition = 0;
@@ -1015,6 +1529,13 @@ gst_multi_socket_sink_hash_adding (GstMultiHandleSink * mhsink,
   GstMultiSocketSink *sink = GST_MULTI_SOCKET_SINK (mhsink);
   GstSocketClient *client = (GstSocketClient *) (mhclient);
 
+  if (GST_MULTI_HANDLE_SINK_USES_EPOLL (mhsink)) {
+    /* we only get an edge when a blocked client becomes writable again */
+    if (mhclient->can_write)
+      gst_multi_handle_sink_client_set_ready (mhsink, mhclient, G_IO_OUT);
+    return;
+  }
+
   ensure_condition (sink, client,
       G_IO_IN | G_IO_OUT | G_IO_PRI | G_IO_ERR | G_IO_HUP);
 }
@@ -1026,39 +1547,69 @@ gst_multi_socket_sink_hash_removing (GstMultiHandleSink * mhsink,
   GstMultiSocketSink *sink = GST_MULTI_SOCKET_SINK (mhsink);
   GstSocketClient *client = (GstSocketClient *) (mhclient);
 
+  /* release the zerocopy sends that completed, and drop the others. The
+   * kernel keeps its own reference to the pages of the sends that are still
+   * in flight, so the memory is safe to unmap, but the data that the removed
+   * client did not get yet can change when the memory is reused. */
+  if (!g_queue_is_empty (&client->zerocopy_pending)) {
+#ifdef HAVE_MSG_ZEROCOPY
+    gst_multi_socket_sink_complete_zerocopy (sink, client);
+#endif
+    if (!g_queue_is_empty (&client->zerocopy_pending))
+      GST_DEBUG_OBJECT (sink, "%s dropping %u pending zerocopy sends",
+          mhclient->debug, client->zerocopy_pending.length);
+    gst_multi_socket_sink_release_zerocopy (client, 0, TRUE);
+  }
+
+  if (GST_MULTI_HANDLE_SINK_USES_EPOLL (mhsink)) {
+    gst_multi_handle_sink_epoll_remove_client (mhsink, mhclient,
+        g_socket_get_fd (mhclient->handle.socket));
+    return;
+  }
+
   ensure_condition (sink, client, 0);
 }
 
+static void
+gst_multi_socket_sink_hash_changed (GstMultiHandleSink * mhsink)
+{
+  GstMultiSocketSink *sink = GST_MULTI_SOCKET_SINK (mhsink);
+
+  /* the sources of the clients wake up the main context themselves, the
+   * ready queue of the epoll set is only checked when we do it */
+  if (GST_MULTI_HANDLE_SINK_USES_EPOLL (mhsink))
+    gst_multi_socket_sink_wakeup (sink);
+}
+
 static void
 gst_multi_socket_sink_stop_sending (GstMultiSocketSink * sink,
     GstSocketClient * client)
 {
+  GstMultiHandleSink *mhsink = GST_MULTI_HANDLE_SINK (sink);
+
+  /* we hear from the client again when the next buffer is queued */
+  gst_multi_handle_sink_client_wait (mhsink, (GstMultiHandleClient *) client);
+
+  /* with epoll, we only hear from the client again on the next edge */
+  if (GST_MULTI_HANDLE_SINK_USES_EPOLL (mhsink))
+    return;
+
   ensure_condition (sink, client, G_IO_IN | G_IO_PRI | G_IO_ERR | G_IO_HUP);
 }
 
 /* Handle the clients. This is called when a socket becomes ready
  * to read or writable. Badly behaving clients are put on a
  * garbage list and removed.
+ *
+ * should be called with the clientslock held.
  */
 static gboolean
-gst_multi_socket_sink_socket_condition (GstMultiSinkHandle handle,
-    GIOCondition condition, GstMultiSocketSink * sink)
+gst_multi_socket_sink_handle_condition (GstMultiSocketSink * sink,
+    GList * clink, GIOCondition condition)
 {
-  GList *clink;
   GstSocketClient *client;
-  gboolean ret = TRUE;
   GstMultiHandleClient *mhclient;
   GstMultiHandleSink *mhsink = GST_MULTI_HANDLE_SINK (sink);
-  GstMultiHandleSinkClass *mhsinkclass =
-      GST_MULTI_HANDLE_SINK_GET_CLASS (mhsink);
-
-  CLIENTS_LOCK (mhsink);
-  clink = g_hash_table_lookup (mhsink->handle_hash,
-      mhsinkclass->handle_hash_key (handle));
-  if (clink == NULL) {
-    ret = FALSE;
-    goto done;
-  }
 
   client = clink->data;
   mhclient = (GstMultiHandleClient *) client;
@@ -1066,67 +1617,183 @@ gst_multi_socket_sink_socket_condition (GstMultiSinkHandle handle,
   if (mhclient->status != GST_CLIENT_STATUS_FLUSHING
       && mhclient->status != GST_CLIENT_STATUS_OK) {
     gst_multi_handle_sink_remove_client_link (mhsink, clink);
-    ret = FALSE;
-    goto done;
+    return FALSE;
   }
 
+#ifdef HAVE_MSG_ZEROCOPY
+  /* the completions of zerocopy sends are reported on the error queue */
+  if ((condition & G_IO_ERR) && client->zerocopy
+      && gst_multi_socket_sink_complete_zerocopy (sink, client))
+    condition &= ~G_IO_ERR;
+#endif
+
   if ((condition & G_IO_ERR)) {
     GST_WARNING_OBJECT (sink, "%s has error", mhclient->debug);
     mhclient->status = GST_CLIENT_STATUS_ERROR;
     gst_multi_handle_sink_remove_client_link (mhsink, clink);
-    ret = FALSE;
-    goto done;
+    return FALSE;
   } else if ((condition & G_IO_HUP)) {
     mhclient->status = GST_CLIENT_STATUS_CLOSED;
     gst_multi_handle_sink_remove_client_link (mhsink, clink);
-    ret = FALSE;
-    goto done;
+    return FALSE;
   }
   if ((condition & G_IO_IN) || (condition & G_IO_PRI)) {
     /* handle client read */
     if (!gst_multi_socket_sink_handle_client_read (sink, client)) {
       gst_multi_handle_sink_remove_client_link (mhsink, clink);
-      ret = FALSE;
-      goto done;
+      return FALSE;
     }
   }
   if ((condition & G_IO_OUT)) {
     /* handle client write */
     if (!gst_multi_socket_sink_handle_client_write (sink, client)) {
       gst_multi_handle_sink_remove_client_link (mhsink, clink);
-      ret = FALSE;
-      goto done;
+      return FALSE;
     }
   }
 
-done:
+  return TRUE;
+}
+
+static gboolean
+gst_multi_socket_sink_socket_condition (GstMultiSinkHandle handle,
+    GIOCondition condition, GstMultiSocketSink * sink)
+{
+  GList *clink;
+  gboolean ret = FALSE;
+  GstMultiHandleSink *mhsink = GST_MULTI_HANDLE_SINK (sink);
+  GstMultiHandleSinkClass *mhsinkclass =
+      GST_MULTI_HANDLE_SINK_GET_CLASS (mhsink);
+
+  CLIENTS_LOCK (mhsink);
+  clink = g_hash_table_lookup (mhsink->handle_hash,
+      mhsinkclass->handle_hash_key (handle));
+  if (clink != NULL)
+    ret = gst_multi_socket_sink_handle_condition (sink, clink, condition);
+  CLIENTS_UNLOCK (mhsink);
+
+  return ret;
+}
+
+#ifdef HAVE_SYS_EPOLL_H
+/* With epoll, a single source watches the epoll set of the clients and
+ * dispatches the clients on the ready queue of the sink. */
+typedef struct
+{
+  GSource source;
+
+  GstMultiSocketSink *sink;
+  guint sender;
+  gpointer tag;
+} GstMultiSocketSinkEpollSource;
+
+static gboolean
+gst_multi_socket_sink_has_ready_clients (GstMultiHandleSink * mhsink,
+    guint sender)
+{
+  gboolean ret;
+
+  CLIENTS_LOCK (mhsink);
+  ret = !g_queue_is_empty (&mhsink->senders[sender].ready_clients);
   CLIENTS_UNLOCK (mhsink);
 
   return ret;
 }
 
 static gboolean
-gst_multi_socket_sink_timeout (GstMultiSocketSink * sink)
+gst_multi_socket_sink_epoll_prepare (GSource * source, gint * timeout)
+{
+  GstMultiSocketSinkEpollSource *esource =
+      (GstMultiSocketSinkEpollSource *) source;
+
+  *timeout = -1;
+
+  return
+      gst_multi_socket_sink_has_ready_clients (GST_MULTI_HANDLE_SINK
+      (esource->sink), esource->sender);
+}
+
+static gboolean
+gst_multi_socket_sink_epoll_check (GSource * source)
+{
+  GstMultiSocketSinkEpollSource *esource =
+      (GstMultiSocketSinkEpollSource *) source;
+
+  if (g_source_query_unix_fd (source, esource->tag) & G_IO_IN)
+    return TRUE;
+
+  return
+      gst_multi_socket_sink_has_ready_clients (GST_MULTI_HANDLE_SINK
+      (esource->sink), esource->sender);
+}
+
+static gboolean
+gst_multi_socket_sink_epoll_dispatch (GSource * source, GSourceFunc callback,
+    gpointer user_data)
+{
+  GstMultiSocketSinkEpollSource *esource =
+      (GstMultiSocketSinkEpollSource *) source;
+  GstMultiHandleSink *mhsink = GST_MULTI_HANDLE_SINK (esource->sink);
+  GstMultiHandleSinkClass *mhsinkclass =
+      GST_MULTI_HANDLE_SINK_GET_CLASS (mhsink);
+  GstMultiHandleClient *mhclient;
+  GIOCondition condition;
+
+  CLIENTS_LOCK (mhsink);
+  gst_multi_handle_sink_epoll_collect (mhsink, esource->sender);
+
+  while ((mhclient = gst_multi_handle_sink_pop_ready_client (mhsink,
+              esource->sender, &condition))) {
+    GList *clink;
+
+    clink = g_hash_table_lookup (mhsink->handle_hash,
+        mhsinkclass->handle_hash_key (mhclient->handle));
+    gst_multi_socket_sink_handle_condition (esource->sink, clink, condition);
+  }
+  CLIENTS_UNLOCK (mhsink);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static GSourceFuncs gst_multi_socket_sink_epoll_funcs = {
+  gst_multi_socket_sink_epoll_prepare,
+  gst_multi_socket_sink_epoll_check,
+  gst_multi_socket_sink_epoll_dispatch,
+  NULL
+};
+
+static GSource *
+gst_multi_socket_sink_epoll_source_new (GstMultiSocketSink * sink,
+    guint sender)
+{
+  GstMultiSocketSinkEpollSource *esource;
+  GSource *source;
+
+  source = g_source_new (&gst_multi_socket_sink_epoll_funcs,
+      sizeof (GstMultiSocketSinkEpollSource));
+  g_source_set_name (source, "GstMultiSocketSinkEpollSource");
+
+  esource = (GstMultiSocketSinkEpollSource *) source;
+  /* the source is destroyed in stop_post, before the sink can go away */
+  esource->sink = sink;
+  esource->sender = sender;
+  esource->tag = g_source_add_unix_fd (source,
+      GST_MULTI_HANDLE_SINK (sink)->senders[sender].epoll_fd, G_IO_IN);
+
+  return source;
+}
+#endif
+
+static gboolean
+gst_multi_socket_sink_timeout (GstMultiHandleSinkSender * sender)
 {
+  GstMultiHandleSink *mhsink = sender->sink;
   GstClockTime now;
-  GList *clients;
-  GstMultiHandleSink *mhsink = GST_MULTI_HANDLE_SINK (sink);
 
   now = g_get_real_time () * GST_USECOND;
 
   CLIENTS_LOCK (mhsink);
-  for (clients = mhsink->clients; clients; clients = clients->next) {
-    GstSocketClient *client;
-    GstMultiHandleClient *mhclient;
-
-    client = clients->data;
-    mhclient = (GstMultiHandleClient *) client;
-    if (mhsink->timeout > 0
-        && now - mhclient->last_activity_time > mhsink->timeout) {
-      mhclient->status = GST_CLIENT_STATUS_SLOW;
-      gst_multi_handle_sink_remove_client_link (mhsink, clients);
-    }
-  }
+  gst_multi_handle_sink_remove_idle_clients (mhsink, now);
   CLIENTS_UNLOCK (mhsink);
 
   return FALSE;
@@ -1135,26 +1802,28 @@ gst_multi_socket_sink_timeout (GstMultiSocketSink * sink)
 /* we handle the client communication in another thread so that we do not block
  * the gstreamer thread while we select() on the client fds */
 static gpointer
-gst_multi_socket_sink_thread (GstMultiHandleSink * mhsink)
+gst_multi_socket_sink_thread (GstMultiHandleSink * mhsink, guint sender)
 {
   GstMultiSocketSink *sink = GST_MULTI_SOCKET_SINK (mhsink);
+  GMainContext *context = sink->main_contexts[sender];
   GSource *timeout = NULL;
 
   while (mhsink->running) {
     if (mhsink->timeout > 0) {
       timeout = g_timeout_source_new (mhsink->timeout / GST_MSECOND);
 
+      /* the senders outlive this thread */
       g_source_set_callback (timeout,
-          (GSourceFunc) gst_multi_socket_sink_timeout, gst_object_ref (sink),
-          (GDestroyNotify) gst_object_unref);
-      g_source_attach (timeout, sink->main_context);
+          (GSourceFunc) gst_multi_socket_sink_timeout,
+          &mhsink->senders[sender], NULL);
+      g_source_attach (timeout, context);
     }
 
     /* Returns after handling all pending events or when
      * _wakeup() was called. In any case we have to add
      * a new timeout because something happened.
      */
-    g_main_context_iteration (sink->main_context, TRUE);
+    g_main_context_iteration (context, TRUE);
 
     if (timeout) {
       g_source_destroy (timeout);
@@ -1178,6 +1847,12 @@ gst_multi_socket_sink_set_property (GObject * object, guint prop_id,
     case PROP_SEND_MESSAGES:
       sink->send_messages = g_value_get_boolean (value);
       break;
+    case PROP_BATCH_SIZE:
+      sink->batch_size = g_value_get_uint (value);
+      break;
+    case PROP_ZEROCOPY:
+      sink->zerocopy = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1197,6 +1872,12 @@ gst_multi_socket_sink_get_property (GObject * object, guint prop_id,
     case PROP_SEND_MESSAGES:
       g_value_set_boolean (value, sink->send_messages);
       break;
+    case PROP_BATCH_SIZE:
+      g_value_set_uint (value, sink->batch_size);
+      break;
+    case PROP_ZEROCOPY:
+      g_value_set_boolean (value, sink->zerocopy);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1210,10 +1891,27 @@ gst_multi_socket_sink_start_pre (GstMultiHandleSink * mhsink)
   GstMultiHandleSinkClass *mhsinkclass =
       GST_MULTI_HANDLE_SINK_GET_CLASS (mhsink);
   GList *clients;
+  guint i;
 
   GST_INFO_OBJECT (mssink, "starting");
 
-  mssink->main_context = g_main_context_new ();
+  /* one context per sender thread, the first one is also used by subclasses
+   * for their own sources */
+  mssink->main_contexts = g_new0 (GMainContext *, mhsink->n_senders);
+  for (i = 0; i < mhsink->n_senders; i++)
+    mssink->main_contexts[i] = g_main_context_new ();
+  mssink->main_context = mssink->main_contexts[0];
+
+#ifdef HAVE_SYS_EPOLL_H
+  if (GST_MULTI_HANDLE_SINK_USES_EPOLL (mhsink)) {
+    mssink->epoll_sources = g_new0 (GSource *, mhsink->n_senders);
+    for (i = 0; i < mhsink->n_senders; i++) {
+      mssink->epoll_sources[i] =
+          gst_multi_socket_sink_epoll_source_new (mssink, i);
+      g_source_attach (mssink->epoll_sources[i], mssink->main_contexts[i]);
+    }
+  }
+#endif
 
   CLIENTS_LOCK (mhsink);
   for (clients = mhsink->clients; clients; clients = clients->next) {
@@ -1240,22 +1938,39 @@ gst_multi_socket_sink_stop_pre (GstMultiHandleSink * mhsink)
 {
   GstMultiSocketSink *mssink = GST_MULTI_SOCKET_SINK (mhsink);
 
-  if (mssink->main_context)
-    g_main_context_wakeup (mssink->main_context);
+  gst_multi_socket_sink_wakeup (mssink);
 }
 
 static void
 gst_multi_socket_sink_stop_post (GstMultiHandleSink * mhsink)
 {
   GstMultiSocketSink *mssink = GST_MULTI_SOCKET_SINK (mhsink);
+  guint i;
 
-  if (mssink->main_context) {
-    g_main_context_unref (mssink->main_context);
+  if (mssink->epoll_sources) {
+    for (i = 0; i < mhsink->n_senders; i++) {
+      g_source_destroy (mssink->epoll_sources[i]);
+      g_source_unref (mssink->epoll_sources[i]);
+    }
+    g_free (mssink->epoll_sources);
+    mssink->epoll_sources = NULL;
+  }
+
+  if (mssink->main_contexts) {
+    for (i = 0; i < mhsink->n_senders; i++)
+      g_main_context_unref (mssink->main_contexts[i]);
+    g_free (mssink->main_contexts);
+    mssink->main_contexts = NULL;
     mssink->main_context = NULL;
   }
 
   g_hash_table_foreach_remove (mhsink->handle_hash, multisocketsink_hash_remove,
       mssink);
+
+  /* all clients are gone and released their zerocopy sends */
+  g_hash_table_foreach_remove (mssink->mappings,
+      gst_multi_socket_sink_mapping_has_no_users, NULL);
+  mssink->mappings_prune_size = 0;
 }
 
 static gboolean
@@ -1267,8 +1982,7 @@ gst_multi_socket_sink_unlock (GstBaseSink * bsink)
 
   GST_DEBUG_OBJECT (sink, "set to flushing");
   g_cancellable_cancel (sink->cancellable);
-  if (sink->main_context)
-    g_main_context_wakeup (sink->main_context);
+  gst_multi_socket_sink_wakeup (sink);
 
   return TRUE;
 }
@@ -55,6 +55,11 @@ typedef struct {
 
   GSource *source;
   GIOCondition condition;
+
+  gboolean zerocopy;            /* SO_ZEROCOPY is enabled on the socket */
+  guint32 zerocopy_next;        /* id of the next zerocopy send */
+  GQueue zerocopy_pending;      /* sends waiting for their completion */
+  gsize zerocopy_bytes;         /* bytes of the zerocopy_pending sends */
 } GstSocketClient;
 
 /**
@@ -66,10 +71,17 @@ struct _GstMultiSocketSink {
   GstMultiHandleSink element;
 
   /*< private >*/
-  GMainContext *main_context;
+  GMainContext *main_context; /* the context of the first sender */
+  GMainContext **main_contexts; /* one per sender thread */
   GCancellable *cancellable;
+  GSource **epoll_sources; /* dispatch the ready clients when using epoll */
   gboolean send_messages;
   gboolean send_dispatched;
+
+  guint batch_size;
+  gboolean zerocopy;
+  GHashTable *mappings; /* GstBuffer -> mapping shared by all clients */
+  guint mappings_prune_size;
 };
 
 struct _GstMultiSocketSinkClass {
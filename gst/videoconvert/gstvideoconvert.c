@@ -371,7 +371,8 @@ gst_video_convert_filter_meta (GstBaseTransform * trans, GstQuery * query,
 {
   /* This element cannot passthrough the crop meta, because it would convert the
    * wrong sub-region of the image, and worst, our output image may not be large
-   * enough for the crop to be applied later */
+   * enough for the crop to be applied later. We apply the crop ourselves, see
+   * gst_video_convert_propose_allocation() */
   if (api == GST_VIDEO_CROP_META_API_TYPE)
     return FALSE;
 
@@ -379,6 +380,29 @@ gst_video_convert_filter_meta (GstBaseTransform * trans, GstQuery * query,
   return TRUE;
 }
 
+static gboolean
+gst_video_convert_propose_allocation (GstBaseTransform * trans,
+    GstQuery * decide_query, GstQuery * query)
+{
+  if (!GST_BASE_TRANSFORM_CLASS (parent_class)->propose_allocation (trans,
+          decide_query, query))
+    return FALSE;
+
+  /* passthrough, downstream decides */
+  if (decide_query == NULL)
+    return TRUE;
+
+  /* The crop is applied while converting, so upstream can send the complete
+   * frame with a crop meta. The video meta describes the complete frame. */
+  if (!gst_query_find_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL))
+    gst_query_add_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL);
+  if (!gst_query_find_allocation_meta (query, GST_VIDEO_CROP_META_API_TYPE,
+          NULL))
+    gst_query_add_allocation_meta (query, GST_VIDEO_CROP_META_API_TYPE, NULL);
+
+  return TRUE;
+}
+
 /* The caps can be transformed into any other caps with format info removed.
  * However, we should prefer passthrough, so if passthrough is possible,
  * put it first in the list. */
@@ -413,7 +437,10 @@ gst_video_convert_transform_meta (GstBaseTransform * trans, GstBuffer * outbuf,
   const GstMetaInfo *info = meta->info;
   gboolean ret;
 
-  if (gst_meta_api_type_has_tag (info->api, _colorspace_quark)) {
+  if (info->api == GST_VIDEO_CROP_META_API_TYPE) {
+    /* the crop is applied while converting */
+    ret = FALSE;
+  } else if (gst_meta_api_type_has_tag (info->api, _colorspace_quark)) {
     /* don't copy colorspace specific metadata, FIXME, we need a MetaTransform
      * for the colorspace metadata. */
     ret = FALSE;
@@ -554,6 +581,8 @@ gst_video_convert_class_init (GstVideoConvertClass * klass)
       GST_DEBUG_FUNCPTR (gst_video_convert_fixate_caps);
   gstbasetransform_class->filter_meta =
       GST_DEBUG_FUNCPTR (gst_video_convert_filter_meta);
+  gstbasetransform_class->propose_allocation =
+      GST_DEBUG_FUNCPTR (gst_video_convert_propose_allocation);
   gstbasetransform_class->transform_meta =
       GST_DEBUG_FUNCPTR (gst_video_convert_transform_meta);
 
@@ -719,6 +748,7 @@ gst_video_convert_transform_frame (GstVideoFilter * filter,
     GstVideoFrame * in_frame, GstVideoFrame * out_frame)
 {
   GstVideoConvert *space;
+  GstVideoCropMeta *crop;
 
   space = GST_VIDEO_CONVERT_CAST (filter);
 
@@ -727,7 +757,10 @@ gst_video_convert_transform_frame (GstVideoFilter * filter,
       GST_VIDEO_INFO_NAME (&filter->in_info),
       GST_VIDEO_INFO_NAME (&filter->out_info));
 
-  gst_video_converter_frame (space->convert, in_frame, out_frame);
+  crop = gst_buffer_get_video_crop_meta (in_frame->buffer);
+  if (crop == NULL || !gst_video_converter_frame_crop (space->convert,
+          in_frame, crop->x, crop->y, crop->width, crop->height, out_frame))
+    gst_video_converter_frame (space->convert, in_frame, out_frame);
 
   return GST_FLOW_OK;
 }
@@ -42,6 +42,7 @@ struct _GstVideoConvert {
   GstVideoFilter element;
 
   GstVideoConverter *convert;
+
   GstVideoDitherMethod dither;
   guint dither_quantization;
   GstVideoResamplerMethod chroma_resampler;
@@ -196,6 +196,8 @@ static GstCaps *gst_video_scale_fixate_caps (GstBaseTransform * base,
     GstPadDirection direction, GstCaps * caps, GstCaps * othercaps);
 static gboolean gst_video_scale_transform_meta (GstBaseTransform * trans,
     GstBuffer * outbuf, GstMeta * meta, GstBuffer * inbuf);
+static gboolean gst_video_scale_propose_allocation (GstBaseTransform * trans,
+    GstQuery * decide_query, GstQuery * query);
 
 static gboolean gst_video_scale_set_info (GstVideoFilter * filter,
     GstCaps * in, GstVideoInfo * in_info, GstCaps * out,
@@ -290,6 +292,8 @@ gst_video_scale_class_init (GstVideoScaleClass * klass)
   trans_class->src_event = GST_DEBUG_FUNCPTR (gst_video_scale_src_event);
   trans_class->transform_meta =
       GST_DEBUG_FUNCPTR (gst_video_scale_transform_meta);
+  trans_class->propose_allocation =
+      GST_DEBUG_FUNCPTR (gst_video_scale_propose_allocation);
 
   filter_class->set_info = GST_DEBUG_FUNCPTR (gst_video_scale_set_info);
   filter_class->transform_frame =
@@ -514,6 +518,10 @@ gst_video_scale_transform_meta (GstBaseTransform * trans, GstBuffer * outbuf,
     GST_META_TAG_VIDEO_SIZE_STR
   };
 
+  /* The crop is applied while scaling */
+  if (info->api == GST_VIDEO_CROP_META_API_TYPE)
+    return FALSE;
+
   tags = gst_meta_api_type_get_tags (info->api);
 
   /* No specific tags, we are good to copy */
@@ -552,6 +560,29 @@ gst_video_scale_transform_meta (GstBaseTransform * trans, GstBuffer * outbuf,
   return TRUE;
 }
 
+static gboolean
+gst_video_scale_propose_allocation (GstBaseTransform * trans,
+    GstQuery * decide_query, GstQuery * query)
+{
+  if (!GST_BASE_TRANSFORM_CLASS (parent_class)->propose_allocation (trans,
+          decide_query, query))
+    return FALSE;
+
+  /* passthrough, downstream decides */
+  if (decide_query == NULL)
+    return TRUE;
+
+  /* The crop is applied while scaling, so upstream can send the complete
+   * frame with a crop meta. The video meta describes the complete frame. */
+  if (!gst_query_find_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL))
+    gst_query_add_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL);
+  if (!gst_query_find_allocation_meta (query, GST_VIDEO_CROP_META_API_TYPE,
+          NULL))
+    gst_query_add_allocation_meta (query, GST_VIDEO_CROP_META_API_TYPE, NULL);
+
+  return TRUE;
+}
+
 static gboolean
 gst_video_scale_set_info (GstVideoFilter * filter, GstCaps * in,
     GstVideoInfo * in_info, GstCaps * out, GstVideoInfo * out_info)
@@ -1171,10 +1202,14 @@ gst_video_scale_transform_frame (GstVideoFilter * filter,
 {
   GstVideoScale *videoscale = GST_VIDEO_SCALE_CAST (filter);
   GstFlowReturn ret = GST_FLOW_OK;
+  GstVideoCropMeta *crop;
 
   GST_CAT_DEBUG_OBJECT (CAT_PERFORMANCE, filter, "doing video scaling");
 
-  gst_video_converter_frame (videoscale->convert, in_frame, out_frame);
+  crop = gst_buffer_get_video_crop_meta (in_frame->buffer);
+  if (crop == NULL || !gst_video_converter_frame_crop (videoscale->convert,
+          in_frame, crop->x, crop->y, crop->width, crop->height, out_frame))
+    gst_video_converter_frame (videoscale->convert, in_frame, out_frame);
 
   return ret;
 }
@@ -2095,6 +2095,111 @@ GST_START_TEST (test_change_output_caps_mid_output_buffer)
   gst_object_unref (bin);
 }
 
+GST_END_TEST;
+
+static void
+handoff_append_cb (GstElement * fakesink, GstBuffer * buffer, GstPad * pad,
+    GByteArray * output)
+{
+  GstMapInfo map;
+
+  gst_buffer_map (buffer, &map, GST_MAP_READ);
+  g_byte_array_append (output, map.data, map.size);
+  gst_buffer_unmap (buffer, &map);
+}
+
+static GByteArray *
+run_n_threads_pipeline (guint n_threads)
+{
+  GstElement *bin, *audiomixer, *capsfilter, *sink;
+  GByteArray *output;
+  GstBus *bus;
+  GstCaps *caps;
+  gint i;
+
+  bin = gst_pipeline_new ("pipeline");
+  bus = gst_element_get_bus (bin);
+  gst_bus_add_signal_watch_full (bus, G_PRIORITY_HIGH);
+
+  g_signal_connect (bus, "message::error", (GCallback) message_received, bin);
+  g_signal_connect (bus, "message::warning", (GCallback) message_received, bin);
+  g_signal_connect (bus, "message::eos", (GCallback) message_received, bin);
+
+  audiomixer = gst_element_factory_make ("audiomixer", "audiomixer");
+  g_object_set (audiomixer, "n-threads", n_threads,
+      "output-buffer-duration", 100 * GST_MSECOND, NULL);
+  capsfilter = gst_element_factory_make ("capsfilter", NULL);
+  caps = gst_caps_new_simple ("audio/x-raw",
+      "format", G_TYPE_STRING, GST_AUDIO_NE (S16),
+      "layout", G_TYPE_STRING, "interleaved",
+      "rate", G_TYPE_INT, 48000, "channels", G_TYPE_INT, 2, NULL);
+  g_object_set (capsfilter, "caps", caps, NULL);
+  gst_caps_unref (caps);
+
+  output = g_byte_array_new ();
+  sink = gst_element_factory_make ("fakesink", "sink");
+  g_object_set (sink, "signal-handoffs", TRUE, NULL);
+  g_signal_connect (sink, "handoff", (GCallback) handoff_append_cb, output);
+
+  gst_bin_add_many (GST_BIN (bin), audiomixer, capsfilter, sink, NULL);
+  fail_unless (gst_element_link_many (audiomixer, capsfilter, sink, NULL));
+
+  /* inputs with different buffer sizes and lengths, so the parts of the
+   * output buffers they cover differ */
+  for (i = 0; i < 8; i++) {
+    GstElement *src;
+    GstPad *srcpad, *sinkpad;
+
+    src = gst_element_factory_make ("audiotestsrc", NULL);
+    g_object_set (src, "freq", 110.0 * (i + 1), "volume", 0.5,
+        "samplesperbuffer", 1000 + 333 * i, "num-buffers", 20 - i, NULL);
+    gst_bin_add (GST_BIN (bin), src);
+
+    srcpad = gst_element_get_static_pad (src, "src");
+    sinkpad = gst_element_get_request_pad (audiomixer, "sink_%u");
+    fail_unless (gst_pad_link (srcpad, sinkpad) == GST_PAD_LINK_OK);
+
+    /* saturating, attenuated and muted inputs */
+    if (i == 1)
+      g_object_set (sinkpad, "volume", 4.0, NULL);
+    else if (i == 2)
+      g_object_set (sinkpad, "volume", 0.3, NULL);
+    else if (i == 3)
+      g_object_set (sinkpad, "mute", TRUE, NULL);
+
+    gst_object_unref (srcpad);
+    gst_object_unref (sinkpad);
+  }
+
+  play_and_wait (bin);
+
+  gst_bus_remove_signal_watch (bus);
+  gst_object_unref (bus);
+  gst_object_unref (bin);
+
+  return output;
+}
+
+/* mixing on several threads gives the same output as on a single one */
+GST_START_TEST (test_n_threads)
+{
+  GByteArray *expected, *output;
+  guint n_threads[] = { 0, 2, 4, 7 };
+  guint i;
+
+  expected = run_n_threads_pipeline (1);
+  fail_unless (expected->len > 0);
+
+  for (i = 0; i < G_N_ELEMENTS (n_threads); i++) {
+    output = run_n_threads_pipeline (n_threads[i]);
+    fail_unless_equals_int (output->len, expected->len);
+    fail_unless (memcmp (output->data, expected->data, expected->len) == 0);
+    g_byte_array_unref (output);
+  }
+
+  g_byte_array_unref (expected);
+}
+
 GST_END_TEST;
 static Suite *
 audiomixer_suite (void)
@@ -2127,6 +2232,7 @@ audiomixer_suite (void)
   tcase_add_checked_fixture (tc_chain, test_setup, test_teardown);
   tcase_add_test (tc_chain, test_change_output_caps);
   tcase_add_test (tc_chain, test_change_output_caps_mid_output_buffer);
+  tcase_add_test (tc_chain, test_n_threads);
 
   /* Use a longer timeout */
 #ifdef HAVE_VALGRIND
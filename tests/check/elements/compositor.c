@@ -2268,6 +2268,253 @@ GST_START_TEST (test_signals)
 
 GST_END_TEST;
 
+static GstBuffer *
+run_n_threads_pipeline (const gchar * format, const gchar * background,
+    guint n_threads)
+{
+  GstElement *pipeline, *sink;
+  GstSample *sample = NULL;
+  GstBuffer *buffer;
+  gchar *desc;
+
+  desc = g_strdup_printf ("compositor name=c n-threads=%u background=%s "
+      "sink_1::xpos=31 sink_1::ypos=-7 sink_1::alpha=0.5 "
+      "sink_2::xpos=-5 sink_2::ypos=60 ! "
+      "video/x-raw,format=%s,width=160,height=121 ! appsink name=sink "
+      "videotestsrc num-buffers=1 pattern=smpte ! "
+      "video/x-raw,format=%s,width=123,height=97 ! c.sink_0 "
+      "videotestsrc num-buffers=1 pattern=ball ! "
+      "video/x-raw,format=%s,width=77,height=65 ! c.sink_1 "
+      "videotestsrc num-buffers=1 pattern=snow ! "
+      "video/x-raw,format=%s,width=51,height=91 ! c.sink_2",
+      n_threads, background, format, format, format, format);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  fail_unless (pipeline != NULL);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  fail_unless (gst_element_set_state (pipeline,
+          GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE);
+  g_signal_emit_by_name (sink, "pull-sample", &sample);
+  fail_unless (sample != NULL);
+  buffer = gst_buffer_ref (gst_sample_get_buffer (sample));
+  gst_sample_unref (sample);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (sink);
+  gst_object_unref (pipeline);
+
+  return buffer;
+}
+
+GST_START_TEST (test_n_threads)
+{
+  const gchar *formats[] = { "AYUV", "BGRA", "I420", "NV12", "Y41B", "Y42B",
+    "YUY2", "RGB", "xRGB"
+  };
+  const gchar *backgrounds[] = { "checker", "black", "transparent" };
+  guint i, j;
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++) {
+    for (j = 0; j < G_N_ELEMENTS (backgrounds); j++) {
+      GstBuffer *serial, *threaded;
+      GstMapInfo map;
+
+      GST_INFO ("testing %s with %s background", formats[i], backgrounds[j]);
+
+      serial = run_n_threads_pipeline (formats[i], backgrounds[j], 1);
+      threaded = run_n_threads_pipeline (formats[i], backgrounds[j], 5);
+
+      /* stripes must give exactly the same result as a single pass */
+      fail_unless_equals_int (gst_buffer_get_size (serial),
+          gst_buffer_get_size (threaded));
+      gst_buffer_map (serial, &map, GST_MAP_READ);
+      fail_unless (gst_buffer_memcmp (threaded, 0, map.data, map.size) == 0);
+      gst_buffer_unmap (serial, &map);
+
+      gst_buffer_unref (serial);
+      gst_buffer_unref (threaded);
+    }
+  }
+}
+
+GST_END_TEST;
+
+/* sink_0 and sink_2 repeat their only buffer, so only the lines covered by
+ * the moving ball of sink_1 change between output frames */
+static GList *
+run_incremental_pipeline (const gchar * format, const gchar * background,
+    gboolean incremental, guint n_threads)
+{
+  GstElement *pipeline, *sink;
+  GstSample *sample;
+  GList *buffers = NULL;
+  gchar *desc;
+
+  desc = g_strdup_printf ("compositor name=c incremental=%d n-threads=%u "
+      "background=%s sink_0::repeat-after-eos=true "
+      "sink_1::xpos=31 sink_1::ypos=13 sink_1::alpha=0.5 "
+      "sink_2::xpos=-5 sink_2::ypos=61 sink_2::repeat-after-eos=true ! "
+      "video/x-raw,format=%s,width=160,height=121 ! "
+      "appsink name=sink sync=false "
+      "videotestsrc num-buffers=1 pattern=smpte ! "
+      "video/x-raw,format=%s,width=123,height=97 ! c.sink_0 "
+      "videotestsrc num-buffers=6 pattern=ball ! "
+      "video/x-raw,format=%s,width=77,height=65 ! c.sink_1 "
+      "videotestsrc num-buffers=1 pattern=snow ! "
+      "video/x-raw,format=%s,width=51,height=91 ! c.sink_2",
+      incremental, n_threads, background, format, format, format, format);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  fail_unless (pipeline != NULL);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  fail_unless (gst_element_set_state (pipeline,
+          GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE);
+  do {
+    sample = NULL;
+    g_signal_emit_by_name (sink, "pull-sample", &sample);
+    if (sample) {
+      buffers = g_list_append (buffers,
+          gst_buffer_ref (gst_sample_get_buffer (sample)));
+      gst_sample_unref (sample);
+    }
+  } while (sample != NULL);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (sink);
+  gst_object_unref (pipeline);
+
+  return buffers;
+}
+
+GST_START_TEST (test_incremental)
+{
+  const gchar *formats[] = { "AYUV", "BGRA", "I420", "NV12", "YUY2", "RGB" };
+  const gchar *backgrounds[] = { "checker", "black", "transparent" };
+  guint i, j;
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++) {
+    for (j = 0; j < G_N_ELEMENTS (backgrounds); j++) {
+      GList *full, *incremental, *l1, *l2;
+
+      GST_INFO ("testing %s with %s background", formats[i], backgrounds[j]);
+
+      full = run_incremental_pipeline (formats[i], backgrounds[j], FALSE, 1);
+      incremental =
+          run_incremental_pipeline (formats[i], backgrounds[j], TRUE, 3);
+
+      /* every frame must be the same as when compositing all of it */
+      fail_unless (g_list_length (full) > 1);
+      fail_unless_equals_int (g_list_length (full),
+          g_list_length (incremental));
+      for (l1 = full, l2 = incremental; l1; l1 = l1->next, l2 = l2->next) {
+        GstMapInfo map;
+
+        fail_unless_equals_int (gst_buffer_get_size (l1->data),
+            gst_buffer_get_size (l2->data));
+        gst_buffer_map (l1->data, &map, GST_MAP_READ);
+        fail_unless (gst_buffer_memcmp (l2->data, 0, map.data, map.size) == 0);
+        gst_buffer_unmap (l1->data, &map);
+      }
+
+      g_list_free_full (full, (GDestroyNotify) gst_buffer_unref);
+      g_list_free_full (incremental, (GDestroyNotify) gst_buffer_unref);
+    }
+  }
+}
+
+GST_END_TEST;
+
+static void
+count_finalized_buffer (gint * finalized, GstMiniObject * obj)
+{
+  g_atomic_int_inc (finalized);
+}
+
+/* All pads are prepared in parallel. sink_1 gets a buffer that is too small
+ * for its caps, so preparing its frame fails. Like when the pads are
+ * prepared one after the other, sink_0 is still composited and sink_2 is
+ * not, and the prepared frames of all pads are released. */
+GST_START_TEST (test_parallel_prepare_failure)
+{
+  GstElement *pipeline, *sink;
+  GstSample *sample = NULL;
+  GstBuffer *buffer;
+  GstMapInfo map;
+  gint finalized = 0;
+  guint i, j;
+
+  pipeline = gst_parse_launch ("compositor name=c background=black "
+      "sink_1::xpos=16 sink_2::xpos=32 ! "
+      "video/x-raw,format=AYUV,width=48,height=16 ! appsink name=sink "
+      "appsrc name=src0 format=time ! c.sink_0 "
+      "appsrc name=src1 format=time ! c.sink_1 "
+      "appsrc name=src2 format=time ! c.sink_2", NULL);
+  fail_unless (pipeline != NULL);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  fail_unless (gst_element_set_state (pipeline,
+          GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE);
+
+  for (i = 0; i < 3; i++) {
+    GstCaps *caps;
+    GstElement *src;
+    GstFlowReturn ret;
+    gchar *name;
+
+    name = g_strdup_printf ("src%u", i);
+    src = gst_bin_get_by_name (GST_BIN (pipeline), name);
+    g_free (name);
+
+    caps = gst_caps_from_string ("video/x-raw,format=AYUV,width=16,height=16,"
+        "framerate=25/1");
+    g_object_set (src, "caps", caps, NULL);
+    gst_caps_unref (caps);
+
+    /* white, except for the broken buffer */
+    buffer = gst_buffer_new_allocate (NULL, i == 1 ? 16 : 16 * 16 * 4, NULL);
+    gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+    for (j = 0; j < map.size; j += 4) {
+      map.data[j] = 0xff;
+      map.data[j + 1] = 235;
+      map.data[j + 2] = 128;
+      map.data[j + 3] = 128;
+    }
+    gst_buffer_unmap (buffer, &map);
+    GST_BUFFER_PTS (buffer) = 0;
+    GST_BUFFER_DURATION (buffer) = GST_SECOND / 25;
+    gst_mini_object_weak_ref (GST_MINI_OBJECT_CAST (buffer),
+        (GstMiniObjectNotify) count_finalized_buffer, &finalized);
+
+    g_signal_emit_by_name (src, "push-buffer", buffer, &ret);
+    fail_unless_equals_int (ret, GST_FLOW_OK);
+    gst_buffer_unref (buffer);
+    g_signal_emit_by_name (src, "end-of-stream", &ret);
+    gst_object_unref (src);
+  }
+
+  g_signal_emit_by_name (sink, "pull-sample", &sample);
+  fail_unless (sample != NULL);
+  buffer = gst_sample_get_buffer (sample);
+  gst_buffer_map (buffer, &map, GST_MAP_READ);
+  /* luma of the first line at sink_0, sink_1 and sink_2 */
+  fail_unless_equals_int (map.data[8 * 4 + 1], 235);
+  fail_unless_equals_int (map.data[24 * 4 + 1], 16);
+  fail_unless_equals_int (map.data[40 * 4 + 1], 16);
+  gst_buffer_unmap (buffer, &map);
+  gst_sample_unref (sample);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (sink);
+  gst_object_unref (pipeline);
+
+  /* no prepared frame keeps an input buffer alive */
+  fail_unless_equals_int (finalized, 3);
+}
+
+GST_END_TEST;
+
 static Suite *
 compositor_suite (void)
 {
@@ -2308,6 +2555,9 @@ compositor_suite (void)
   tcase_add_test (tc_chain, test_start_time_first_live_drop_3_unlinked_1);
   tcase_add_test (tc_chain, test_gap_events);
   tcase_add_test (tc_chain, test_signals);
+  tcase_add_test (tc_chain, test_n_threads);
+  tcase_add_test (tc_chain, test_incremental);
+  tcase_add_test (tc_chain, test_parallel_prepare_failure);
 
   return s;
 }
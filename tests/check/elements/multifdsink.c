@@ -18,6 +18,7 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#include <errno.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
 
@@ -562,6 +563,66 @@ GST_START_TEST (test_burst_client_bytes)
 
 GST_END_TEST;
 
+/* keep 640 bytes and burst 480 bytes to a client after the buffer queue
+ * wrapped around several times */
+GST_START_TEST (test_burst_client_bytes_wraparound)
+{
+  GstElement *sink;
+  GstCaps *caps;
+  int pfd[2];
+  gchar ref[16];
+  gint i;
+  guint buffers_queued;
+
+  sink = setup_multifdsink ();
+  g_object_set (sink, "bytes-min", 640, NULL);
+  g_object_set (sink, "sync-method", 3, NULL);  /* 3 = burst */
+  g_object_set (sink, "burst-format", GST_FORMAT_BYTES, NULL);
+  g_object_set (sink, "burst-value", (guint64) 480, NULL);
+
+  fail_if (pipe (pfd) == -1);
+
+  ASSERT_SET_STATE (sink, GST_STATE_PLAYING, GST_STATE_CHANGE_ASYNC);
+
+  caps = gst_caps_from_string ("application/x-gst-check");
+  gst_check_setup_events (mysrcpad, sink, caps, GST_FORMAT_BYTES);
+
+  for (i = 0; i < 100; i++) {
+    GstBuffer *buffer = gst_new_buffer (i);
+
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+
+  /* 40 buffers (640 bytes) are kept in the queue */
+  g_object_get (sink, "buffers-queued", &buffers_queued, NULL);
+  fail_unless_equals_int (buffers_queued, 40);
+
+  g_signal_emit_by_name (sink, "add", pfd[1]);
+  fail_unless_num_handles (sink, 1);
+
+  /* push a buffer to make the client fd ready for reading */
+  fail_unless (gst_pad_push (mysrcpad, gst_new_buffer (100)) == GST_FLOW_OK);
+
+  /* the client gets the last 30 buffers (480 bytes) */
+  for (i = 71; i <= 100; i++) {
+    g_snprintf (ref, 16, "deadbee%08x", i);
+    fail_unless_read ("client", pfd[0], 16, ref);
+  }
+
+  /* and then continues with new buffers */
+  fail_unless (gst_pad_push (mysrcpad, gst_new_buffer (101)) == GST_FLOW_OK);
+  fail_unless_read ("client", pfd[0], 16, "deadbee00000065");
+
+  GST_DEBUG ("cleaning up multifdsink");
+  ASSERT_SET_STATE (sink, GST_STATE_NULL, GST_STATE_CHANGE_SUCCESS);
+  cleanup_multifdsink (sink);
+
+  ASSERT_CAPS_REFCOUNT (caps, "caps", 1);
+  gst_caps_unref (caps);
+}
+
+GST_END_TEST;
+
 /* keep 100 bytes and burst 80 bytes to clients */
 GST_START_TEST (test_burst_client_bytes_keyframe)
 {
@@ -747,6 +808,91 @@ GST_START_TEST (test_burst_client_bytes_with_keyframe)
 
 GST_END_TEST;
 
+/* keep 6 seconds and burst 3 seconds to clients, positions are found with
+ * the time index of the queue */
+GST_START_TEST (test_burst_client_time_keyframe)
+{
+  GstElement *sink;
+  GstCaps *caps;
+  int pfd1[2];
+  int pfd2[2];
+  gint i;
+  guint buffers_queued;
+
+  sink = setup_multifdsink ();
+  /* make sure we keep at least 6 seconds at all times */
+  g_object_set (sink, "time-min", (gint64) 6 * GST_SECOND, NULL);
+  g_object_set (sink, "sync-method", 4, NULL);  /* 4 = burst_keyframe */
+  g_object_set (sink, "burst-format", GST_FORMAT_TIME, NULL);
+  g_object_set (sink, "burst-value", (guint64) 3 * GST_SECOND, NULL);
+
+  fail_if (pipe (pfd1) == -1);
+  fail_if (pipe (pfd2) == -1);
+
+  ASSERT_SET_STATE (sink, GST_STATE_PLAYING, GST_STATE_CHANGE_ASYNC);
+
+  caps = gst_caps_from_string ("application/x-gst-check");
+  gst_check_setup_events (mysrcpad, sink, caps, GST_FORMAT_BYTES);
+  GST_DEBUG ("Created test caps %p %" GST_PTR_FORMAT, caps, caps);
+
+  /* push 9 buffers, one per second */
+  for (i = 0; i < 9; i++) {
+    GstBuffer *buffer = gst_new_buffer (i);
+
+    GST_BUFFER_TIMESTAMP (buffer) = i * GST_SECOND;
+    /* mark most buffers as delta */
+    if (i != 0 && i != 4 && i != 8)
+      GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+
+  /* the buffers from 2 to 8 seconds are kept */
+  g_object_get (sink, "buffers-queued", &buffers_queued, NULL);
+  fail_unless_equals_int (buffers_queued, 7);
+
+  /* now add the clients */
+  g_signal_emit_by_name (sink, "add", pfd1[1]);
+  g_signal_emit_by_name (sink, "add_full", pfd2[1],
+      4, GST_FORMAT_TIME, (guint64) GST_SECOND, GST_FORMAT_TIME,
+      (guint64) 2 * GST_SECOND);
+
+  /* push last buffer to make client fds ready for reading */
+  {
+    GstBuffer *buffer = gst_new_buffer (9);
+
+    GST_BUFFER_TIMESTAMP (buffer) = 9 * GST_SECOND;
+    GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+
+  /* the first client bursts at least 3 seconds, the keyframe at 4 seconds
+   * is the first one before that */
+  GST_DEBUG ("Reading from client 1");
+  for (i = 4; i < 10; i++) {
+    gchar ref[16];
+
+    g_snprintf (ref, 16, "deadbee%08x", i);
+    fail_unless_read ("client 1", pfd1[0], 16, ref);
+  }
+
+  /* the second client bursts between 1 and 2 seconds and starts with the
+   * keyframe at 8 seconds */
+  GST_DEBUG ("Reading from client 2");
+  fail_unless_read ("client 2", pfd2[0], 16, "deadbee00000008");
+  fail_unless_read ("client 2", pfd2[0], 16, "deadbee00000009");
+
+  GST_DEBUG ("cleaning up multifdsink");
+  ASSERT_SET_STATE (sink, GST_STATE_NULL, GST_STATE_CHANGE_SUCCESS);
+  cleanup_multifdsink (sink);
+
+  ASSERT_CAPS_REFCOUNT (caps, "caps", 1);
+  gst_caps_unref (caps);
+}
+
+GST_END_TEST;
+
 /* Check that we can get data when multifdsink is configured in next-keyframe
  * mode */
 GST_START_TEST (test_client_next_keyframe)
@@ -943,6 +1089,153 @@ GST_START_TEST (test_client_kick)
 
 GST_END_TEST;
 
+/* read exactly @size bytes, a client that was blocked can get a buffer in
+ * several pieces */
+static void
+read_full (int fd, gchar * data, gsize size)
+{
+  gsize nread = 0;
+
+  while (nread < size) {
+    gssize ret = read (fd, data + nread, size - nread);
+
+    fail_unless (ret > 0, "could not read: %s", g_strerror (errno));
+    nread += ret;
+  }
+}
+
+/* with use-epoll, a client that filled its pipe must get the rest of the
+ * data after it starts reading again */
+GST_START_TEST (test_use_epoll)
+{
+  GstElement *sink;
+  GstCaps *caps;
+  int pfd1[2], pfd2[2];
+  gchar ref[16], data[16];
+  gint i;
+
+  sink = setup_multifdsink ();
+  g_object_set (sink, "use-epoll", TRUE, NULL);
+
+  fail_if (pipe (pfd1) == -1);
+  fail_if (pipe (pfd2) == -1);
+
+  ASSERT_SET_STATE (sink, GST_STATE_PLAYING, GST_STATE_CHANGE_ASYNC);
+
+  caps = gst_caps_from_string ("application/x-gst-check");
+  gst_check_setup_events (mysrcpad, sink, caps, GST_FORMAT_BYTES);
+
+  g_signal_emit_by_name (sink, "add", pfd1[1]);
+  g_signal_emit_by_name (sink, "add", pfd2[1]);
+  fail_unless_num_handles (sink, 2);
+
+  /* 80000 bytes, more than fits in a pipe */
+  for (i = 0; i < 5000; i++)
+    fail_unless (gst_pad_push (mysrcpad, gst_new_buffer (i)) == GST_FLOW_OK);
+
+  for (i = 0; i < 5000; i++) {
+    g_snprintf (ref, 16, "deadbee%08x", i);
+    read_full (pfd1[0], data, 16);
+    fail_unless (memcmp (data, ref, 16) == 0);
+    read_full (pfd2[0], data, 16);
+    fail_unless (memcmp (data, ref, 16) == 0);
+  }
+
+  /* both clients caught up and get new data right away */
+  fail_unless (gst_pad_push (mysrcpad, gst_new_buffer (5000)) == GST_FLOW_OK);
+  g_snprintf (ref, 16, "deadbee%08x", 5000);
+  read_full (pfd1[0], data, 16);
+  fail_unless (memcmp (data, ref, 16) == 0);
+  read_full (pfd2[0], data, 16);
+  fail_unless (memcmp (data, ref, 16) == 0);
+
+  GST_DEBUG ("cleaning up multifdsink");
+  ASSERT_SET_STATE (sink, GST_STATE_NULL, GST_STATE_CHANGE_SUCCESS);
+  cleanup_multifdsink (sink);
+
+  close (pfd1[0]);
+  close (pfd1[1]);
+  close (pfd2[0]);
+  close (pfd2[1]);
+
+  ASSERT_CAPS_REFCOUNT (caps, "caps", 1);
+  gst_caps_unref (caps);
+}
+
+GST_END_TEST;
+
+#define SENDER_CLIENTS 8
+
+/* with several sender threads, every client must still get all buffers in
+ * order */
+static void
+run_sender_threads (gboolean use_epoll)
+{
+  GstElement *sink;
+  GstCaps *caps;
+  int pfd[SENDER_CLIENTS][2];
+  gchar ref[16], data[16];
+  gint i, j;
+
+  sink = setup_multifdsink ();
+  g_object_set (sink, "n-sender-threads", 4, "use-epoll", use_epoll, NULL);
+
+  for (j = 0; j < SENDER_CLIENTS; j++)
+    fail_if (pipe (pfd[j]) == -1);
+
+  ASSERT_SET_STATE (sink, GST_STATE_PLAYING, GST_STATE_CHANGE_ASYNC);
+
+  caps = gst_caps_from_string ("application/x-gst-check");
+  gst_check_setup_events (mysrcpad, sink, caps, GST_FORMAT_BYTES);
+
+  for (j = 0; j < SENDER_CLIENTS; j++)
+    g_signal_emit_by_name (sink, "add", pfd[j][1]);
+  fail_unless_num_handles (sink, SENDER_CLIENTS);
+
+  /* more than fits in a pipe, so the senders have to wait for the reader */
+  for (i = 0; i < 5000; i++)
+    fail_unless (gst_pad_push (mysrcpad, gst_new_buffer (i)) == GST_FLOW_OK);
+
+  for (i = 0; i < 5000; i++) {
+    g_snprintf (ref, 16, "deadbee%08x", i);
+    for (j = 0; j < SENDER_CLIENTS; j++) {
+      read_full (pfd[j][0], data, 16);
+      fail_unless (memcmp (data, ref, 16) == 0);
+    }
+  }
+
+  /* removing a client while the others are served */
+  g_signal_emit_by_name (sink, "remove", pfd[0][1]);
+  fail_unless_num_handles (sink, SENDER_CLIENTS - 1);
+
+  fail_unless (gst_pad_push (mysrcpad, gst_new_buffer (5000)) == GST_FLOW_OK);
+  g_snprintf (ref, 16, "deadbee%08x", 5000);
+  for (j = 1; j < SENDER_CLIENTS; j++) {
+    read_full (pfd[j][0], data, 16);
+    fail_unless (memcmp (data, ref, 16) == 0);
+  }
+
+  GST_DEBUG ("cleaning up multifdsink");
+  ASSERT_SET_STATE (sink, GST_STATE_NULL, GST_STATE_CHANGE_SUCCESS);
+  cleanup_multifdsink (sink);
+
+  for (j = 0; j < SENDER_CLIENTS; j++) {
+    close (pfd[j][0]);
+    close (pfd[j][1]);
+  }
+
+  ASSERT_CAPS_REFCOUNT (caps, "caps", 1);
+  gst_caps_unref (caps);
+}
+
+GST_START_TEST (test_sender_threads)
+{
+  run_sender_threads (FALSE);
+  run_sender_threads (TRUE);
+}
+
+GST_END_TEST;
+
 /* FIXME: add test simulating chained oggs where:
  * sync-method is burst-on-connect
  * (when multifdsink actually does burst-on-connect based on byte size, not
@@ -963,10 +1256,14 @@ multifdsink_suite (void)
   tcase_add_test (tc_chain, test_streamheader);
   tcase_add_test (tc_chain, test_change_streamheader);
   tcase_add_test (tc_chain, test_burst_client_bytes);
+  tcase_add_test (tc_chain, test_burst_client_bytes_wraparound);
   tcase_add_test (tc_chain, test_burst_client_bytes_keyframe);
   tcase_add_test (tc_chain, test_burst_client_bytes_with_keyframe);
+  tcase_add_test (tc_chain, test_burst_client_time_keyframe);
   tcase_add_test (tc_chain, test_client_next_keyframe);
   tcase_add_test (tc_chain, test_client_kick);
+  tcase_add_test (tc_chain, test_use_epoll);
+  tcase_add_test (tc_chain, test_sender_threads);
 
   return s;
 }
@@ -965,6 +965,126 @@ GST_START_TEST (test_client_next_keyframe)
 
 GST_END_TEST;
 
+/* with batch-size, a client that was blocked gets all queued buffers in
+ * order, also ones with many memories */
+GST_START_TEST (test_batch_size)
+{
+  TestSinkAndSocket tsas = { 0 };
+  GstBuffer *buffer;
+  GstCaps *caps;
+  gchar ref[16], data[16];
+  int i, j;
+
+  tsas.sink = setup_multisocketsink ();
+  g_object_set (tsas.sink, "batch-size", 16, NULL);
+  fail_unless (setup_handles (&tsas.sinksocket, &tsas.srcsocket));
+
+  ASSERT_SET_STATE (tsas.sink, GST_STATE_PLAYING, GST_STATE_CHANGE_ASYNC);
+  g_signal_emit_by_name (tsas.sink, "add", tsas.sinksocket);
+  caps = gst_caps_from_string ("application/x-gst-check");
+  gst_check_setup_events (mysrcpad, tsas.sink, caps, GST_FORMAT_BYTES);
+  gst_caps_unref (caps);
+
+  for (i = 0; i < 1000; i++) {
+    /* every buffer consists of 4 memories of 4 bytes */
+    buffer = gst_buffer_new ();
+    g_snprintf (ref, 16, "deadbee%08x", i);
+    for (j = 0; j < 4; j++) {
+      GstBuffer *part = gst_buffer_new_and_alloc (4);
+
+      gst_buffer_fill (part, 0, ref + 4 * j, 4);
+      buffer = gst_buffer_append (buffer, part);
+    }
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+
+  for (i = 0; i < 1000; i++) {
+    g_snprintf (ref, 16, "deadbee%08x", i);
+    fail_unless (read_handle_n_bytes_exactly (tsas.srcsocket, data, 16));
+    fail_unless (memcmp (data, ref, 16) == 0);
+  }
+  wait_bytes_served (tsas.sink, 16000);
+
+  teardown_sink_with_socket (&tsas);
+}
+
+GST_END_TEST;
+
+static void
+setup_tcp_handles (GSocket ** sinkhandle, GSocket ** srchandle)
+{
+  GSocket *listener;
+  GInetAddress *loopback;
+  GSocketAddress *addr, *bound;
+
+  listener = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_STREAM,
+      G_SOCKET_PROTOCOL_TCP, NULL);
+  fail_unless (listener != NULL);
+  loopback = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  addr = g_inet_socket_address_new (loopback, 0);
+  fail_unless (g_socket_bind (listener, addr, TRUE, NULL));
+  fail_unless (g_socket_listen (listener, NULL));
+  bound = g_socket_get_local_address (listener, NULL);
+  fail_unless (bound != NULL);
+
+  *srchandle = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_STREAM,
+      G_SOCKET_PROTOCOL_TCP, NULL);
+  fail_unless (g_socket_connect (*srchandle, bound, NULL, NULL));
+  *sinkhandle = g_socket_accept (listener, NULL, NULL);
+  fail_unless (*sinkhandle != NULL);
+
+  g_object_unref (bound);
+  g_object_unref (addr);
+  g_object_unref (loopback);
+  g_object_unref (listener);
+}
+
+/* large buffers are sent with MSG_ZEROCOPY where the kernel supports it,
+ * the data must arrive the same either way */
+GST_START_TEST (test_zerocopy)
+{
+  TestSinkAndSocket tsas = { 0 };
+  GstBuffer *buffer;
+  GstCaps *caps;
+  GstMapInfo map;
+  guint8 *data;
+  gsize size = 64 * 1024;
+  int i;
+
+  tsas.sink = setup_multisocketsink ();
+  g_object_set (tsas.sink, "zerocopy", TRUE, "batch-size", 4, NULL);
+  setup_tcp_handles (&tsas.sinksocket, &tsas.srcsocket);
+
+  ASSERT_SET_STATE (tsas.sink, GST_STATE_PLAYING, GST_STATE_CHANGE_ASYNC);
+  g_signal_emit_by_name (tsas.sink, "add", tsas.sinksocket);
+  caps = gst_caps_from_string ("application/x-gst-check");
+  gst_check_setup_events (mysrcpad, tsas.sink, caps, GST_FORMAT_BYTES);
+  gst_caps_unref (caps);
+
+  for (i = 0; i < 32; i++) {
+    buffer = gst_buffer_new_and_alloc (size);
+    gst_buffer_memset (buffer, 0, i, size);
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+
+  data = g_malloc (size);
+  for (i = 0; i < 32; i++) {
+    fail_unless (read_handle_n_bytes_exactly (tsas.srcsocket, data, size));
+    buffer = gst_buffer_new_and_alloc (size);
+    gst_buffer_memset (buffer, 0, i, size);
+    gst_buffer_map (buffer, &map, GST_MAP_READ);
+    fail_unless (memcmp (data, map.data, size) == 0);
+    gst_buffer_unmap (buffer, &map);
+    gst_buffer_unref (buffer);
+  }
+  g_free (data);
+  wait_bytes_served (tsas.sink, 32 * size);
+
+  teardown_sink_with_socket (&tsas);
+}
+
+GST_END_TEST;
+
 /* FIXME: add test simulating chained oggs where:
  * sync-method is burst-on-connect
  * (when multisocketsink actually does burst-on-connect based on byte size, not
@@ -988,6 +1108,8 @@ multisocketsink_suite (void)
   tcase_add_test (tc_chain, test_burst_client_bytes_keyframe);
   tcase_add_test (tc_chain, test_burst_client_bytes_with_keyframe);
   tcase_add_test (tc_chain, test_client_next_keyframe);
+  tcase_add_test (tc_chain, test_batch_size);
+  tcase_add_test (tc_chain, test_zerocopy);
 
   return s;
 }
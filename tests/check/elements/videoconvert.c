@@ -28,6 +28,7 @@
 #endif
 
 #include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
 #include <gst/video/video.h>
 
 static guint
@@ -117,6 +118,79 @@ GST_START_TEST (test_template_formats)
 
 GST_END_TEST;
 
+GST_START_TEST (test_crop_meta)
+{
+  GstHarness *h;
+  GstCaps *caps;
+  GstQuery *query;
+  GstBuffer *buf, *outbuf;
+  GstVideoInfo info;
+  GstVideoMeta *vmeta;
+  GstVideoCropMeta *crop;
+  GstMapInfo map;
+  gint x, y, stride = 80 * 4;
+
+  h = gst_harness_new ("videoconvert");
+  gst_harness_set_caps_str (h,
+      "video/x-raw,format=RGBx,width=64,height=48,framerate=25/1",
+      "video/x-raw,format=BGRx,width=64,height=48,framerate=25/1");
+
+  /* the crop is applied in videoconvert, upstream can send it */
+  caps = gst_caps_from_string
+      ("video/x-raw,format=RGBx,width=64,height=48,framerate=25/1");
+  query = gst_query_new_allocation (caps, TRUE);
+  fail_unless (gst_pad_peer_query (h->srcpad, query));
+  fail_unless (gst_query_find_allocation_meta (query,
+          GST_VIDEO_CROP_META_API_TYPE, NULL));
+  fail_unless (gst_query_find_allocation_meta (query,
+          GST_VIDEO_META_API_TYPE, NULL));
+  gst_query_unref (query);
+  gst_caps_unref (caps);
+
+  /* 64x48 visible pixels in a 80x60 frame */
+  buf = gst_buffer_new_and_alloc (stride * 60);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  for (y = 0; y < 60; y++) {
+    for (x = 0; x < 80; x++) {
+      map.data[y * stride + x * 4 + 0] = x;
+      map.data[y * stride + x * 4 + 1] = y;
+      map.data[y * stride + x * 4 + 2] = x + y;
+      map.data[y * stride + x * 4 + 3] = 0;
+    }
+  }
+  gst_buffer_unmap (buf, &map);
+  vmeta = gst_buffer_add_video_meta (buf, GST_VIDEO_FRAME_FLAG_NONE,
+      GST_VIDEO_FORMAT_RGBx, 80, 60);
+  vmeta->stride[0] = stride;
+  crop = gst_buffer_add_video_crop_meta (buf);
+  crop->x = 8;
+  crop->y = 6;
+  crop->width = 64;
+  crop->height = 48;
+
+  outbuf = gst_harness_push_and_pull (h, buf);
+  fail_unless (outbuf != NULL);
+  fail_unless (gst_buffer_get_video_crop_meta (outbuf) == NULL);
+
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_BGRx, 64, 48);
+  gst_buffer_map (outbuf, &map, GST_MAP_READ);
+  for (y = 0; y < 48; y++) {
+    guint8 *p = map.data + y * GST_VIDEO_INFO_PLANE_STRIDE (&info, 0);
+
+    for (x = 0; x < 64; x++) {
+      fail_unless_equals_int (p[x * 4 + 2], x + 8);
+      fail_unless_equals_int (p[x * 4 + 1], y + 6);
+      fail_unless_equals_int (p[x * 4 + 0], x + y + 14);
+    }
+  }
+  gst_buffer_unmap (outbuf, &map);
+  gst_buffer_unref (outbuf);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 static Suite *
 videoconvert_suite (void)
 {
@@ -126,6 +200,7 @@ videoconvert_suite (void)
   suite_add_tcase (s, tc_chain);
 
   tcase_add_test (tc_chain, test_template_formats);
+  tcase_add_test (tc_chain, test_crop_meta);
 
   return s;
 }
@@ -24,6 +24,7 @@
 #include <gst/base/gstbasesink.h>
 
 #include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
 #include <string.h>
 
 /* kids, don't do this at home, skipping checks is *BAD* */
@@ -923,6 +924,82 @@ GST_START_TEST (test_basetransform_negotiation)
 
 GST_END_TEST;
 
+GST_START_TEST (test_crop_meta)
+{
+  GstHarness *h;
+  GstCaps *caps;
+  GstQuery *query;
+  GstBuffer *buf, *outbuf;
+  GstVideoInfo info;
+  GstVideoMeta *vmeta;
+  GstVideoCropMeta *crop;
+  GstMapInfo map;
+  gint x, y, stride = 80 * 4;
+
+  h = gst_harness_new_parse ("videoscale method=nearest-neighbour");
+  gst_harness_set_caps_str (h,
+      "video/x-raw,format=RGBx,width=64,height=48,framerate=25/1",
+      "video/x-raw,format=RGBx,width=32,height=24,framerate=25/1");
+
+  /* the crop is applied in videoscale, upstream can send it */
+  caps = gst_caps_from_string
+      ("video/x-raw,format=RGBx,width=64,height=48,framerate=25/1");
+  query = gst_query_new_allocation (caps, TRUE);
+  fail_unless (gst_pad_peer_query (h->srcpad, query));
+  fail_unless (gst_query_find_allocation_meta (query,
+          GST_VIDEO_CROP_META_API_TYPE, NULL));
+  fail_unless (gst_query_find_allocation_meta (query,
+          GST_VIDEO_META_API_TYPE, NULL));
+  gst_query_unref (query);
+  gst_caps_unref (caps);
+
+  /* 64x48 visible pixels of one color in a 80x60 frame of another */
+  buf = gst_buffer_new_and_alloc (stride * 60);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  for (y = 0; y < 60; y++) {
+    for (x = 0; x < 80; x++) {
+      gboolean inside = x >= 8 && x < 72 && y >= 6 && y < 54;
+
+      map.data[y * stride + x * 4 + 0] = inside ? 0x20 : 0xff;
+      map.data[y * stride + x * 4 + 1] = inside ? 0x40 : 0x00;
+      map.data[y * stride + x * 4 + 2] = inside ? 0x60 : 0xff;
+      map.data[y * stride + x * 4 + 3] = 0;
+    }
+  }
+  gst_buffer_unmap (buf, &map);
+  vmeta = gst_buffer_add_video_meta (buf, GST_VIDEO_FRAME_FLAG_NONE,
+      GST_VIDEO_FORMAT_RGBx, 80, 60);
+  vmeta->stride[0] = stride;
+  crop = gst_buffer_add_video_crop_meta (buf);
+  crop->x = 8;
+  crop->y = 6;
+  crop->width = 64;
+  crop->height = 48;
+
+  outbuf = gst_harness_push_and_pull (h, buf);
+  fail_unless (outbuf != NULL);
+  fail_unless (gst_buffer_get_video_crop_meta (outbuf) == NULL);
+
+  /* only the visible pixels are scaled */
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_RGBx, 32, 24);
+  gst_buffer_map (outbuf, &map, GST_MAP_READ);
+  for (y = 0; y < 24; y++) {
+    guint8 *p = map.data + y * GST_VIDEO_INFO_PLANE_STRIDE (&info, 0);
+
+    for (x = 0; x < 32; x++) {
+      fail_unless_equals_int (p[x * 4 + 0], 0x20);
+      fail_unless_equals_int (p[x * 4 + 1], 0x40);
+      fail_unless_equals_int (p[x * 4 + 2], 0x60);
+    }
+  }
+  gst_buffer_unmap (outbuf, &map);
+  gst_buffer_unref (outbuf);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 #endif /* !defined(VSCALE_TEST_GROUP) */
 
 static Suite *
@@ -944,6 +1021,7 @@ videoscale_suite (void)
   tcase_add_test (tc_chain, test_reverse_negotiation);
 #endif
   tcase_add_test (tc_chain, test_basetransform_negotiation);
+  tcase_add_test (tc_chain, test_crop_meta);
 #else
 #if VSCALE_TEST_GROUP == 1
   tcase_add_test (tc_chain, test_downscale_640x480_320x240_method_0);
@@ -29,6 +29,7 @@
 
 #include <gst/audio/audio.h>
 #include <string.h>
+#include <math.h>
 
 static GstBuffer *
 make_buffer (guint8 ** _data)
@@ -1528,6 +1529,566 @@ GST_START_TEST (test_audio_make_raw_caps)
 
 GST_END_TEST;
 
+#define RESAMPLER_IN_FRAMES 4096
+/* private option of the resampler to use the C functions */
+#define RESAMPLER_OPT_NO_SIMD "GstAudioResampler.no-simd"
+
+static gdouble *
+resample_sine (GstAudioFormat format, GstAudioResamplerFilterMode mode,
+    GstAudioResamplerFilterInterpolation interpolation, gboolean no_simd,
+    gsize * n_out)
+{
+  GstAudioResampler *resampler;
+  GstStructure *options;
+  gpointer in, out;
+  gdouble *res, scale;
+  gsize i, in_frames = RESAMPLER_IN_FRAMES, out_frames;
+  gint bps;
+
+  bps = GST_AUDIO_FORMAT_INFO_WIDTH (gst_audio_format_get_info (format)) / 8;
+  options = gst_structure_new_empty ("options");
+  gst_audio_resampler_options_set_quality (GST_AUDIO_RESAMPLER_METHOD_KAISER,
+      GST_AUDIO_RESAMPLER_QUALITY_DEFAULT, 48000, 44100, options);
+  gst_structure_set (options,
+      GST_AUDIO_RESAMPLER_OPT_FILTER_MODE, GST_TYPE_AUDIO_RESAMPLER_FILTER_MODE,
+      mode, GST_AUDIO_RESAMPLER_OPT_FILTER_INTERPOLATION,
+      GST_TYPE_AUDIO_RESAMPLER_FILTER_INTERPOLATION, interpolation,
+      RESAMPLER_OPT_NO_SIMD, G_TYPE_BOOLEAN, no_simd, NULL);
+
+  resampler = gst_audio_resampler_new (GST_AUDIO_RESAMPLER_METHOD_KAISER,
+      GST_AUDIO_RESAMPLER_FLAG_NONE, format, 1, 48000, 44100, options);
+  fail_unless (resampler != NULL);
+  gst_structure_free (options);
+
+  scale = format == GST_AUDIO_FORMAT_S16 ? G_MAXINT16 :
+      format == GST_AUDIO_FORMAT_S32 ? G_MAXINT32 : 1.0;
+
+  in = g_malloc (in_frames * bps);
+  for (i = 0; i < in_frames; i++) {
+    gdouble v = 0.5 * sin (2.0 * G_PI * 1000.0 * i / 48000.0);
+
+    switch (format) {
+      case GST_AUDIO_FORMAT_S16:
+        ((gint16 *) in)[i] = (gint16) lrint (v * scale);
+        break;
+      case GST_AUDIO_FORMAT_S32:
+        ((gint32 *) in)[i] = (gint32) lrint (v * scale);
+        break;
+      case GST_AUDIO_FORMAT_F32:
+        ((gfloat *) in)[i] = v;
+        break;
+      default:
+        ((gdouble *) in)[i] = v;
+        break;
+    }
+  }
+
+  out_frames = gst_audio_resampler_get_out_frames (resampler, in_frames);
+  out = g_malloc (out_frames * bps);
+  gst_audio_resampler_resample (resampler, &in, in_frames, &out, out_frames);
+
+  res = g_new (gdouble, out_frames);
+  for (i = 0; i < out_frames; i++) {
+    switch (format) {
+      case GST_AUDIO_FORMAT_S16:
+        res[i] = ((gint16 *) out)[i] / scale;
+        break;
+      case GST_AUDIO_FORMAT_S32:
+        res[i] = ((gint32 *) out)[i] / scale;
+        break;
+      case GST_AUDIO_FORMAT_F32:
+        res[i] = ((gfloat *) out)[i];
+        break;
+      default:
+        res[i] = ((gdouble *) out)[i];
+        break;
+    }
+  }
+  *n_out = out_frames;
+
+  g_free (in);
+  g_free (out);
+  gst_audio_resampler_free (resampler);
+
+  return res;
+}
+
+/* The resampler uses the SIMD functions for the CPU it runs on. For each
+ * sample format and filter mode, these must give the output of the C
+ * functions up to rounding: 2 steps for S16, 1e-6 for S32, 1e-5 for F32 and
+ * 1e-9 for F64. The C functions of all formats compute the same as those for
+ * doubles, up to the precision of the format. */
+GST_START_TEST (test_audio_resampler_formats)
+{
+  static const struct
+  {
+    GstAudioResamplerFilterMode mode;
+    GstAudioResamplerFilterInterpolation interpolation;
+  } modes[] = {
+    {GST_AUDIO_RESAMPLER_FILTER_MODE_FULL,
+        GST_AUDIO_RESAMPLER_FILTER_INTERPOLATION_NONE},
+    {GST_AUDIO_RESAMPLER_FILTER_MODE_INTERPOLATED,
+        GST_AUDIO_RESAMPLER_FILTER_INTERPOLATION_LINEAR},
+    {GST_AUDIO_RESAMPLER_FILTER_MODE_INTERPOLATED,
+        GST_AUDIO_RESAMPLER_FILTER_INTERPOLATION_CUBIC},
+  };
+  static const struct
+  {
+    GstAudioFormat format;
+    gdouble tolerance;
+    /* the integer SIMD functions round like the C ones and must give the
+     * same samples, the float ones sum in another order */
+    gdouble simd_tolerance;
+  } formats[] = {
+    {GST_AUDIO_FORMAT_S16, 4.0 / G_MAXINT16, 0.0},
+    {GST_AUDIO_FORMAT_S32, 1e-6, 0.0},
+    {GST_AUDIO_FORMAT_F32, 1e-5, 1e-5},
+    {GST_AUDIO_FORMAT_F64, 0.0, 1e-9},
+  };
+  gdouble *full = NULL, *ref, *res, *c;
+  gsize n_full = 0, n_ref, n_res, n_c, i, j, k;
+
+  for (i = 0; i < G_N_ELEMENTS (modes); i++) {
+    gdouble energy = 0.0;
+
+    ref = resample_sine (GST_AUDIO_FORMAT_F64, modes[i].mode,
+        modes[i].interpolation, TRUE, &n_ref);
+    fail_unless (n_ref > RESAMPLER_IN_FRAMES / 2);
+
+    /* skip the filter latency, the rest is a sine with amplitude 0.5 */
+    for (k = n_ref / 2; k < n_ref; k++)
+      energy += ref[k] * ref[k];
+    fail_unless (fabs (sqrt (energy / (n_ref - n_ref / 2)) - 0.5 / G_SQRT2) <
+        5e-3);
+
+    /* the interpolated filters are close to the full filter */
+    if (full == NULL) {
+      full = ref;
+      n_full = n_ref;
+    } else {
+      fail_unless_equals_int (n_ref, n_full);
+      for (k = 0; k < n_ref; k++)
+        fail_unless (fabs (ref[k] - full[k]) < 1e-2,
+            "mode %" G_GSIZE_FORMAT " sample %" G_GSIZE_FORMAT ": %f != %f",
+            i, k, ref[k], full[k]);
+    }
+
+    for (j = 0; j < G_N_ELEMENTS (formats); j++) {
+      c = resample_sine (formats[j].format, modes[i].mode,
+          modes[i].interpolation, TRUE, &n_c);
+      fail_unless_equals_int (n_c, n_ref);
+      res = resample_sine (formats[j].format, modes[i].mode,
+          modes[i].interpolation, FALSE, &n_res);
+      fail_unless_equals_int (n_res, n_c);
+
+      for (k = 0; k < n_res; k++) {
+        fail_unless (fabs (c[k] - ref[k]) <= formats[j].tolerance,
+            "format %s mode %" G_GSIZE_FORMAT " sample %" G_GSIZE_FORMAT
+            ": %f != %f", gst_audio_format_to_string (formats[j].format), i,
+            k, c[k], ref[k]);
+        fail_unless (fabs (res[k] - c[k]) <= formats[j].simd_tolerance,
+            "SIMD format %s mode %" G_GSIZE_FORMAT " sample %" G_GSIZE_FORMAT
+            ": %g != %g", gst_audio_format_to_string (formats[j].format), i,
+            k, res[k], c[k]);
+      }
+      g_free (c);
+      g_free (res);
+    }
+
+    if (ref != full)
+      g_free (ref);
+  }
+  g_free (full);
+}
+
+GST_END_TEST;
+
+#define THREADS_CHANNELS 13
+#define THREADS_CHUNK 1000
+#define THREADS_N_CHUNKS 4
+
+static guint8 *
+resample_channels (GstAudioFormat format, GstAudioResamplerFlags flags,
+    GstAudioResamplerFilterMode mode, guint n_threads, gsize * size)
+{
+  GstAudioResampler *resampler;
+  GstStructure *options;
+  gint bps, c, chunk;
+  gsize i, out_frames, offset = 0;
+  guint8 *in, *res;
+
+  bps = GST_AUDIO_FORMAT_INFO_WIDTH (gst_audio_format_get_info (format)) / 8;
+
+  options = gst_structure_new_empty ("options");
+  gst_audio_resampler_options_set_quality (GST_AUDIO_RESAMPLER_METHOD_KAISER,
+      GST_AUDIO_RESAMPLER_QUALITY_DEFAULT, 48000, 44100, options);
+  gst_structure_set (options,
+      GST_AUDIO_RESAMPLER_OPT_FILTER_MODE, GST_TYPE_AUDIO_RESAMPLER_FILTER_MODE,
+      mode, GST_AUDIO_RESAMPLER_OPT_THREADS, G_TYPE_UINT, n_threads, NULL);
+
+  resampler = gst_audio_resampler_new (GST_AUDIO_RESAMPLER_METHOD_KAISER,
+      flags, format, THREADS_CHANNELS, 48000, 44100, options);
+  fail_unless (resampler != NULL);
+  gst_structure_free (options);
+
+  in = g_malloc (THREADS_CHUNK * THREADS_CHANNELS * bps);
+  *size = 0;
+  res = NULL;
+
+  for (chunk = 0; chunk < THREADS_N_CHUNKS; chunk++) {
+    gpointer in_ptrs[THREADS_CHANNELS], out_ptrs[THREADS_CHANNELS];
+
+    /* a different frequency in each channel, interleaved or not, the
+     * resampler only cares about the pointers */
+    for (c = 0; c < THREADS_CHANNELS; c++) {
+      for (i = 0; i < THREADS_CHUNK; i++) {
+        gdouble v = 0.5 * sin (2.0 * G_PI * (200.0 + 300.0 * c) *
+            (chunk * THREADS_CHUNK + i) / 48000.0);
+        gsize idx = (flags & GST_AUDIO_RESAMPLER_FLAG_NON_INTERLEAVED_IN) ?
+            c * THREADS_CHUNK + i : i * THREADS_CHANNELS + c;
+
+        if (format == GST_AUDIO_FORMAT_S16)
+          ((gint16 *) in)[idx] = (gint16) lrint (v * G_MAXINT16);
+        else
+          ((gfloat *) in)[idx] = v;
+      }
+      in_ptrs[c] = in + c * THREADS_CHUNK * bps;
+    }
+    if (!(flags & GST_AUDIO_RESAMPLER_FLAG_NON_INTERLEAVED_IN))
+      in_ptrs[0] = in;
+
+    out_frames = gst_audio_resampler_get_out_frames (resampler, THREADS_CHUNK);
+    res = g_realloc (res, *size + out_frames * THREADS_CHANNELS * bps);
+    for (c = 0; c < THREADS_CHANNELS; c++)
+      out_ptrs[c] = res + offset + c * out_frames * bps;
+    if (!(flags & GST_AUDIO_RESAMPLER_FLAG_NON_INTERLEAVED_OUT))
+      out_ptrs[0] = res + offset;
+
+    gst_audio_resampler_resample (resampler, in_ptrs, THREADS_CHUNK, out_ptrs,
+        out_frames);
+
+    offset += out_frames * THREADS_CHANNELS * bps;
+    *size = offset;
+  }
+
+  g_free (in);
+  gst_audio_resampler_free (resampler);
+
+  return res;
+}
+
+GST_START_TEST (test_audio_resampler_threads)
+{
+  static const GstAudioResamplerFlags flags[] = {
+    GST_AUDIO_RESAMPLER_FLAG_NONE,
+    GST_AUDIO_RESAMPLER_FLAG_NON_INTERLEAVED_IN |
+        GST_AUDIO_RESAMPLER_FLAG_NON_INTERLEAVED_OUT,
+  };
+  static const GstAudioResamplerFilterMode modes[] = {
+    GST_AUDIO_RESAMPLER_FILTER_MODE_FULL,
+    GST_AUDIO_RESAMPLER_FILTER_MODE_INTERPOLATED,
+  };
+  static const GstAudioFormat formats[] = {
+    GST_AUDIO_FORMAT_S16, GST_AUDIO_FORMAT_F32
+  };
+  static const guint n_threads[] = { 2, 4, THREADS_CHANNELS, 0 };
+  gint f, m, l, t;
+
+  for (f = 0; f < G_N_ELEMENTS (formats); f++) {
+    for (m = 0; m < G_N_ELEMENTS (modes); m++) {
+      for (l = 0; l < G_N_ELEMENTS (flags); l++) {
+        guint8 *ref, *res;
+        gsize ref_size, res_size;
+
+        ref = resample_channels (formats[f], flags[l], modes[m], 1, &ref_size);
+        fail_unless (ref_size > 0);
+
+        for (t = 0; t < G_N_ELEMENTS (n_threads); t++) {
+          res = resample_channels (formats[f], flags[l], modes[m],
+              n_threads[t], &res_size);
+          fail_unless_equals_int (res_size, ref_size);
+          fail_unless (memcmp (res, ref, ref_size) == 0,
+              "format %d mode %d flags %d threads %u differ", formats[f],
+              modes[m], flags[l], n_threads[t]);
+          g_free (res);
+        }
+        g_free (ref);
+      }
+    }
+  }
+}
+
+GST_END_TEST;
+
+static GstAudioConverter *
+make_converter (GstAudioFormat in_format, gint in_channels,
+    GstAudioFormat out_format, gint out_channels)
+{
+  GstAudioInfo in_info, out_info;
+
+  gst_audio_info_set_format (&in_info, in_format, 48000, in_channels, NULL);
+  gst_audio_info_set_format (&out_info, out_format, 48000, out_channels, NULL);
+
+  return gst_audio_converter_new (0, &in_info, &out_info, NULL);
+}
+
+GST_START_TEST (test_audio_converter_fast_paths)
+{
+  static const gfloat fin[] = { 1.0, -1.0, 2.0, -2.0, 0.5, -0.5, 0.0, -0.25 };
+  static const gint16 fout[] = { 32767, -32768, 32767, -32768, 16384, -16384,
+    0, -8192
+  };
+  GstAudioConverter *to_f32, *to_s16, *to_s32, *from_s32;
+  gint16 *s16, *res16;
+  gint32 *s32;
+  gfloat *f32;
+  gpointer in[1], out[1];
+  gint i;
+
+  s16 = g_new (gint16, 65536);
+  res16 = g_new (gint16, 65536);
+  s32 = g_new (gint32, 65536);
+  f32 = g_new (gfloat, 65536);
+
+  for (i = 0; i < 65536; i++)
+    s16[i] = i - 32768;
+
+  to_f32 = make_converter (GST_AUDIO_FORMAT_S16, 2, GST_AUDIO_FORMAT_F32, 2);
+  to_s16 = make_converter (GST_AUDIO_FORMAT_F32, 2, GST_AUDIO_FORMAT_S16, 2);
+  fail_unless (to_f32 != NULL && to_s16 != NULL);
+
+  /* S16 -> F32 is exact and converting back yields the same samples */
+  in[0] = s16;
+  out[0] = f32;
+  fail_unless (gst_audio_converter_samples (to_f32, 0, in, 32768, out,
+          32768));
+  for (i = 0; i < 65536; i++)
+    fail_unless_equals_float (f32[i], s16[i] / 32768.0);
+
+  in[0] = f32;
+  out[0] = res16;
+  fail_unless (gst_audio_converter_samples (to_s16, 0, in, 32768, out,
+          32768));
+  fail_unless (memcmp (res16, s16, 65536 * sizeof (gint16)) == 0);
+
+  /* rounding and clipping */
+  memcpy (f32, fin, sizeof (fin));
+  fail_unless (gst_audio_converter_samples (to_s16, 0, in,
+          G_N_ELEMENTS (fin) / 2, out, G_N_ELEMENTS (fin) / 2));
+  for (i = 0; i < G_N_ELEMENTS (fin) / 2 * 2; i++)
+    fail_unless_equals_int (res16[i], fout[i]);
+
+  /* silence */
+  fail_unless (gst_audio_converter_samples (to_f32, 0, NULL, 16, out, 16));
+  for (i = 0; i < 32; i++)
+    fail_unless_equals_float (f32[i], 0.0);
+
+  gst_audio_converter_free (to_f32);
+  gst_audio_converter_free (to_s16);
+
+  /* S16 -> S32 -> S16 and S32 -> F32 */
+  to_s32 = make_converter (GST_AUDIO_FORMAT_S16, 1, GST_AUDIO_FORMAT_S32, 1);
+  to_s16 = make_converter (GST_AUDIO_FORMAT_S32, 1, GST_AUDIO_FORMAT_S16, 1);
+  from_s32 = make_converter (GST_AUDIO_FORMAT_S32, 1, GST_AUDIO_FORMAT_F32, 1);
+
+  in[0] = s16;
+  out[0] = s32;
+  fail_unless (gst_audio_converter_samples (to_s32, 0, in, 65536, out,
+          65536));
+  for (i = 0; i < 65536; i++)
+    fail_unless_equals_int (s32[i], s16[i] * 65536);
+
+  in[0] = s32;
+  out[0] = res16;
+  fail_unless (gst_audio_converter_samples (to_s16, 0, in, 65536, out,
+          65536));
+  fail_unless (memcmp (res16, s16, 65536 * sizeof (gint16)) == 0);
+
+  out[0] = f32;
+  fail_unless (gst_audio_converter_samples (from_s32, 0, in, 65536, out,
+          65536));
+  for (i = 0; i < 65536; i++)
+    fail_unless_equals_float (f32[i], s16[i] / 32768.0);
+
+  gst_audio_converter_free (to_s32);
+  gst_audio_converter_free (to_s16);
+  gst_audio_converter_free (from_s32);
+
+  g_free (s16);
+  g_free (res16);
+  g_free (s32);
+  g_free (f32);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_audio_converter_readonly_input)
+{
+  GstAudioConverter *convert;
+  gint32 in_data[64], orig[64];
+  gfloat fin[32], fout[64];
+  guint8 out24[64 * 3];
+  gpointer in[1], out[1];
+  gint i;
+
+  for (i = 0; i < 64; i++)
+    orig[i] = in_data[i] = (i - 32) * 0x01234567;
+
+  /* the quantizer works in place on the unpacked samples, a read-only
+   * input must not be modified */
+  convert = make_converter (GST_AUDIO_FORMAT_S32, 2, GST_AUDIO_FORMAT_S24, 2);
+  in[0] = in_data;
+  out[0] = out24;
+  fail_unless (gst_audio_converter_samples (convert, 0, in, 32, out, 32));
+  fail_unless (memcmp (in_data, orig, sizeof (orig)) == 0);
+  gst_audio_converter_free (convert);
+
+  /* channel mixing reads the input samples directly */
+  for (i = 0; i < 32; i++)
+    fin[i] = (i - 16) / 16.0;
+
+  convert = make_converter (GST_AUDIO_FORMAT_F32, 1, GST_AUDIO_FORMAT_F32, 2);
+  in[0] = fin;
+  out[0] = fout;
+  fail_unless (gst_audio_converter_samples (convert, 0, in, 32, out, 32));
+  for (i = 0; i < 32; i++) {
+    fail_unless_equals_float (fout[2 * i], fout[2 * i + 1]);
+    fail_unless_equals_float (fin[i], (i - 16) / 16.0);
+  }
+  gst_audio_converter_free (convert);
+}
+
+GST_END_TEST;
+
+#define MIXER_SAMPLES 67
+
+static gfloat **
+copy_mix_matrix (const gfloat * m, gint in_channels, gint out_channels)
+{
+  gfloat **matrix = g_new (gfloat *, in_channels);
+  gint i, j;
+
+  for (i = 0; i < in_channels; i++) {
+    matrix[i] = g_new (gfloat, out_channels);
+    for (j = 0; j < out_channels; j++)
+      matrix[i][j] = m[j * in_channels + i];
+  }
+  return matrix;
+}
+
+/* mix with the given matrix, one row per output channel, and compare
+ * against a straightforward implementation */
+static void
+check_channel_mixer (const gfloat * m, gint in_channels, gint out_channels,
+    GstAudioFormat format, GstAudioChannelMixerFlags flags)
+{
+  GstAudioChannelMixer *mix;
+  gint16 in16[8 * MIXER_SAMPLES], out16[8 * MIXER_SAMPLES];
+  gfloat inf[8 * MIXER_SAMPLES], outf[8 * MIXER_SAMPLES];
+  gpointer in[8], out[8];
+  gboolean in_planar, out_planar, is_int;
+  gint i, j, n;
+
+  is_int = format == GST_AUDIO_FORMAT_S16;
+  in_planar = flags & GST_AUDIO_CHANNEL_MIXER_FLAGS_NON_INTERLEAVED_IN;
+  out_planar = flags & GST_AUDIO_CHANNEL_MIXER_FLAGS_NON_INTERLEAVED_OUT;
+
+  for (i = 0; i < in_channels * MIXER_SAMPLES; i++) {
+    in16[i] = (i * 7919) % 65536 - 32768;
+    inf[i] = in16[i] / 32768.0;
+  }
+  for (i = 0; i < 8; i++) {
+    if (is_int) {
+      in[i] = in_planar ? in16 + i * MIXER_SAMPLES : in16;
+      out[i] = out_planar ? out16 + i * MIXER_SAMPLES : out16;
+    } else {
+      in[i] = in_planar ? inf + i * MIXER_SAMPLES : inf;
+      out[i] = out_planar ? outf + i * MIXER_SAMPLES : outf;
+    }
+  }
+
+  mix = gst_audio_channel_mixer_new_with_matrix (flags, format, in_channels,
+      out_channels, copy_mix_matrix (m, in_channels, out_channels));
+  fail_unless (mix != NULL);
+  gst_audio_channel_mixer_samples (mix, in, out, MIXER_SAMPLES);
+  gst_audio_channel_mixer_free (mix);
+
+  for (n = 0; n < MIXER_SAMPLES; n++) {
+    for (j = 0; j < out_channels; j++) {
+      gint o = out_planar ? j * MIXER_SAMPLES + n : n * out_channels + j;
+
+      if (is_int) {
+        gint32 res = 0;
+
+        for (i = 0; i < in_channels; i++) {
+          gint idx = in_planar ? i * MIXER_SAMPLES + n : n * in_channels + i;
+          res += in16[idx] * (gint32) (m[j * in_channels + i] * 1024);
+        }
+        res = CLAMP ((res + 512) >> 10, G_MININT16, G_MAXINT16);
+        fail_unless_equals_int (out16[o], res);
+      } else {
+        gfloat res = 0.0;
+
+        for (i = 0; i < in_channels; i++) {
+          gint idx = in_planar ? i * MIXER_SAMPLES + n : n * in_channels + i;
+          res += inf[idx] * m[j * in_channels + i];
+        }
+        fail_unless (fabs (outf[o] - res) < 1e-6,
+            "sample %d channel %d: %f != %f", n, j, outf[o], res);
+      }
+    }
+  }
+}
+
+GST_START_TEST (test_audio_channel_mixer_matrices)
+{
+  /* channel reorder with a silent and a duplicated output */
+  static const gfloat permute[] = {
+    0, 1, 0, 0,
+    1, 0, 0, 0,
+    0, 0, 0, 0,
+    0, 0, 0, 1,
+    0, 0, 0, 1,
+  };
+  static const gfloat gain[] = {
+    0.5, 0, 0, 0,
+    0, -0.25, 0, 0,
+    0, 0, 1, 0,
+    0, 0, 0, 0.75,
+  };
+  /* 5.1 to stereo */
+  static const gfloat downmix[] = {
+    0.4142, 0, 0.2929, 0, 0.2929, 0,
+    0, 0.4142, 0.2929, 0, 0, 0.2929,
+  };
+  static const gfloat dense[] = {
+    0.3, 0.6, -0.1,
+    0.2, -0.5, 0.3,
+  };
+  static const GstAudioFormat formats[] = {
+    GST_AUDIO_FORMAT_S16, GST_AUDIO_FORMAT_F32
+  };
+  gint f, l;
+
+  for (f = 0; f < G_N_ELEMENTS (formats); f++) {
+    for (l = 0; l < 4; l++) {
+      GstAudioChannelMixerFlags flags = 0;
+
+      if (l & 1)
+        flags |= GST_AUDIO_CHANNEL_MIXER_FLAGS_NON_INTERLEAVED_IN;
+      if (l & 2)
+        flags |= GST_AUDIO_CHANNEL_MIXER_FLAGS_NON_INTERLEAVED_OUT;
+
+      check_channel_mixer (permute, 4, 5, formats[f], flags);
+      check_channel_mixer (gain, 4, 4, formats[f], flags);
+      check_channel_mixer (downmix, 6, 2, formats[f], flags);
+      check_channel_mixer (dense, 3, 2, formats[f], flags);
+    }
+  }
+}
+
+GST_END_TEST;
+
 static Suite *
 audio_suite (void)
 {
@@ -1564,6 +2125,11 @@ audio_suite (void)
   tcase_add_test (tc_chain, test_audio_buffer_and_audio_meta);
   tcase_add_test (tc_chain, test_audio_info_from_caps);
   tcase_add_test (tc_chain, test_audio_make_raw_caps);
+  tcase_add_test (tc_chain, test_audio_resampler_formats);
+  tcase_add_test (tc_chain, test_audio_resampler_threads);
+  tcase_add_test (tc_chain, test_audio_converter_fast_paths);
+  tcase_add_test (tc_chain, test_audio_converter_readonly_input);
+  tcase_add_test (tc_chain, test_audio_channel_mixer_matrices);
 
   return s;
 }
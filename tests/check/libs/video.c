@@ -1228,6 +1228,122 @@ GST_START_TEST (test_convert_frame_async_error)
 
 GST_END_TEST;
 
+GST_START_TEST (test_convert_frame_cache)
+{
+  GstVideoConvertSampleCache *cache;
+  GstVideoInfo vinfo, out_info;
+  GstCaps *from_caps, *to_caps;
+  GstBuffer *from_buffer;
+  GstSample *from_sample, *to_sample;
+  GError *error = NULL;
+  GstVideoFrame frame;
+  GstMapInfo map;
+  guint8 *pixel;
+  gint i;
+
+  gst_debug_set_threshold_for_name ("default", GST_LEVEL_NONE);
+
+  from_buffer = gst_buffer_new_and_alloc (640 * 480 * 4);
+
+  gst_buffer_map (from_buffer, &map, GST_MAP_WRITE);
+  for (i = 0; i < 640 * 480; i++) {
+    map.data[4 * i + 0] = 0;    /* x */
+    map.data[4 * i + 1] = 255;  /* R */
+    map.data[4 * i + 2] = 0;    /* G */
+    map.data[4 * i + 3] = 0;    /* B */
+  }
+  gst_buffer_unmap (from_buffer, &map);
+  GST_BUFFER_PTS (from_buffer) = 5 * GST_SECOND;
+
+  gst_video_info_init (&vinfo);
+  fail_unless (gst_video_info_set_format (&vinfo, GST_VIDEO_FORMAT_xRGB, 640,
+          480));
+  vinfo.fps_n = 25;
+  vinfo.fps_d = 1;
+  vinfo.par_n = 1;
+  vinfo.par_d = 1;
+  from_caps = gst_video_info_to_caps (&vinfo);
+
+  from_sample = gst_sample_new (from_buffer, from_caps, NULL, NULL);
+
+  /* the height is chosen to keep the display aspect ratio */
+  to_caps = gst_caps_from_string ("video/x-raw, format=(string)RGB, "
+      "width=(int)320, pixel-aspect-ratio=(fraction)1/1");
+
+  cache = gst_video_convert_sample_cache_new (2);
+
+  for (i = 0; i < 3; i++) {
+    to_sample = gst_video_convert_sample_cache_convert (cache, from_sample,
+        to_caps, GST_CLOCK_TIME_NONE, &error);
+    fail_unless (to_sample != NULL);
+    fail_unless (error == NULL);
+
+    fail_unless (gst_video_info_from_caps (&out_info,
+            gst_sample_get_caps (to_sample)));
+    fail_unless_equals_int (GST_VIDEO_INFO_FORMAT (&out_info),
+        GST_VIDEO_FORMAT_RGB);
+    fail_unless_equals_int (GST_VIDEO_INFO_WIDTH (&out_info), 320);
+    fail_unless_equals_int (GST_VIDEO_INFO_HEIGHT (&out_info), 240);
+    fail_unless_equals_int (GST_VIDEO_INFO_FPS_N (&out_info), 25);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (gst_sample_get_buffer
+            (to_sample)), 5 * GST_SECOND);
+
+    fail_unless (gst_video_frame_map (&frame, &out_info,
+            gst_sample_get_buffer (to_sample), GST_MAP_READ));
+    pixel = GST_VIDEO_FRAME_PLANE_DATA (&frame, 0);
+    pixel += 120 * GST_VIDEO_FRAME_PLANE_STRIDE (&frame, 0) + 160 * 3;
+    fail_unless_equals_int (pixel[0], 255);
+    fail_unless_equals_int (pixel[1], 0);
+    fail_unless_equals_int (pixel[2], 0);
+    gst_video_frame_unmap (&frame);
+
+    gst_sample_unref (to_sample);
+  }
+  gst_caps_unref (to_caps);
+
+  /* black borders are added to keep the display aspect ratio */
+  to_caps = gst_caps_from_string ("video/x-raw, format=(string)RGB, "
+      "width=(int)320, height=(int)320, pixel-aspect-ratio=(fraction)1/1");
+
+  to_sample = gst_video_convert_sample_cache_convert (cache, from_sample,
+      to_caps, GST_CLOCK_TIME_NONE, &error);
+  fail_unless (to_sample != NULL);
+  fail_unless (error == NULL);
+
+  fail_unless (gst_video_info_from_caps (&out_info,
+          gst_sample_get_caps (to_sample)));
+  fail_unless (gst_video_frame_map (&frame, &out_info,
+          gst_sample_get_buffer (to_sample), GST_MAP_READ));
+  pixel = GST_VIDEO_FRAME_PLANE_DATA (&frame, 0);
+  fail_unless_equals_int (pixel[0], 0);
+  pixel += 160 * GST_VIDEO_FRAME_PLANE_STRIDE (&frame, 0) + 160 * 3;
+  fail_unless_equals_int (pixel[0], 255);
+  gst_video_frame_unmap (&frame);
+
+  gst_sample_unref (to_sample);
+  gst_caps_unref (to_caps);
+
+  /* and errors are reported like without cache */
+  to_caps =
+      gst_caps_from_string
+      ("something/that, does=(string)not, exist=(boolean)FALSE");
+
+  to_sample = gst_video_convert_sample_cache_convert (cache, from_sample,
+      to_caps, GST_CLOCK_TIME_NONE, &error);
+  fail_if (to_sample != NULL);
+  fail_unless (error != NULL);
+  g_error_free (error);
+
+  gst_caps_unref (to_caps);
+  gst_video_convert_sample_cache_free (cache);
+
+  gst_buffer_unref (from_buffer);
+  gst_caps_unref (from_caps);
+  gst_sample_unref (from_sample);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_video_size_from_caps)
 {
   GstVideoInfo vinfo;
@@ -2413,6 +2529,57 @@ GST_START_TEST (test_video_scaler)
 
 GST_END_TEST;
 
+GST_START_TEST (test_video_scaler_shared_tables)
+{
+  GstVideoScaler *scale1, *scale2, *scale3;
+  GstStructure *options;
+  const gdouble *coeff1, *coeff2, *coeff3;
+  guint8 src[16], dest1[8], dest2[8];
+  guint i, in_offset, n_taps;
+
+  for (i = 0; i < 16; i++)
+    src[i] = i * 16;
+
+  scale1 = gst_video_scaler_new (GST_VIDEO_RESAMPLER_METHOD_CUBIC,
+      GST_VIDEO_SCALER_FLAG_NONE, 0, 16, 8, NULL);
+  scale2 = gst_video_scaler_new (GST_VIDEO_RESAMPLER_METHOD_CUBIC,
+      GST_VIDEO_SCALER_FLAG_NONE, 0, 16, 8, NULL);
+
+  /* scalers with the same parameters share their coefficients */
+  coeff1 = gst_video_scaler_get_coeff (scale1, 3, &in_offset, &n_taps);
+  coeff2 = gst_video_scaler_get_coeff (scale2, 3, NULL, NULL);
+  fail_unless (coeff1 == coeff2);
+
+  /* and scale the same */
+  gst_video_scaler_horizontal (scale1, GST_VIDEO_FORMAT_GRAY8, src, dest1, 0,
+      8);
+  gst_video_scaler_horizontal (scale2, GST_VIDEO_FORMAT_GRAY8, src, dest2, 0,
+      8);
+  fail_unless (memcmp (dest1, dest2, sizeof (dest1)) == 0);
+
+  /* other options give other coefficients */
+  options = gst_structure_new ("options",
+      GST_VIDEO_RESAMPLER_OPT_CUBIC_B, G_TYPE_DOUBLE, 0.0,
+      GST_VIDEO_RESAMPLER_OPT_CUBIC_C, G_TYPE_DOUBLE, 0.5, NULL);
+  scale3 = gst_video_scaler_new (GST_VIDEO_RESAMPLER_METHOD_CUBIC,
+      GST_VIDEO_SCALER_FLAG_NONE, 0, 16, 8, options);
+  coeff3 = gst_video_scaler_get_coeff (scale3, 3, NULL, NULL);
+  fail_unless (coeff3 != coeff1);
+  gst_structure_free (options);
+
+  /* the tables stay valid when other scalers using them are freed */
+  gst_video_scaler_free (scale1);
+  gst_video_scaler_free (scale3);
+  coeff2 = gst_video_scaler_get_coeff (scale2, 3, NULL, NULL);
+  fail_unless (coeff2 != NULL);
+  gst_video_scaler_horizontal (scale2, GST_VIDEO_FORMAT_GRAY8, src, dest2, 0,
+      8);
+  fail_unless (memcmp (dest1, dest2, sizeof (dest1)) == 0);
+  gst_video_scaler_free (scale2);
+}
+
+GST_END_TEST;
+
 typedef enum
 {
   RGB,
@@ -2719,6 +2886,819 @@ GST_START_TEST (test_video_convert)
 
 GST_END_TEST;
 
+static void
+task_pool_count_func (gpointer user_data)
+{
+  gint *counter = user_data;
+
+  g_atomic_int_inc (counter);
+}
+
+GST_START_TEST (test_video_task_pool)
+{
+  GstVideoTaskPool *pool, *shared1, *shared2;
+  gint counters[16] = { 0, };
+  gpointer tasks[16];
+  guint i, j;
+
+  for (i = 0; i < G_N_ELEMENTS (tasks); i++)
+    tasks[i] = &counters[i];
+
+  pool = gst_video_task_pool_new (3);
+  fail_unless_equals_int (gst_video_task_pool_get_n_threads (pool), 3);
+
+  /* each task must run exactly once per job, whatever the number of tasks */
+  for (j = 0; j <= G_N_ELEMENTS (tasks); j++) {
+    memset (counters, 0, sizeof (counters));
+    gst_video_task_pool_run (pool, task_pool_count_func, tasks, j);
+    for (i = 0; i < G_N_ELEMENTS (tasks); i++)
+      fail_unless_equals_int (counters[i], i < j ? 1 : 0);
+  }
+  gst_video_task_pool_unref (pool);
+
+  shared1 = gst_video_task_pool_get_shared ();
+  shared2 = gst_video_task_pool_get_shared ();
+  fail_unless (shared1 == shared2);
+  gst_video_task_pool_unref (shared1);
+  gst_video_task_pool_unref (shared2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_video_convert_with_pool)
+{
+  GstVideoInfo ininfo, outinfo;
+  GstVideoFrame inframe, outframe, refframe;
+  GstBuffer *inbuffer, *outbuffer, *refbuffer;
+  GstVideoConverter *convert;
+  GstVideoTaskPool *pool;
+  GstMapInfo map;
+  guint i;
+
+  fail_unless (gst_video_info_set_format (&ininfo, GST_VIDEO_FORMAT_I420, 320,
+          960));
+  inbuffer = gst_buffer_new_and_alloc (ininfo.size);
+  gst_buffer_map (inbuffer, &map, GST_MAP_WRITE);
+  for (i = 0; i < map.size; i++)
+    map.data[i] = i * 7;
+  gst_buffer_unmap (inbuffer, &map);
+  gst_video_frame_map (&inframe, &ininfo, inbuffer, GST_MAP_READ);
+
+  fail_unless (gst_video_info_set_format (&outinfo, GST_VIDEO_FORMAT_BGRx, 240,
+          800));
+  outbuffer = gst_buffer_new_and_alloc (outinfo.size);
+  gst_video_frame_map (&outframe, &outinfo, outbuffer, GST_MAP_WRITE);
+  refbuffer = gst_buffer_new_and_alloc (outinfo.size);
+  gst_video_frame_map (&refframe, &outinfo, refbuffer, GST_MAP_WRITE);
+
+  convert = gst_video_converter_new (&ininfo, &outinfo,
+      gst_structure_new ("options",
+          GST_VIDEO_CONVERTER_OPT_THREADS, G_TYPE_UINT, 1, NULL));
+  gst_video_converter_frame (convert, &inframe, &refframe);
+  gst_video_converter_free (convert);
+
+  /* slices running on a pool must produce the same output */
+  pool = gst_video_task_pool_new (2);
+  convert = gst_video_converter_new_with_pool (&ininfo, &outinfo,
+      gst_structure_new ("options",
+          GST_VIDEO_CONVERTER_OPT_THREADS, G_TYPE_UINT, 4, NULL), pool);
+  gst_video_converter_frame (convert, &inframe, &outframe);
+  gst_video_converter_free (convert);
+  gst_video_task_pool_unref (pool);
+
+  fail_unless (gst_buffer_memcmp (outbuffer, 0, GST_VIDEO_FRAME_PLANE_DATA
+          (&refframe, 0), outinfo.size) == 0);
+
+  gst_video_frame_unmap (&refframe);
+  gst_buffer_unref (refbuffer);
+  gst_video_frame_unmap (&outframe);
+  gst_buffer_unref (outbuffer);
+  gst_video_frame_unmap (&inframe);
+  gst_buffer_unref (inbuffer);
+}
+
+GST_END_TEST;
+
+static void
+convert_fused_frame (GstVideoFrame * inframe, GstVideoFormat format,
+    GstVideoFrame * outframe)
+{
+  GstVideoInfo outinfo;
+  GstVideoConverter *convert;
+  GstBuffer *outbuffer;
+
+  fail_unless (gst_video_info_set_format (&outinfo, format,
+          GST_VIDEO_FRAME_WIDTH (inframe), GST_VIDEO_FRAME_HEIGHT (inframe)));
+  outbuffer = gst_buffer_new_and_alloc (outinfo.size);
+  gst_video_frame_map (outframe, &outinfo, outbuffer, GST_MAP_WRITE);
+  gst_buffer_unref (outbuffer);
+
+  convert = gst_video_converter_new (&inframe->info, &outinfo, NULL);
+  gst_video_converter_frame (convert, inframe, outframe);
+  gst_video_converter_free (convert);
+}
+
+GST_START_TEST (test_video_convert_fused)
+{
+  GstVideoInfo i420info, nv12info, yuy2info;
+  GstVideoFrame i420frame, nv12frame, yuy2frame;
+  GstVideoFrame refframe, outframe;
+  GstBuffer *buffer;
+  guint8 *sy, *su, *sv, *d, *r, *o;
+  gint i, j, width = 320, height = 240;
+
+  fail_unless (gst_video_info_set_format (&i420info, GST_VIDEO_FORMAT_I420,
+          width, height));
+  buffer = gst_buffer_new_and_alloc (i420info.size);
+  gst_video_frame_map (&i420frame, &i420info, buffer, GST_MAP_READWRITE);
+  gst_buffer_unref (buffer);
+  for (i = 0; i < height; i++) {
+    sy = (guint8 *) GST_VIDEO_FRAME_COMP_DATA (&i420frame, 0) +
+        i * GST_VIDEO_FRAME_COMP_STRIDE (&i420frame, 0);
+    for (j = 0; j < width; j++)
+      sy[j] = i * 3 + j * 5;
+  }
+  for (i = 0; i < height / 2; i++) {
+    su = (guint8 *) GST_VIDEO_FRAME_COMP_DATA (&i420frame, 1) +
+        i * GST_VIDEO_FRAME_COMP_STRIDE (&i420frame, 1);
+    sv = (guint8 *) GST_VIDEO_FRAME_COMP_DATA (&i420frame, 2) +
+        i * GST_VIDEO_FRAME_COMP_STRIDE (&i420frame, 2);
+    for (j = 0; j < width / 2; j++) {
+      su[j] = i * 7 + j;
+      sv[j] = 255 - i - j * 3;
+    }
+  }
+
+  /* the same picture in NV12 and YUY2 */
+  fail_unless (gst_video_info_set_format (&nv12info, GST_VIDEO_FORMAT_NV12,
+          width, height));
+  buffer = gst_buffer_new_and_alloc (nv12info.size);
+  gst_video_frame_map (&nv12frame, &nv12info, buffer, GST_MAP_READWRITE);
+  gst_buffer_unref (buffer);
+  fail_unless (gst_video_info_set_format (&yuy2info, GST_VIDEO_FORMAT_YUY2,
+          width, height));
+  buffer = gst_buffer_new_and_alloc (yuy2info.size);
+  gst_video_frame_map (&yuy2frame, &yuy2info, buffer, GST_MAP_READWRITE);
+  gst_buffer_unref (buffer);
+
+  for (i = 0; i < height; i++) {
+    sy = (guint8 *) GST_VIDEO_FRAME_COMP_DATA (&i420frame, 0) +
+        i * GST_VIDEO_FRAME_COMP_STRIDE (&i420frame, 0);
+    su = (guint8 *) GST_VIDEO_FRAME_COMP_DATA (&i420frame, 1) +
+        (i / 2) * GST_VIDEO_FRAME_COMP_STRIDE (&i420frame, 1);
+    sv = (guint8 *) GST_VIDEO_FRAME_COMP_DATA (&i420frame, 2) +
+        (i / 2) * GST_VIDEO_FRAME_COMP_STRIDE (&i420frame, 2);
+
+    d = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&nv12frame, 0) +
+        i * GST_VIDEO_FRAME_PLANE_STRIDE (&nv12frame, 0);
+    memcpy (d, sy, width);
+    if ((i & 1) == 0) {
+      d = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&nv12frame, 1) +
+          (i / 2) * GST_VIDEO_FRAME_PLANE_STRIDE (&nv12frame, 1);
+      for (j = 0; j < width / 2; j++) {
+        d[j * 2] = su[j];
+        d[j * 2 + 1] = sv[j];
+      }
+    }
+
+    d = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&yuy2frame, 0) +
+        i * GST_VIDEO_FRAME_PLANE_STRIDE (&yuy2frame, 0);
+    for (j = 0; j < width / 2; j++) {
+      d[j * 4] = sy[j * 2];
+      d[j * 4 + 1] = su[j];
+      d[j * 4 + 2] = sy[j * 2 + 1];
+      d[j * 4 + 3] = sv[j];
+    }
+  }
+
+  /* I420 -> BGRx is the orc fastpath, the fused kernels must give the
+   * same result */
+  convert_fused_frame (&i420frame, GST_VIDEO_FORMAT_BGRx, &refframe);
+
+  convert_fused_frame (&nv12frame, GST_VIDEO_FORMAT_BGRx, &outframe);
+  for (i = 0; i < height; i++) {
+    r = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&refframe, 0) +
+        i * GST_VIDEO_FRAME_PLANE_STRIDE (&refframe, 0);
+    o = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&outframe, 0) +
+        i * GST_VIDEO_FRAME_PLANE_STRIDE (&outframe, 0);
+    for (j = 0; j < width; j++)
+      fail_unless (memcmp (r + j * 4, o + j * 4, 3) == 0);
+  }
+  gst_video_frame_unmap (&outframe);
+
+  convert_fused_frame (&yuy2frame, GST_VIDEO_FORMAT_BGRx, &outframe);
+  for (i = 0; i < height; i++) {
+    r = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&refframe, 0) +
+        i * GST_VIDEO_FRAME_PLANE_STRIDE (&refframe, 0);
+    o = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&outframe, 0) +
+        i * GST_VIDEO_FRAME_PLANE_STRIDE (&outframe, 0);
+    for (j = 0; j < width; j++)
+      fail_unless (memcmp (r + j * 4, o + j * 4, 3) == 0);
+  }
+  gst_video_frame_unmap (&outframe);
+
+  convert_fused_frame (&i420frame, GST_VIDEO_FORMAT_RGBA, &outframe);
+  for (i = 0; i < height; i++) {
+    r = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&refframe, 0) +
+        i * GST_VIDEO_FRAME_PLANE_STRIDE (&refframe, 0);
+    o = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&outframe, 0) +
+        i * GST_VIDEO_FRAME_PLANE_STRIDE (&outframe, 0);
+    for (j = 0; j < width; j++) {
+      fail_unless_equals_int (o[j * 4 + 0], r[j * 4 + 2]);
+      fail_unless_equals_int (o[j * 4 + 1], r[j * 4 + 1]);
+      fail_unless_equals_int (o[j * 4 + 2], r[j * 4 + 0]);
+      fail_unless_equals_int (o[j * 4 + 3], 0xff);
+    }
+  }
+  gst_video_frame_unmap (&outframe);
+
+  gst_video_frame_unmap (&refframe);
+  gst_video_frame_unmap (&yuy2frame);
+  gst_video_frame_unmap (&nv12frame);
+  gst_video_frame_unmap (&i420frame);
+}
+
+GST_END_TEST;
+
+static void
+convert_color_lut_frame (GstVideoFrame * inframe, GstVideoInfo * outinfo,
+    gboolean lut, GstVideoFrame * outframe)
+{
+  GstVideoConverter *convert;
+  GstBuffer *outbuffer;
+
+  outbuffer = gst_buffer_new_and_alloc (outinfo->size);
+  gst_video_frame_map (outframe, outinfo, outbuffer, GST_MAP_WRITE);
+  gst_buffer_unref (outbuffer);
+
+  convert = gst_video_converter_new (&inframe->info, outinfo,
+      gst_structure_new ("options",
+          GST_VIDEO_CONVERTER_OPT_GAMMA_MODE, GST_TYPE_VIDEO_GAMMA_MODE,
+          GST_VIDEO_GAMMA_MODE_REMAP,
+          GST_VIDEO_CONVERTER_OPT_PRIMARIES_MODE, GST_TYPE_VIDEO_PRIMARIES_MODE,
+          GST_VIDEO_PRIMARIES_MODE_FAST,
+          GST_VIDEO_CONVERTER_OPT_COLOR_LUT, G_TYPE_BOOLEAN, lut, NULL));
+  gst_video_converter_frame (convert, inframe, outframe);
+  gst_video_converter_free (convert);
+}
+
+GST_START_TEST (test_video_convert_color_lut)
+{
+  static const GstVideoFormat formats[] = {
+    GST_VIDEO_FORMAT_AYUV, GST_VIDEO_FORMAT_AYUV64
+  };
+  GstVideoInfo ininfo, outinfo;
+  GstVideoFrame inframe, refframe, outframe;
+  GstBuffer *buffer;
+  gint f, i, j, c, width = 256, height = 64;
+
+  for (f = 0; f < G_N_ELEMENTS (formats); f++) {
+    gboolean is16 = formats[f] == GST_VIDEO_FORMAT_AYUV64;
+    gint max_diff = 0, max_diff16 = 0;
+
+    fail_unless (gst_video_info_set_format (&ininfo, formats[f], width,
+            height));
+    fail_unless (gst_video_colorimetry_from_string (&ininfo.colorimetry,
+            GST_VIDEO_COLORIMETRY_BT709));
+    outinfo = ininfo;
+    fail_unless (gst_video_colorimetry_from_string (&outinfo.colorimetry,
+            GST_VIDEO_COLORIMETRY_BT2020));
+
+    buffer = gst_buffer_new_and_alloc (ininfo.size);
+    gst_video_frame_map (&inframe, &ininfo, buffer, GST_MAP_READWRITE);
+    gst_buffer_unref (buffer);
+    for (i = 0; i < height; i++) {
+      guint8 *p = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&inframe, 0) +
+          i * GST_VIDEO_FRAME_PLANE_STRIDE (&inframe, 0);
+
+      for (j = 0; j < width; j++) {
+        guint v[4] = { 0xff, 16 + (j * 219) / 255, 16 + i * 3 + j / 8,
+          240 - i * 2 - j / 4
+        };
+
+        for (c = 0; c < 4; c++) {
+          if (is16)
+            ((guint16 *) p)[j * 4 + c] = v[c] * 257;
+          else
+            p[j * 4 + c] = v[c];
+        }
+      }
+    }
+
+    /* the table must stay close to the exact conversion */
+    convert_color_lut_frame (&inframe, &outinfo, FALSE, &refframe);
+    convert_color_lut_frame (&inframe, &outinfo, TRUE, &outframe);
+
+    for (i = 0; i < height; i++) {
+      guint8 *r = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&refframe, 0) +
+          i * GST_VIDEO_FRAME_PLANE_STRIDE (&refframe, 0);
+      guint8 *o = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&outframe, 0) +
+          i * GST_VIDEO_FRAME_PLANE_STRIDE (&outframe, 0);
+
+      for (j = 0; j < width * 4; j++) {
+        gint diff;
+
+        if (is16) {
+          diff = ABS (((guint16 *) r)[j] - ((guint16 *) o)[j]);
+          max_diff16 = MAX (max_diff16, diff);
+          diff >>= 8;
+        } else {
+          diff = ABS (r[j] - o[j]);
+        }
+        max_diff = MAX (max_diff, diff);
+      }
+    }
+    GST_DEBUG ("%s max difference %d", gst_video_format_to_string (formats[f]),
+        max_diff);
+    fail_unless (max_diff <= 2);
+    /* the interpolation between the points of the table is linear, the exact
+     * conversion is not, so the 16 bit samples can't all be the same when
+     * the table was used */
+    if (is16)
+      fail_unless (max_diff16 > 0, "the color lut was not used");
+
+    gst_video_frame_unmap (&outframe);
+    gst_video_frame_unmap (&refframe);
+    gst_video_frame_unmap (&inframe);
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_video_convert_frame_rect)
+{
+  GstVideoInfo ininfo, outinfo;
+  GstVideoFrame inframe, refframe, outframe;
+  GstVideoConverter *convert, *refconvert;
+  GstBuffer *buffer;
+  guint8 *p, *r, *o;
+  gint i, j, k;
+  static const struct
+  {
+    gint sx, sy, sw, sh;
+    gint dx, dy, dw, dh;
+  } rects[] = {
+    {16, 8, 160, 120, 100, 50, 80, 60},
+    /* same sizes, other positions */
+    {40, 20, 160, 120, 10, 200, 80, 60},
+    {0, 0, 320, 240, 0, 0, 640, 480},
+    {16, 8, 160, 120, 300, 300, 80, 60},
+  };
+
+  fail_unless (gst_video_info_set_format (&ininfo, GST_VIDEO_FORMAT_AYUV, 320,
+          240));
+  buffer = gst_buffer_new_and_alloc (ininfo.size);
+  gst_video_frame_map (&inframe, &ininfo, buffer, GST_MAP_READWRITE);
+  gst_buffer_unref (buffer);
+  for (i = 0; i < 240; i++) {
+    p = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&inframe, 0) +
+        i * GST_VIDEO_FRAME_PLANE_STRIDE (&inframe, 0);
+    for (j = 0; j < 320; j++) {
+      p[j * 4 + 0] = 0xff;
+      p[j * 4 + 1] = i * 3 + j;
+      p[j * 4 + 2] = 128 + i - j / 2;
+      p[j * 4 + 3] = j * 5 - i;
+    }
+  }
+
+  fail_unless (gst_video_info_set_format (&outinfo, GST_VIDEO_FORMAT_BGRx, 640,
+          480));
+  buffer = gst_buffer_new_and_alloc (outinfo.size);
+  gst_video_frame_map (&outframe, &outinfo, buffer, GST_MAP_READWRITE);
+  gst_buffer_unref (buffer);
+
+  convert = gst_video_converter_new (&ininfo, &outinfo, NULL);
+
+  for (k = 0; k < G_N_ELEMENTS (rects); k++) {
+    /* the reference is made with the rectangle options */
+    buffer = gst_buffer_new_and_alloc (outinfo.size);
+    gst_video_frame_map (&refframe, &outinfo, buffer, GST_MAP_READWRITE);
+    gst_buffer_unref (buffer);
+    refconvert = gst_video_converter_new (&ininfo, &outinfo,
+        gst_structure_new ("options",
+            GST_VIDEO_CONVERTER_OPT_SRC_X, G_TYPE_INT, rects[k].sx,
+            GST_VIDEO_CONVERTER_OPT_SRC_Y, G_TYPE_INT, rects[k].sy,
+            GST_VIDEO_CONVERTER_OPT_SRC_WIDTH, G_TYPE_INT, rects[k].sw,
+            GST_VIDEO_CONVERTER_OPT_SRC_HEIGHT, G_TYPE_INT, rects[k].sh,
+            GST_VIDEO_CONVERTER_OPT_DEST_X, G_TYPE_INT, rects[k].dx,
+            GST_VIDEO_CONVERTER_OPT_DEST_Y, G_TYPE_INT, rects[k].dy,
+            GST_VIDEO_CONVERTER_OPT_DEST_WIDTH, G_TYPE_INT, rects[k].dw,
+            GST_VIDEO_CONVERTER_OPT_DEST_HEIGHT, G_TYPE_INT, rects[k].dh,
+            NULL));
+    gst_video_converter_frame (refconvert, &inframe, &refframe);
+    gst_video_converter_free (refconvert);
+
+    /* pixels outside of the rectangle must stay untouched */
+    memset (GST_VIDEO_FRAME_PLANE_DATA (&outframe, 0), 0x5a,
+        GST_VIDEO_FRAME_SIZE (&outframe));
+    fail_unless (gst_video_converter_frame_rect (convert, &inframe,
+            rects[k].sx, rects[k].sy, rects[k].sw, rects[k].sh, &outframe,
+            rects[k].dx, rects[k].dy, rects[k].dw, rects[k].dh));
+
+    for (i = 0; i < 480; i++) {
+      gboolean in_y = i >= rects[k].dy && i < rects[k].dy + rects[k].dh;
+
+      r = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&refframe, 0) +
+          i * GST_VIDEO_FRAME_PLANE_STRIDE (&refframe, 0);
+      o = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&outframe, 0) +
+          i * GST_VIDEO_FRAME_PLANE_STRIDE (&outframe, 0);
+      for (j = 0; j < 640; j++) {
+        if (in_y && j >= rects[k].dx && j < rects[k].dx + rects[k].dw)
+          fail_unless (memcmp (r + j * 4, o + j * 4, 3) == 0);
+        else
+          fail_unless (o[j * 4] == 0x5a && o[j * 4 + 1] == 0x5a &&
+              o[j * 4 + 2] == 0x5a && o[j * 4 + 3] == 0x5a);
+      }
+    }
+    gst_video_frame_unmap (&refframe);
+  }
+  gst_video_converter_free (convert);
+
+  gst_video_frame_unmap (&outframe);
+  gst_video_frame_unmap (&inframe);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_video_convert_frame_rect_interlaced)
+{
+  GstVideoInfo info;
+  GstVideoFrame inframe, outframe;
+  GstVideoConverter *convert;
+  GstBuffer *buffer;
+  guint8 *p, *o;
+  gint i, j, plane;
+
+  gst_video_info_set_interlaced_format (&info, GST_VIDEO_FORMAT_I420,
+      GST_VIDEO_INTERLACE_MODE_INTERLEAVED, 64, 64);
+
+  buffer = gst_buffer_new_and_alloc (info.size);
+  gst_video_frame_map (&inframe, &info, buffer, GST_MAP_READWRITE);
+  gst_buffer_unref (buffer);
+  for (plane = 0; plane < 3; plane++) {
+    for (i = 0; i < GST_VIDEO_FRAME_COMP_HEIGHT (&inframe, plane); i++) {
+      p = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&inframe, plane) +
+          i * GST_VIDEO_FRAME_PLANE_STRIDE (&inframe, plane);
+      for (j = 0; j < GST_VIDEO_FRAME_COMP_WIDTH (&inframe, plane); j++)
+        p[j] = i * 4 + plane;
+    }
+  }
+
+  buffer = gst_buffer_new_and_alloc (info.size);
+  gst_video_frame_map (&outframe, &info, buffer, GST_MAP_READWRITE);
+  gst_buffer_unref (buffer);
+
+  convert = gst_video_converter_new (&info, &info, NULL);
+
+  /* a chroma line of a field covers 4 lines of the frame, positions in
+   * between are rounded down */
+  for (i = 0; i < 8; i++) {
+    gint y = i & ~3;
+
+    fail_unless (gst_video_converter_frame_rect (convert, &inframe, 0, i, 32,
+            32, &outframe, 0, 0, 32, 32));
+
+    for (j = 0; j < 32; j++) {
+      o = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&outframe, 0) +
+          j * GST_VIDEO_FRAME_PLANE_STRIDE (&outframe, 0);
+      fail_unless_equals_int (o[0], (y + j) * 4);
+    }
+  }
+  gst_video_converter_free (convert);
+
+  gst_video_frame_unmap (&outframe);
+  gst_video_frame_unmap (&inframe);
+}
+
+GST_END_TEST;
+
+/* expected unpacked pixel @x of line @y, the components are read with the
+ * generic format info */
+static void
+get_unpacked_pixel (GstVideoFrame * frame, gint x, gint y, guint8 pixel[4])
+{
+  const GstVideoFormatInfo *finfo = frame->info.finfo;
+  gint c;
+
+  for (c = 0; c < 4; c++) {
+    const guint8 *p;
+    gint cx, cy;
+    guint8 val;
+
+    if (c >= GST_VIDEO_FORMAT_INFO_N_COMPONENTS (finfo)) {
+      pixel[0] = 0xff;
+      break;
+    }
+    cx = x >> GST_VIDEO_FORMAT_INFO_W_SUB (finfo, c);
+    cy = y >> GST_VIDEO_FORMAT_INFO_H_SUB (finfo, c);
+    p = (guint8 *) GST_VIDEO_FRAME_COMP_DATA (frame, c) +
+        cy * GST_VIDEO_FRAME_COMP_STRIDE (frame, c) +
+        cx * GST_VIDEO_FRAME_COMP_PSTRIDE (frame, c);
+    val = *p;
+    /* AYUV or ARGB */
+    pixel[(c + 1) & 3] = val;
+  }
+}
+
+GST_START_TEST (test_video_pack_unpack_simd)
+{
+  const GstVideoFormat formats[] = {
+    GST_VIDEO_FORMAT_I420, GST_VIDEO_FORMAT_YUY2, GST_VIDEO_FORMAT_NV12,
+    GST_VIDEO_FORMAT_BGRA
+  };
+  gint i, j, x, width, max_width = 77, height = 4;
+  guint8 *line;
+
+  line = g_malloc ((max_width + 1) * 4);
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++) {
+    const GstVideoFormatInfo *finfo = gst_video_format_get_info (formats[i]);
+    GstVideoInfo info;
+    GstVideoFrame frame;
+    GstBuffer *buffer;
+    GstMapInfo map;
+    guint8 pixel[4];
+
+    GST_DEBUG ("testing %s", GST_VIDEO_FORMAT_INFO_NAME (finfo));
+
+    fail_unless (gst_video_info_set_format (&info, formats[i], max_width,
+            height));
+    buffer = gst_buffer_new_and_alloc (info.size);
+    gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+    for (j = 0; j < map.size; j++)
+      map.data[j] = g_random_int ();
+    gst_buffer_unmap (buffer, &map);
+    gst_video_frame_map (&frame, &info, buffer, GST_MAP_READWRITE);
+    gst_buffer_unref (buffer);
+
+    /* unpack at all offsets and widths, to and from unaligned memory too */
+    for (x = 0; x < 3; x++) {
+      for (width = 1; width + x <= max_width; width++) {
+        guint8 *dest = line + (width & 1) * 4;
+
+        finfo->unpack_func (finfo, GST_VIDEO_PACK_FLAG_NONE, dest,
+            frame.data, frame.info.stride, x, 2, width);
+        for (j = 0; j < width; j++) {
+          get_unpacked_pixel (&frame, x + j, 2, pixel);
+          fail_unless (memcmp (dest + j * 4, pixel, 4) == 0);
+        }
+      }
+    }
+
+    /* pack lines of all widths */
+    for (width = 1; width <= max_width; width++) {
+      for (j = 0; j < width * 4; j++)
+        line[j] = g_random_int ();
+
+      finfo->pack_func (finfo, GST_VIDEO_PACK_FLAG_NONE, line, 0, frame.data,
+          frame.info.stride, frame.info.chroma_site, 0, width);
+      for (j = 0; j < width; j++) {
+        gint c;
+
+        get_unpacked_pixel (&frame, j, 0, pixel);
+        for (c = 0; c < 4; c++) {
+          gint w_sub;
+
+          if (c >= GST_VIDEO_FORMAT_INFO_N_COMPONENTS (finfo))
+            break;
+          /* subsampled components are taken from the first pixel */
+          w_sub = GST_VIDEO_FORMAT_INFO_W_SUB (finfo, c);
+          fail_unless_equals_int (pixel[(c + 1) & 3],
+              line[((j >> w_sub) << w_sub) * 4 + ((c + 1) & 3)]);
+        }
+      }
+    }
+    gst_video_frame_unmap (&frame);
+  }
+  g_free (line);
+}
+
+GST_END_TEST;
+
+/* unpack one pixel of a format with more than 8 bits per component to
+ * AYUV64 */
+static void
+get_unpacked_pixel16 (GstVideoFrame * frame, gint x, gint y, gboolean expand,
+    guint16 pixel[4])
+{
+  const GstVideoFormatInfo *finfo = frame->info.finfo;
+  gint c, depth = GST_VIDEO_FORMAT_INFO_DEPTH (finfo, 0);
+  const guint8 *line;
+
+  line = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (frame, 0) +
+      y * GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0);
+  pixel[0] = 0xffff;
+
+  if (GST_VIDEO_FRAME_FORMAT (frame) == GST_VIDEO_FORMAT_v210) {
+    /* 4 dwords with U0 Y0 V0, Y1 U2 Y2, V2 Y3 U4, Y4 V4 Y5 */
+    static const gint fields[6][3] = {
+      {1, 0, 2}, {3, 0, 2}, {5, 4, 6}, {7, 4, 6}, {9, 8, 10}, {11, 8, 10}
+    };
+
+    for (c = 0; c < 3; c++) {
+      gint f = fields[x % 6][c];
+      guint32 a = GST_READ_UINT32_LE (line + (x / 6) * 16 + (f / 3) * 4);
+
+      pixel[c + 1] = ((a >> ((f % 3) * 10)) & 0x3ff) << 6;
+    }
+  } else if (GST_VIDEO_FRAME_FORMAT (frame) == GST_VIDEO_FORMAT_UYVP) {
+    /* U0 Y0 V0 Y1 in 40 big endian bits */
+    const guint8 *p = line + (x / 2) * 5;
+    guint64 v = ((guint64) GST_READ_UINT32_BE (p) << 8) | p[4];
+
+    pixel[1] = ((v >> ((x & 1) ? 0 : 20)) & 0x3ff) << 6;
+    pixel[2] = ((v >> 30) & 0x3ff) << 6;
+    pixel[3] = ((v >> 10) & 0x3ff) << 6;
+  } else if (GST_VIDEO_FRAME_FORMAT (frame) == GST_VIDEO_FORMAT_Y210 ||
+      GST_VIDEO_FRAME_FORMAT (frame) == GST_VIDEO_FORMAT_Y212_LE) {
+    /* Y0 U Y1 V with the samples in the high bits */
+    const guint8 *p = line + (x / 2) * 8;
+
+    pixel[1] = GST_READ_UINT16_LE (p + (x & 1) * 4);
+    pixel[2] = GST_READ_UINT16_LE (p + 2);
+    pixel[3] = GST_READ_UINT16_LE (p + 6);
+  } else {
+    for (c = 0; c < 3; c++) {
+      const guint8 *p;
+      gint cx, cy, shift;
+
+      cx = x >> GST_VIDEO_FORMAT_INFO_W_SUB (finfo, c);
+      cy = y >> GST_VIDEO_FORMAT_INFO_H_SUB (finfo, c);
+      p = (guint8 *) GST_VIDEO_FRAME_COMP_DATA (frame, c) +
+          cy * GST_VIDEO_FRAME_COMP_STRIDE (frame, c) +
+          cx * GST_VIDEO_FRAME_COMP_PSTRIDE (frame, c);
+      /* samples are moved to the high bits, the low bits of samples that
+       * are already there are kept */
+      shift = 16 - depth - GST_VIDEO_FORMAT_INFO_SHIFT (finfo, c);
+      pixel[c + 1] = GST_READ_UINT16_LE (p) << shift;
+    }
+  }
+  if (expand) {
+    for (c = 1; c < 4; c++)
+      pixel[c] |= pixel[c] >> depth;
+  }
+}
+
+GST_START_TEST (test_video_pack_unpack_simd_16)
+{
+  const GstVideoFormat formats[] = {
+    GST_VIDEO_FORMAT_v210, GST_VIDEO_FORMAT_UYVP, GST_VIDEO_FORMAT_Y210,
+    GST_VIDEO_FORMAT_Y212_LE, GST_VIDEO_FORMAT_I420_10LE,
+    GST_VIDEO_FORMAT_I420_12LE, GST_VIDEO_FORMAT_I422_10LE,
+    GST_VIDEO_FORMAT_I422_12LE, GST_VIDEO_FORMAT_P010_10LE,
+    GST_VIDEO_FORMAT_P012_LE, GST_VIDEO_FORMAT_P016_LE
+  };
+  gint i, j, x, width, max_width = 77, height = 4;
+  guint16 *line, *check;
+
+  line = g_malloc ((max_width + 1) * 8);
+  check = g_malloc (max_width * 8);
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++) {
+    const GstVideoFormatInfo *finfo = gst_video_format_get_info (formats[i]);
+    gint depth = GST_VIDEO_FORMAT_INFO_DEPTH (finfo, 0);
+    guint16 mask = 0xffff << (16 - depth);
+    GstVideoInfo info;
+    GstVideoFrame frame;
+    GstBuffer *buffer;
+    GstMapInfo map;
+    guint16 pixel[4];
+    gint max_x, flags;
+
+    GST_DEBUG ("testing %s", GST_VIDEO_FORMAT_INFO_NAME (finfo));
+
+    fail_unless (gst_video_info_set_format (&info, formats[i], max_width,
+            height));
+    buffer = gst_buffer_new_and_alloc (info.size);
+    gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+    for (j = 0; j < map.size; j++)
+      map.data[j] = g_random_int ();
+    gst_buffer_unmap (buffer, &map);
+    gst_video_frame_map (&frame, &info, buffer, GST_MAP_READWRITE);
+    gst_buffer_unref (buffer);
+
+    /* v210 and UYVP can only be unpacked from the start of the line */
+    max_x = (formats[i] == GST_VIDEO_FORMAT_v210 ||
+        formats[i] == GST_VIDEO_FORMAT_UYVP) ? 1 : 3;
+
+    /* unpack at all offsets and widths, with and without expanding the
+     * samples to 16 bits */
+    for (flags = 0; flags < 2; flags++) {
+      for (x = 0; x < max_x; x++) {
+        for (width = 1; width + x <= max_width; width++) {
+          guint16 *dest = line + (width & 1) * 4;
+
+          finfo->unpack_func (finfo, flags ? GST_VIDEO_PACK_FLAG_NONE :
+              GST_VIDEO_PACK_FLAG_TRUNCATE_RANGE, dest, frame.data,
+              frame.info.stride, x, 2, width);
+          for (j = 0; j < width; j++) {
+            get_unpacked_pixel16 (&frame, x + j, 2, flags, pixel);
+            fail_unless (memcmp (dest + j * 4, pixel, 8) == 0);
+          }
+        }
+      }
+    }
+
+    /* pack lines of all widths and check the samples that were kept. Line 1
+     * only contains luma samples for the 4:2:0 formats. */
+    for (width = 1; width <= max_width; width++) {
+      gint y;
+
+      for (y = 1; y >= 0; y--) {
+        for (j = 0; j < width * 4; j++)
+          line[j] = g_random_int ();
+
+        finfo->pack_func (finfo, GST_VIDEO_PACK_FLAG_NONE, line, 0,
+            frame.data, frame.info.stride, frame.info.chroma_site, y, width);
+        finfo->unpack_func (finfo, GST_VIDEO_PACK_FLAG_TRUNCATE_RANGE, check,
+            frame.data, frame.info.stride, 0, y, width);
+
+        for (j = 0; j < width; j++) {
+          gint c;
+
+          fail_unless_equals_int (check[j * 4 + 0], 0xffff);
+          fail_unless_equals_int (check[j * 4 + 1], line[j * 4 + 1] & mask);
+          if (y == 1 && GST_VIDEO_FORMAT_INFO_H_SUB (finfo, 1))
+            continue;
+          /* chroma is taken from the first pixel of each pair */
+          for (c = 2; c < 4; c++)
+            fail_unless_equals_int (check[j * 4 + c],
+                line[(j & ~1) * 4 + c] & mask);
+        }
+      }
+    }
+    gst_video_frame_unmap (&frame);
+  }
+  g_free (check);
+  g_free (line);
+}
+
+GST_END_TEST;
+
+static void
+convert_matrix_line (GstVideoFormat format, gint width, gint height,
+    GstBuffer * inbuffer, GstBuffer * outbuffer)
+{
+  GstVideoInfo ininfo, outinfo;
+  GstVideoFrame inframe, outframe;
+  GstVideoConverter *convert;
+
+  gst_video_info_set_format (&ininfo, format, width, height);
+  gst_video_colorimetry_from_string (&ininfo.colorimetry, "bt601");
+  gst_video_info_set_format (&outinfo, format, width, height);
+  gst_video_colorimetry_from_string (&outinfo.colorimetry, "bt709");
+
+  gst_video_frame_map (&inframe, &ininfo, inbuffer, GST_MAP_READ);
+  gst_video_frame_map (&outframe, &outinfo, outbuffer, GST_MAP_WRITE);
+  convert = gst_video_converter_new (&ininfo, &outinfo,
+      gst_structure_new ("options",
+          GST_VIDEO_CONVERTER_OPT_THREADS, G_TYPE_UINT, 1, NULL));
+  gst_video_converter_frame (convert, &inframe, &outframe);
+  gst_video_converter_free (convert);
+  gst_video_frame_unmap (&outframe);
+  gst_video_frame_unmap (&inframe);
+}
+
+GST_START_TEST (test_video_matrix_simd)
+{
+  const GstVideoFormat formats[] = {
+    GST_VIDEO_FORMAT_AYUV, GST_VIDEO_FORMAT_AYUV64
+  };
+  gint i, width = 67;
+
+  /* a line of pixels is converted with the vector code, a column of pixels
+   * only with the code for the remaining pixels. Both must give the same
+   * result. */
+  for (i = 0; i < G_N_ELEMENTS (formats); i++) {
+    GstBuffer *inbuffer, *out1, *out2;
+    GstMapInfo map;
+    gsize size;
+    gint j;
+
+    size = width * (formats[i] == GST_VIDEO_FORMAT_AYUV ? 4 : 8);
+    inbuffer = gst_buffer_new_and_alloc (size);
+    gst_buffer_map (inbuffer, &map, GST_MAP_WRITE);
+    for (j = 0; j < size; j++)
+      map.data[j] = g_random_int ();
+    gst_buffer_unmap (inbuffer, &map);
+    out1 = gst_buffer_new_and_alloc (size);
+    out2 = gst_buffer_new_and_alloc (size);
+
+    convert_matrix_line (formats[i], width, 1, inbuffer, out1);
+    convert_matrix_line (formats[i], 1, width, inbuffer, out2);
+
+    gst_buffer_map (out1, &map, GST_MAP_READ);
+    fail_unless (gst_buffer_memcmp (out2, 0, map.data, size) == 0);
+    gst_buffer_unmap (out1, &map);
+
+    gst_buffer_unref (out2);
+    gst_buffer_unref (out1);
+    gst_buffer_unref (inbuffer);
+  }
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_video_transfer)
 {
   gint i, j;
@@ -3874,6 +4854,7 @@ video_suite (void)
   tcase_add_test (tc_chain, test_convert_frame);
   tcase_add_test (tc_chain, test_convert_frame_async);
   tcase_add_test (tc_chain, test_convert_frame_async_error);
+  tcase_add_test (tc_chain, test_convert_frame_cache);
   tcase_add_test (tc_chain, test_video_size_from_caps);
   tcase_add_test (tc_chain, test_interlace_mode);
   tcase_add_test (tc_chain, test_overlay_composition);
@@ -3882,6 +4863,7 @@ video_suite (void)
   tcase_add_test (tc_chain, test_video_pack_unpack2);
   tcase_add_test (tc_chain, test_video_chroma);
   tcase_add_test (tc_chain, test_video_scaler);
+  tcase_add_test (tc_chain, test_video_scaler_shared_tables);
   tcase_add_test (tc_chain, test_video_color_convert_rgb_rgb);
   tcase_add_test (tc_chain, test_video_color_convert_rgb_yuv);
   tcase_add_test (tc_chain, test_video_color_convert_yuv_yuv);
@@ -3889,6 +4871,15 @@ video_suite (void)
   tcase_add_test (tc_chain, test_video_color_convert_other);
   tcase_add_test (tc_chain, test_video_size_convert);
   tcase_add_test (tc_chain, test_video_convert);
+  tcase_add_test (tc_chain, test_video_task_pool);
+  tcase_add_test (tc_chain, test_video_convert_with_pool);
+  tcase_add_test (tc_chain, test_video_convert_fused);
+  tcase_add_test (tc_chain, test_video_convert_color_lut);
+  tcase_add_test (tc_chain, test_video_convert_frame_rect);
+  tcase_add_test (tc_chain, test_video_convert_frame_rect_interlaced);
+  tcase_add_test (tc_chain, test_video_pack_unpack_simd);
+  tcase_add_test (tc_chain, test_video_pack_unpack_simd_16);
+  tcase_add_test (tc_chain, test_video_matrix_simd);
   tcase_add_test (tc_chain, test_video_transfer);
   tcase_add_test (tc_chain, test_overlay_blend);
   tcase_add_test (tc_chain, test_video_center_rect);
@@ -82,6 +82,12 @@ struct _GstVideoDecoderTester
   guint64 last_buf_num;
   guint64 last_kf_num;
   gboolean set_output_state;
+
+  /* frames in handle_frame, and whether there were any when the decoder
+   * was flushed or stopped */
+  gint n_handling;
+  gboolean handling_on_flush;
+  gboolean handling_on_stop;
 };
 
 struct _GstVideoDecoderTesterClass
@@ -107,6 +113,11 @@ gst_video_decoder_tester_start (GstVideoDecoder * dec)
 static gboolean
 gst_video_decoder_tester_stop (GstVideoDecoder * dec)
 {
+  GstVideoDecoderTester *dectester = (GstVideoDecoderTester *) dec;
+
+  if (g_atomic_int_get (&dectester->n_handling) > 0)
+    dectester->handling_on_stop = TRUE;
+
   return TRUE;
 }
 
@@ -115,6 +126,9 @@ gst_video_decoder_tester_flush (GstVideoDecoder * dec)
 {
   GstVideoDecoderTester *dectester = (GstVideoDecoderTester *) dec;
 
+  if (g_atomic_int_get (&dectester->n_handling) > 0)
+    dectester->handling_on_flush = TRUE;
+
   dectester->last_buf_num = -1;
   dectester->last_kf_num = -1;
 
@@ -146,10 +160,16 @@ gst_video_decoder_tester_handle_frame (GstVideoDecoder * dec,
   gint size;
   GstMapInfo map;
 
+  g_atomic_int_inc (&dectester->n_handling);
+
   gst_buffer_map (frame->input_buffer, &map, GST_MAP_READ);
 
   input_num = *((guint64 *) map.data);
 
+  /* let frame threads finish out of order */
+  if (gst_video_decoder_get_frame_threads (dec) > 1 && input_num % 2 == 0)
+    g_usleep (1000);
+
   if ((input_num == dectester->last_buf_num + 1
           && dectester->last_buf_num != -1)
       || !GST_BUFFER_FLAG_IS_SET (frame->input_buffer,
@@ -172,6 +192,8 @@ gst_video_decoder_tester_handle_frame (GstVideoDecoder * dec,
 
   gst_buffer_unmap (frame->input_buffer, &map);
 
+  g_atomic_int_add (&dectester->n_handling, -1);
+
   if (frame->output_buffer)
     return gst_video_decoder_finish_frame (dec, frame);
   gst_video_codec_frame_unref (frame);
@@ -1254,6 +1276,226 @@ GST_START_TEST (videodecoder_playback_event_order)
 
 GST_END_TEST;
 
+#define NUM_THREADED_BUFFERS 100
+GST_START_TEST (videodecoder_playback_frame_threads)
+{
+  GstSegment segment;
+  GstBuffer *buffer;
+  guint64 i;
+  GList *iter;
+
+  setup_videodecodertester (NULL, NULL);
+  gst_video_decoder_set_frame_threads (GST_VIDEO_DECODER (dec), 4);
+  fail_unless_equals_int (gst_video_decoder_get_frame_threads
+      (GST_VIDEO_DECODER (dec)), 4);
+
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_element_set_state (dec, GST_STATE_PLAYING);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  send_startup_events ();
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+
+  /* all keyframes, so every frame can be decoded on its own */
+  for (i = 0; i < NUM_THREADED_BUFFERS; i++) {
+    buffer = create_test_buffer (i);
+
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  /* the frames come out in decoding order */
+  fail_unless_equals_int (g_list_length (buffers), NUM_THREADED_BUFFERS);
+  i = 0;
+  for (iter = buffers; iter; iter = g_list_next (iter)) {
+    GstMapInfo map;
+    guint64 num;
+
+    buffer = iter->data;
+
+    gst_buffer_map (buffer, &map, GST_MAP_READ);
+    num = *(guint64 *) map.data;
+    fail_unless (i == num);
+    fail_unless (GST_BUFFER_PTS (buffer) == gst_util_uint64_scale_round (i,
+            GST_SECOND * TEST_VIDEO_FPS_D, TEST_VIDEO_FPS_N));
+    gst_buffer_unmap (buffer, &map);
+    i++;
+  }
+
+  g_list_free_full (buffers, (GDestroyNotify) gst_buffer_unref);
+  buffers = NULL;
+
+  cleanup_videodecodertest ();
+}
+
+GST_END_TEST;
+
+GST_START_TEST (videodecoder_frame_threads_flush_seek_stop)
+{
+  GstVideoDecoderTester *dectester;
+  GstSegment segment;
+  guint64 i;
+
+  setup_videodecodertester (NULL, NULL);
+  dectester = (GstVideoDecoderTester *) dec;
+  gst_video_decoder_set_frame_threads (GST_VIDEO_DECODER (dec), 4);
+
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_element_set_state (dec, GST_STATE_PLAYING);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  send_startup_events ();
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+
+  /* flush with frames in flight, they are discarded before the subclass
+   * is flushed */
+  for (i = 0; i < 8; i++)
+    fail_unless (gst_pad_push (mysrcpad, create_test_buffer (i)) ==
+        GST_FLOW_OK);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_flush_start ()));
+  fail_unless (gst_pad_push_event (mysrcpad,
+          gst_event_new_flush_stop (TRUE)));
+  fail_if (dectester->handling_on_flush);
+
+  g_list_free_full (buffers, (GDestroyNotify) gst_buffer_unref);
+  buffers = NULL;
+
+  /* a new segment, as after a non-flushing seek, comes after all frames of
+   * the previous one */
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+  for (i = 0; i < 8; i++)
+    fail_unless (gst_pad_push (mysrcpad, create_test_buffer (i)) ==
+        GST_FLOW_OK);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+  fail_unless_equals_int (g_list_length (buffers), 8);
+
+  /* stop with frames in flight */
+  for (i = 8; i < 16; i++)
+    fail_unless (gst_pad_push (mysrcpad, create_test_buffer (i)) ==
+        GST_FLOW_OK);
+  gst_element_set_state (dec, GST_STATE_READY);
+  fail_if (dectester->handling_on_stop);
+
+  g_list_free_full (buffers, (GDestroyNotify) gst_buffer_unref);
+  buffers = NULL;
+
+  cleanup_videodecodertest ();
+}
+
+GST_END_TEST;
+
+#define NUM_PENDING_FRAMES 32
+GST_START_TEST (videodecoder_get_frame)
+{
+  GstVideoDecoder *vdec;
+  GstSegment segment;
+  GstBuffer *buffer;
+  GstVideoCodecFrame *frame, *found;
+  GList *frames, *l;
+  guint i;
+
+  setup_videodecodertester (NULL, NULL);
+  vdec = GST_VIDEO_DECODER (dec);
+
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_element_set_state (dec, GST_STATE_PLAYING);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  send_startup_events ();
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+
+  /* delta units without a keyframe are not decoded by the tester and
+   * stay pending in the decoder */
+  for (i = 0; i < NUM_PENDING_FRAMES; i++) {
+    buffer = create_test_buffer (i);
+    GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+
+  frames = gst_video_decoder_get_frames (vdec);
+  fail_unless_equals_int (g_list_length (frames), NUM_PENDING_FRAMES);
+
+  for (l = frames; l; l = l->next) {
+    GstVideoCodecFrame *tmp = l->data;
+
+    frame = gst_video_decoder_get_frame (vdec, tmp->system_frame_number);
+    fail_unless (frame == tmp);
+    gst_video_codec_frame_unref (frame);
+  }
+
+  /* release every other frame, out of order */
+  for (l = frames, i = 0; l; l = l->next, i++) {
+    if (i % 2 == 1)
+      gst_video_decoder_release_frame (vdec,
+          gst_video_codec_frame_ref (l->data));
+  }
+
+  for (l = frames, i = 0; l; l = l->next, i++) {
+    GstVideoCodecFrame *tmp = l->data;
+
+    frame = gst_video_decoder_get_frame (vdec, tmp->system_frame_number);
+    if (i % 2 == 1) {
+      fail_unless (frame == NULL);
+    } else {
+      fail_unless (frame == tmp);
+      gst_video_codec_frame_unref (frame);
+    }
+  }
+
+  frame = gst_video_decoder_get_oldest_frame (vdec);
+  fail_unless (frame == frames->data);
+  gst_video_codec_frame_unref (frame);
+
+  g_list_free_full (frames, (GDestroyNotify) gst_video_codec_frame_unref);
+
+  frames = gst_video_decoder_get_frames (vdec);
+  fail_unless_equals_int (g_list_length (frames), NUM_PENDING_FRAMES / 2);
+
+  /* a frame that was renumbered by the subclass can't be found anymore
+   * once released */
+  frame = frames->data;
+  i = frame->system_frame_number;
+  frame->system_frame_number += 1000;
+  gst_video_decoder_release_frame (vdec, gst_video_codec_frame_ref (frame));
+  fail_unless (gst_video_decoder_get_frame (vdec, i) == NULL);
+  fail_unless (gst_video_decoder_get_frame (vdec,
+          frame->system_frame_number) == NULL);
+  g_list_free_full (frames, (GDestroyNotify) gst_video_codec_frame_unref);
+
+  frames = gst_video_decoder_get_frames (vdec);
+  fail_unless_equals_int (g_list_length (frames), NUM_PENDING_FRAMES / 2 - 1);
+
+  /* a pending frame that was renumbered is found by its new number */
+  frame = frames->next->data;
+  i = frame->system_frame_number;
+  frame->system_frame_number += 1000;
+  fail_unless (gst_video_decoder_get_frame (vdec, i) == NULL);
+  found = gst_video_decoder_get_frame (vdec, frame->system_frame_number);
+  fail_unless (found == frame);
+  gst_video_codec_frame_unref (found);
+  found = gst_video_decoder_get_frame (vdec,
+      ((GstVideoCodecFrame *) frames->data)->system_frame_number);
+  fail_unless (found == frames->data);
+  gst_video_codec_frame_unref (found);
+  g_list_free_full (frames, (GDestroyNotify) gst_video_codec_frame_unref);
+
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  g_list_free_full (buffers, (GDestroyNotify) gst_buffer_unref);
+  buffers = NULL;
+
+  cleanup_videodecodertest ();
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_videodecoder_suite (void)
 {
@@ -1280,6 +1522,9 @@ gst_videodecoder_suite (void)
       G_N_ELEMENTS (test_default_caps));
 
   tcase_add_test (tc, videodecoder_playback_event_order);
+  tcase_add_test (tc, videodecoder_get_frame);
+  tcase_add_test (tc, videodecoder_playback_frame_threads);
+  tcase_add_test (tc, videodecoder_frame_threads_flush_seek_stop);
 
   return s;
 }
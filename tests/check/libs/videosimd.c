@@ -0,0 +1,249 @@
+/* GStreamer unit test for the optimised video line functions
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/video/video-simd-private.h>
+#include <string.h>
+
+/* Every optimised line function must give exactly the same result as the
+ * ORC or C version it replaces. They are called on all widths up to
+ * MAX_WIDTH, from and to unaligned memory, with random samples and with
+ * samples that are all 0, all 1 or alternating. */
+
+#define MAX_WIDTH 67
+/* enough for MAX_WIDTH of the largest unit, 6 pixels of AYUV64 */
+#define BUF_SIZE (MAX_WIDTH * 48 + 64)
+#define N_PATTERNS 4
+
+static const GstVideoSimdFuncs *ref_funcs, *opt_funcs;
+static guint8 *src[3], *ref_dest[3], *opt_dest[3];
+
+static void
+fill_sources (gint pattern)
+{
+  gint i, j;
+
+  for (i = 0; i < 3; i++) {
+    for (j = 0; j < BUF_SIZE; j++) {
+      switch (pattern) {
+        case 0:
+          src[i][j] = g_random_int ();
+          break;
+        case 1:
+          src[i][j] = 0x00;
+          break;
+        case 2:
+          src[i][j] = 0xff;
+          break;
+        default:
+          src[i][j] = (j & 2) ? 0xff : 0x00;
+          break;
+      }
+    }
+  }
+}
+
+static void
+setup_buffers (void)
+{
+  gint i;
+
+  ref_funcs = gst_video_simd_get_default_funcs ();
+  opt_funcs = gst_video_simd_get_funcs ();
+  if (ref_funcs->unpack_I420 == opt_funcs->unpack_I420)
+    GST_INFO ("no optimised functions for this CPU");
+
+  for (i = 0; i < 3; i++) {
+    src[i] = g_malloc (BUF_SIZE);
+    ref_dest[i] = g_malloc (BUF_SIZE);
+    opt_dest[i] = g_malloc (BUF_SIZE);
+  }
+}
+
+static void
+teardown_buffers (void)
+{
+  gint i;
+
+  for (i = 0; i < 3; i++) {
+    g_free (src[i]);
+    g_free (ref_dest[i]);
+    g_free (opt_dest[i]);
+  }
+}
+
+/* Run the call with the default functions in f and the destinations in d,
+ * then with the optimised ones, and compare the destinations completely so
+ * that writes past the end are found too. s are the sources, n the width
+ * and o an offset that makes the odd widths unaligned. */
+#define COMPARE(...) G_STMT_START {                                     \
+  const GstVideoSimdFuncs *f;                                           \
+  guint8 *d[3], *s[3];                                                  \
+  gint k;                                                               \
+                                                                        \
+  for (k = 0; k < 3; k++) {                                             \
+    memset (ref_dest[k], 0x5a, BUF_SIZE);                               \
+    memset (opt_dest[k], 0x5a, BUF_SIZE);                               \
+    s[k] = src[k] + o;                                                  \
+  }                                                                     \
+  f = ref_funcs;                                                        \
+  for (k = 0; k < 3; k++)                                               \
+    d[k] = ref_dest[k] + o;                                             \
+  __VA_ARGS__;                                                          \
+  f = opt_funcs;                                                        \
+  for (k = 0; k < 3; k++)                                               \
+    d[k] = opt_dest[k] + o;                                             \
+  __VA_ARGS__;                                                          \
+  for (k = 0; k < 3; k++)                                               \
+    fail_unless (memcmp (ref_dest[k], opt_dest[k], BUF_SIZE) == 0,      \
+        "%s differs in plane %d for width %d, pattern %d",              \
+        #__VA_ARGS__, k, n, pattern);                                   \
+} G_STMT_END
+
+#define FOR_WIDTHS_AND_PATTERNS(pattern,n,o)                            \
+  for (pattern = 0; pattern < N_PATTERNS; pattern++)                    \
+    for (n = 1, o = 2, fill_sources (pattern); n <= MAX_WIDTH;          \
+        n++, o = (n & 1) * 2)
+
+#define U16(p) ((guint16 *) (p))
+
+GST_START_TEST (test_video_simd_8bit)
+{
+  gint pattern, n, o;
+
+  FOR_WIDTHS_AND_PATTERNS (pattern, n, o) {
+    COMPARE (f->unpack_I420 (d[0], s[0], s[1], s[2], n));
+    COMPARE (f->pack_I420 (d[0], d[1], d[2], s[0], n));
+    COMPARE (f->unpack_YUY2 (d[0], s[0], n));
+    COMPARE (f->pack_YUY2 (d[0], s[0], n));
+    COMPARE (f->unpack_NV12 (d[0], s[0], s[1], n));
+    COMPARE (f->pack_NV12 (d[0], d[1], s[0], n));
+    COMPARE (f->unpack_BGRA (d[0], s[0], n));
+    COMPARE (f->pack_BGRA (d[0], s[0], n));
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_video_simd_16bit)
+{
+  static const gint depths[] = { 10, 12, 16 };
+  gint pattern, n, o, i, expand;
+
+  FOR_WIDTHS_AND_PATTERNS (pattern, n, o) {
+    for (i = 0; i < G_N_ELEMENTS (depths); i++) {
+      gint bits = depths[i];
+
+      for (expand = 0; expand < 2; expand++) {
+        /* the planar formats have at most 12 bits */
+        if (bits < 16)
+          COMPARE (f->unpack_I420_16 (U16 (d[0]), U16 (s[0]), U16 (s[1]),
+                  U16 (s[2]), bits, expand, n));
+        COMPARE (f->unpack_P016 (U16 (d[0]), U16 (s[0]), U16 (s[1]), bits,
+                expand, n));
+        COMPARE (f->unpack_Y216 (U16 (d[0]), s[0], bits, expand, n));
+        COMPARE (f->pack_Y16 (U16 (d[0]), U16 (s[0]), bits, expand, n));
+      }
+      if (bits < 16)
+        COMPARE (f->pack_I420_16 (U16 (d[0]), U16 (d[1]), U16 (d[2]),
+                U16 (s[0]), bits, n));
+      COMPARE (f->pack_P016 (U16 (d[0]), U16 (d[1]), U16 (s[0]), bits, n));
+      COMPARE (f->pack_Y216 (d[0], U16 (s[0]), bits, n));
+    }
+
+    for (expand = 0; expand < 2; expand++) {
+      COMPARE (f->unpack_v210 (U16 (d[0]), s[0], expand, n));
+      COMPARE (f->unpack_UYVP (U16 (d[0]), s[0], expand, n));
+    }
+    COMPARE (f->pack_v210 (d[0], U16 (s[0]), n));
+    COMPARE (f->pack_UYVP (d[0], U16 (s[0]), n));
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_video_simd_matrix)
+{
+  gint pattern, n, o, i, m;
+
+  for (m = 0; m < 8; m++) {
+    gint im[12];
+
+    /* random coefficients, some large enough to clamp the results */
+    for (i = 0; i < 12; i++) {
+      if ((i & 3) == 3)
+        im[i] = g_random_int_range (-(1 << 24), 1 << 24);
+      else
+        im[i] = g_random_int_range (-1024, 1024);
+    }
+
+    FOR_WIDTHS_AND_PATTERNS (pattern, n, o) {
+      COMPARE (f->matrix16 (U16 (d[0]), U16 (s[0]), im, n));
+    }
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_video_simd_lut3d)
+{
+  gint pattern, n, o, i, bits;
+
+  for (bits = 4; bits <= 6; bits++) {
+    gint size = (1 << bits) + 1;
+    gint n_values = size * size * size * 4;
+    guint16 *lut = g_new (guint16, n_values);
+
+    /* random values, with the extremes in the corners */
+    for (i = 0; i < n_values; i++)
+      lut[i] = g_random_int ();
+    for (i = 0; i < 4; i++) {
+      lut[i] = 0;
+      lut[n_values - 4 + i] = 0xffff;
+    }
+
+    FOR_WIDTHS_AND_PATTERNS (pattern, n, o) {
+      COMPARE (f->lut3d (U16 (d[0]), U16 (s[0]), lut, bits, n));
+    }
+    g_free (lut);
+  }
+}
+
+GST_END_TEST;
+
+static Suite *
+videosimd_suite (void)
+{
+  Suite *s = suite_create ("videosimd");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_checked_fixture (tc_chain, setup_buffers, teardown_buffers);
+  tcase_add_test (tc_chain, test_video_simd_8bit);
+  tcase_add_test (tc_chain, test_video_simd_16bit);
+  tcase_add_test (tc_chain, test_video_simd_matrix);
+  tcase_add_test (tc_chain, test_video_simd_lut3d);
+
+  return s;
+}
+
+GST_CHECK_MAIN (videosimd);
@@ -0,0 +1,181 @@
+/* GStreamer audio format conversion benchmark
+ * Copyright (C) 2021 GStreamer developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/gst.h>
+#include <gst/audio/audio.h>
+
+#define DEFAULT_FRAMES 1024
+
+#define DEFAULT_DURATION 2.0
+
+typedef struct
+{
+  /* the converter path the conversion is expected to take */
+  const gchar *path;
+  GstAudioFormat in_format;
+  gint in_channels;
+  gint in_rate;
+  GstAudioFormat out_format;
+  gint out_channels;
+  gint out_rate;
+} BenchCase;
+
+static const BenchCase cases[] = {
+  {"passthrough", GST_AUDIO_FORMAT_S16LE, 2, 48000, GST_AUDIO_FORMAT_S16LE, 2,
+      48000},
+  {"endian", GST_AUDIO_FORMAT_S16LE, 2, 48000, GST_AUDIO_FORMAT_S16BE, 2,
+      48000},
+  {"fast", GST_AUDIO_FORMAT_S16, 2, 48000, GST_AUDIO_FORMAT_F32, 2, 48000},
+  {"fast", GST_AUDIO_FORMAT_F32, 2, 48000, GST_AUDIO_FORMAT_S16, 2, 48000},
+  {"fast", GST_AUDIO_FORMAT_S16, 2, 48000, GST_AUDIO_FORMAT_S32, 2, 48000},
+  {"fast", GST_AUDIO_FORMAT_S32, 2, 48000, GST_AUDIO_FORMAT_S16, 2, 48000},
+  {"fast", GST_AUDIO_FORMAT_S32, 2, 48000, GST_AUDIO_FORMAT_F32, 2, 48000},
+  {"fast", GST_AUDIO_FORMAT_F32, 2, 48000, GST_AUDIO_FORMAT_S32, 2, 48000},
+  {"generic", GST_AUDIO_FORMAT_S24, 2, 48000, GST_AUDIO_FORMAT_F32, 2, 48000},
+  {"generic", GST_AUDIO_FORMAT_F64, 2, 48000, GST_AUDIO_FORMAT_F32, 2, 48000},
+  {"generic", GST_AUDIO_FORMAT_S16, 2, 48000, GST_AUDIO_FORMAT_S16, 1, 48000},
+  {"generic", GST_AUDIO_FORMAT_F32, 6, 48000, GST_AUDIO_FORMAT_F32, 2, 48000},
+  {"generic", GST_AUDIO_FORMAT_S16, 2, 44100, GST_AUDIO_FORMAT_F32, 2, 48000},
+  {"resample", GST_AUDIO_FORMAT_F32, 2, 44100, GST_AUDIO_FORMAT_F32, 2,
+      48000},
+};
+
+static void
+do_benchmark_conversions (gint frames, const gchar * in_format,
+    const gchar * out_format, gboolean writable, gdouble max_duration)
+{
+  GTimer *timer;
+  guint i;
+
+  timer = g_timer_new ();
+
+  for (i = 0; i < G_N_ELEMENTS (cases); i++) {
+    const BenchCase *c = &cases[i];
+    const gchar *infmt_str, *outfmt_str;
+    GstAudioInfo ininfo, outinfo;
+    GstAudioConverter *convert;
+    GstAudioConverterFlags flags;
+    gpointer indata, outdata;
+    gpointer in[1], out[1];
+    gsize out_frames;
+    gdouble elapsed, samples_sec;
+    gint count;
+
+    infmt_str = gst_audio_format_to_string (c->in_format);
+    if (in_format != NULL && !g_str_equal (in_format, infmt_str))
+      continue;
+    outfmt_str = gst_audio_format_to_string (c->out_format);
+    if (out_format != NULL && !g_str_equal (out_format, outfmt_str))
+      continue;
+
+    gst_audio_info_set_format (&ininfo, c->in_format, c->in_rate,
+        c->in_channels, NULL);
+    gst_audio_info_set_format (&outinfo, c->out_format, c->out_rate,
+        c->out_channels, NULL);
+
+    convert = gst_audio_converter_new (0, &ininfo, &outinfo, NULL);
+    out_frames = gst_audio_converter_get_out_frames (convert, frames);
+
+    /* leave room for the resampler to produce a few frames more */
+    indata = g_malloc0 (frames * ininfo.bpf);
+    outdata = g_malloc0 ((out_frames + 16) * outinfo.bpf);
+    in[0] = indata;
+    out[0] = outdata;
+
+    flags = writable ? GST_AUDIO_CONVERTER_FLAG_IN_WRITABLE : 0;
+
+    /* warmup, this also allocates the temp memory of the converter */
+    gst_audio_converter_samples (convert, flags, in, frames, out,
+        gst_audio_converter_get_out_frames (convert, frames));
+
+    count = 0;
+    g_timer_start (timer);
+    while (TRUE) {
+      gst_audio_converter_samples (convert, flags, in, frames, out,
+          gst_audio_converter_get_out_frames (convert, frames));
+
+      count++;
+      elapsed = g_timer_elapsed (timer, NULL);
+      if (elapsed >= max_duration)
+        break;
+    }
+
+    /* samples per second, counted on the input side */
+    samples_sec = (gdouble) count * frames * c->in_channels / elapsed;
+
+    gst_println ("%14.1f samples/sec %-12s %s/%d/%d -> %s/%d/%d%s, %d/%.5f",
+        samples_sec, c->path, infmt_str, c->in_channels, c->in_rate,
+        outfmt_str, c->out_channels, c->out_rate,
+        gst_audio_converter_supports_inplace (convert) ? " (in-place)" : "",
+        count, elapsed);
+
+    gst_audio_converter_free (convert);
+    g_free (indata);
+    g_free (outdata);
+  }
+
+  g_timer_destroy (timer);
+}
+
+int
+main (int argc, char **argv)
+{
+  GError *err = NULL;
+  gint frames = DEFAULT_FRAMES;
+  gdouble max_dur = DEFAULT_DURATION;
+  gboolean writable = FALSE;
+  gchar *from_fmt = NULL;
+  gchar *to_fmt = NULL;
+  GOptionContext *ctx;
+  GOptionEntry options[] = {
+    {"frames", 'n', 0, G_OPTION_ARG_INT, &frames,
+        "Number of frames per conversion", NULL},
+    {"from-format", 'f', 0, G_OPTION_ARG_STRING, &from_fmt, "From Format",
+        NULL},
+    {"to-format", 't', 0, G_OPTION_ARG_STRING, &to_fmt, "To Format", NULL},
+    {"writable", 'w', 0, G_OPTION_ARG_NONE, &writable,
+        "Allow the converter to write into the input samples", NULL},
+    {"duration", 'd', 0, G_OPTION_ARG_DOUBLE, &max_dur,
+        "Benchmark duration for each run (in seconds)", NULL},
+    {NULL}
+  };
+
+  ctx = g_option_context_new ("");
+  g_option_context_add_main_entries (ctx, options, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_print ("Error initializing: %s\n", GST_STR_NULL (err->message));
+    g_option_context_free (ctx);
+    g_clear_error (&err);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  if (frames <= 0) {
+    g_print ("Invalid number of frames %d\n", frames);
+    return 1;
+  }
+
+  do_benchmark_conversions (frames, from_fmt, to_fmt, writable, max_dur);
+  return 0;
+}
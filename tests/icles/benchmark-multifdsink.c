@@ -0,0 +1,136 @@
+/* GStreamer multifdsink delivery benchmark
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+#include <gst/gst.h>
+#include <gst/app/app.h>
+
+#define NUM_BUFFERS 50
+#define BUFFER_SIZE 188
+
+static gdouble
+get_cpu_time (void)
+{
+  struct rusage usage;
+
+  getrusage (RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+      (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+/* Push NUM_BUFFERS buffers to @n_clients local socket clients and print the
+ * process CPU time spent per delivered buffer. The clients don't read, all
+ * data fits in the socket buffers. */
+static void
+run_benchmark (guint n_clients, gboolean use_epoll)
+{
+  GstElement *pipeline, *src, *sink;
+  GstCaps *caps;
+  int *fds;
+  guint64 bytes, bytes_served;
+  gdouble start, cpu;
+  struct rlimit rl;
+  guint i;
+
+  /* we need two fds per client */
+  if (getrlimit (RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < 2 * n_clients + 64) {
+    rl.rlim_cur = MIN (rl.rlim_max, 2 * n_clients + 64);
+    setrlimit (RLIMIT_NOFILE, &rl);
+    if (rl.rlim_cur < 2 * n_clients + 64) {
+      g_printerr ("not enough file descriptors for %u clients\n", n_clients);
+      return;
+    }
+  }
+
+  pipeline = gst_pipeline_new (NULL);
+  src = gst_element_factory_make ("appsrc", NULL);
+  sink = gst_element_factory_make ("multifdsink", NULL);
+  if (!src || !sink) {
+    g_printerr ("appsrc or multifdsink not available\n");
+    exit (1);
+  }
+
+  caps = gst_caps_new_empty_simple ("application/x-benchmark");
+  g_object_set (src, "caps", caps, "format", GST_FORMAT_BYTES, NULL);
+  gst_caps_unref (caps);
+  g_object_set (sink, "use-epoll", use_epoll, "sync", FALSE, NULL);
+
+  gst_bin_add_many (GST_BIN (pipeline), src, sink, NULL);
+  gst_element_link (src, sink);
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  fds = g_new (int, 2 * n_clients);
+  for (i = 0; i < n_clients; i++) {
+    if (socketpair (AF_UNIX, SOCK_STREAM, 0, &fds[2 * i]) == -1) {
+      g_printerr ("could not create socket pair %u\n", i);
+      exit (1);
+    }
+    g_signal_emit_by_name (sink, "add", fds[2 * i + 1]);
+  }
+
+  start = get_cpu_time ();
+  for (i = 0; i < NUM_BUFFERS; i++) {
+    GstBuffer *buffer = gst_buffer_new_and_alloc (BUFFER_SIZE);
+
+    gst_buffer_memset (buffer, 0, i, BUFFER_SIZE);
+    gst_app_src_push_buffer (GST_APP_SRC (src), buffer);
+
+    /* wait for the delivery to all clients without burning CPU */
+    bytes = (guint64) (i + 1) * n_clients * BUFFER_SIZE;
+    do {
+      g_usleep (100);
+      g_object_get (sink, "bytes-served", &bytes_served, NULL);
+    } while (bytes_served < bytes);
+  }
+  cpu = get_cpu_time () - start;
+
+  g_print ("multifdsink %5u clients, use-epoll %d: %.3f us CPU per "
+      "delivered buffer\n", n_clients, use_epoll,
+      cpu * 1e6 / ((gdouble) n_clients * NUM_BUFFERS));
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  for (i = 0; i < 2 * n_clients; i++)
+    close (fds[i]);
+  g_free (fds);
+}
+
+int
+main (int argc, char **argv)
+{
+  static const guint n_clients[] = { 100, 1000, 10000 };
+  guint i;
+
+  gst_init (&argc, &argv);
+
+  for (i = 0; i < G_N_ELEMENTS (n_clients); i++) {
+    run_benchmark (n_clients[i], FALSE);
+    run_benchmark (n_clients[i], TRUE);
+  }
+
+  return 0;
+}
@@ -22,6 +22,8 @@
 #include "config.h"
 #endif
 
+#include <stdio.h>
+
 #include <gst/gst.h>
 #include <gst/video/video.h>
 
@@ -30,6 +32,33 @@
 
 #define DEFAULT_DURATION 2.0
 
+/* used by --sweep */
+#define SWEEP_RESOLUTIONS "320x240,1280x720,1920x1080,3840x2160," \
+    "1920x1080:1280x720,1280x720:1920x1080"
+#define SWEEP_RESAMPLERS "all"
+#define SWEEP_DITHERS "none,bayer"
+#define SWEEP_THREADS "1,4"
+
+typedef struct
+{
+  guint in_width, in_height;
+  guint out_width, out_height;
+} Resolution;
+
+typedef struct
+{
+  GArray *resolutions;
+  gchar **in_formats;
+  gchar **out_formats;
+  /* GstVideoResamplerMethod, GstVideoDitherMethod, guint */
+  GArray *resamplers;
+  GArray *dithers;
+  GArray *threads;
+  gdouble max_duration;
+  gboolean compare_generic;
+  gboolean json;
+} BenchConfig;
+
 static gint
 get_num_formats (void)
 {
@@ -41,79 +70,338 @@ get_num_formats (void)
   return num_formats + 1;
 }
 
+static gboolean
+parse_resolutions (const gchar * str, GArray * resolutions)
+{
+  gchar **items;
+  gint i;
+  gboolean res = TRUE;
+
+  items = g_strsplit (str, ",", -1);
+  for (i = 0; items[i]; i++) {
+    Resolution r;
+    gint n;
+
+    /* WxH or WxH:WxH to also scale */
+    n = sscanf (items[i], "%ux%u:%ux%u", &r.in_width, &r.in_height,
+        &r.out_width, &r.out_height);
+    if (n == 2) {
+      r.out_width = r.in_width;
+      r.out_height = r.in_height;
+    } else if (n != 4) {
+      g_printerr ("invalid resolution '%s'\n", items[i]);
+      res = FALSE;
+      break;
+    }
+    g_array_append_val (resolutions, r);
+  }
+  g_strfreev (items);
+
+  return res;
+}
+
+/* parse a comma separated list of enum nicks, "all" selects all values */
+static gboolean
+parse_enums (const gchar * str, GType type, GArray * values)
+{
+  GEnumClass *klass;
+  gchar **items;
+  gint i;
+  gboolean res = TRUE;
+
+  klass = g_type_class_ref (type);
+  if (g_str_equal (str, "all")) {
+    for (i = 0; i < klass->n_values; i++)
+      g_array_append_val (values, klass->values[i].value);
+    g_type_class_unref (klass);
+    return TRUE;
+  }
+
+  items = g_strsplit (str, ",", -1);
+  for (i = 0; items[i]; i++) {
+    GEnumValue *val = g_enum_get_value_by_nick (klass, items[i]);
+
+    if (val == NULL) {
+      g_printerr ("invalid %s '%s'\n", g_type_name (type), items[i]);
+      res = FALSE;
+      break;
+    }
+    g_array_append_val (values, val->value);
+  }
+  g_strfreev (items);
+  g_type_class_unref (klass);
+
+  return res;
+}
+
+static gboolean
+parse_threads (const gchar * str, GArray * threads)
+{
+  gchar **items;
+  gint i;
+  gboolean res = TRUE;
+
+  items = g_strsplit (str, ",", -1);
+  for (i = 0; items[i]; i++) {
+    gchar *end;
+    guint n = g_ascii_strtoull (items[i], &end, 10);
+
+    if (*items[i] == '\0' || *end != '\0') {
+      g_printerr ("invalid thread count '%s'\n", items[i]);
+      res = FALSE;
+      break;
+    }
+    g_array_append_val (threads, n);
+  }
+  g_strfreev (items);
+
+  return res;
+}
+
+static const gchar *
+enum_nick (GType type, gint value)
+{
+  GEnumClass *klass = g_type_class_ref (type);
+  GEnumValue *val = g_enum_get_value (klass, value);
+  const gchar *nick = val ? val->value_nick : "unknown";
+
+  /* enum classes are never finalized, the nick stays valid */
+  g_type_class_unref (klass);
+
+  return nick;
+}
+
+static gboolean
+format_selected (gchar ** formats, const gchar * format)
+{
+  return formats == NULL || g_strv_contains ((const gchar * const *) formats,
+      format);
+}
+
+static gdouble
+run_conversion (GstVideoConverter * convert, GstVideoFrame * inframe,
+    GstVideoFrame * outframe, GTimer * timer, gdouble max_duration,
+    gint * count)
+{
+  gdouble elapsed;
+
+  /* warmup */
+  gst_video_converter_frame (convert, inframe, outframe);
+
+  *count = 0;
+  g_timer_start (timer);
+  while (TRUE) {
+    gst_video_converter_frame (convert, inframe, outframe);
+
+    (*count)++;
+    elapsed = g_timer_elapsed (timer, NULL);
+    if (elapsed >= max_duration)
+      break;
+  }
+
+  return elapsed;
+}
+
+static void
+print_json_header (const BenchConfig * config)
+{
+  const gchar *orc_code = g_getenv ("ORC_CODE");
+  gchar *version = gst_version_string ();
+
+  gst_println ("{");
+  gst_println ("  \"version\": \"%s\",", version);
+  if (orc_code)
+    gst_println ("  \"orc-code\": \"%s\",", orc_code);
+  else
+    gst_println ("  \"orc-code\": null,");
+  gst_println ("  \"duration\": %g,", config->max_duration);
+  gst_println ("  \"results\": [");
+  g_free (version);
+}
+
+static void
+print_json_footer (void)
+{
+  gst_println ("");
+  gst_println ("  ]");
+  gst_println ("}");
+}
+
+static void
+benchmark_conversion (const BenchConfig * config, GstVideoFrame * inframe,
+    GstVideoFrame * outframe, const Resolution * r, gint resampler,
+    gint dither, guint threads, GTimer * timer, gboolean * first)
+{
+  GstVideoConverter *convert;
+  gdouble elapsed, convert_sec, ns_per_pixel, mb_per_sec;
+  gdouble generic_sec = 0.0;
+  const gchar *infmt_str, *outfmt_str, *resampler_str;
+  gboolean scaling;
+  gint count;
+  gsize frame_size;
+
+  infmt_str = GST_VIDEO_INFO_NAME (&inframe->info);
+  outfmt_str = GST_VIDEO_INFO_NAME (&outframe->info);
+  scaling = r->in_width != r->out_width || r->in_height != r->out_height;
+  resampler_str = scaling ? enum_nick (GST_TYPE_VIDEO_RESAMPLER_METHOD,
+      resampler) : NULL;
+
+  convert = gst_video_converter_new (&inframe->info, &outframe->info,
+      gst_structure_new ("options",
+          GST_VIDEO_CONVERTER_OPT_RESAMPLER_METHOD,
+          GST_TYPE_VIDEO_RESAMPLER_METHOD, resampler,
+          GST_VIDEO_CONVERTER_OPT_DITHER_METHOD,
+          GST_TYPE_VIDEO_DITHER_METHOD, dither,
+          GST_VIDEO_CONVERTER_OPT_THREADS, G_TYPE_UINT, threads, NULL));
+  elapsed = run_conversion (convert, inframe, outframe, timer,
+      config->max_duration, &count);
+  convert_sec = count / elapsed;
+  gst_video_converter_free (convert);
+
+  if (config->compare_generic) {
+    /* a dither quantization other than 1 disables the fastpaths, with
+     * dithering disabled the generic path produces the same result */
+    convert = gst_video_converter_new (&inframe->info, &outframe->info,
+        gst_structure_new ("options",
+            GST_VIDEO_CONVERTER_OPT_RESAMPLER_METHOD,
+            GST_TYPE_VIDEO_RESAMPLER_METHOD, resampler,
+            GST_VIDEO_CONVERTER_OPT_DITHER_METHOD,
+            GST_TYPE_VIDEO_DITHER_METHOD, GST_VIDEO_DITHER_NONE,
+            GST_VIDEO_CONVERTER_OPT_DITHER_QUANTIZATION, G_TYPE_UINT, 2,
+            GST_VIDEO_CONVERTER_OPT_THREADS, G_TYPE_UINT, threads, NULL));
+    elapsed = run_conversion (convert, inframe, outframe, timer,
+        config->max_duration, &count);
+    generic_sec = count / elapsed;
+    gst_video_converter_free (convert);
+  }
+
+  /* per output pixel, bytes are read and written per frame */
+  ns_per_pixel = 1e9 / (convert_sec * r->out_width * r->out_height);
+  frame_size = GST_VIDEO_FRAME_SIZE (inframe) + GST_VIDEO_FRAME_SIZE (outframe);
+  mb_per_sec = convert_sec * frame_size / 1e6;
+
+  if (config->json) {
+    gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+    gst_println ("%s    {", *first ? "" : ",");
+    gst_println ("      \"in-format\": \"%s\",", infmt_str);
+    gst_println ("      \"out-format\": \"%s\",", outfmt_str);
+    gst_println ("      \"in-width\": %u, \"in-height\": %u,",
+        r->in_width, r->in_height);
+    gst_println ("      \"out-width\": %u, \"out-height\": %u,",
+        r->out_width, r->out_height);
+    if (resampler_str)
+      gst_println ("      \"resampler\": \"%s\",", resampler_str);
+    else
+      gst_println ("      \"resampler\": null,");
+    gst_println ("      \"dither\": \"%s\",",
+        enum_nick (GST_TYPE_VIDEO_DITHER_METHOD, dither));
+    gst_println ("      \"threads\": %u,", threads);
+    gst_println ("      \"conversions-per-sec\": %s,",
+        g_ascii_formatd (buf, sizeof (buf), "%.2f", convert_sec));
+    gst_println ("      \"ns-per-pixel\": %s,",
+        g_ascii_formatd (buf, sizeof (buf), "%.4f", ns_per_pixel));
+    if (config->compare_generic) {
+      gst_println ("      \"generic-ns-per-pixel\": %s,",
+          g_ascii_formatd (buf, sizeof (buf), "%.4f",
+              1e9 / (generic_sec * r->out_width * r->out_height)));
+    }
+    gst_printf ("      \"mb-per-sec\": %s\n    }",
+        g_ascii_formatd (buf, sizeof (buf), "%.2f", mb_per_sec));
+  } else if (config->compare_generic) {
+    gst_println ("%8.1f conversions/sec %s -> %s @ %ux%u -> %ux%u, "
+        "generic %8.1f conversions/sec, speedup %.2fx", convert_sec,
+        infmt_str, outfmt_str, r->in_width, r->in_height, r->out_width,
+        r->out_height, generic_sec, convert_sec / generic_sec);
+  } else {
+    gst_println ("%8.1f conversions/sec %s -> %s @ %ux%u -> %ux%u, "
+        "%.3f ns/pixel, %.1f MB/s, %s/%s/%u threads", convert_sec,
+        infmt_str, outfmt_str, r->in_width, r->in_height, r->out_width,
+        r->out_height, ns_per_pixel, mb_per_sec,
+        resampler_str ? resampler_str : "-",
+        enum_nick (GST_TYPE_VIDEO_DITHER_METHOD, dither), threads);
+  }
+  *first = FALSE;
+}
+
 static void
-do_benchmark_conversions (guint width, guint height, const gchar * in_format,
-    const gchar * out_format, gdouble max_duration)
+do_benchmark_conversions (const BenchConfig * config)
 {
-  const gchar *infmt_str, *outfmt_str;
   GstVideoFormat infmt, outfmt;
   GTimer *timer;
   gint num_formats;
+  gboolean first = TRUE;
+  guint r, i, j, k;
 
   timer = g_timer_new ();
 
   num_formats = get_num_formats ();
 
-  for (infmt = GST_VIDEO_FORMAT_I420; infmt < num_formats; infmt++) {
-    GstVideoInfo ininfo;
-    GstVideoFrame inframe;
-    GstBuffer *inbuffer;
-
-    infmt_str = gst_video_format_to_string (infmt);
-    if (in_format != NULL && !g_str_equal (in_format, infmt_str))
-      continue;
-
-    gst_video_info_set_format (&ininfo, infmt, width, height);
-    inbuffer = gst_buffer_new_and_alloc (ininfo.size);
-    gst_buffer_memset (inbuffer, 0, 0, -1);
-    gst_video_frame_map (&inframe, &ininfo, inbuffer, GST_MAP_READ);
-
-    for (outfmt = GST_VIDEO_FORMAT_I420; outfmt < num_formats; outfmt++) {
-      GstVideoInfo outinfo;
-      GstVideoFrame outframe;
-      GstBuffer *outbuffer;
-      GstVideoConverter *convert;
-      gdouble elapsed, convert_sec;
-      gint count;
-
-      outfmt_str = gst_video_format_to_string (outfmt);
-      if (out_format != NULL && !g_str_equal (out_format, outfmt_str))
-        continue;
+  if (config->json)
+    print_json_header (config);
 
-      /* Or maybe we should allocate more buffers to minimise cache effects? */
-      gst_video_info_set_format (&outinfo, outfmt, width, height);
-      outbuffer = gst_buffer_new_and_alloc (outinfo.size);
-      gst_video_frame_map (&outframe, &outinfo, outbuffer, GST_MAP_WRITE);
+  for (r = 0; r < config->resolutions->len; r++) {
+    const Resolution *res =
+        &g_array_index (config->resolutions, Resolution, r);
+    gboolean scaling = res->in_width != res->out_width ||
+        res->in_height != res->out_height;
+    /* the resampler is only used when scaling */
+    guint n_resamplers = scaling ? config->resamplers->len : 1;
 
-      convert = gst_video_converter_new (&ininfo, &outinfo, NULL);
-      /* warmup */
-      gst_video_converter_frame (convert, &inframe, &outframe);
+    for (infmt = GST_VIDEO_FORMAT_I420; infmt < num_formats; infmt++) {
+      GstVideoInfo ininfo;
+      GstVideoFrame inframe;
+      GstBuffer *inbuffer;
 
-      count = 0;
-      g_timer_start (timer);
-      while (TRUE) {
-        gst_video_converter_frame (convert, &inframe, &outframe);
+      if (!format_selected (config->in_formats,
+              gst_video_format_to_string (infmt)))
+        continue;
 
-        count++;
-        elapsed = g_timer_elapsed (timer, NULL);
-        if (elapsed >= max_duration)
-          break;
-      }
+      if (!gst_video_info_set_format (&ininfo, infmt, res->in_width,
+              res->in_height))
+        continue;
+      inbuffer = gst_buffer_new_and_alloc (ininfo.size);
+      gst_buffer_memset (inbuffer, 0, 0, -1);
+      gst_video_frame_map (&inframe, &ininfo, inbuffer, GST_MAP_READ);
 
-      convert_sec = count / elapsed;
+      for (outfmt = GST_VIDEO_FORMAT_I420; outfmt < num_formats; outfmt++) {
+        GstVideoInfo outinfo;
+        GstVideoFrame outframe;
+        GstBuffer *outbuffer;
 
-      gst_println ("%8.1f conversions/sec %s -> %s @ %ux%u, %d/%.5f",
-          convert_sec, infmt_str, outfmt_str, width, height, count, elapsed);
+        if (!format_selected (config->out_formats,
+                gst_video_format_to_string (outfmt)))
+          continue;
 
-      gst_video_converter_free (convert);
+        /* Or maybe we should allocate more buffers to minimise cache effects? */
+        if (!gst_video_info_set_format (&outinfo, outfmt, res->out_width,
+                res->out_height))
+          continue;
+        outbuffer = gst_buffer_new_and_alloc (outinfo.size);
+        gst_video_frame_map (&outframe, &outinfo, outbuffer, GST_MAP_WRITE);
 
-      gst_video_frame_unmap (&outframe);
-      gst_buffer_unref (outbuffer);
+        for (i = 0; i < n_resamplers; i++) {
+          for (j = 0; j < config->dithers->len; j++) {
+            for (k = 0; k < config->threads->len; k++) {
+              benchmark_conversion (config, &inframe, &outframe, res,
+                  g_array_index (config->resamplers, gint, i),
+                  g_array_index (config->dithers, gint, j),
+                  g_array_index (config->threads, guint, k), timer, &first);
+            }
+          }
+        }
+
+        gst_video_frame_unmap (&outframe);
+        gst_buffer_unref (outbuffer);
+      }
+      gst_video_frame_unmap (&inframe);
+      gst_buffer_unref (inbuffer);
     }
-    gst_video_frame_unmap (&inframe);
-    gst_buffer_unref (inbuffer);
   }
 
+  if (config->json)
+    print_json_footer ();
+
   g_timer_destroy (timer);
 }
 
@@ -126,15 +414,44 @@ main (int argc, char **argv)
   gdouble max_dur = DEFAULT_DURATION;
   gchar *from_fmt = NULL;
   gchar *to_fmt = NULL;
+  gchar *resolutions = NULL;
+  gchar *resamplers = NULL;
+  gchar *dithers = NULL;
+  gchar *threads = NULL;
+  gboolean compare_generic = FALSE;
+  gboolean json = FALSE;
+  gboolean orc_backup = FALSE;
+  gboolean sweep = FALSE;
+  BenchConfig config;
+  gboolean ret;
   GOptionContext *ctx;
   GOptionEntry options[] = {
     {"width", 'w', 0, G_OPTION_ARG_INT, &width, "Width", NULL},
     {"height", 'h', 0, G_OPTION_ARG_INT, &height, "Height", NULL},
-    {"from-format", 'f', 0, G_OPTION_ARG_STRING, &from_fmt, "From Format",
-        NULL},
-    {"to-format", 't', 0, G_OPTION_ARG_STRING, &to_fmt, "To Format", NULL},
+    {"from-format", 'f', 0, G_OPTION_ARG_STRING, &from_fmt,
+        "From Formats (comma separated)", NULL},
+    {"to-format", 't', 0, G_OPTION_ARG_STRING, &to_fmt,
+        "To Formats (comma separated)", NULL},
+    {"resolutions", 'r', 0, G_OPTION_ARG_STRING, &resolutions,
+          "Resolutions as WxH or WxH:WxH to scale (comma separated), "
+          "overrides width and height", NULL},
+    {"resampler", 's', 0, G_OPTION_ARG_STRING, &resamplers,
+        "Resampler methods used when scaling (comma separated or all)", NULL},
+    {"dither", 'D', 0, G_OPTION_ARG_STRING, &dithers,
+        "Dither methods (comma separated or all)", NULL},
+    {"threads", 'T', 0, G_OPTION_ARG_STRING, &threads,
+        "Thread counts (comma separated)", NULL},
+    {"sweep", 'S', 0, G_OPTION_ARG_NONE, &sweep,
+          "Sweep common resolutions, all resamplers and some dither methods "
+          "and thread counts, unless given explicitly", NULL},
     {"duration", 'd', 0, G_OPTION_ARG_DOUBLE, &max_dur,
         "Benchmark duration for each run (in seconds)", NULL},
+    {"compare-generic", 'g', 0, G_OPTION_ARG_NONE, &compare_generic,
+        "Compare with the generic conversion path", NULL},
+    {"orc-backup", 'b', 0, G_OPTION_ARG_NONE, &orc_backup,
+        "Use the C backup functions instead of ORC compiled code", NULL},
+    {"json", 'j', 0, G_OPTION_ARG_NONE, &json,
+        "Print the results as JSON", NULL},
     {NULL}
   };
 
@@ -149,6 +466,55 @@ main (int argc, char **argv)
   }
   g_option_context_free (ctx);
 
-  do_benchmark_conversions (width, height, from_fmt, to_fmt, max_dur);
-  return 0;
+  /* ORC reads this when the first ORC function is compiled, which has not
+   * happened yet */
+  if (orc_backup)
+    g_setenv ("ORC_CODE", "backup", TRUE);
+
+  config.resolutions = g_array_new (FALSE, FALSE, sizeof (Resolution));
+  config.resamplers = g_array_new (FALSE, FALSE, sizeof (gint));
+  config.dithers = g_array_new (FALSE, FALSE, sizeof (gint));
+  config.threads = g_array_new (FALSE, FALSE, sizeof (guint));
+  config.in_formats = from_fmt ? g_strsplit (from_fmt, ",", -1) : NULL;
+  config.out_formats = to_fmt ? g_strsplit (to_fmt, ",", -1) : NULL;
+  config.max_duration = max_dur;
+  config.compare_generic = compare_generic;
+  config.json = json;
+
+  if (resolutions) {
+    ret = parse_resolutions (resolutions, config.resolutions);
+  } else if (sweep) {
+    ret = parse_resolutions (SWEEP_RESOLUTIONS, config.resolutions);
+  } else {
+    Resolution r = { width, height, width, height };
+
+    g_array_append_val (config.resolutions, r);
+    ret = TRUE;
+  }
+  /* the defaults of the converter when not sweeping */
+  ret = ret && parse_enums (resamplers ? resamplers : sweep ?
+      SWEEP_RESAMPLERS : "cubic", GST_TYPE_VIDEO_RESAMPLER_METHOD,
+      config.resamplers);
+  ret = ret && parse_enums (dithers ? dithers : sweep ?
+      SWEEP_DITHERS : "bayer", GST_TYPE_VIDEO_DITHER_METHOD, config.dithers);
+  ret = ret && parse_threads (threads ? threads : sweep ?
+      SWEEP_THREADS : "1", config.threads);
+
+  if (ret)
+    do_benchmark_conversions (&config);
+
+  g_array_unref (config.resolutions);
+  g_array_unref (config.resamplers);
+  g_array_unref (config.dithers);
+  g_array_unref (config.threads);
+  g_strfreev (config.in_formats);
+  g_strfreev (config.out_formats);
+  g_free (from_fmt);
+  g_free (to_fmt);
+  g_free (resolutions);
+  g_free (resamplers);
+  g_free (dithers);
+  g_free (threads);
+
+  return ret ? 0 : 1;
 }